@@ -7,11 +7,16 @@
 #include <time.h>
 #include <memory>
 #include <mutex>
+#include <atomic>
+#include <future>
 
 #include "CCDB/Globals.h"
 #include "CCDB/Providers/DataProvider.h"
+#include "CCDB/Providers/DataProviderPool.h"
 #include "CCDB/PthreadMutex.h"
 #include "CCDB/PthreadSyncObject.h"
+#include "CCDB/Helpers/SharedMemoryCache.h"
+#include "CCDB/Helpers/ConstantsSnapshot.h"
 
 #define ERRMSG_INVALID_CONNECT_USAGE "Invalid DMySQLCalibration usage. Using DMySQLCalibration::Connect method with provider == NULL and ProviderIsLocked==true." 
 #define ERRMSG_CONNECTED_TO_ANOTHER "The connection is open to another source. DCalibration is already connected using another connection string" 
@@ -121,6 +126,9 @@ public:
      * /path/to/data:::2029 - only path and date
      *
      *
+     * Each row has a copy of every column name. To read cells by names without copies
+     * use GetAssignment(namepath)->GetRow(rowIndex), @see Assignment::RowView
+     *
      * @parameter [out] values - vector of rows, each row is a map<header_name, string_cell_value>
      * @parameter [in]  namepath - data path. Short /path/to/data .Full format is /path/to/data:run:variation:time
      * @return true if constants were found and filled. false if namepath was not found. raises std::exception if any other error acured.
@@ -142,6 +150,59 @@ public:
     virtual bool GetCalib(vector< vector<double> > &values, const string & namepath);
     virtual bool GetCalib(vector< vector<int> >   &values, const string & namepath);
 
+    /** @brief Get only selected columns of constants by namepath
+     *
+     * this version of function fills values as a table represented as
+     * vector< vector<T> > = vector of rows where each row has the cells of requested columns
+     * in the order they are given in columns. Other columns are not copied or converted,
+     * which matters for wide tables that are read partially.
+     *
+     * @parameter [out] values - vector of rows, each row is a vector of the selected cells
+     * @parameter [in]  namepath - data path
+     * @parameter [in]  columns - names of columns to take
+     * @return true if constants were found and filled. false if namepath was not found. raises std::logic_error if a column doesn't exist or any other error acured.
+     */
+    virtual bool GetCalib(vector< vector<string> > &values, const string & namepath, const vector<string> & columns);
+    virtual bool GetCalib(vector< vector<double> > &values, const string & namepath, const vector<string> & columns);
+    virtual bool GetCalib(vector< vector<int> >   &values, const string & namepath, const vector<string> & columns);
+
+    /** @brief Finds one row of constants by value of a key column
+     *
+     * Tables like channel => values are usually read whole and then scanned for the needed row.
+     * Lookup uses the index of the key column that is built once per cached assignment
+     * (@see Assignment::GetRowIndex) and finds the row in O(1).
+     * For the hottest loops one can take GetAssignment(namepath) once and use
+     * Assignment::GetRowIndex directly, that skips the namepath parsing too.
+     *
+     * @parameter [out] row - cells of the found row
+     * @parameter [in]  namepath - data path
+     * @parameter [in]  keyColumn - name of the key column
+     * @parameter [in]  key - value of the key column as it is stored, or an integer value
+     *                         (@see Assignment::GetIntRowIndex), so "07" is found by 7
+     * @return true if the row was found. false if namepath or key was not found. raises std::logic_error if there is no such column
+     */
+    virtual bool Lookup(vector<string> &row, const string & namepath, const string & keyColumn, const string & key);
+    virtual bool Lookup(vector<double> &row, const string & namepath, const string & keyColumn, const string & key);
+    virtual bool Lookup(vector<int> &row, const string & namepath, const string & keyColumn, const string & key);
+    virtual bool Lookup(vector<string> &row, const string & namepath, const string & keyColumn, long key);
+    virtual bool Lookup(vector<double> &row, const string & namepath, const string & keyColumn, long key);
+    virtual bool Lookup(vector<int> &row, const string & namepath, const string & keyColumn, long key);
+
+    /** @brief Opens a cursor that reads constants row by row
+     *
+     * For huge tables (millions of rows) GetCalib materializes the whole table at once.
+     * The cursor decodes only one row at a time and, with SQLite provider, reads the blob
+     * from the database by chunks. The data is not cached. A streaming cursor takes a connection
+     * of the read pool until it is deleted, without the pool the blob is read into memory at once.
+     * So a thread should not keep more cursors open than the pool size.
+     *
+     * @remark the cursor must be deleted by the caller and before the calibration is disconnected
+     *
+     * @parameter [in] namepath - full namepath is /path/to/data:run:variation:time but usually it is only /path/to/data
+     * @return new BlobCursor or NULL if namepath was not found
+     */
+    virtual BlobCursor* OpenCursor(const string & namepath);
+
     /** @brief Get constants by namepath
      *
      * this version of function fills values as one row
@@ -271,6 +332,110 @@ public:
     /** @brief if true the caching is using */
     bool IsCacheEnabled();
 
+    /** @brief Keeps decoded tables in a shared memory segment used by all processes of the node
+     *
+     * GetCalib(vector< vector<double> >) and GetCalib(vector<double>) take values from the segment
+     * if another process has decoded them already, otherwise they decode and add them.
+     * Tables are kept until the segment is removed, @see SharedMemoryCache. Latest constants (no time
+     * in the request) older than SetCacheMaxAge are loaded again and replace the shared table.
+     * CalibrationGenerator enables it if CCDB_SHARED_CACHE environment variable has the segment name.
+     *
+     * @param segmentName - name of the segment, i.e. "/ccdb_cache". Throws logic_error if it can't be opened
+     * @param size        - size of the segment, if this process creates it
+     */
+    void EnableSharedCache(const string& segmentName, size_t size = SharedMemoryCache::DefaultSize);
+
+    /** @brief Shared cache of decoded tables or NULL if it is not enabled */
+    SharedMemoryCache* GetSharedCache() const { return mSharedCache; }
+
+    /** @brief Loads tables before the process forks workers
+     *
+     * Tables are decoded and packed into one read-only block (@see ConstantsSnapshot), that
+     * GetCalib(vector< vector<double> >) and GetCalib(vector<double>) read from. Forked workers
+     * share its pages with the parent. Then database connections are closed, so no handle is
+     * shared by processes. A worker connects again only if it reads a table that is not packed.
+     *
+     * Only the number forms GetCalib(vector< vector<double> >) and GetCalib(vector<double>) read the
+     * snapshot. Other forms (strings, ints, maps by column names) and GetAssignment load the assignment
+     * through a new connection, as packed numbers don't keep cells as they are in the database.
+     * Throws std::logic_error if the provider is locked (@see UseProvider): its connection can't be closed here.
+     *
+     * @warning no other thread should read constants while the process forks
+     *
+     * @parameter [in] namepaths - tables to load. All tables of the default run and variation if empty
+     * @return false if some of the given namepaths were not found. Other tables are loaded anyway
+     */
+    bool PrepareForFork(const vector<string> & namepaths = vector<string>());
+
+    /** @brief Tables packed by PrepareForFork or NULL */
+    ConstantsSnapshot* GetForkSnapshot() const { return mForkSnapshot; }
+
+    /** @brief Pool of read connections or NULL if this calibration doesn't use one
+     *
+     * If there is a pool, GetAssignment takes a provider from it and threads read constants
+     * in parallel, each through its own connection. Otherwise reads are serialized on one provider.
+     * The pool may be used to change the number of connections and to see the statistics.
+     */
+    DataProviderPool* GetReadPool() const { return mReadPool; }
+
+    /** @brief Time a request waits for the database, ms. 0 - no limit (default)
+     *
+     * If loading of a table takes longer, GetCalib returns the last known good assignment
+     * of the table (the expired cached one or the one of the same run loaded for another time)
+     * and the table is loaded in background. Constants of another run are never given. Later requests get the new one when it is loaded.
+     * If there is no older assignment of the table, the request waits as without the deadline.
+     * For online monitoring slightly stale constants are better than a stalled event loop.
+     * @see DeadlineScope to set the deadline for some requests only
+     */
+    void SetDeadline(unsigned milliseconds) { mDeadline = milliseconds; }
+
+    /** @brief Deadline of requests in ms. 0 - no limit */
+    unsigned GetDeadline() const { return mDeadline; }
+
+    /** @brief Sets the deadline for requests of this thread while the scope lives
+     *
+     * The deadline is taken instead of the one given by SetDeadline by all calibrations.
+     * 0 - the calibration deadline is used. Scopes may be nested
+     */
+    class DeadlineScope
+    {
+    public:
+        explicit DeadlineScope(unsigned milliseconds);
+        ~DeadlineScope();
+
+    private:
+        unsigned mPrevious;
+        DeadlineScope(const DeadlineScope&);
+        DeadlineScope& operator=(const DeadlineScope&);
+    };
+
+    /** @brief Age in seconds after which a cached assignment is loaded again. 0 - never (default)
+     *
+     * The replaced assignment is deleted when the same constants are loaded again the next time,
+     * so a caller should not keep assignments longer than the max age.
+     */
+    void SetCacheMaxAge(double seconds) { mCacheMaxAge = seconds; }
+
+    /** @brief Age in seconds after which a cached assignment is loaded again */
+    double GetCacheMaxAge() const { return mCacheMaxAge; }
+
+    /** @brief Counts of GetAssignment results */
+    struct LookupStats
+    {
+        size_t Hits;        /// Taken from the cache
+        size_t Stale;       /// Last known good assignment given on the deadline
+        size_t Timeouts;    /// The deadline passed and there was nothing to give, the request waited
+    };
+
+    /** @brief Counts of GetAssignment results of this calibration */
+    LookupStats GetLookupStats() const;
+
+    /** @brief Waits until tables that are loaded in background are loaded
+     *
+     * Disconnect and the destructor call it, so background loads never use a closed provider
+     */
+    void WaitForRefreshes();
+
 protected:
 
 
@@ -298,20 +463,62 @@ protected:
      */
     void UpdateActivityTime();
 
+    void CheckConnection(); /// Check if is connected and reconnect if needed (and allowed)
+
     DataProvider *mProvider;         /// Underlaid DataProvider object
+    DataProviderPool *mReadPool;     /// Providers for parallel reads (may be NULL)
     bool mProviderIsLocked;          /// If provider
     int mDefaultRun;                 /// Default run number
     string mDefaultVariation;        /// Default variation
     time_t mDefaultTime;             /// Set default time
-    time_t mLastActivityTime;        /// Time of the last request
+    std::atomic<time_t> mLastActivityTime; /// Time of the last request
     bool mIsAutoReconnect;           /// Try to auto-reconnect if possible
     bool mIsCacheEnabled;            /// If true the data is cached
+    SharedMemoryCache *mSharedCache; /// Decoded tables shared by processes of the node (may be NULL)
+    ConstantsSnapshot *mForkSnapshot;/// Decoded tables packed before fork (may be NULL)
 
-    std::mutex mReadMutex;
+    std::mutex mReadMutex;           /// Guards mProvider when there is no read pool
 private:
     Calibration(const Calibration& rhs);
     Calibration& operator=(const Calibration& rhs);
-    void CheckConnection(); /// Check if is connected and reconnect if needed (and allowed)
+    /** @brief Gets assignment with loaded columns and finds indexes of requested columns
+     *  @return assignment or NULL if namepath was not found. Throws logic_error if a column doesn't exist
+     */
+    Assignment* GetAssignmentColumns(const string & namepath, const vector<string> & columns, vector<int> & columnIndexes);
+
+    /** @brief Finds the row by the key (string or long) and converts its cells, @see Lookup */
+    template<class TCell, class TKey>
+    bool LookupRow(vector<TCell> &row, const string & namepath, const string & keyColumn, const TKey & key);
+
+    /** @brief Loads assignment through the pool or the main provider and puts it to the cache
+     *  @return the cached assignment, which is the loaded one or the one loaded by another thread meanwhile
+     */
+    Assignment* LoadAssignment(const string& cacheKey, const string& tableKey, int run, const string& path, const string& variation, time_t time, bool loadColumns);
+
+    /** @brief Puts loaded assignment to the cache. The provider that loaded it must be held by the caller */
+    Assignment* StoreAssignment(const string& cacheKey, const string& tableKey, Assignment* assignment);
+
+    /** @brief Starts background load of the assignment or gives the load that is going already */
+    std::shared_future<Assignment*> StartRefresh(const string& cacheKey, const string& tableKey, int run, const string& path, const string& variation, time_t time, bool loadColumns);
+
+    /** @brief Key of the table in the shared cache and the fork snapshot. It has the hash of the connection string and resolved run, variation and time */
+    string GetSharedCacheKey(const string & namepath);
+
+    std::atomic<unsigned> mDeadline;                /// Request deadline, ms. 0 - no limit
+    double mCacheMaxAge;                            /// Cached assignments older than this are loaded again, s. 0 - never
+    std::atomic<size_t> mHitsCount;
+    std::atomic<size_t> mStaleCount;
+    std::atomic<size_t> mTimeoutsCount;
+    /** @brief The last loaded assignment of a table */
+    struct LastGood
+    {
+        string CacheKey;                            /// The assignment is taken from the cache by it, the cache may replace it
+        Assignment* Value;                          /// Used when the cache is disabled
+    };
+
+    std::mutex mRefreshMutex;                       /// Guards mRefreshes and mLastGood
+    std::map<string, std::shared_future<Assignment*> > mRefreshes;  /// Background loads by cache key
+    std::map<string, LastGood> mLastGood;           /// path:run:variation => the last loaded assignment
 };
 
 }
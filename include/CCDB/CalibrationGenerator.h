@@ -99,8 +99,12 @@ public:
 
 private:	
 
-    //@parameter [in] connectionString - Connection string to the data source
-    static Calibration* CreateCalibration(bool isMySQL, int run, const std::string& variation, const time_t time);
+    /** @brief Creates not connected Calibration of the connection string type
+     *
+     * @parameter [in] connectionString - Connection string to the data source
+     * @return Calibration*. Throws logic_error if the type is unknown
+     */
+    static Calibration* NewCalibration(const std::string & connectionString, int run, const std::string& variation, const time_t time);
 
     CalibrationGenerator(const CalibrationGenerator& rhs);
     CalibrationGenerator& operator=(const CalibrationGenerator& rhs);
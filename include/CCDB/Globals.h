@@ -82,6 +82,9 @@ typedef int dbkey_t;
 //My sql result was not cleaned after last query
 #define CCDB_WARNING_RESULT_NOT_CLEANED 5020
 
+//Local copy of sqlite file could not be made, the original file is used
+#define CCDB_WARNING_SCRATCH_COPY 5030
+
 //Object name format is invalid. Only English letters, numbers and '_' are allowed.
 #define CCDB_ERROR_INVALID_OBJECT_NAME 1110
 
@@ -140,6 +143,9 @@ typedef int dbkey_t;
 //ASSIGMEN is NULL or has improper ID so update operations cant be done
 #define CCDB_ERROR_DATA_INCONSISTANT 1280
 
+//Data file (i.e. ccdbpack) has wrong format, unsupported version or is truncated
+#define CCDB_ERROR_FILE_FORMAT 1290
+
 /*----------------------------------------------------------------------------------------------------
  *  SYSTEM DEFINE
  * -------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,108 @@
+#ifndef AdmissionControl_h__
+#define AdmissionControl_h__
+
+#include <stddef.h>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace ccdb
+{
+    /** @brief Client side limits of requests to one server
+     *
+     * When thousands of jobs start at once, each of them connects and sends its first queries at the
+     * same instant. The controller smooths that from the client side:
+     *   - token bucket: requests go with the given rate, up to burst requests at once
+     *   - in flight cap: not more than the given number of requests of the process wait for the server
+     * Connections also wait a random jitter before connecting and retry with randomized exponential
+     * backoff (@see GetBackoffMilliseconds), so jobs that started together spread in time.
+     *
+     * Controllers are shared by all connections of the process to the host with the same limits (@see GetForHost).
+     * All functions are thread safe
+     */
+    class AdmissionControl
+    {
+    public:
+
+        /**
+         * @param rate        - requests per second, <= 0 - no rate limit
+         * @param burst       - requests that may go at once. At least 1
+         * @param maxInFlight - requests waiting for the server at once, 0 - no limit
+         */
+        AdmissionControl(double rate, size_t burst, size_t maxInFlight);
+
+        /** @brief Controller shared by all connections of the process to the host with the same limits
+         *
+         * The controller is made by the first call for the host and limits and lives until the process ends.
+         * Connections that ask other limits for the host get a controller of their own, so each one
+         * has the limits it asked for and limits are never changed silently.
+         */
+        static AdmissionControl* GetForHost(const std::string& host, double rate, size_t burst, size_t maxInFlight);
+
+        /** @brief Waits for a token of the bucket */
+        void AcquireToken();
+
+        /** @brief Takes a token if there is one. Doesn't wait */
+        bool TryAcquireToken();
+
+        /** @brief Waits for a free in flight place and takes it */
+        void Enter();
+
+        /** @brief Frees the in flight place */
+        void Leave();
+
+        /** Number of requests in flight now */
+        size_t GetInFlight() const;
+
+        /** Limits of the controller */
+        double GetRate() const { return mRate; }
+        size_t GetMaxInFlight() const { return mMaxInFlight; }
+
+        /** @brief Takes a token and an in flight place for the scope of a request. NULL controller does nothing */
+        class Ticket
+        {
+        public:
+            explicit Ticket(AdmissionControl* control): mControl(control)
+            {
+                if(!mControl) return;
+                mControl->AcquireToken();
+                mControl->Enter();
+            }
+            ~Ticket() { if(mControl) mControl->Leave(); }
+
+        private:
+            AdmissionControl* mControl;
+            Ticket(const Ticket&);
+            Ticket& operator=(const Ticket&);
+        };
+
+        /** @brief Random delay in [0, maxMilliseconds] */
+        static unsigned RandomMilliseconds(unsigned maxMilliseconds);
+
+        /** @brief Delay before the retry: random in [0, min(cap, base*2^attempt)] ("full jitter" backoff) */
+        static unsigned GetBackoffMilliseconds(unsigned attempt, unsigned baseMilliseconds, unsigned capMilliseconds);
+
+    private:
+
+        typedef std::chrono::steady_clock Clock;
+
+        /** Adds tokens for the time passed. mMutex should be locked */
+        void Refill(Clock::time_point now);
+
+        double mRate;
+        double mBurst;
+        size_t mMaxInFlight;
+
+        mutable std::mutex mMutex;
+        std::condition_variable mInFlightFreed;
+        double mTokens;
+        Clock::time_point mLastRefill;
+        size_t mInFlight;
+
+        AdmissionControl(const AdmissionControl&);
+        AdmissionControl& operator=(const AdmissionControl&);
+    };
+}
+
+#endif // AdmissionControl_h__
@@ -0,0 +1,101 @@
+#ifndef BlobCursor_h__
+#define BlobCursor_h__
+
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace ccdb
+{
+    /** @brief Reads data blob row by row without materializing the whole table
+     *
+     * The blob is pulled by chunks through ReadChunk, cells are decoded the same way
+     * as StringUtils::SplitBlob does ('&delimiter;' is decoded, empty cells are skipped),
+     * and only one row is kept in memory at a time.
+     *
+     * Derived classes define where the chunks come from: @see StringBlobCursor
+     * and the incremental blob I/O cursor of SQLiteDataProvider.
+     */
+    class BlobCursor
+    {
+    public:
+
+        /**
+         * @param columnsCount - number of columns in the table. Each row has that number of cells
+         * @param bufferSize   - size of the read buffer in bytes
+         */
+        BlobCursor(size_t columnsCount, size_t bufferSize = 64*1024);
+        virtual ~BlobCursor();
+
+        /** @brief Reads next cell
+         * @param [out] cell - decoded cell value
+         * @return false if there are no more cells
+         */
+        bool NextCell(std::string& cell);
+
+        /** @brief Reads next row
+         * @param [out] row - GetColumnsCount() cells of the row
+         * @return false if there are no more full rows
+         */
+        bool NextRow(std::vector<std::string>& row);
+        bool NextRow(std::vector<double>& row);
+        bool NextRow(std::vector<int>& row);
+
+        /** Number of columns (cells in a row) */
+        size_t GetColumnsCount() const { return mColumnsCount; }
+
+        /** Number of rows read so far */
+        size_t GetRowsRead() const { return mRowsRead; }
+
+        /** @brief Action done when the cursor is deleted, after the derived class has closed the blob.
+         *  I.e. the connection the cursor reads through is given back to its pool
+         */
+        void SetCloseAction(const std::function<void()>& action) { mCloseAction = action; }
+
+    protected:
+
+        /** @brief Reads next chunk of the blob
+         * @param [out] buffer - where to put data
+         * @param [in]  size   - buffer size
+         * @return number of bytes read. 0 means end of blob (or read error)
+         */
+        virtual size_t ReadChunk(char* buffer, size_t size) = 0;
+
+    private:
+
+        /** Makes at least 'needed' bytes available in the buffer if the blob has them */
+        bool Fill(size_t needed);
+
+        size_t mColumnsCount;       // number of columns
+        size_t mRowsRead;           // number of rows read
+        std::vector<char> mBuffer;  // read buffer
+        size_t mPos;                // current position in mBuffer
+        size_t mEnd;                // end of valid data in mBuffer
+        bool mIsEof;                // ReadChunk returned 0
+        std::string mCell;          // cell buffer for typed NextRow
+        std::function<void()> mCloseAction;   // done in the destructor, may be empty
+
+        BlobCursor(const BlobCursor& rhs);
+        BlobCursor& operator=(const BlobCursor& rhs);
+    };
+
+
+    /** @brief BlobCursor over a blob that is already in memory
+     *
+     * The blob is owned by the cursor
+     */
+    class StringBlobCursor: public BlobCursor
+    {
+    public:
+        StringBlobCursor(const std::string& blob, size_t columnsCount, size_t bufferSize = 64*1024);
+
+    protected:
+        virtual size_t ReadChunk(char* buffer, size_t size);
+
+    private:
+        std::string mBlob;          // the blob
+        size_t mReadPos;            // position of the next chunk
+    };
+}
+
+#endif // BlobCursor_h__
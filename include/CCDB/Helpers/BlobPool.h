@@ -0,0 +1,100 @@
+#ifndef BlobPool_h__
+#define BlobPool_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace ccdb
+{
+    /** @brief Data blob together with its decoded cells */
+    struct DecodedBlob
+    {
+        std::string RawData;                // data blob as it is in the database
+        std::vector<std::string> Cells;     // cells of the blob with decoded separators
+        uint64_t Hash;                      // @see BlobPool::Hash of RawData
+    };
+
+
+    /** @brief Decoded blobs of the process deduplicated by their content
+     *
+     * The same constants are often uploaded again for new run ranges or copied between
+     * variations, so many constantSets rows hold byte identical blobs. Assignments take decoded
+     * blobs from the pool and the ones with identical blobs share one DecodedBlob, whatever
+     * calibration, provider or variation they come from. So memory grows with unique data,
+     * not with the number of assignments.
+     *
+     * Blobs are found by a hash of the content and then compared byte by byte, so a hash collision
+     * never gives wrong data. The pool doesn't own the blobs: a blob is removed when the last
+     * assignment that uses it is deleted.
+     *
+     * All functions are thread safe
+     */
+    class BlobPool
+    {
+    public:
+
+        /** @brief The pool of the process. It lives until the process ends */
+        static BlobPool& Instance();
+
+        /** @brief Finds decoded blob with the same content
+         * @return the blob or NULL if there is no such blob in the pool
+         */
+        std::shared_ptr<const DecodedBlob> Find(const char* data, size_t length, uint64_t hash);
+
+        /** @brief Adds decoded blob to the pool
+         *
+         * If a blob with the same content was added meanwhile, the blob is deleted and the one
+         * from the pool is returned
+         * @param [in] blob - blob with Hash filled. The pool takes it
+         */
+        std::shared_ptr<const DecodedBlob> Add(DecodedBlob* blob);
+
+        /** @brief The empty blob that assignments without data share */
+        static std::shared_ptr<const DecodedBlob> Empty();
+
+        /** @brief Hash of the blob content (64 bit FNV-1a) */
+        static uint64_t Hash(const char* data, size_t length);
+
+        /** Number of unique blobs in the pool */
+        size_t GetBlobsCount() const;
+
+        /** Number of times a blob was found in the pool instead of being decoded */
+        size_t GetSharedCount() const;
+
+    private:
+
+        BlobPool(): mSharedCount(0) {}
+
+        /** Find with mMutex locked */
+        std::shared_ptr<const DecodedBlob> FindLocked(const char* data, size_t length, uint64_t hash);
+
+        /** Removes the blob from the pool and deletes it. Called when the last user releases the blob */
+        void Remove(DecodedBlob* blob);
+
+        /** Hands the blob back to the pool when its last user releases it */
+        struct Deleter
+        {
+            void operator()(DecodedBlob* blob) const;
+        };
+
+        struct Entry
+        {
+            const DecodedBlob* Address;                 // finds the entry of a deleted blob
+            std::weak_ptr<const DecodedBlob> Blob;
+        };
+
+        mutable std::mutex mMutex;
+        std::unordered_multimap<uint64_t, Entry> mBlobs;   // hash => blobs
+        size_t mSharedCount;
+
+        BlobPool(const BlobPool&);
+        BlobPool& operator=(const BlobPool&);
+    };
+}
+
+#endif // BlobPool_h__
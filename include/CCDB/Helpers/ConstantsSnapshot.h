@@ -0,0 +1,68 @@
+#ifndef ConstantsSnapshot_h__
+#define ConstantsSnapshot_h__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "CCDB/Helpers/SharedMemoryCache.h"
+
+namespace ccdb
+{
+    /** @brief Decoded tables packed into one read-only block of memory
+     *
+     * Tables are collected with Add, then Seal copies them with a sorted index into one
+     * mapping and makes it read only. Find does a binary search and touches nothing but
+     * the mapping, so processes forked after Seal share its pages with the parent and
+     * never copy them. @see Calibration::PrepareForFork
+     *
+     * Seal throws std::logic_error if the memory can't be mapped
+     */
+    class ConstantsSnapshot
+    {
+    public:
+        typedef SharedMemoryCache::Table Table;
+
+        ConstantsSnapshot();
+        ~ConstantsSnapshot();
+
+        /** @brief Adds the table. Tables can't be added after Seal */
+        void Add(const std::string& key, const std::vector< std::vector<double> >& values);
+
+        /** @brief Packs the added tables and makes the memory read only */
+        void Seal();
+
+        /** @brief Finds the table by key in the sealed snapshot
+         * @return false if there is no such table
+         */
+        bool Find(const std::string& key, Table& table) const;
+
+        bool IsSealed() const { return mBase != NULL; }
+
+        /** Number of tables in the sealed snapshot */
+        size_t GetTablesCount() const { return mTablesCount; }
+
+        /** Bytes of the sealed snapshot */
+        size_t GetSize() const { return mSize; }
+
+    private:
+
+        struct PendingTable
+        {
+            std::string Key;
+            uint32_t Rows;
+            uint32_t Columns;
+            std::vector<double> Values;
+        };
+
+        std::vector<PendingTable> mPending;     // tables added before Seal
+        char* mBase;                            // sealed memory, NULL before Seal
+        size_t mSize;                           // size of the sealed memory
+        size_t mTablesCount;                    // number of tables in the sealed memory
+
+        ConstantsSnapshot(const ConstantsSnapshot& rhs);
+        ConstantsSnapshot& operator=(const ConstantsSnapshot& rhs);
+    };
+}
+
+#endif // ConstantsSnapshot_h__
@@ -0,0 +1,129 @@
+#ifndef ObjectPool_h__
+#define ObjectPool_h__
+
+#include <stddef.h>
+#include <new>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+namespace ccdb
+{
+    /** @brief Pool of memory blocks of one size
+     *
+     * Blocks are cut from chunks of many blocks, freed blocks are kept in a free list and given
+     * again. So objects of one class take one malloc per chunk instead of one per object, and
+     * long jobs that load and drop constants for many runs reuse the same memory instead of
+     * fragmenting the heap. Chunks are not returned to the system.
+     *
+     * Each thread keeps its own short free list of the pool, so threads that make and drop objects
+     * don't wait for each other. The shared list is locked only to take or give back a batch of blocks.
+     * Blocks of the thread list go back to the shared list when the thread exits.
+     *
+     * All functions are thread safe
+     */
+    class FixedSizePool
+    {
+    public:
+
+        /**
+         * @param blockSize      - size of a block. It is rounded up to the alignment of any object
+         * @param blocksPerChunk - blocks allocated at once
+         */
+        explicit FixedSizePool(size_t blockSize, size_t blocksPerChunk = 128);
+
+        /** Chunks are freed. Blocks must not be used after the pool is destroyed */
+        ~FixedSizePool();
+
+        /** @brief Takes a free block. Throws std::bad_alloc if there is no memory */
+        void* Allocate();
+
+        /** @brief Returns the block to the pool. NULL is ignored */
+        void Free(void* block);
+
+        /** Size of blocks */
+        size_t GetBlockSize() const { return mBlockSize; }
+
+        /** Number of chunks allocated */
+        size_t GetChunksCount() const;
+
+        /** Number of blocks in use. Blocks in free lists of threads are not counted */
+        size_t GetUsedCount() const;
+
+        /** Blocks a thread takes from the shared list at once. It keeps up to twice as many */
+        static const size_t cThreadBatchSize = 32;
+
+    private:
+
+        struct FreeBlock
+        {
+            FreeBlock* Next;
+        };
+
+        /** Free list of one thread. Only Count is read by other threads */
+        struct ThreadList
+        {
+            FreeBlock* FreeList;
+            std::atomic<size_t> Count;
+        };
+
+        /** Free lists of the thread by ids of pools. Gives blocks back when the thread exits */
+        struct ThreadLists;
+
+        ThreadList* GetThreadList();                        ///< NULL when the thread exits
+        void Refill(ThreadList* list);                      ///< Moves a batch of the shared list to the thread list
+        void Drain(ThreadList* list, size_t count);         ///< Moves blocks of the thread list to the shared list
+        void CutChunk();                                    ///< Adds a new chunk to the shared list, mMutex must be locked
+
+        size_t mBlockSize;
+        size_t mBlocksPerChunk;
+        size_t mId;                                         ///< Index of the pool in lists of threads
+
+        mutable std::mutex mMutex;
+        FreeBlock* mFreeList;
+        std::vector<void*> mChunks;
+        std::vector<ThreadList*> mThreadLists;
+        size_t mUsedCount;                                  ///< Blocks out of the shared list
+
+        FixedSizePool(const FixedSizePool&);
+        FixedSizePool& operator=(const FixedSizePool&);
+    };
+
+
+    /** @brief Base class that allocates objects of T from FixedSizePool of T
+     *
+     * Model objects (assignments, tables, columns, variations, run ranges) are made by every lookup,
+     * they derive from PooledObject<their class>. Classes derived from T are bigger and go to the heap
+     */
+    template<class T>
+    class PooledObject
+    {
+    public:
+
+        static void* operator new(size_t size)
+        {
+            if(size != sizeof(T)) return ::operator new(size);
+            return GetPool().Allocate();
+        }
+
+        static void operator delete(void* object, size_t size)
+        {
+            if(object == NULL) return;
+            if(size != sizeof(T))
+            {
+                ::operator delete(object);
+                return;
+            }
+            GetPool().Free(object);
+        }
+
+        /** @brief Pool of T objects. It is never destroyed, as objects may be deleted at exit */
+        static FixedSizePool& GetPool()
+        {
+            static FixedSizePool* pool = new FixedSizePool(sizeof(T));
+            return *pool;
+        }
+    };
+}
+
+#endif // ObjectPool_h__
@@ -0,0 +1,76 @@
+#ifndef ReplicaSelector_h__
+#define ReplicaSelector_h__
+
+#include <stddef.h>
+#include <vector>
+#include <chrono>
+
+namespace ccdb
+{
+    /** @brief Chooses the fastest healthy replica by latencies of its recent requests
+     *
+     * Each replica has a moving average of its latency, which is used for routing, and a window
+     * of the last samples, which gives the percentile a request is hedged after.
+     * Replicas that were never measured go first, so every replica gets measured.
+     * A failed replica is skipped for the retry delay. If all replicas are down, the one that
+     * is due first is given anyway, so a request is never refused by the selector itself.
+     *
+     * The selector is not thread safe, the owner calls it from one thread
+     */
+    class ReplicaSelector
+    {
+    public:
+
+        /**
+         * @param replicasCount - number of replicas
+         * @param samplesCount  - number of the last latencies the percentile is taken from
+         */
+        explicit ReplicaSelector(size_t replicasCount, size_t samplesCount=64);
+
+        /** @brief Index of the fastest healthy replica that is not excluded. -1 if all replicas are excluded */
+        int Select(const std::vector<size_t>& excluded=std::vector<size_t>()) const;
+
+        /** @brief Adds latency of a successful request. The replica becomes healthy */
+        void AddLatency(size_t replica, double milliseconds);
+
+        /** @brief Marks the replica down for the retry delay */
+        void MarkFailed(size_t replica);
+
+        /** @brief Is the replica healthy now */
+        bool IsHealthy(size_t replica) const;
+
+        /** @brief Moving average latency of the replica in ms. 0 if it was never measured */
+        double GetLatency(size_t replica) const { return mReplicas[replica].Latency; }
+
+        /** @brief Latency percentile of the replica in ms. Negative if there are too few samples */
+        double GetPercentile(size_t replica, double percentile) const;
+
+        /** @brief Time a failed replica is skipped. Default is 10 s */
+        void SetRetryDelay(double seconds) { mRetryDelay = seconds; }
+
+        /** Number of replicas */
+        size_t GetReplicasCount() const { return mReplicas.size(); }
+
+        /** Minimum number of samples for the percentile */
+        static const size_t MinSamplesCount = 8;
+
+    private:
+
+        typedef std::chrono::steady_clock Clock;
+
+        struct Replica
+        {
+            double Latency;                     // moving average, ms
+            std::vector<double> Samples;        // ring of the last latencies
+            size_t NextSample;                  // ring position
+            bool IsFailed;
+            Clock::time_point RetryTime;        // failed replica is skipped until this time
+        };
+
+        std::vector<Replica> mReplicas;
+        size_t mSamplesCount;
+        double mRetryDelay;
+    };
+}
+
+#endif // ReplicaSelector_h__
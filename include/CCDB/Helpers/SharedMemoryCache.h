@@ -0,0 +1,136 @@
+#ifndef SharedMemoryCache_h__
+#define SharedMemoryCache_h__
+
+#include <stdint.h>
+#include <time.h>
+#include <string>
+
+/** Environment variable with the name of the shared cache segment, @see Calibration::EnableSharedCache */
+#define CCDB_ENV_SHARED_CACHE "CCDB_SHARED_CACHE"
+
+namespace ccdb
+{
+    /** @brief Cache of decoded constants in a POSIX shared memory segment
+     *
+     * All processes of the node that open the segment with the same name see the same tables.
+     * A table is decoded once by the first process that needs it, others read the values in place,
+     * so the memory taken by constants doesn't grow with the number of processes.
+     *
+     * The segment has a fixed size and is filled by appending: entries are not changed or removed one by one.
+     * An entry may be replaced by a newer one of the same key, the old one stays but is not found.
+     * When the segment is full, all entries are dropped at once and a new generation starts, so
+     * replaced entries don't take the space for the life of the segment (@see GetResetsCount).
+     * Writers are serialized with a process shared (robust on Linux) mutex, so a process killed
+     * while adding doesn't lock the others. An entry becomes visible only after it is fully written,
+     * readers don't lock at all: they copy the values and then check that the generation is the same
+     * (@see IsUnchanged).
+     *
+     * The values of a table are kept once per assignment: keys of requests (i.e. of each run)
+     * are aliases of the assignment key (@see AddAlias), so runs of one run range share the values.
+     *
+     * The segment stays in the system until Remove is called or the node is rebooted.
+     * It is created readable by its user only. Open throws std::logic_error if the segment can't be
+     * created or mapped, or if it belongs to another user or is open to others.
+     */
+    class SharedMemoryCache
+    {
+    public:
+
+        /** Decoded table in the segment */
+        struct Table
+        {
+            const double* Values;       // Rows*Columns values, row by row
+            uint32_t Rows;
+            uint32_t Columns;
+            time_t LoadTime;            // when the table was added, 0 - unknown
+            uint64_t Generation;        // generation of the segment when the table was found, @see IsUnchanged
+        };
+
+        static const size_t DefaultSize = 64*1024*1024;
+
+        SharedMemoryCache();
+
+        /** @brief Unmaps the segment. The segment itself and its tables stay for other processes */
+        ~SharedMemoryCache();
+
+        /**
+         * @brief Opens the segment, creates it if there is no segment with this name
+         *
+         * @param name - segment name, i.e. "/ccdb_cache"
+         * @param size - size of a new segment in bytes. An existing segment keeps its size
+         */
+        void Open(const std::string& name, size_t size = DefaultSize);
+
+        /** @brief Unmaps the segment */
+        void Close();
+
+        /** @brief Removes the segment from the system. Processes that have it opened may still use it */
+        static void Remove(const std::string& name);
+
+        bool IsOpen() const { return mHeader != NULL; }
+
+        /** @brief Finds the table by key, an alias leads to its table. Doesn't lock
+         *
+         * The values stay in the segment. They must be copied and then checked by IsUnchanged,
+         * because the segment may be reset by another process meanwhile
+         * @return false if there is no such table
+         */
+        bool Find(const std::string& key, Table& table) const;
+
+        /** @brief The segment was not reset since the table was found, so its values copied before are right */
+        bool IsUnchanged(const Table& table) const;
+
+        /** @brief Adds the table. Does nothing if another process has added it already at minLoadTime or later
+         *
+         * If the segment is full, it is reset first
+         * @param minLoadTime - the table added earlier is replaced. 0 - tables are never replaced
+         * @return false if the table is bigger than the segment
+         */
+        bool Add(const std::string& key, const double* values, uint32_t rows, uint32_t columns, time_t minLoadTime = 0);
+
+        /** @brief Adds the key that gives the table of targetKey. Load time of the alias is given by Find
+         * @param minLoadTime - the alias added earlier is replaced. 0 - aliases are never replaced
+         * @return false if the segment is not opened
+         */
+        bool AddAlias(const std::string& key, const std::string& targetKey, time_t minLoadTime = 0);
+
+        /** Size of the segment in bytes */
+        size_t GetSize() const;
+
+        /** Bytes taken by tables and the index */
+        size_t GetUsedBytes() const;
+
+        /** Bytes that are left for new tables */
+        size_t GetFreeBytes() const;
+
+        /** Number of tables in the segment. Aliases are not counted */
+        size_t GetTablesCount() const;
+
+        /** Number of times the segment was full and all its tables were dropped */
+        size_t GetResetsCount() const;
+
+    private:
+
+        struct Header;
+        struct Entry;
+
+        /** @brief Walks the bucket list of the hash. @return offset of the entry or 0 */
+        uint64_t FindEntry(const std::string& key, uint64_t hash) const;
+
+        /** @brief Adds a table (target is empty) or an alias. @return false if the entry is bigger than the segment */
+        bool AddEntry(const std::string& key, const std::string& target, const double* values, uint32_t rows, uint32_t columns, time_t minLoadTime);
+
+        /** @brief Drops all entries. The write mutex must be locked */
+        void Reset();
+
+        std::string mName;          // segment name
+        char* mBase;                // mapped segment
+        size_t mMappedSize;         // mapped bytes
+        Header* mHeader;            // NULL if not opened
+
+        SharedMemoryCache(const SharedMemoryCache& rhs);
+        SharedMemoryCache& operator=(const SharedMemoryCache& rhs);
+    };
+}
+
+#endif // SharedMemoryCache_h__
@@ -0,0 +1,52 @@
+#ifndef StringPool_h__
+#define StringPool_h__
+
+#include <stddef.h>
+#include <string>
+#include <mutex>
+#include <unordered_set>
+
+namespace ccdb
+{
+    /** @brief Interned strings of the process
+     *
+     * Each distinct string is kept once and is given as a handle - a pointer to the kept string.
+     * Equal strings have equal handles, so handles are compared as pointers.
+     * Column names and cells of low cardinality columns (states like "ON"/"OFF", detector names)
+     * are interned, @see ConstantsTypeColumn::GetNameHandle and Assignment::GetColumnHandles.
+     *
+     * Strings are kept until the process ends, so columns with many distinct values
+     * should not be interned. All functions are thread safe
+     */
+    class StringPool
+    {
+    public:
+
+        /** Handle of an interned string. It is valid until the process ends */
+        typedef const std::string* Handle;
+
+        /** @brief The pool of the process */
+        static StringPool& Instance();
+
+        /** @brief Handle of the string. The string is added if it is not in the pool */
+        Handle Intern(const std::string& value);
+
+        /** @brief Handle of the string or NULL if it was never interned. Doesn't add it */
+        Handle Find(const std::string& value) const;
+
+        /** Number of interned strings */
+        size_t GetCount() const;
+
+    private:
+
+        StringPool() {}
+
+        mutable std::mutex mMutex;
+        std::unordered_set<std::string> mStrings;  // nodes are not moved, so pointers to them are stable
+
+        StringPool(const StringPool&);
+        StringPool& operator=(const StringPool&);
+    };
+}
+
+#endif // StringPool_h__
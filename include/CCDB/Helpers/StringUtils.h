@@ -11,6 +11,7 @@
 #include <stdio.h>
 
 #include <stdarg.h>
+#include <stdint.h>
 #include <string>
 #include <string.h>
 #include <sstream>
@@ -259,6 +260,73 @@ public:
 
     }
 
+    static const char   cBlobDelimiter = '|';          ///< separator of blob cells, see CCDB_DATA_BLOB_DELIMETER in Globals.h
+    static const char   cBlobEscape[12];               ///< "&delimiter;", encoded separator, see Assignment::EncodeBlobSeparator
+    static const size_t cBlobEscapeLength = 11;        ///< length of cBlobEscape
+
+    /** @brief Finds the first cBlobDelimiter or '&' (start of cBlobEscape) in [pos, end)
+     *
+     * If the build has SSE2, data is scanned 16 bytes at a time.
+     * @return pointer to the found character or 'end' if there is none
+     */
+    static const char* FindBlobSpecial(const char* pos, const char* end);
+
+    /** @brief Splits data blob to cells in one pass
+     *
+     * Cells are separated by CCDB_DATA_BLOB_DELIMETER ('|'). Encoded separators
+     * '&delimiter;' are decoded in the same pass, so no Replace is needed per cell.
+     * Empty cells are skipped the same way Split(blob, tokens, "|") does.
+     * If the build has SSE2, the blob is scanned 16 bytes at a time
+     *
+     * @param [in]  data   - pointer to the blob (doesn't need to be null terminated)
+     * @param [in]  length - length of the blob
+     * @param [out] tokens - decoded cells. The vector is cleared before filling
+     * @return number of cells
+     */
+    static size_t SplitBlob(const char* data, size_t length, vector<string>& tokens);
+
+    /** @brief Splits data blob to cells in one pass. @see SplitBlob(const char*, size_t, vector<string>&) */
+    static size_t SplitBlob(const string& blob, vector<string>& tokens)
+    {
+        return SplitBlob(blob.data(), blob.size(), tokens);
+    }
+
+    /** @brief Splits big data blob to cells using several threads
+     *
+     * The blob is cut to chunks at delimiter boundaries, each chunk is split by SplitBlob
+     * in its own thread (the first one in the calling thread) and the cells are joined in order.
+     * The result is identical to SplitBlob.
+     *
+     * All calls of the process together run at most hardware_concurrency() decoder threads.
+     * If other calls took them, the blob is cut to fewer chunks or is split in the calling thread.
+     *
+     * @param [in]  data        - pointer to the blob (doesn't need to be null terminated)
+     * @param [in]  length      - length of the blob
+     * @param [out] tokens      - decoded cells. The vector is cleared before filling
+     * @param [in]  chunksCount - number of chunks. 0 means std::thread::hardware_concurrency()
+     * @return number of cells
+     */
+    static size_t SplitBlobParallel(const char* data, size_t length, vector<string>& tokens, unsigned int chunksCount = 0);
+
+    /** @brief Number of decoder threads SplitBlobParallel calls run now */
+    static unsigned int GetDecoderThreadsCount();
+
+    /** @brief Parses numbers without copying them to std::string
+     *
+     * Leading blanks are skipped and the number is read until the first character that
+     * can't be a part of it, i.e. the same way atol/atof do. Decimal numbers are parsed without
+     * locale and errno overhead; doubles that can't be converted exactly by the fast path
+     * (too many digits, big exponents, hex, inf, nan) are handed to strtod.
+     * @param [in]  source - pointer to the number (doesn't need to be null terminated)
+     * @param [in]  length - number of characters available
+     * @param [out] result - if not NULL, set to true if the whole input (but trailing blanks) is a number
+     *                       that fits the type. Out of range integers are clamped to the limits of the type
+     *                       as strtol does, and result is false
+     */
+    static long             ParseLong(const char* source, size_t length, bool *result=NULL );
+    static unsigned long    ParseULong(const char* source, size_t length, bool *result=NULL );
+    static double           ParseDouble(const char* source, size_t length, bool *result=NULL );
+
     static int              ParseInt(const string& source, bool *result=NULL );         ///Reads int    from the last query row
     static unsigned int     ParseUInt(const string& source, bool *result=NULL );        ///Reads unsigned int from the last query row
     static long             ParseLong(const string& source, bool *result=NULL );        ///Reads long from the last query row
@@ -267,6 +335,16 @@ public:
     static double           ParseDouble(const string& source, bool *result=NULL );      ///Reads double from the last query row
     static string           ParseString(const string& source, bool *result=NULL );      ///Reads string from the last query row
     static time_t           ParseUnixTime(const string& source, bool *result=NULL );    ///Reads string from the last query row
+
+    /** @brief 64 bit FNV-1a hash of the data. It is the same in all processes and builds,
+     * so it may be stored in files and shared memory */
+    static uint64_t Hash64(const char* data, size_t length);
+
+    /** @brief 64 bit FNV-1a hash of the string. @see Hash64(const char*, size_t) */
+    static uint64_t Hash64(const string& str)
+    {
+        return Hash64(str.data(), str.size());
+    }
 };
 }
 #endif // StringUtils_h__
@@ -7,12 +7,18 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
 
 #include "CCDB/Model/StoredObject.h"
 #include "CCDB/Model/ObjectsOwner.h"
 #include "CCDB/Model/ConstantsTypeTable.h"
 #include "CCDB/Model/ConstantsTypeColumn.h"
 #include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Helpers/BlobPool.h"
+#include "CCDB/Helpers/StringPool.h"
+#include "CCDB/Helpers/ObjectPool.h"
 
 using namespace std;
 
@@ -22,7 +28,7 @@ class EventRange;
 class Variation;
 class RunRange;
 
-class Assignment: public ObjectsOwner, public StoredObject {
+class Assignment: public ObjectsOwner, public StoredObject, public PooledObject<Assignment> {
 public:
 	Assignment(ObjectsOwner * owner=NULL, DataProvider *provider=NULL);
 	virtual ~Assignment();
@@ -101,11 +107,48 @@ public:
 	time_t	GetModifiedTime() const { return mModifiedTime;}   ///Time of last modification
     void	SetModifiedTime(time_t val) {mModifiedTime = val;} ///Time of last modification
 
-	string	GetRawData() const { return mRawData; }            ///Raw data blob
-	void	SetRawData(std::string val);					   ///Raw data blob
+	string	GetRawData() const { return mBlob->RawData; }      ///Raw data blob
+	void	SetRawData(const std::string& val);			   ///Raw data blob
+
+	/** @brief Makes the data read only: SetRawData throws std::logic_error after it
+	 *
+	 * Assignments shared by threads (@see Calibration cache) are made read only,
+	 * so the cells, indexes and column handles they give are never changed while they live
+	 */
+	void	SetDataReadOnly() { mIsDataReadOnly = true; }
+	bool	IsDataReadOnly() const { return mIsDataReadOnly; }
+
+	/** @brief Sets raw data blob right from a DB result buffer
+	 *
+	 * The blob is copied once to keep GetRawData() and split to cells in the same call.
+	 * If an identical blob is decoded already, its cells are shared (@see BlobPool).
+	 * The buffer is not used after the function returns
+	 * @param [in] data   - pointer to the blob. Doesn't need to be null terminated
+	 * @param [in] length - length of the blob
+	 */
+	void	SetRawData(const char* data, size_t length);
+
+	/** @brief Sets raw data blob together with cells that are already decoded
+	 *
+	 * For providers that keep decoded cells (@see PackDataProvider), so the blob is not split again
+	 * @param [in] rawData - raw data blob
+	 * @param [in] cells   - decoded cells of the blob. The vector is moved from
+	 */
+	void	SetRawData(const std::string& rawData, vector<string>&& cells);
+
+	/** @brief Blobs longer than this are decoded in parallel chunks by SetRawData
+	 *
+	 * @see StringUtils::SplitBlobParallel. 0 disables parallel decoding.
+	 * It is a global setting, so it should be set before worker threads start
+	 * @param [in] bytes - blob length threshold in bytes
+	 */
+	static void		SetParallelDecodingThreshold(size_t bytes) { mParallelDecodingThreshold = bytes; }
+	static size_t	GetParallelDecodingThreshold() { return mParallelDecodingThreshold; }
 
 	
 	/** @brief GetMappedData returns rows vector of maps of column_name => data_value
+	 *
+	 * Every row gets a copy of every column name and cell, @see GetRow to read rows by names without copies
 	 * @return   vector<map<string,string> >
 	 */
 	vector<map<string,string> > GetMappedData() const;					
@@ -119,6 +162,118 @@ public:
 	 */
 	vector<vector<string> > GetData() const;
 	void GetData(vector<vector<string> > &data) const;
+
+	/** @brief Gets only selected columns as vector of rows
+	 *
+	 * Each row has columnIndexes.size() cells in the order of columnIndexes.
+	 * Cells of other columns are not copied.
+	 * @param [out] data          - rows of the selected cells
+	 * @param [in]  columnIndexes - indexes of columns to take. @see GetColumnIndex
+	 */
+	void GetData(vector<vector<string> > &data, const vector<int>& columnIndexes) const;
+
+	/** @brief Gets index of a column by its name. Takes no locks, @see ConstantsTypeTable::GetColumnIndex
+	 * @return column index or -1 if there is no such column (or columns are not loaded)
+	 */
+	int GetColumnIndex(const string& columnName) const;
+
+	/** @brief Row of the assignment that gives cells by column names like map<string,string> of GetMappedData does
+	 *
+	 * Neither names nor cells are copied. Cells are found by column name (@see GetColumnIndex)
+	 * or by interned column name (@see ConstantsTypeColumn::GetNameHandle), which is a pointer comparison.
+	 * The view is valid while the assignment lives and its data is not changed
+	 */
+	class RowView
+	{
+	public:
+		RowView(const Assignment& assignment, size_t rowIndex): mAssignment(&assignment), mRowIndex(rowIndex) {}
+
+		/** @brief Cell of the column. Throws std::out_of_range if there is no such column, as map::at does */
+		const string& at(const string& columnName) const;
+		const string& at(StringPool::Handle columnName) const;
+
+		/** @brief 1 if there is such column, 0 otherwise, as map::count does */
+		size_t count(const string& columnName) const { return mAssignment->GetColumnIndex(columnName) < 0 ? 0 : 1; }
+
+		/** Number of cells */
+		size_t size() const { return mAssignment->GetColumnsCount(); }
+
+		size_t GetRowIndex() const { return mRowIndex; }
+
+	private:
+		const Assignment* mAssignment;
+		size_t mRowIndex;
+	};
+
+	/** @brief Gets view of the row. The index is not checked, @see GetRowsCount */
+	RowView GetRow(size_t rowIndex) const { return RowView(*this, rowIndex); }
+
+	/** @brief Gets decoded cell without copying. Indexes are not checked */
+	const string& GetCell(size_t rowIndex, size_t columnIndex) const { return mBlob->Cells[rowIndex*GetColumnsCount() + columnIndex]; }
+
+	/** @brief Gets number of decoded cells in the blob */
+	size_t GetCellsCount() const { return mBlob->Cells.size(); }
+
+	/** @brief Gets the decoded blob. Assignments with identical blobs share it */
+	std::shared_ptr<const DecodedBlob> GetDecodedBlob() const { return mBlob; }
+
+	/** row index: key column cell value => row number */
+	typedef std::unordered_map<std::string, size_t> RowIndex;
+
+	/** @brief Gets index of rows by values of the key column
+	 *
+	 * The index is built on the first call for this column and is kept until SetRawData,
+	 * so for cached assignments it is built once. The function is thread safe. The index of
+	 * an assignment with read only data (@see SetDataReadOnly) is never changed after it is built,
+	 * so it can be used without locks.
+	 * Keys are cell values as they are in the blob. If a key repeats, the first row is indexed.
+	 *
+	 * @param [in] keyColumnIndex - index of the key column. @see GetColumnIndex
+	 * @return index of rows
+	 */
+	const RowIndex& GetRowIndex(size_t keyColumnIndex);
+
+	/** @brief Finds row by value of the key column using @see GetRowIndex
+	 * @return row number or -1 if there is no such key
+	 */
+	int Lookup(size_t keyColumnIndex, const string& key);
+
+	/** integer row index: key column cell parsed by StringUtils::ParseLong => row number */
+	typedef std::unordered_map<long, size_t> IntRowIndex;
+
+	/** @brief Gets index of rows by integer values of the key column
+	 *
+	 * The same as GetRowIndex, but cells are parsed by StringUtils::ParseLong, so "7", "07" and " 7"
+	 * are the same key. Cells that are not integers are not indexed.
+	 *
+	 * @param [in] keyColumnIndex - index of the key column. @see GetColumnIndex
+	 * @return index of rows
+	 */
+	const IntRowIndex& GetIntRowIndex(size_t keyColumnIndex);
+
+	/** @brief Finds row by integer value of the key column using @see GetIntRowIndex
+	 * @return row number or -1 if there is no such key
+	 */
+	int Lookup(size_t keyColumnIndex, long key);
+
+	/** @brief Gets interned cells of the column, one handle per row
+	 *
+	 * For columns with few distinct values (states like "ON"/"OFF", detector names): the column
+	 * takes one pointer per row and cells are compared as pointers (@see StringPool::Find).
+	 * Handles are made on the first call for this column and kept until SetRawData.
+	 * The function is thread safe, the returned vector is never changed after it is made
+	 * if the data is read only (@see SetDataReadOnly).
+	 * Interned strings are kept until the process ends, so only columns declared low cardinality
+	 * (@see ConstantsTypeColumn::SetLowCardinality) and string or bool columns with at most
+	 * cMaxDetectedDistinctCells distinct cells are interned.
+	 *
+	 * @param [in] columnIndex - index of the column. @see GetColumnIndex
+	 * @return handles of the column cells by rows. Empty if there is no such column or it is not interned
+	 */
+	const vector<StringPool::Handle>& GetColumnHandles(size_t columnIndex);
+
+	/** Not declared columns with more distinct cells are not interned by GetColumnHandles */
+	static const size_t cMaxDetectedDistinctCells = 64;
 	
 	std::string GetComment() const { return mComment;} ///Comment of assignment
 	void SetComment(std::string val) {mComment = val;} ///Comment of assignment
@@ -171,8 +326,6 @@ public:
 	size_t GetColumnsCount() const { return mTypeTable->GetColumnsCount(); }
 private:
 
-	vector<map<string,string> > mRows;	// cache for blob data by rows
-	string mRawData;					// data blob
 	int mId;							// id in database
 	int mDataBlobId;					// blob id in database
 	unsigned int mVariationId;			// database ID of variation
@@ -190,7 +343,17 @@ private:
 	time_t mModifiedTime;				// time of last modification
 	string mComment;					// Comment of assignment
 
-	vector<string> mVectorData;         // Vectorized blob
+	std::shared_ptr<const DecodedBlob> mBlob; // data blob and its cells, shared by assignments with identical blobs
+
+	static size_t mParallelDecodingThreshold; // blobs longer than this are decoded in parallel chunks
+
+	std::map<size_t, RowIndex> mRowIndexes; // key column index => row index, @see GetRowIndex
+	std::map<size_t, IntRowIndex> mIntRowIndexes; // key column index => integer row index, @see GetIntRowIndex
+	std::map<size_t, vector<StringPool::Handle> > mColumnHandles; // column index => interned cells, @see GetColumnHandles
+	std::mutex mRowIndexesMutex;            // guards mRowIndexes, mIntRowIndexes and mColumnHandles
+	bool mIsDataReadOnly;                   // SetRawData is not allowed, @see SetDataReadOnly
+
+	void ResetData();                       // drops indexes before SetRawData, throws if the data is read only
 
 	Assignment(const Assignment& rhs);	
 	Assignment& operator=(const Assignment& rhs);
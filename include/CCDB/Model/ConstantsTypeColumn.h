@@ -12,6 +12,8 @@
 #include <string>
 #include "CCDB/Globals.h"
 #include "CCDB/Model/StoredObject.h"
+#include "CCDB/Helpers/StringPool.h"
+#include "CCDB/Helpers/ObjectPool.h"
 //#include "Model/ConstantsTypeTable.h"
 
 using namespace std;
@@ -19,7 +21,7 @@ using namespace std;
 namespace ccdb {
 class ConstantsTypeTable;
 
-class ConstantsTypeColumn: public StoredObject {
+class ConstantsTypeColumn: public StoredObject, public PooledObject<ConstantsTypeColumn> {
 	friend class ConstantsTypeTable;
 public:
 	enum ColumnTypes
@@ -70,6 +72,17 @@ public:
 	string			GetName() const;					///get name
 	void			SetName(string val);				///set name
 
+	/** @brief Interned name. Columns with equal names have equal handles, @see StringPool */
+	StringPool::Handle GetNameHandle() const { return mNameHandle; }
+
+	/** @brief Declares that the column has few distinct values, so its cells may be interned
+	 *
+	 * Only string and bool columns with few values in the assignment are interned otherwise
+	 * (@see Assignment::GetColumnHandles)
+	 */
+	void			SetLowCardinality(bool val) { mIsLowCardinality = val; }
+	bool			IsLowCardinality() const { return mIsLowCardinality; }
+
 	string			GetComment() const;					///get comment
 	void			SetComment(std::string val);		///set comment
 
@@ -129,6 +142,8 @@ protected:
 private:
 	dbkey_t			mId;			//database table uniq id;
 	string			mName;			//name	
+	StringPool::Handle mNameHandle;	//interned name
+	bool			mIsLowCardinality;	//cells may be interned, @see SetLowCardinality
 	string			mComment;		//comment
 	time_t			mCreatedTime;	//mCreatedTime time
 	time_t			mModifiedTime;	//mModifiedTime time
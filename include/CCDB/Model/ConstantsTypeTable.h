@@ -9,11 +9,14 @@
 #define TABLEHEADER_H_
 
 #include <string>
+#include <map>
+#include <unordered_map>
 
 #include "CCDB/Model/Directory.h"
 #include "CCDB/Model/StoredObject.h"
 #include "CCDB/Model/ConstantsTypeColumn.h"
 #include "CCDB/Model/ObjectsOwner.h"
+#include "CCDB/Helpers/ObjectPool.h"
 #include "CCDB/Model/ConstantsTypeColumn.h"
 
 using namespace std;
@@ -22,9 +25,10 @@ namespace ccdb {
 
 	//class ConstantsTypeColumn;
 
-class ConstantsTypeTable: public ObjectsOwner, public StoredObject 
+class ConstantsTypeTable: public ObjectsOwner, public StoredObject, public PooledObject<ConstantsTypeTable>
 {
 	friend class DataProvider;
+	friend class ConstantsTypeColumn;
 public:
 	ConstantsTypeTable(ObjectsOwner * owner=NULL, DataProvider *provider=NULL);
 	virtual ~ConstantsTypeTable();
@@ -125,6 +129,14 @@ public:
 	 */
 	void				 	ClearColumns();
 
+	/** @brief Gets index of the column by its name
+	 *
+	 * Columns are indexed by names when they are added or renamed, so the lookup takes no locks
+	 * and a type table shared by threads is searched by all of them at once
+	 * @return column index or -1 if there is no such column
+	 */
+	int						GetColumnIndex(const string& name) const;
+
 	vector<string>			GetColumnNames() const;
 	vector<string>			GetColumnTypeStrings() const;
 
@@ -144,6 +156,9 @@ private:
 	int			mNColumnsFromDB;// Value of nColumns of constantType table in DB
 								
 	map<string, ConstantsTypeColumn *> mColumnsByName;
+	unordered_map<string, int> mColumnIndexes;	//column name => index in mColumns, @see GetColumnIndex
+
+	void IndexColumns();		//makes mColumnIndexes after columns are changed
 	
 	vector<ConstantsTypeColumn *> mColumns; //Columns object
 	ConstantsTypeTable(const ConstantsTypeTable& rhs);	
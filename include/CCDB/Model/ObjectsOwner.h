@@ -1,7 +1,7 @@
 #ifndef _DObjectsOwner_
 #define _DObjectsOwner_
 #include "CCDB/Model/StoredObject.h"
-#include <map>
+#include <vector>
 using namespace std;
 
 namespace ccdb
@@ -33,9 +33,17 @@ public:
 	 * @return   void
 	 */
 	virtual void ReleaseOwnership(StoredObject * object);
+
+	/** Number of owned objects */
+	size_t GetOwnedCount() const { return mOwnedObjects.size(); }
+
+	/** Owner index of objects that are not owned, @see StoredObject */
+	static const size_t NotOwnedIndex = (size_t)-1;
 private:
 	
-	std::map<unsigned long, StoredObject *> mOwnedObjects; //stored objects by id
+	//Each object keeps its index here, so it is added and removed without a search
+	//and without a node allocation per object
+	std::vector<StoredObject *> mOwnedObjects;
 };
 
 }
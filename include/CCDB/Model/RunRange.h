@@ -10,11 +10,12 @@
 
 #include <string>
 #include "CCDB/Model/StoredObject.h"
+#include "CCDB/Helpers/ObjectPool.h"
 using namespace std;
 
 namespace ccdb {
 
-class RunRange: public StoredObject
+class RunRange: public StoredObject, public PooledObject<RunRange>
 {
 public:
 	RunRange();
@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <string>
+#include <atomic>
 
 
 using namespace std;
@@ -112,9 +113,10 @@ private:
 	
 	ObjectsOwner* mOwner;		//owner of the object
 	unsigned long mTempId;	// This is actually UID, The unique Id during a program run. It is called Temp to emphasise that it has no buisness to Id in database
+	size_t mOwnerIndex;		// index in the owned objects of the owner, @see ObjectsOwner
 
 
-	static unsigned long mLastTempId;	//Last given UID
+	static std::atomic<unsigned long> mLastTempId;	//Last given UID. Objects are created by parallel readers too
 
 };
 }
@@ -9,13 +9,14 @@
 #ifndef VARIATION_H_
 #define VARIATION_H_
 #include "CCDB/Model/StoredObject.h"
+#include "CCDB/Helpers/ObjectPool.h"
 #include <string>
 #include <time.h>
 using namespace std;
 
 namespace ccdb {
 
-class Variation: public StoredObject {
+class Variation: public StoredObject, public PooledObject<Variation> {
 public:
 	Variation(ObjectsOwner * owner=NULL, DataProvider *provider=NULL);
 
@@ -0,0 +1,66 @@
+#ifndef DProviderCalibration_h
+#define DProviderCalibration_h
+
+#include <string>
+#include "CCDB/Calibration.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+/** @brief Calibration that reads constants through one provider made by a factory
+ *
+ * Sources that don't need a pool of read connections (a mapped pack, a directory of files,
+ * constants in memory, the local cache, the daemon, shards) differ only by the provider.
+ * CalibrationGenerator gives the factory by the type of the connection string.
+ */
+class ProviderCalibration: public Calibration
+{
+    
+public:
+    /** @brief Makes a new not connected provider */
+    typedef DataProvider* (*ProviderFactory)();
+
+    /** @brief Ctor takes the provider factory, default run number and default variation
+	 *
+	 * @param factory          [in] Makes the provider on the first Connect
+	 * @param defaultRun       [in] Sets default run number
+	 * @param defaultVariation [in] Sets default variation
+	 * @param defaultTime      [in] Sets default time
+	 */
+    ProviderCalibration(ProviderFactory factory, int defaultRun, string defaultVariation="default", time_t defaultTime=0);
+
+	/** @brief Ctor that takes only the provider factory
+	 */
+	explicit ProviderCalibration(ProviderFactory factory);
+
+	virtual ~ProviderCalibration();
+
+	/**
+     * @brief Connects the provider, makes it by the factory if needed
+     *
+     * @param connectionString the connection string of the provider
+     * @return true if connected
+     */
+	virtual bool Connect(std::string connectionString);
+
+	/** @brief Disconnects the provider */
+	virtual void Disconnect();
+
+	/** @brief indicates ether the connection is open or not
+	 * 
+	 * @return true if  connection is open
+	 */
+	virtual bool IsConnected();
+
+private:
+    ProviderFactory mFactory;        /// Makes the provider
+
+    ProviderCalibration(const ProviderCalibration& rhs);
+    ProviderCalibration& operator=(const ProviderCalibration& rhs);
+};
+
+}
+
+#endif // DProviderCalibration_h
@@ -0,0 +1,59 @@
+#ifndef ArchiveSplitter_h__
+#define ArchiveSplitter_h__
+
+#include <string>
+
+namespace ccdb
+{
+    /** @brief Splits a SQLite database into a slim hot database and a history archive
+     *
+     * The hot database keeps assignments that can still be the latest constants for runs of the window.
+     * An assignment is moved out if it has no runs in the window or if its runs in the window are
+     * covered by newer assignments of the same table and variation. Constant sets of moved assignments
+     * are removed too. Directories, tables, variations and run ranges are kept and the schema is the
+     * same, so the hot database is read by SQLite provider (or loaded to MySQL) as before.
+     *
+     * The archive is a complete copy of the source: queries with time are answered by it alone.
+     * The window is written to the `archiveWindow` table of the hot database, so the provider
+     * opened with sqlite://<hot>?archive=<archive> sends queries with time and queries for runs
+     * outside the window to the archive (@see SQLiteDataProvider::ParseConnectionString)
+     *
+     * Functions throw std::logic_error if the files can't be read or written
+     */
+    class ArchiveSplitter
+    {
+    public:
+
+        ArchiveSplitter();
+
+        /** @brief Runs the hot database is made for. Default is all runs [0, INFINITE_RUN] */
+        void SetRunWindow(int runMin, int runMax);
+
+        /** @brief Writes the hot database and the archive. Existing files are overwritten
+         *
+         * @param sourcePath  - SQLite file to split. It is not changed
+         * @param hotPath     - SQLite file with the latest constants of the window
+         * @param archivePath - SQLite file with all constants
+         */
+        void Split(const std::string& sourcePath, const std::string& hotPath, const std::string& archivePath);
+
+        /** Number of assignments in the source */
+        size_t GetAssignmentsCount() const { return mAssignmentsCount; }
+
+        /** Number of assignments that are only in the archive */
+        size_t GetMovedAssignmentsCount() const { return mMovedAssignmentsCount; }
+
+        /** Number of constant sets that are only in the archive */
+        size_t GetMovedConstantSetsCount() const { return mMovedConstantSetsCount; }
+
+    private:
+
+        int mRunMin;
+        int mRunMax;
+        size_t mAssignmentsCount;
+        size_t mMovedAssignmentsCount;
+        size_t mMovedConstantSetsCount;
+    };
+}
+
+#endif // ArchiveSplitter_h__
@@ -0,0 +1,233 @@
+#ifndef _CachingDataProvider_
+#define _CachingDataProvider_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <sqlite3.h>
+
+#include "CCDB/Providers/CatalogDataProvider.h"
+
+/** Environment variable with the path of the local cache file. @see CachingDataProvider */
+#define CCDB_ENV_CACHE_FILE "CCDB_CACHE_FILE"
+
+using namespace std;
+
+namespace ccdb
+{
+
+/** @brief Provider that caches constants of a remote provider in memory and in a local SQLite file
+ *
+ * Type tables and assignments are looked up in tiers:
+ *   1. in-process memory,
+ *   2. local SQLite cache file, shared by all processes of the node and kept between restarts,
+ *   3. remote provider (MySQL or SQLite).
+ * What is fetched from the remote is written through to the memory and to the cache file.
+ * The remote is connected on the first miss only, so jobs that find everything in the cache
+ * file never open a connection to the remote database.
+ *
+ * Cached entries are keyed by the request: table path, variation and time, and are kept for all runs
+ * the remote gives the same assignment for (@see DataProvider::GetAssignmentForRuns), so one fetch
+ * serves every run of a run range. Constants at a time in the past never change and never expire. The latest constants (time=0) expire after
+ * the max age (@see SetMaxAge) and are fetched again. If the remote fails then, the expired
+ * entry is used and a warning is reported.
+ *
+ * Directory and type table searches, run ranges, variations and assignment history
+ * are not cached and go to the remote.
+ *
+ * Errors writing the cache file are reported as warnings, the constants are returned anyway.
+ */
+class CachingDataProvider: public CatalogDataProvider
+{
+public:
+	/** @param cacheFilePath - local SQLite cache file. If empty, CCDB_CACHE_FILE environment variable is used.
+	 *                        If it is not set either, constants are cached in memory only */
+	explicit CachingDataProvider(const string& cacheFilePath="");
+	virtual ~CachingDataProvider(void);
+
+	//----------------------------------------------------------------------------------------
+	//	C O N N E C T I O N
+	//----------------------------------------------------------------------------------------
+
+	/**
+	 * @brief Opens the cache file. The remote is connected on the first cache miss
+	 *
+	 * @param connectionString "cache://<connection string of the remote>", i.e. cache://mysql://ccdb_user@hallddb.jlab.org/ccdb
+	 * @return true if the connection string is valid
+	 */
+	virtual bool Connect(string connectionString);
+
+	/** @brief Closes the cache file and the remote connection. Objects read stay valid */
+	virtual void Disconnect();
+
+	/** @brief Seconds after which cached latest constants are fetched again. 0 - never. Default 3600 */
+	void SetMaxAge(time_t seconds) { mMaxAge = seconds; }
+	time_t GetMaxAge() const { return mMaxAge; }
+
+	/** Path of the local cache file. Empty if constants are cached in memory only */
+	const string& GetCacheFilePath() const { return mCacheFilePath; }
+
+	/** The remote was connected because of a cache miss or a not cached request */
+	bool IsRemoteConnected() const { return mRemote != NULL && mRemote->IsConnected(); }
+
+	/** Numbers of requests served by each tier */
+	size_t GetMemoryHits() const { return mMemoryHits; }
+	size_t GetFileHits() const { return mFileHits; }
+	size_t GetRemoteFetches() const { return mRemoteFetches; }
+
+	//----------------------------------------------------------------------------------------
+	//	D I R E C T O R Y   M A N G E M E N T
+	//----------------------------------------------------------------------------------------
+
+	virtual Directory* GetDirectory(const string& path);
+	virtual Directory* const GetRootDirectory();
+	virtual bool SearchDirectories(vector<Directory *>& resultDirectories, const string& searchPattern, const string& parentPath="", int take=0, int startWith=0);
+	using CatalogDataProvider::SearchDirectories;
+
+	//----------------------------------------------------------------------------------------
+	//	C O N S T A N T   T Y P E   T A B L E
+	//----------------------------------------------------------------------------------------
+
+	/** @brief Gets type table from the cache or from the remote */
+	virtual ConstantsTypeTable * GetConstantsTypeTable(const string& path, bool loadColumns=false);
+	virtual ConstantsTypeTable * GetConstantsTypeTable(const string& name, Directory *parentDir, bool loadColumns=false);
+	virtual bool GetConstantsTypeTables(vector<ConstantsTypeTable *>& typeTables, const string& parentDirPath, bool loadColumns=false);
+	virtual vector<ConstantsTypeTable *> GetConstantsTypeTables(Directory *parentDir, bool loadColumns=false);
+	virtual bool GetConstantsTypeTables(vector<ConstantsTypeTable *>& typeTables, Directory *parentDir, bool loadColumns=false);
+	virtual bool SearchConstantsTypeTables(vector<ConstantsTypeTable *>& typeTables, const string& pattern, const string& parentPath = "", bool loadColumns=false, int take=0, int startWith=0 );
+	virtual vector<ConstantsTypeTable *> SearchConstantsTypeTables(const string& pattern, const string& parentPath = "", bool loadColumns=false, int take=0, int startWith=0 );
+	virtual int CountConstantsTypeTables(Directory *dir);
+
+	/** @brief Loads columns from the cache or from the remote */
+	virtual bool LoadColumns(ConstantsTypeTable* table);
+
+	//----------------------------------------------------------------------------------------
+	//	R U N   R A N G E S
+	//----------------------------------------------------------------------------------------
+
+	virtual RunRange* GetRunRange(int min, int max, const string& name = "");
+	virtual bool GetRunRanges(vector<RunRange *>& resultRunRanges, ConstantsTypeTable *table, const string& variation="", int take=0, int startWith=0 );
+	virtual RunRange* GetRunRange(const string& name);
+	using CatalogDataProvider::GetRunRanges;
+
+	//----------------------------------------------------------------------------------------
+	//	V A R I A T I O N
+	//----------------------------------------------------------------------------------------
+
+	virtual Variation* GetVariation(const string& name);
+	virtual bool GetVariations(vector<Variation *>& resultVariations, ConstantsTypeTable *table, int run=0, int take=0, int startWith=0 );
+	virtual vector<Variation *> GetVariations(ConstantsTypeTable *table, int run=0, int take=0, int startWith=0 );
+	using CatalogDataProvider::GetVariations;
+
+	//----------------------------------------------------------------------------------------
+	//	A S S I G N M E N T S
+	//----------------------------------------------------------------------------------------
+
+	/** @brief Gets assignment from the cache or from the remote */
+	virtual Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation="default", bool loadColumns=false);
+	using CatalogDataProvider::GetAssignmentShort;
+
+	/** @brief Gets assignment with run range and variation from the cache or from the remote */
+	virtual Assignment* GetAssignmentFull(int run, const string& path, const string& variation="default");
+	virtual Assignment* GetAssignmentFull(int run, const string& path, int version, const string& variation="default");
+
+	virtual bool GetAssignments(vector<Assignment *> &assingments,const string& path, int runMin, int runMax, const string& runRangeName, const string& variation, time_t beginTime, time_t endTime, int sortBy=0, int take=0, int startWith=0);
+	using CatalogDataProvider::GetAssignments;
+	virtual bool FillAssignment(Assignment* assignment);
+
+private:
+
+	/** Assignment as it is kept in the cache */
+	struct CachedAssignment
+	{
+		time_t FetchedTime;           // when it was taken from the remote
+		int Id;
+		time_t CreatedTime;
+		time_t ModifiedTime;
+		string Comment;
+		int DataVaultId;
+		bool HasRelations;            // run range and variation are set (GetAssignmentFull)
+		int RunRangeId;
+		string RunRangeName;
+		int RunMin;
+		int RunMax;
+		int VariationId;
+		string VariationName;
+		string RawData;
+		int FirstRun;                 // runs the request gives this assignment for
+		int LastRun;
+	};
+
+	/** @brief Gets connected remote. Connects it on the first call. Reports errors */
+	DataProvider* GetRemote(const string& errorSource);
+
+	/** @brief Copies error codes of the remote after a call forwarded to it */
+	void CopyRemoteErrors();
+
+	/** @brief Opens the cache file and creates its tables. Reports a warning on failure */
+	bool OpenCacheFile();
+
+	/** @brief Finalizes statements and closes the cache file */
+	void CloseCacheFile();
+
+	/** @brief Reports a warning with the last error of the cache file */
+	void CacheFileWarning(const string& errorSource);
+
+	/** @brief Finds type table in the catalog, in the cache file or in the remote and adds it to the catalog
+	 * @return index of the table in the catalog or -1
+	 */
+	int CacheTable(const string& path);
+
+	/** @brief Adds type table of the remote to the catalog and to the cache file
+	 * @return index of the table in the catalog
+	 */
+	int AddCachedTable(const string& path, ConstantsTypeTable* table);
+
+	/** @brief Finds assignment in the cache tiers or fetches it from the remote */
+	Assignment* QueryAssignment(int run, const string& path, time_t time, const string& variation, bool loadColumns, bool full);
+
+	/** @brief Finds in memory the assignment entry of the request that is kept for the run */
+	bool FindMemoryAssignment(const string& key, int run, CachedAssignment& cached);
+
+	/** @brief Keeps assignment entry in memory instead of entries of the same runs */
+	void StoreMemoryAssignment(const string& key, const CachedAssignment& cached);
+
+	/** @brief Reads assignment entry of the cache file that is kept for the run */
+	bool ReadCachedAssignment(const string& key, int run, CachedAssignment& cached);
+
+	/** @brief Writes assignment entry to the cache file instead of entries of the same runs */
+	void WriteCachedAssignment(const string& key, const CachedAssignment& cached);
+
+	/** @brief Latest constants entry is older than the max age */
+	bool IsExpired(const CachedAssignment& cached, time_t requestTime, time_t now) const;
+
+	/** @brief Creates assignment object from the cache entry */
+	Assignment* CreateCachedAssignment(size_t tableIndex, const CachedAssignment& cached, int run, bool loadColumns);
+
+	string mCacheFilePath;                               // local cache file, empty - memory only
+	string mRemoteConnectionString;                      // connection string of the remote
+	string mRemoteKey;                                   // identifies the remote in the cache file
+	DataProvider* mRemote;                               // remote provider, created on the first miss
+	time_t mMaxAge;                                      // seconds the latest constants are valid
+
+	sqlite3* mCacheFile;                                 // opened cache file or NULL
+	sqlite3_stmt* mSelectTable;                          // prepared statements of the cache file
+	sqlite3_stmt* mInsertTable;
+	sqlite3_stmt* mSelectAssignment;
+	sqlite3_stmt* mInsertAssignment;
+	sqlite3_stmt* mDeleteAssignments;
+
+	unordered_map<string, map<int, CachedAssignment> > mAssignments; // request key => first run => cached assignment
+
+	size_t mMemoryHits;
+	size_t mFileHits;
+	size_t mRemoteFetches;
+
+	CachingDataProvider(const CachingDataProvider& rhs);
+	CachingDataProvider& operator=(const CachingDataProvider& rhs);
+};
+
+}
+
+#endif // _CachingDataProvider_
@@ -0,0 +1,151 @@
+#ifndef _CatalogDataProvider_
+#define _CatalogDataProvider_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+#include "CCDB/Providers/DataProvider.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+/** @brief Base of read only providers that keep the whole catalog in memory
+ *
+ * Providers that read constants from files (@see PackDataProvider) have no database to query
+ * directories, type tables and variations from. They fill the catalog on Connect with AddTable and
+ * AddVariation, and this class serves all catalog functions from memory. Derived classes only
+ * implement Connect, Disconnect and GetAssignmentShort.
+ *
+ * The catalog is read only. Run ranges and assignment history (GetAssignments) are not kept,
+ * such functions report CCDB_ERROR_NOT_IMPLEMENTED
+ */
+class CatalogDataProvider: public DataProvider
+{
+public:
+	CatalogDataProvider(void);
+	virtual ~CatalogDataProvider(void);
+
+	//----------------------------------------------------------------------------------------
+	//	C O N N E C T I O N
+	//----------------------------------------------------------------------------------------
+
+	virtual bool IsConnected();
+
+	//----------------------------------------------------------------------------------------
+	//	D I R E C T O R Y   M A N G E M E N T
+	//----------------------------------------------------------------------------------------
+
+	virtual Directory* GetDirectory(const string& path);
+	virtual bool SearchDirectories(vector<Directory *>& resultDirectories, const string& searchPattern, const string& parentPath="", int take=0, int startWith=0);
+	virtual vector<Directory *> SearchDirectories(const string& searchPattern, const string& parentPath="", int take=0, int startWith=0);
+
+	//----------------------------------------------------------------------------------------
+	//	C O N S T A N T   T Y P E   T A B L E
+	//----------------------------------------------------------------------------------------
+
+	virtual ConstantsTypeTable * GetConstantsTypeTable(const string& path, bool loadColumns=false);
+	virtual ConstantsTypeTable * GetConstantsTypeTable(const string& name, Directory *parentDir, bool loadColumns=false);
+	virtual bool GetConstantsTypeTables(vector<ConstantsTypeTable *>& typeTables, const string& parentDirPath, bool loadColumns=false);
+	virtual vector<ConstantsTypeTable *> GetConstantsTypeTables(Directory *parentDir, bool loadColumns=false);
+	virtual bool GetConstantsTypeTables(vector<ConstantsTypeTable *>& typeTables, Directory *parentDir, bool loadColumns=false);
+	virtual bool SearchConstantsTypeTables(vector<ConstantsTypeTable *>& typeTables, const string& pattern, const string& parentPath = "", bool loadColumns=false, int take=0, int startWith=0 );
+	virtual vector<ConstantsTypeTable *> SearchConstantsTypeTables(const string& pattern, const string& parentPath = "", bool loadColumns=false, int take=0, int startWith=0 );
+	virtual int CountConstantsTypeTables(Directory *dir);
+	virtual bool LoadColumns(ConstantsTypeTable* table);
+
+	//----------------------------------------------------------------------------------------
+	//	R U N   R A N G E S
+	//----------------------------------------------------------------------------------------
+
+	virtual RunRange* GetRunRange(int min, int max, const string& name = "");
+	virtual bool GetRunRanges(vector<RunRange *>& resultRunRanges, ConstantsTypeTable *table, const string& variation="", int take=0, int startWith=0 );
+	virtual RunRange* GetRunRange(const string& name);
+
+	//----------------------------------------------------------------------------------------
+	//	V A R I A T I O N
+	//----------------------------------------------------------------------------------------
+
+	virtual Variation* GetVariation(const string& name);
+
+	/** @brief Gets all variations of the catalog. table and run are not taken into account */
+	virtual bool GetVariations(vector<Variation *>& resultVariations, ConstantsTypeTable *table, int run=0, int take=0, int startWith=0 );
+	virtual vector<Variation *> GetVariations(ConstantsTypeTable *table, int run=0, int take=0, int startWith=0 );
+
+	//----------------------------------------------------------------------------------------
+	//	A S S I G N M E N T S
+	//----------------------------------------------------------------------------------------
+
+	virtual Assignment* GetAssignmentShort(int run, const string& path, const string& variation="default", bool loadColumns=false);
+	virtual Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation="default", bool loadColumns=false)=0;
+
+	/** @brief The same as GetAssignmentShort with columns. Run range and variation are not set */
+	virtual Assignment* GetAssignmentFull(int run, const string& path, const string& variation="default");
+	virtual Assignment* GetAssignmentFull(int run, const string& path, int version, const string& variation="default");
+
+	virtual bool GetAssignments(vector<Assignment *> &assingments,const string& path, int runMin, int runMax, const string& runRangeName, const string& variation, time_t beginTime, time_t endTime, int sortBy=0, int take=0, int startWith=0);
+	virtual bool GetAssignments(vector<Assignment *> &assingments,const string& path, int run, const string& variation="", time_t date=0, int take=0, int startWith=0);
+	virtual vector<Assignment *> GetAssignments(const string& path, int run, const string& variation="", time_t date=0, int take=0, int startWith=0);
+	virtual bool GetAssignments(vector<Assignment *> &assingments,const string& path, const string& runName, const string& variation="", time_t date=0, int take=0, int startWith=0);
+	virtual vector<Assignment *> GetAssignments(const string& path, const string& runName, const string& variation="", time_t date=0, int take=0, int startWith=0);
+	virtual bool FillAssignment(Assignment* assignment);
+
+protected:
+
+	/** @brief Type table as it is kept in the catalog */
+	struct CatalogTable
+	{
+		string FullPath;              // full path of the table
+		string Name;                  // name of the table
+		Directory* Parent;            // directory of the table
+		string Comment;               // comment
+		int RowsCount;                // number of rows
+		vector<string> ColumnNames;   // names of columns
+		vector<string> ColumnTypes;   // types of columns as strings. @see ConstantsTypeColumn::SetType
+	};
+
+	/** The catalog is filled on Connect, so there is nothing to load */
+	virtual bool LoadDirectories();
+
+	/** @brief Adds type table to the catalog. Directories of the path are created if needed
+	 * @return index of the table in the catalog
+	 */
+	size_t AddTable(const string& fullPath, const vector<string>& columnNames, const vector<string>& columnTypes, int rowsCount, const string& comment="");
+
+	/** @brief Finds or creates directory with all its parents */
+	Directory* AddDirectories(const string& path);
+
+	/** @brief Adds variation to the catalog. The parent should be added before */
+	Variation* AddVariation(const string& name, const string& parentName="");
+
+	/** @brief Deletes directories, tables and variations of the catalog */
+	void ClearCatalog();
+
+	/** @return index of the table or -1 if there is no such table */
+	int FindTable(const string& fullPath) const;
+
+	/** @brief Creates type table object for the catalog table. The provider owns it */
+	ConstantsTypeTable* CreateTypeTable(size_t tableIndex, bool loadColumns);
+
+	/** @brief Creates assignment with the type table set. The provider owns the assignment, the assignment owns the table */
+	Assignment* CreateAssignment(size_t tableIndex, int run, bool loadColumns);
+
+	/** @brief Checks connection and clears errors before the call */
+	bool CheckConnection(const string& errorSource);
+
+	bool mIsConnected;                               // indicates connection to the data
+	vector<CatalogTable> mTables;                    // type tables of the catalog
+	unordered_map<string, size_t> mTablesByPath;     // full path => index in mTables
+	map<string, Variation*> mVariationsByName;       // variations of the catalog
+
+private:
+	CatalogDataProvider(const CatalogDataProvider& rhs);
+	CatalogDataProvider& operator=(const CatalogDataProvider& rhs);
+};
+
+}
+
+#endif // _CatalogDataProvider_
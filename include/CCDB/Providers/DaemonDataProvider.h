@@ -0,0 +1,81 @@
+#ifndef _DaemonDataProvider_
+#define _DaemonDataProvider_
+
+#include <string>
+#include <vector>
+
+#include "CCDB/Providers/CatalogDataProvider.h"
+#include "CCDB/Providers/DaemonProtocol.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+/** @brief Provider that takes constants from the ccdbd daemon of the node
+ *
+ * The daemon (@see DaemonServer) keeps one database connection and one cache for all processes
+ * of the node. The provider talks to it over a Unix domain socket (@see DaemonProtocol).
+ * On Connect the catalog of all type tables is taken from the daemon, variations are taken on
+ * the first use. Several assignments can be requested in one round trip with GetAssignmentsBatch.
+ *
+ * If the daemon is restarted, the socket is opened again on the next request.
+ * Run ranges and assignment history are not served by the daemon.
+ */
+class DaemonDataProvider: public CatalogDataProvider
+{
+public:
+	DaemonDataProvider(void);
+	virtual ~DaemonDataProvider(void);
+
+	/**
+	 * @brief Connects to the daemon and reads the catalog
+	 *
+	 * @param connectionString "ccdbd://<path to the socket>", i.e. ccdbd:///tmp/ccdbd.socket
+	 * @return true if connected
+	 */
+	virtual bool Connect(string connectionString);
+
+	/** @brief Closes the socket. Objects read stay valid */
+	virtual void Disconnect();
+
+	/** @brief Gets variation. Variations are taken from the daemon on the first use */
+	virtual Variation* GetVariation(const string& name);
+
+	virtual Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation="default", bool loadColumns=false);
+	using CatalogDataProvider::GetAssignmentShort;
+
+	/**
+	 * @brief Gets assignments of several requests in one round trip to the daemon
+	 *
+	 * @param [in]  requests    - run, time, path and variation of each assignment
+	 * @param [out] assignments - assignment for each request, NULL if no constants were found or on error
+	 * @param [in]  loadColumns - load columns of type tables
+	 * @return false if the daemon can't be reached. Errors of single requests are reported, but the result is true
+	 */
+	bool GetAssignmentsBatch(const vector<DaemonProtocol::ConstantsRequest>& requests, vector<Assignment*>& assignments, bool loadColumns=false);
+
+private:
+
+	/** @brief Opens the socket and checks the protocol version. Reports errors */
+	bool OpenSocket();
+
+	/** @brief Closes the socket if it is opened */
+	void CloseSocket();
+
+	/** @brief Sends the request and reads the reply. Opens the socket if needed. Reports errors */
+	bool Exchange(const string& request, string& reply, const string& errorSource);
+
+	/** @brief Reads the catalog of all type tables from the daemon */
+	bool ReadCatalog();
+
+	string mSocketPath;                 // path of the daemon socket
+	int mSocket;                        // -1 if not opened
+
+	DaemonDataProvider(const DaemonDataProvider& rhs);
+	DaemonDataProvider& operator=(const DaemonDataProvider& rhs);
+};
+
+}
+
+#endif // _DaemonDataProvider_
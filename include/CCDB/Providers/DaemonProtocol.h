@@ -0,0 +1,128 @@
+#ifndef DaemonProtocol_h__
+#define DaemonProtocol_h__
+
+#include <stdint.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+namespace ccdb
+{
+    /** @brief Messages between the ccdbd daemon and DaemonDataProvider
+     *
+     * The daemon and its clients run on the same node and talk over a Unix domain socket,
+     * so numbers are in the byte order of the machine. Each message is a frame:
+     *
+     *   uint32 payload length, payload
+     *
+     * Payload starts with uint8 message type. Strings are uint32 length and chars.
+     *
+     *   Hello       client: magic, version          daemon: status, version
+     *   Catalog     client: -                       daemon: status, tables count, tables
+     *                                               table: path, rows, comment, columns count, (name, type)...
+     *   Variation   client: name                    daemon: status, parent name
+     *   Assignments client: count, requests         daemon: count, results
+     *                request: run, time, path, variation
+     *                result:  status, [id, created, modified, data vault id, comment, blob]
+     *
+     * Assignments are requested in batches, results go in the order of requests.
+     */
+    namespace DaemonProtocol
+    {
+        const uint32_t cMagic = 0x44444343;          // "CCDD"
+        const uint32_t cVersion = 1;
+        const uint32_t cMaxFrameLength = 256*1024*1024;
+
+        enum MessageType
+        {
+            cHello       = 'H',
+            cCatalog     = 'C',
+            cVariation   = 'V',
+            cAssignments = 'A'
+        };
+
+        enum Status
+        {
+            cOk       = 0,
+            cNotFound = 1,   // no constants or no such variation
+            cError    = 2    // followed by int32 ccdb error code
+        };
+
+        /** Request of one assignment in a batch */
+        struct ConstantsRequest
+        {
+            int Run;
+            time_t Time;                // 0 - the latest
+            std::string Path;
+            std::string Variation;
+        };
+
+        /** @brief Builds message payload */
+        class MessageWriter
+        {
+        public:
+            explicit MessageWriter(uint8_t type) { mBuffer.push_back((char)type); }
+
+            void WriteUInt8(uint8_t value)   { mBuffer.push_back((char)value); }
+            void WriteInt32(int32_t value)   { Write(&value, sizeof(value)); }
+            void WriteUInt32(uint32_t value) { Write(&value, sizeof(value)); }
+            void WriteInt64(int64_t value)   { Write(&value, sizeof(value)); }
+            void WriteString(const std::string& value);
+
+            /** Appends bytes as they are, i.e. a part of another payload */
+            void WriteBytes(const char* data, size_t length) { Write(data, length); }
+
+            const std::string& GetPayload() const { return mBuffer; }
+
+        private:
+            void Write(const void* data, size_t length) { mBuffer.append((const char*)data, length); }
+            std::string mBuffer;
+        };
+
+        /** @brief Reads message payload. Reading past the end sets IsOk to false */
+        class MessageReader
+        {
+        public:
+            explicit MessageReader(const std::string& payload): mPayload(payload), mPosition(0), mIsOk(true) {}
+
+            uint8_t ReadUInt8();
+            int32_t ReadInt32();
+            uint32_t ReadUInt32();
+            int64_t ReadInt64();
+            std::string ReadString();
+
+            /** All reads were within the payload */
+            bool IsOk() const { return mIsOk; }
+
+            /** The whole payload was read */
+            bool IsAtEnd() const { return mPosition == mPayload.size(); }
+
+        private:
+            bool Read(void* data, size_t length);
+            const std::string& mPayload;
+            size_t mPosition;
+            bool mIsOk;
+        };
+
+        /** @brief Writes the frame to the socket. Blocks until everything is written
+         * @return false if the socket is closed or fails
+         */
+        bool WriteFrame(int socket, const std::string& payload);
+
+        /** @brief Reads a frame from the socket. Blocks until the whole frame is read
+         * @return false if the socket is closed, fails or the frame is too long
+         */
+        bool ReadFrame(int socket, std::string& payload);
+
+        /** @brief Appends the frame of the payload to the buffer. For non blocking sockets */
+        void AppendFrame(std::string& buffer, const std::string& payload);
+
+        /** @brief Takes the first frame from bytes received by a non blocking socket
+         * @return 1 - the frame is taken from the buffer, 0 - the whole frame is not received yet,
+         *         -1 - the frame is empty or too long
+         */
+        int TakeFrame(std::string& buffer, std::string& payload);
+    }
+}
+
+#endif // DaemonProtocol_h__
@@ -0,0 +1,207 @@
+#ifndef DaemonServer_h__
+#define DaemonServer_h__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <list>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <time.h>
+
+#include "CCDB/Providers/DataProvider.h"
+#include "CCDB/Providers/DaemonProtocol.h"
+
+namespace ccdb
+{
+    /** @brief Serves constants of one provider to the processes of a node over a Unix domain socket
+     *
+     * This is the core of the ccdbd daemon (@see DaemonProtocol, DaemonDataProvider). The node has one
+     * connection to the database (the upstream provider) and one cache: results of assignment requests
+     * are kept already serialized, so a cache hit is one lookup and one copy to the reply. A result is
+     * kept for all runs the upstream gives the same assignment for (@see DataProvider::GetAssignmentForRuns),
+     * so the runs of a run range are fetched once.
+     *
+     * Clients are served by one thread with poll() on non blocking sockets, each client has its own
+     * input and output buffers, so a client that sends half a frame or doesn't read its replies
+     * stalls only itself. Cache hits are answered in this thread. Misses go to the upstream thread,
+     * the only one that uses the provider, and the reply is sent when the upstream is done.
+     * A key is fetched once, other clients that ask it meanwhile wait for the same fetch.
+     * Cached latest constants (time=0) expire after the
+     * max age (@see SetMaxAge) and are purged once per max age, constants at a time never expire.
+     * When results take more than the cache limit, the least recently used go first (@see SetMaxCacheBytes).
+     *
+     * Listen throws std::logic_error if the socket can't be made
+     */
+    class DaemonServer
+    {
+    public:
+
+        /** @param upstream - connected provider to take constants from. It is not owned */
+        explicit DaemonServer(DataProvider* upstream);
+        ~DaemonServer();
+
+        /** @brief Creates the socket. An old socket file at the path is removed */
+        void Listen(const std::string& socketPath);
+
+        /** @brief Serves clients until Stop is called */
+        void Run();
+
+        /** @brief Makes Run return. Can be called from another thread or a signal handler */
+        void Stop() { mIsStopping = true; }
+
+        /** @brief Seconds after which cached latest constants are taken from the upstream again. 0 - never */
+        void SetMaxAge(time_t seconds) { mMaxAge = seconds; }
+
+        /** @brief Bytes the cached results may take. The least recently used are dropped first. 0 - no limit */
+        void SetMaxCacheBytes(size_t bytes) { mMaxCacheBytes = bytes; }
+
+        /** Number of cached assignment results */
+        size_t GetCacheSize() const { return mUseOrder.size(); }
+
+        /** Bytes taken by cached results and their keys */
+        size_t GetCacheBytes() const { return mCacheBytes; }
+
+        /** Number of assignment requests that went to the upstream */
+        size_t GetUpstreamRequests() const { return mUpstreamRequests; }
+
+        /** Number of clients connected now */
+        size_t GetClientsCount() const { return mClients.size(); }
+
+    private:
+
+        /** A message of a client that waits for the upstream */
+        struct PendingMessage
+        {
+            int Client;                         // socket of the client, -1 if the client is gone
+            uint8_t Type;                       // message type of the reply
+            std::vector<std::string> Results;   // results in the order of requests
+            size_t MissingCount;                // results the upstream has not given yet
+        };
+
+        /** What a pending message waits for: result of a key goes to Results[Index] */
+        struct Waiter
+        {
+            std::shared_ptr<PendingMessage> Message;
+            size_t Index;
+        };
+
+        /** Work of the upstream thread */
+        struct Fetch
+        {
+            std::string Key;
+            uint8_t Type;                       // cCatalog, cVariation or cAssignments
+            DaemonProtocol::ConstantsRequest Request;   // assignment to fetch or the name of the variation in Path
+            std::string Result;                 // filled by the upstream thread
+            bool IsCacheable;                   // false for errors
+            int FirstRun;                       // runs the result is given for
+            int LastRun;
+        };
+
+        struct Client
+        {
+            Client(): Socket(-1), OutputSent(0) {}
+            int Socket;
+            std::string Input;                  // received bytes that are not handled yet
+            std::string Output;                 // replies that are not sent yet
+            size_t OutputSent;                  // bytes of Output that are sent
+            std::shared_ptr<PendingMessage> Pending;    // message that waits for the upstream
+        };
+
+        /** Cached result: the request key (path, variation and time) and the first run it is kept for */
+        typedef std::pair<std::string, int> CacheKey;
+
+        struct CacheEntry
+        {
+            time_t FetchedTime;
+            time_t RequestTime;                 // time of constants in the request, 0 - the latest
+            int LastRun;                        // the result is kept for runs from the key to this one
+            std::string Result;                 // serialized result of the request
+            std::list<CacheKey>::iterator Use;  // place in mUseOrder
+        };
+
+        /** @brief Is the cached result too old to be given */
+        bool IsExpired(const CacheEntry& entry, time_t now) const;
+
+        /** @brief Finds the result of the request that is kept for the run. @return NULL if there is none */
+        CacheEntry* FindCached(const std::string& key, int run);
+
+        /** @brief Removes the result from the cache */
+        void EraseCached(const CacheKey& key);
+
+        /** @brief Removes expired results */
+        void PurgeExpired(time_t now);
+
+        /** @brief Keeps the result of an assignment request instead of results of the same runs. The least recently used go over the limit */
+        void StoreCached(const std::string& key, int firstRun, int lastRun, time_t requestTime, const std::string& result);
+
+        /** @brief Reads what the client has sent. @return false if the client is closed */
+        bool ReceiveInput(Client& client);
+
+        /** @brief Sends what the socket takes without blocking. @return false if the client is closed */
+        bool SendOutput(Client& client);
+
+        /** @brief Handles whole frames of the client while it waits for nothing. @return false if a message is wrong */
+        bool ServeClient(Client& client);
+
+        /** @brief Handles a message of a client. @return false if the message is wrong */
+        bool HandleMessage(Client& client, const std::string& request);
+
+        /** @brief Makes the message wait for the key. The key is fetched if it is not fetched already */
+        void WaitFor(const std::shared_ptr<PendingMessage>& message, size_t index, const Fetch& fetch);
+
+        /** @brief Gives results of finished fetches to the messages that wait for them */
+        void TakeFinishedFetches();
+
+        /** @brief Sends the reply of a message that has all results */
+        void Reply(Client& client, const PendingMessage& message);
+
+        /** @brief Upstream thread: does fetches one by one */
+        void RunUpstream();
+
+        /** @brief Upstream thread: does the fetch with the provider */
+        void DoFetch(Fetch& fetch);
+
+        /** @brief Serializes all type tables of the upstream */
+        void MakeCatalog(DaemonProtocol::MessageWriter& writer);
+
+        /** @brief Serializes the result of one assignment request. @return false for errors, they are not cached
+         * @param [out] firstRun, lastRun - runs the result is given for
+         */
+        bool FetchAssignment(const DaemonProtocol::ConstantsRequest& request, std::string& result, int& firstRun, int& lastRun);
+
+        DataProvider* mUpstream;                // provider to take constants from
+        std::string mSocketPath;                // path of the listening socket
+        int mListenSocket;                      // -1 if not listening
+        std::map<int, Client> mClients;         // socket => connected client
+        std::atomic<bool> mIsStopping;          // Run should return
+        time_t mMaxAge;                         // seconds the latest constants are valid
+
+        std::string mCatalog;                   // serialized catalog, made on the first request
+        std::unordered_map<std::string, std::map<int, CacheEntry> > mCache;   // request key => first run => result
+        std::list<CacheKey> mUseOrder;          // keys of mCache, the most recently used first
+        size_t mCacheBytes;                     // bytes taken by mCache
+        size_t mMaxCacheBytes;                  // 0 - no limit
+        time_t mLastPurgeTime;
+        std::atomic<size_t> mUpstreamRequests;
+
+        std::unordered_map<std::string, std::vector<Waiter> > mInFlight;  // key => messages that wait for its fetch
+        std::thread mUpstreamThread;            // the only thread that uses mUpstream
+        std::mutex mFetchesMutex;               // guards mFetches, mFinished and mIsUpstreamStopping
+        std::condition_variable mFetchesCondition;
+        std::deque<Fetch> mFetches;             // fetches for the upstream thread
+        std::deque<Fetch> mFinished;            // fetches done by the upstream thread
+        bool mIsUpstreamStopping;
+        int mWakePipe[2];                       // the upstream thread wakes poll() by writing to it
+
+        DaemonServer(const DaemonServer& rhs);
+        DaemonServer& operator=(const DaemonServer& rhs);
+    };
+}
+
+#endif // DaemonServer_h__
@@ -13,6 +13,7 @@
 #include "CCDB/Model/RunRange.h"
 #include "CCDB/Model/Variation.h"
 #include "CCDB/CCDBError.h"
+#include "CCDB/Helpers/BlobCursor.h"
 
 
 
@@ -87,6 +88,16 @@ public:
      * @return true if  connection is open
      */
     virtual bool IsConnected()=0;
+
+    /**
+     * @brief checks that the connection is still alive
+     *
+     * Servers drop connections that were idle for too long, IsConnected doesn't know about it.
+     * The base implementation returns IsConnected(), server based providers ask the server.
+     *
+     * @return true if connection is open and alive
+     */
+    virtual bool Ping();
     
     /** @brief Connection string that was used on last successful connect.
      *
@@ -419,7 +430,36 @@ public:
      * @return DAssignment object or NULL if no assignment is found or error
      */
     virtual Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation="default", bool loadColumns=false)=0;
-       
+
+
+    /** @brief Get cursor that reads the data blob of the assignment row by row
+     *
+     * Selects the same assignment as GetAssignmentShort does, but instead of decoding the whole
+     * blob returns a cursor that decodes one row at a time. The base implementation
+     * loads the blob into memory, providers that can stream the blob override it.
+     *
+     * @param [in] run - run number
+     * @param [in] path - object path
+     * @param [in] time - timestamp, data that is equal or earlier in time than that timestamp is returned. 0 - latest
+     * @param [in] variation - variation name
+     * @return new BlobCursor object (the caller should delete it) or NULL if no assignment is found or error
+     */
+    virtual BlobCursor* GetAssignmentCursor(int run, const string& path, time_t time, const string& variation="default");
+
+    /** @brief true if the provider keeps constants as numbers, @see GetDecodedValues */
+    virtual bool HasDecodedValues() const { return false; }
+
+    /** @brief Gets constants as numbers the provider keeps decoded
+     *
+     * The numbers must be the ones StringUtils::ParseDouble gives for the cells, so
+     * Calibration::GetCalib returns the same whatever the provider is. The base implementation
+     * has no numbers, Calibration then loads the assignment and parses it.
+     *
+     * @param [out] values - rows of cells
+     * @return false if there are no such constants
+     */
+    virtual bool GetDecodedValues(vector< vector<double> >& values, int run, const string& path, time_t time, const string& variation="default") { return false; }
+
 
     /** @brief Get last Assignment with all related objects
      *
@@ -439,6 +479,22 @@ public:
      * @return   DAssignment*
      */
     virtual Assignment* GetAssignmentFull(int run, const string& path, int version, const string& variation="default")=0;
+
+    /** @brief Gets assignment with all related objects and the runs the same request gives it for
+     *
+     * The runs are the run range of the assignment without the runs of newer assignments of its
+     * variation and of assignments of more specific variations. So caches may keep the assignment
+     * for all runs in [runMin, runMax], not only for the requested run.
+     * If the provider keeps no assignments history or there are too many assignments to check,
+     * the runs are just [run, run]
+     *
+     * @param [in] time - timestamp, data that is equal or earlier in time than that timestamp is returned. 0 - latest
+     * @param [in] useParents - take the assignment of the parent variation if the variation has none, as GetAssignmentShort does.
+     *                          Otherwise as GetAssignmentFull does
+     * @param [out] runMin, runMax - the runs the assignment is given for
+     * @return NULL if no assignment is found or error
+     */
+    Assignment* GetAssignmentForRuns(int run, const string& path, time_t time, const string& variation, bool useParents, int& runMin, int& runMax);
     
     /**
      * @brief Complex and universal function to retrieve assignments
@@ -0,0 +1,123 @@
+#ifndef DataProviderPool_h__
+#define DataProviderPool_h__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "CCDB/Providers/DataProvider.h"
+
+namespace ccdb
+{
+    /** @brief Bounded pool of connected DataProvider objects
+     *
+     * A DataProvider keeps the statement and the caches of one connection and
+     * can't be used by several threads at once. The pool gives each reading thread its
+     * own provider (i.e. its own connection) so that read queries run in parallel.
+     *
+     * Providers are created and connected lazily, up to GetMaxSize().
+     * When all providers are taken Acquire waits until one is released.
+     * A provider that was not used for GetPingInterval() seconds is pinged (@see DataProvider::Ping)
+     * before it is given out and is reconnected if the server dropped the connection.
+     *
+     * Objects read through a pooled provider are owned by that provider and
+     * live as long as the pool lives.
+     */
+    class DataProviderPool
+    {
+    public:
+
+        /** Creates a new (not connected) provider */
+        typedef std::function<DataProvider*()> ProviderFactory;
+
+        /** @brief Takes provider from the pool and releases it at the end of the scope */
+        class Lease
+        {
+        public:
+            explicit Lease(DataProviderPool& pool): mPool(pool), mProvider(pool.Acquire()) {}
+            ~Lease() { if(mProvider) mPool.Release(mProvider); }
+
+            /** Connected provider or NULL if connection failed */
+            DataProvider* Get() const { return mProvider; }
+
+        private:
+            DataProviderPool& mPool;
+            DataProvider* mProvider;
+
+            Lease(const Lease& rhs);
+            Lease& operator=(const Lease& rhs);
+        };
+
+        /**
+         * @param connectionString - connection string the providers connect with
+         * @param factory          - creates a provider
+         * @param maxSize          - maximum number of providers. 0 means @see GetDefaultSize
+         */
+        DataProviderPool(const std::string& connectionString, ProviderFactory factory, size_t maxSize=0);
+
+        /** Deletes all providers. No provider should be taken at this moment */
+        ~DataProviderPool();
+
+        /** @brief Takes a free provider, creates a new one or waits for one to be released
+         *
+         * The provider is connected if it isn't
+         * @return provider, that must be given back by Release, or NULL if it failed to connect
+         */
+        DataProvider* Acquire();
+
+        /** @brief Gives the provider taken by Acquire back to the pool */
+        void Release(DataProvider* provider);
+
+        /** @brief Disconnects free providers. They reconnect on the next Acquire */
+        void Disconnect();
+
+        /** Connection string for new connections */
+        std::string GetConnectionString();
+        void SetConnectionString(const std::string& connectionString);
+
+        /** Maximum number of providers (connections) */
+        size_t GetMaxSize();
+        void SetMaxSize(size_t maxSize);
+
+        /** Seconds a provider may stay unused before Acquire pings it. 0 - ping every time, negative - never */
+        int GetPingInterval();
+        void SetPingInterval(int seconds);
+
+        /** Number of providers created so far */
+        size_t GetSize();
+
+        /** Number of Acquire calls */
+        size_t GetAcquiresCount();
+
+        /** Number of Acquire calls that had to wait for a free provider */
+        size_t GetWaitsCount();
+
+        /** Number of providers that failed the ping and were reconnected */
+        size_t GetReconnectsCount();
+
+        /** Default size is the number of hardware threads */
+        static size_t GetDefaultSize();
+
+    private:
+        std::string mConnectionString;          // connection string for providers
+        ProviderFactory mFactory;               // creates providers
+        size_t mMaxSize;                        // maximum number of providers
+        std::vector<DataProvider*> mProviders;  // all created providers
+        std::vector<DataProvider*> mFree;       // providers that are not taken
+        std::map<DataProvider*, time_t> mReleaseTimes; // when the provider was released last time
+        int mPingInterval;                      // seconds before unused provider is pinged
+        size_t mAcquiresCount;                  // number of Acquire calls
+        size_t mWaitsCount;                     // number of Acquire calls that waited
+        size_t mReconnectsCount;                // number of reconnects after failed ping
+        std::mutex mMutex;
+        std::condition_variable mReleased;
+
+        DataProviderPool(const DataProviderPool& rhs);
+        DataProviderPool& operator=(const DataProviderPool& rhs);
+    };
+}
+
+#endif // DataProviderPool_h__
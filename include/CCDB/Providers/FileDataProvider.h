@@ -1,38 +1,111 @@
-#pragma once
-#include "DataProvider.h"
-#ifndef WIN32
-#include <dirent.h>
-#include <stdio.h>
-#endif
-namespace ccdb
-{
-#ifndef WIN32
-	int listdir(const char *path) 
-	{
-		struct dirent *entry;
-		DIR *dp;
+#ifndef _FileDataProvider_
+#define _FileDataProvider_
 
-		dp = opendir(path);
-		if (dp == NULL) {
-			perror("opendir");
-			return -1;
-		}
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
 
-		while((entry = readdir(dp)))
-			puts(entry->d_name);
+#include "CCDB/Providers/CatalogDataProvider.h"
 
-		closedir(dp);
-		return 0;
-	}
-#endif
+using namespace std;
+
+namespace ccdb
+{
 
-class FileDataProvider : public DataProvider
+/** @brief Read only provider over a directory of per-table files
+ *
+ * No database server or database file is needed. The directory is made by FileDataWriter
+ * (@see ccdbfiles tool) and looks like:
+ *
+ *   <dir>/ccdb.index                       - the index
+ *   <dir>/test/test_vars/test_table.ccdb   - data blobs of /test/test_vars/test_table
+ *
+ * The index is a text file, one record per line, fields are separated by tabs:
+ *
+ *   ccdbfiles  <format version>  <creation time>
+ *   variation  <name>  <parent name>       - parents go before children
+ *   table      <path>  <rows>  <comment>
+ *   column     <name>  <type>              - columns of the last table
+ *   interval   <variation>  <run min>  <run max>  <assignment id>  <created>  <offset>  <length>
+ *                                          - constants of the last table in the variation for the runs
+ *
+ * Intervals of one table and one variation don't overlap and hold the latest constants.
+ * The index is read on Connect, so a lookup is a binary search in memory and one read
+ * of <length> bytes at <offset> of the table file. If a variation has no constants for the run,
+ * its parent is searched as in the database.
+ */
+class FileDataProvider: public CatalogDataProvider
 {
 public:
 	FileDataProvider(void);
-	~FileDataProvider(void);
-	virtual bool Connect(std::string connectionString);
+	virtual ~FileDataProvider(void);
 
+	/**
+	 * @brief Reads the index of the directory
+	 *
+	 * @param connectionString "file://<path to directory>"
+	 * @return true if the index is read and is correct
+	 */
+	virtual bool Connect(string connectionString);
+
+	/** @brief Forgets the index. Objects read from the directory stay valid */
 	virtual void Disconnect();
+
+	/** @brief Gets assignment from the table file
+	 *
+	 * The directory keeps only the latest constants, so time should be 0 or not before GetCreatedTime.
+	 * The assignment has id of the source database, the run range is not set
+	 */
+	virtual Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation="default", bool loadColumns=false);
+	using CatalogDataProvider::GetAssignmentShort;
+
+	/** Time the directory was made */
+	time_t GetCreatedTime() const { return mCreatedTime; }
+
+	/** Name of the index file in the directory */
+	static const char* GetIndexFileName() { return "ccdb.index"; }
+
+	/** Extension of table files */
+	static const char* GetTableFileExtension() { return ".ccdb"; }
+
+	/** Version of the index format */
+	static int GetFormatVersion() { return 1; }
+
+private:
+
+	/** Constants of a table for runs [RunMin, RunMax] */
+	struct FileInterval
+	{
+		int RunMin;
+		int RunMax;
+		int AssignmentId;
+		time_t CreatedTime;
+		uint64_t Offset;                         // offset of the blob in the table file
+		uint64_t Length;                         // length of the blob
+
+		bool operator<(const FileInterval& rhs) const { return RunMin < rhs.RunMin; }
+	};
+
+	typedef map<string, vector<FileInterval> > VariationIntervals;
+
+	/** @brief Parses the index and fills the catalog */
+	bool ReadIndex(const string& index);
+
+	/** @brief Finds interval of the table for the run in the variation or its parents */
+	const FileInterval* FindInterval(size_t tableIndex, Variation* variation, int run) const;
+
+	/** @brief Reads the blob of the interval from the table file */
+	bool ReadBlob(size_t tableIndex, const FileInterval& interval, string& blob);
+
+	string mDirectory;                           // directory with files
+	time_t mCreatedTime;                         // time the directory was made
+	vector<VariationIntervals> mIntervals;       // intervals of each catalog table by variation
+
+	FileDataProvider(const FileDataProvider& rhs);
+	FileDataProvider& operator=(const FileDataProvider& rhs);
 };
+
 }
+
+#endif // _FileDataProvider_
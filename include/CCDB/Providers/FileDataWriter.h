@@ -0,0 +1,95 @@
+#ifndef FileDataWriter_h__
+#define FileDataWriter_h__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <time.h>
+
+#include "CCDB/Providers/DataProvider.h"
+
+namespace ccdb
+{
+    /** @brief Makes directories for FileDataProvider from constants of any provider
+     *
+     * All variations and all runs of the added tables are exported, only the latest constants are kept
+     * (@see FileDataProvider for the layout). Assignments of each table are selected once,
+     * the intervals of each variation are computed from their run ranges.
+     *
+     * Functions throw std::logic_error if the source reports an error or files can't be written
+     */
+    class FileDataWriter
+    {
+    public:
+
+        /** @param source - connected provider to take constants from */
+        explicit FileDataWriter(DataProvider* source);
+
+        /** @brief Reads constants of the table */
+        void AddTable(const std::string& path);
+
+        /** @brief Reads constants of all tables of the source */
+        void AddAllTables();
+
+        /** @brief Writes table files and the index to the directory
+         *
+         * The directory is created if needed. The index is written to a temporary file that is
+         * renamed at the end, so readers never see a partially written index
+         */
+        void Write(const std::string& dirPath);
+
+        /** Number of tables added */
+        size_t GetTablesCount() const { return mTables.size(); }
+
+        /** Number of run intervals of all tables and variations */
+        size_t GetIntervalsCount() const;
+
+    private:
+
+        struct IntervalEntry
+        {
+            std::string Variation;
+            int RunMin;
+            int RunMax;
+            size_t Blob;                            // index in TableEntry::Blobs
+        };
+
+        struct BlobEntry
+        {
+            int AssignmentId;
+            time_t CreatedTime;
+            std::string RawData;
+        };
+
+        struct TableEntry
+        {
+            std::string Path;
+            std::string Comment;
+            int RowsCount;
+            std::vector<std::string> ColumnNames;
+            std::vector<std::string> ColumnTypes;
+            std::vector<IntervalEntry> Intervals;   // sorted by variation and run
+            std::vector<BlobEntry> Blobs;           // distinct constants of the table
+        };
+
+        /** Adds the variation and its parents. Parents go first */
+        void AddVariation(const std::string& name);
+
+        /** Message with errors of the source */
+        std::string GetSourceErrors(const std::string& message);
+
+        /** Creates the directory and its parents */
+        void MakeDirectories(const std::string& dirPath);
+
+        DataProvider* mSource;                                  // provider to read constants from
+        std::map<std::string, TableEntry> mTables;              // tables by path
+        std::vector<std::pair<std::string, std::string> > mVariations; // name and parent name
+        std::set<std::string> mVariationNames;                  // names in mVariations
+
+        FileDataWriter(const FileDataWriter& rhs);
+        FileDataWriter& operator=(const FileDataWriter& rhs);
+    };
+}
+
+#endif // FileDataWriter_h__
@@ -0,0 +1,187 @@
+#ifndef _MemoryDataProvider_
+#define _MemoryDataProvider_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+#include "CCDB/Providers/CatalogDataProvider.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+/** @brief Provider that keeps constants of another provider in memory
+ *
+ * On Connect the provider bulk loads type tables, variations, run ranges and assignments with their
+ * data blobs from the source provider, one GetAssignments request per table. After that no request
+ * goes to the source: tables are found by a hash of the path, and the latest constants of each
+ * variation are found by a binary search over non overlapping run intervals. Requests for a time and
+ * assignment history (GetAssignments) are served from the loaded assignments too.
+ *
+ * With lazy loading only the catalog is loaded on Connect, and assignments of a table are loaded on
+ * the first request to the table. Then the source stays connected until Disconnect.
+ *
+ * The provider reflects the source at the moment of loading, new constants of the source are not seen.
+ */
+class MemoryDataProvider: public CatalogDataProvider
+{
+public:
+	/** @param loadLazily - load assignments of a table on the first request to the table */
+	explicit MemoryDataProvider(bool loadLazily=false);
+	virtual ~MemoryDataProvider(void);
+
+	/**
+	 * @brief Connects to the source and loads it
+	 *
+	 * @param connectionString "memory://<connection string of the source>", i.e. memory://sqlite:///path/to/ccdb.sqlite
+	 * @return true if the source is loaded
+	 */
+	virtual bool Connect(string connectionString);
+
+	/**
+	 * @brief Loads the connected provider
+	 *
+	 * The provider is not owned. With lazy loading it should live and stay connected until Disconnect
+	 * @return true if the source is loaded
+	 */
+	bool Load(DataProvider* source);
+
+	/** @brief Forgets the loaded data and disconnects the source if it was created by Connect. Objects read stay valid */
+	virtual void Disconnect();
+
+	/** Assignments of a table are loaded on the first request to the table */
+	bool IsLoadingLazily() const { return mLoadLazily; }
+
+	/** Number of tables which assignments are loaded */
+	size_t GetLoadedTablesCount() const { return mLoadedTablesCount; }
+
+	//----------------------------------------------------------------------------------------
+	//	R U N   R A N G E S
+	//----------------------------------------------------------------------------------------
+
+	/** @brief Run ranges of the loaded assignments only */
+	virtual RunRange* GetRunRange(int min, int max, const string& name = "");
+	virtual bool GetRunRanges(vector<RunRange *>& resultRunRanges, ConstantsTypeTable *table, const string& variation="", int take=0, int startWith=0 );
+	virtual RunRange* GetRunRange(const string& name);
+
+	//----------------------------------------------------------------------------------------
+	//	V A R I A T I O N
+	//----------------------------------------------------------------------------------------
+
+	/** @brief Gets variation. With lazy loading variations that are not loaded yet are taken from the source */
+	virtual Variation* GetVariation(const string& name);
+
+	//----------------------------------------------------------------------------------------
+	//	A S S I G N M E N T S
+	//----------------------------------------------------------------------------------------
+
+	virtual Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation="default", bool loadColumns=false);
+	using CatalogDataProvider::GetAssignmentShort;
+
+	/** @brief The same as GetAssignmentShort with columns, run range and variation */
+	virtual Assignment* GetAssignmentFull(int run, const string& path, const string& variation="default");
+
+	/** @brief Gets version of assignment. @see DataProvider::GetAssignmentFull */
+	virtual Assignment* GetAssignmentFull(int run, const string& path, int version, const string& variation="default");
+
+	virtual bool GetAssignments(vector<Assignment *> &assingments,const string& path, int runMin, int runMax, const string& runRangeName, const string& variation, time_t beginTime, time_t endTime, int sortBy=0, int take=0, int startWith=0);
+	using CatalogDataProvider::GetAssignments;
+
+	/** @brief Fills assignment by its id with data, run range and variation */
+	virtual bool FillAssignment(Assignment* assignment);
+
+private:
+
+	struct MemoryRunRange
+	{
+		int Id;
+		string Name;
+		int Min;
+		int Max;
+		string Comment;
+		time_t CreatedTime;
+		time_t ModifiedTime;
+	};
+
+	struct MemoryAssignment
+	{
+		int Id;
+		time_t CreatedTime;
+		time_t ModifiedTime;
+		string Comment;
+		size_t RunRangeIndex;                    // index in mRunRanges
+		Variation* VariationObject;              // catalog variation
+		int DataVaultId;
+		size_t BlobIndex;                        // index in mBlobs
+	};
+
+	/** Latest constants of a variation for runs [RunMin, RunMax] */
+	struct LatestInterval
+	{
+		int RunMin;
+		int RunMax;
+		size_t AssignmentIndex;                  // index in MemoryTable::Assignments
+
+		bool operator<(const LatestInterval& rhs) const { return RunMin < rhs.RunMin; }
+	};
+
+	struct MemoryTable
+	{
+		bool IsLoaded;
+		vector<MemoryAssignment> Assignments;                 // sorted by id, the latest goes last
+		map<string, vector<size_t> > ByVariation;             // variation => indexes in Assignments
+		map<string, vector<LatestInterval> > Latest;          // variation => latest constants by runs
+	};
+
+	/** @brief Loads the catalog and, if not lazy, all assignments */
+	bool LoadSource(DataProvider* source);
+
+	/** @brief Loads assignments of the table if they are not loaded. Reports errors */
+	bool LoadTable(size_t tableIndex);
+
+	/** @brief Adds variation of the source and its parents to the catalog */
+	Variation* AddSourceVariation(const string& name);
+
+	/** @brief Computes MemoryTable::Latest */
+	void IndexTable(MemoryTable& table);
+
+	/** @brief Finds assignment of the variation or its parents for the run. time=0 - the latest */
+	const MemoryAssignment* FindAssignment(const MemoryTable& table, Variation* variation, int run, time_t time) const;
+
+	/** @brief Finds assignment for GetAssignmentShort and GetAssignmentFull. Reports errors */
+	Assignment* QueryAssignment(int run, const string& path, time_t time, const string& variation, bool loadColumns, bool full);
+
+	/** @brief Creates assignment object. Run range and variation are set if full is true */
+	Assignment* CreateMemoryAssignment(size_t tableIndex, const MemoryAssignment& memAssignment, int run, bool loadColumns, bool full);
+
+	/** @brief Copies to the assignment its run range and variation */
+	void FillRelations(Assignment* assignment, const MemoryAssignment& memAssignment);
+
+	/** @brief Creates run range object owned by the owner */
+	RunRange* CreateRunRange(const MemoryRunRange& memRunRange, ObjectsOwner* owner);
+
+	/** @brief Message with errors of the source */
+	string GetSourceErrors(const string& message);
+
+	bool mLoadLazily;                                    // load assignments of table on request
+	DataProvider* mSource;                               // source for lazy loading
+	bool mIsSourceOwned;                                 // source was created by Connect
+	size_t mLoadedTablesCount;                           // tables which assignments are loaded
+
+	vector<MemoryTable> mMemoryTables;                   // assignments of each catalog table
+	vector<MemoryRunRange> mRunRanges;                   // run ranges of loaded assignments
+	unordered_map<int, size_t> mRunRangesById;           // run range id => index in mRunRanges
+	vector<string> mBlobs;                               // data blobs of loaded assignments
+	unordered_map<int, size_t> mBlobsByVaultId;          // data vault id => index in mBlobs
+	unordered_map<int, pair<size_t, size_t> > mAssignmentsById;  // assignment id => table and assignment indexes
+
+	MemoryDataProvider(const MemoryDataProvider& rhs);
+	MemoryDataProvider& operator=(const MemoryDataProvider& rhs);
+};
+
+}
+
+#endif // _MemoryDataProvider_
@@ -1,6 +1,7 @@
 #ifndef _DMySQLConnectionInfo_
 #define _DMySQLConnectionInfo_
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -15,7 +16,14 @@ class MySQLConnectionInfo
 	Password(""),
 	HostName(""),
 	Database(""),
-	Port(0)
+	Port(0),
+	PoolSize(0),
+	HedgePercentile(0),
+	RateLimit(0),
+	RateBurst(1),
+	MaxInFlight(0),
+	ConnectJitter(0),
+	ConnectRetries(0)
 	{
 	}
 	~MySQLConnectionInfo(){}
@@ -24,6 +32,15 @@ class MySQLConnectionInfo
 	string 	Database;
 	string	HostName;
 	int		Port;
+	int		PoolSize;	///Number of connections for parallel reads, 0 - default. Set by ?pool= option
+	vector<string>	ReplicaHosts;	///Hosts of 'host1:port1,host2:port2' list. Empty if one host is given
+	vector<int>		ReplicaPorts;	///Ports of the list hosts, 0 - default port
+	int		HedgePercentile;	///Latency percentile a read is hedged to the next replica after, 0 - no hedging. Set by ?hedge= option
+	double	RateLimit;		///Queries per second of the process to the host, 0 - no limit. Set by ?rate= option
+	int		RateBurst;		///Queries that may go at once within the rate. Set by ?burst= option
+	int		MaxInFlight;	///Queries of the process waiting for the host at once, 0 - no limit. Set by ?inflight= option
+	int		ConnectJitter;	///Random delay before connect up to N ms, 0 - no delay. Set by ?jitter= option
+	int		ConnectRetries;	///Connect retries with randomized exponential backoff. Set by ?retries= option
 	
 };
 
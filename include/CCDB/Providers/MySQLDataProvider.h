@@ -10,6 +10,7 @@
 
 #include "CCDB/Providers/DataProvider.h"
 #include "CCDB/Providers/MySQLConnectionInfo.h"
+#include "CCDB/Helpers/AdmissionControl.h"
 #include "CCDB/Model/ConstantsTypeTable.h"
 
 #define CCDB_DEFAULT_MYSQL_USERNAME  "ccdbuser"
@@ -72,7 +73,32 @@ public:
 	 */
 	virtual void Disconnect();
 
+	/**
+	 * @brief checks that the server hasn't dropped the connection (mysql_ping)
+	 *
+	 * @return true if connection is open and alive
+	 */
+	virtual bool Ping();
+
 	/** @brief Parse Connection String
+	 *
+	 * Besides the address the string may have options after '?', options are separated by '&':
+	 * mysql://<username>:<password>@<mysql.address>:<port>/<database>?pool=<connections number>
+	 * MySQLCalibration makes the pool of read connections only for pool > 1 and without replicas
+	 *
+	 * Several addresses separated by ',' are read replicas of one database:
+	 * mysql://<username>@<address1>:<port1>,<address2>:<port2>/<database>?hedge=<percentile>
+	 * The provider connects to the first address that answers and takes the catalog from it.
+	 * Assignments are read from the replica with the lowest latency, a failed replica is skipped
+	 * for a while. With hedge=P a read that takes longer than P percentile of the replica latencies
+	 * is sent to the next replica too, and the first answer is taken (@see ReplicaSelector)
+	 *
+	 * Options that keep mass job starts from overloading the server (@see AdmissionControl):
+	 *   rate=R     - queries per second of the process to the host, burst=B of them may go at once
+	 *   inflight=N - queries of the process waiting for the host at once
+	 *   jitter=MS  - wait random time up to MS before connecting
+	 *   retries=N  - retry a failed connect N times with randomized exponential backoff
+	 * Limits are shared by all connections of the process to the host with the same options
 	 *
 	 * @param   [in]  conStr
 	 * @param   [out] DMySQLConnectionInfo & connection
@@ -93,6 +119,15 @@ public:
 	 */
 	virtual bool CheckConnection(const string& errorSource="");
 
+	/** Number of read replicas. 0 if the connection string has one address */
+	size_t GetReplicasCount() const;
+
+	/** Number of reads that were sent to a second replica */
+	size_t GetHedgedRequestsCount() const;
+
+	/** Index of the replica that gave the last assignment. -1 if there was none */
+	int GetLastReplica() const;
+
 	//----------------------------------------------------------------------------------------
 	//	D I R E C T O R Y   M A N G E M E N T
 	//----------------------------------------------------------------------------------------    
@@ -663,6 +698,15 @@ protected:
 	double			ReadDouble(int fieldNum);	///Reads double from the last query row
 	string			ReadString(int fieldNum);	///Reads string from the last query row
 	time_t			ReadUnixTime(int fieldNum); ///Reads string from the last query row
+
+	/** @brief Gives the field of the last fetched row right from the MySQL result buffer without copying it
+	 *
+	 * The pointer is valid until FreeMySQLResult()
+	 * @param [in]  fieldNum - field index
+	 * @param [out] data     - pointer to the field, "" if the field is NULL or unreadable
+	 * @param [out] length   - field length in bytes
+	 */
+	void			ReadStringBuffer(int fieldNum, const char*& data, size_t& length);
 	
 	
 	/** @brief
@@ -724,6 +768,18 @@ private:
 	
     //VARIATIONs WORK
     Variation* mLastVariation;                     ///Last requested variation ID. Used for caching
+
+	AdmissionControl* mAdmission;		//limits of the host. NULL if there are none
+
+	//READ REPLICAS
+	struct ReplicaSet;
+	ReplicaSet* mReplicas;				//NULL if the connection string never had replicas. Kept after Disconnect
+	bool mIsReplicaSetActive;			//reads go to mReplicas
+	vector<ReplicaSet*> mRetiredReplicas;	//sets of earlier connections. Their providers own assignments given to users
+
+	bool ConnectReplicas(const MySQLConnectionInfo& connection);	///Connects to the first address that answers and makes the replica set
+	void CloseReplicas();											///Waits for hedged reads and disconnects replicas. Providers are kept
+	Assignment* GetAssignmentFromReplicas(int run, const string& path, time_t time, const string& variation, bool loadColumns);
 	
 
 #pragma endregion Private
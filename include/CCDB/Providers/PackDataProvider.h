@@ -0,0 +1,127 @@
+#ifndef _PackDataProvider_
+#define _PackDataProvider_
+
+#include <string>
+#include <vector>
+
+#include "CCDB/Providers/CatalogDataProvider.h"
+#include "CCDB/Providers/PackFormat.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+/** @brief Constants of one table for one run right in the mapped pack file
+ *
+ * The pointers are valid while the provider is connected
+ */
+struct PackConstants
+{
+	size_t RowsCount;                   // number of rows
+	size_t ColumnsCount;                // number of columns
+	const double* Values;               // RowsCount*ColumnsCount cells as numbers, row by row, as StringUtils::ParseDouble gives them
+	const PackFormat::StrRef* Cells;    // RowsCount*ColumnsCount decoded cells
+	const char* Base;                   // beginning of the mapped file
+
+	/** Cell as number. Indexes are not checked */
+	double GetValue(size_t row, size_t column) const { return Values[row*ColumnsCount + column]; }
+
+	/** Decoded cell. It is NOT null terminated, @see GetCellLength. Indexes are not checked */
+	const char* GetCell(size_t row, size_t column) const { return Base + Cells[row*ColumnsCount + column].Offset; }
+
+	/** Length of the decoded cell */
+	size_t GetCellLength(size_t row, size_t column) const { return (size_t)Cells[row*ColumnsCount + column].Length; }
+
+	/** Decoded cell as string */
+	std::string GetCellString(size_t row, size_t column) const { return std::string(GetCell(row, column), GetCellLength(row, column)); }
+};
+
+
+/** @brief Read only provider over a ccdbpack file
+ *
+ * The file is made by PackWriter (@see ccdbpack tool) and is mapped to memory on Connect.
+ * Lookups are binary searches over the path and run interval indexes of the file,
+ * no SQL and no parsing is involved: cells are stored decoded and as numbers.
+ * The mapping is shared, so all processes on the node that use the same pack
+ * share one copy of it in the page cache.
+ *
+ * The pack holds one variation at one time, requests for other variations or times fail.
+ * A pack of the latest constants (time 0) also serves requests for any time since the pack was made.
+ */
+class PackDataProvider: public CatalogDataProvider
+{
+public:
+	PackDataProvider(void);
+	virtual ~PackDataProvider(void);
+
+	/**
+	 * @brief Maps the pack file
+	 *
+	 * @param connectionString "ccdbpack://<path to file>"
+	 * @return true if the file is mapped and has right format
+	 */
+	virtual bool Connect(string connectionString);
+
+	/** @brief Unmaps the file. Objects read from the pack stay valid */
+	virtual void Disconnect();
+
+	/** @brief Gets assignment from the pack
+	 *
+	 * The assignment has id of the source database, the run range is not set
+	 */
+	virtual Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation="default", bool loadColumns=false);
+	using CatalogDataProvider::GetAssignmentShort;
+
+	/** @brief Finds constants without creating any objects
+	 *
+	 * That is the fastest way to read the pack. Errors are reported as for GetAssignmentShort
+	 * @param [out] constants - view of the constants in the mapped file
+	 * @return false if there are no such constants in the pack
+	 */
+	bool FindConstants(PackConstants& constants, int run, const string& path, const string& variation="default", time_t time=0);
+
+	/** @brief Copies the pre-decoded numbers of the constants. @see DataProvider::GetDecodedValues */
+	virtual bool HasDecodedValues() const { return true; }
+	virtual bool GetDecodedValues(vector< vector<double> >& values, int run, const string& path, time_t time, const string& variation="default");
+
+	/** Variation the pack was made for */
+	string GetPackVariation() const { return mVariation; }
+
+	/** Time the pack was made for. 0 - the latest constants at GetPackCreatedTime */
+	time_t GetPackTime() const { return mTime; }
+
+	/** Time the pack was made */
+	time_t GetPackCreatedTime() const { return mCreatedTime; }
+
+private:
+
+	/** @brief Checks the header and all records of the mapped file and fills the catalog */
+	bool ReadIndex();
+
+	/** @brief Checks that [offset, offset + count*size) is inside the file */
+	bool IsInFile(uint64_t offset, uint64_t count, uint64_t size) const;
+
+	/** @brief Finds data block of the table for the run. Reports errors */
+	const PackFormat::Block* FindBlock(int run, const string& path, time_t time, const string& variation, int& tableIndex);
+
+	string GetString(const PackFormat::StrRef& ref) const { return string(mData + ref.Offset, (size_t)ref.Length); }
+
+	template<class T> const T* At(uint64_t offset) const { return reinterpret_cast<const T*>(mData + offset); }
+
+	const char* mData;                          // mapped file
+	size_t mSize;                               // size of mapped file
+	bool mIsMapped;                             // mData is mapped (false if it was read to mBuffer)
+	vector<char> mBuffer;                       // file content where mapping isn't available
+	vector<const PackFormat::Table*> mPackTables; // pack table of each catalog table
+	string mVariation;                          // variation of the pack
+	time_t mTime;                               // time of the pack
+	time_t mCreatedTime;                        // creation time of the pack
+
+	PackDataProvider(const PackDataProvider& rhs);
+	PackDataProvider& operator=(const PackDataProvider& rhs);
+};
+
+}
+
+#endif // _PackDataProvider_
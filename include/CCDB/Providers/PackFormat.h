@@ -0,0 +1,93 @@
+#ifndef PackFormat_h__
+#define PackFormat_h__
+
+#include <stdint.h>
+
+namespace ccdb
+{
+    /** @brief On-disk layout of ccdbpack files
+     *
+     * A pack holds constants of chosen tables for chosen runs of one variation at one time.
+     * It is made by PackWriter (ccdbpack tool) and is read by PackDataProvider right from the
+     * memory mapped file, so all processes of a node share one copy in the page cache.
+     *
+     * The file is a Header at offset 0 followed by records. Records refer to each other
+     * by absolute file offsets. Structures are 8 bytes aligned and have no padding, numbers are
+     * in the byte order of the machine that made the pack (@see Header::ByteOrderMark).
+     *
+     *   Header
+     *     -> Table[TablesCount]             sorted by path
+     *          -> Column[ColumnsCount]
+     *          -> Interval[IntervalsCount]  sorted by RunMin, not overlapping
+     *               -> Block                constants of one assignment, shared by intervals
+     *                    -> StrRef[CellsCount] cells, decoded. Point inside RawData when possible
+     *                    -> double[CellsCount] cells as numbers, row by row
+     */
+    namespace PackFormat
+    {
+        const char     cMagic[8] = {'C','C','D','B','P','A','C','K'};
+        const uint32_t cVersion = 2;
+        const uint32_t cByteOrderMark = 0x01020304;
+
+        /** @brief String in the file
+         *
+         * Strings are not null terminated in general: cells refer to their chars inside the raw blob.
+         * Other strings (paths, names, blobs...) are followed by '\0'
+         */
+        struct StrRef
+        {
+            uint64_t Offset;
+            uint64_t Length;
+        };
+
+        struct Header
+        {
+            char     Magic[8];          // cMagic
+            uint32_t Version;           // cVersion
+            uint32_t ByteOrderMark;     // cByteOrderMark as written by the machine
+            uint64_t FileSize;          // size of the whole file
+            uint64_t TablesOffset;      // Table[TablesCount]
+            uint64_t TablesCount;
+            StrRef   Variation;         // variation the constants were taken for
+            int64_t  Time;              // time the constants were taken for. 0 - the latest
+            int64_t  CreatedTime;       // time the pack was made
+        };
+
+        struct Table
+        {
+            StrRef   Path;              // full path of the table
+            StrRef   Comment;
+            uint64_t ColumnsOffset;     // Column[ColumnsCount]
+            uint64_t ColumnsCount;
+            uint64_t IntervalsOffset;   // Interval[IntervalsCount]
+            uint64_t IntervalsCount;
+            int64_t  RowsCount;
+        };
+
+        struct Column
+        {
+            StrRef   Name;
+            StrRef   Type;              // @see ConstantsTypeColumn::GetTypeString
+        };
+
+        struct Interval
+        {
+            int32_t  RunMin;            // first run of the interval
+            int32_t  RunMax;            // last run of the interval
+            uint64_t BlockOffset;       // Block
+        };
+
+        struct Block
+        {
+            int64_t  AssignmentId;      // id of the assignment in the source database
+            int64_t  CreatedTime;       // creation time of the assignment
+            StrRef   RawData;           // data blob as it is in the database
+            uint64_t CellsOffset;       // StrRef[CellsCount]
+            uint64_t ValuesOffset;      // double[CellsCount]. StringUtils::ParseDouble of the cells
+            uint64_t CellsCount;
+            uint64_t RowsCount;
+        };
+    }
+}
+
+#endif // PackFormat_h__
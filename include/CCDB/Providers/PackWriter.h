@@ -0,0 +1,117 @@
+#ifndef PackWriter_h__
+#define PackWriter_h__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <time.h>
+
+#include "CCDB/Providers/DataProvider.h"
+#include "CCDB/Providers/PackFormat.h"
+
+namespace ccdb
+{
+    /** @brief Makes ccdbpack files from constants of any provider
+     *
+     * The pack holds constants of the added tables for the added runs of one variation at one time
+     * (@see PackFormat, PackDataProvider). For each table the writer takes run ranges of all its
+     * assignments, reads constants once per interval between run range borders and merges neighbour
+     * intervals that have the same assignment. So the number of requests to the source depends on
+     * the number of run ranges, not on the number of runs.
+     *
+     * Functions throw std::logic_error if the source reports an error or the file can't be written
+     */
+    class PackWriter
+    {
+    public:
+
+        /**
+         * @param source    - connected provider to take constants from
+         * @param variation - variation of constants
+         * @param time      - time of constants. 0 - the latest
+         */
+        PackWriter(DataProvider* source, const std::string& variation="default", time_t time=0);
+
+        /** @brief Adds runs to export. If no runs are added, all runs [0, INFINITE_RUN] are exported
+         *
+         * Should be called before tables are added
+         */
+        void AddRunRange(int runMin, int runMax);
+
+        /** @brief Reads constants of the table for added runs */
+        void AddTable(const std::string& path);
+
+        /** @brief Reads constants of all tables of the source */
+        void AddAllTables();
+
+        /** @brief Writes the pack
+         *
+         * The pack is written to a temporary file that is renamed at the end,
+         * so readers never map a partially written pack
+         */
+        void Write(const std::string& filePath);
+
+        /** Number of tables added */
+        size_t GetTablesCount() const { return mTables.size(); }
+
+        /** Number of run intervals of all tables */
+        size_t GetIntervalsCount() const;
+
+        /** Number of distinct constants (assignments) of all tables */
+        size_t GetBlocksCount() const { return mBlocks.size(); }
+
+    private:
+
+        struct IntervalEntry
+        {
+            int RunMin;
+            int RunMax;
+            size_t Block;                           // index in mBlocks
+        };
+
+        struct TableEntry
+        {
+            std::string Path;
+            std::string Comment;
+            int RowsCount;
+            std::vector<std::string> ColumnNames;
+            std::vector<std::string> ColumnTypes;
+            std::vector<IntervalEntry> Intervals;
+        };
+
+        struct BlockEntry
+        {
+            int AssignmentId;
+            time_t CreatedTime;
+            std::string RawData;
+            std::vector<std::string> Cells;
+            std::vector<double> Values;
+            size_t RowsCount;
+        };
+
+        /** Reads constants for runs [runMin, runMax] that have the same constants */
+        void AddInterval(TableEntry& table, const std::vector<std::string>& columnTypes, int runMin, int runMax);
+
+        /** Message with errors of the source */
+        std::string GetSourceErrors(const std::string& message);
+
+        // building of the file
+        uint64_t Append(std::vector<char>& file, const void* data, size_t size);
+        uint64_t Align(std::vector<char>& file);
+        PackFormat::StrRef AppendString(std::vector<char>& file, const std::string& str);
+        uint64_t AppendBlock(std::vector<char>& file, const BlockEntry& block);
+
+        DataProvider* mSource;                      // provider to read constants from
+        std::string mVariation;                     // variation of constants
+        time_t mTime;                               // time of constants
+        std::vector<std::pair<int, int> > mRuns;    // runs to export
+        std::map<std::string, TableEntry> mTables;  // tables by path
+        std::vector<BlockEntry> mBlocks;            // distinct constants
+        std::map<int, size_t> mBlocksByAssignment;  // assignment id => index in mBlocks
+
+        PackWriter(const PackWriter& rhs);
+        PackWriter& operator=(const PackWriter& rhs);
+    };
+}
+
+#endif // PackWriter_h__
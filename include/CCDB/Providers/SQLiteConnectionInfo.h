@@ -0,0 +1,41 @@
+#ifndef _DSQLiteConnectionInfo_
+#define _DSQLiteConnectionInfo_
+#include <string>
+
+using namespace std;
+
+namespace ccdb
+{
+	///Internal temporary class to pass connection info to sqlite provider
+class SQLiteConnectionInfo
+{
+	public:
+	SQLiteConnectionInfo()
+	:FilePath(""),
+	IsImmutable(false),
+	MmapSize(-1),
+	CacheSize(0),
+	IsPrewarm(false),
+	IsInMemory(false),
+	ScratchDir(""),
+	PoolSize(0),
+	ArchivePath(""),
+	SharedMemoryName("")
+	{
+	}
+
+	~SQLiteConnectionInfo(){}
+
+	string		FilePath;		///Path to sqlite file
+	bool		IsImmutable;	///immutable=1 - the file never changes, sqlite doesn't lock it
+	long long	MmapSize;		///mmap=<bytes> - PRAGMA mmap_size. Negative - sqlite default
+	int			CacheSize;		///cache_size=<pages or -KiB> - PRAGMA cache_size. 0 - sqlite default
+	bool		IsPrewarm;		///prewarm=1 - read the file through once on connect to fill OS page cache
+	bool		IsInMemory;		///memory=1 - copy the whole database to memory on connect
+	string		ScratchDir;		///scratch=<dir> - copy the file to local directory first and use the copy
+	int			PoolSize;		///pool=N - number of connections for parallel reads, 0 - default
+	string		ArchivePath;	///archive=<file> - history database for time-travel queries and runs outside the hot window
+	string		SharedMemoryName; ///shared_memory=<name> - open the image loaded to memory by other connection of the process
+};
+}
+#endif // _DSQLiteConnectionInfo_
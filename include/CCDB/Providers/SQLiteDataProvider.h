@@ -9,6 +9,7 @@
 #include <map>
 
 #include "CCDB/Providers/DataProvider.h"
+#include "CCDB/Providers/SQLiteConnectionInfo.h"
 #include "CCDB/Model/ConstantsTypeTable.h"
 
 
@@ -39,12 +40,38 @@ public:
 	 * 
 	 * Connects to database using connection string
 	 * connection string might be in form: 
-	 * mysql://<username>:<password>@<mysql.address>:<port> <database>
+	 * sqlite://<path to file>?<options>
 	 * 
-	 * @param connectionString "mysql://<username>:<password>@<mysql.address>:<port> <database>"
+	 * @see ParseConnectionString for options
+	 * @param connectionString "sqlite://<path to file>"
 	 * @return true if connected
 	 */
 	virtual bool Connect(string connectionString);
+
+	/** @brief Parse Connection String
+	 *
+	 * Besides the file path the string may have options after '?', options are separated by '&':
+	 * sqlite:///path/to/ccdb.sqlite?immutable=1&mmap=268435456&cache_size=-65536&prewarm=1
+	 *   immutable=1  - the file is never changed (read only or network filesystems), no locks are taken
+	 *   mmap=N       - read the file through memory map of N bytes, so processes share OS page cache
+	 *   cache_size=N - sqlite page cache size: N pages or -N KiB
+	 *   prewarm=1    - read the file sequentially once on connect
+	 *   memory=1     - copy the whole database to memory on connect, all queries go to RAM.
+	 *                  The copy is a named memory database, other connections of the process
+	 *                  open it by shared_memory option instead of loading own copies (@see GetMemoryName)
+	 *   shared_memory=NAME - open the copy made by other connection with memory=1. The file is not read
+	 *   scratch=DIR  - copy the file to local DIR once and open the copy. The copy is named by
+	 *                  hash of the file path, size and modification time, so a changed file is copied again
+	 *   pool=N       - number of read connections SQLiteCalibration opens for parallel reads
+	 *   archive=FILE - the file is a hot database made by ArchiveSplitter. Queries with time, queries
+	 *                  for runs outside its window and history (lists, versions) go to the archive FILE,
+	 *                  which is opened on the first such query. Relative FILE is next to the hot database
+	 *
+	 * @param   [in]  conStr
+	 * @param   [out] connection
+	 * @return  false if the string is not sqlite:// one
+	 */
+	static bool ParseConnectionString(std::string conStr, SQLiteConnectionInfo &connection);
 	
 
 	/**
@@ -53,6 +80,12 @@ public:
 	 * @return true if  connection is open
 	 */
 	virtual bool IsConnected();
+
+	/** @brief Name of the database copy in memory made by memory=1 option, empty if there is no copy
+	 *
+	 * The copy lives while any connection to it is open. @see shared_memory option
+	 */
+	const string& GetMemoryName() const { return mMemoryName; }
 	
 
 	/**
@@ -397,6 +430,16 @@ public:
      * @return new DAssignment object or 
      */
     virtual Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation="default", bool loadColumns =false);
+
+
+	/** @brief Get cursor that reads the data blob of the assignment row by row
+	 *
+	 * The vault is read by chunks with sqlite incremental blob I/O (sqlite3_blob_open),
+	 * so the whole blob is never loaded to memory. The cursor must be deleted before
+	 * the provider is disconnected.
+	 * @see DataProvider::GetAssignmentCursor
+	 */
+	virtual BlobCursor* GetAssignmentCursor(int run, const string& path, time_t time, const string& variation="default");
      
     
 	/** @brief Get last Assignment with all related objects
@@ -636,6 +679,12 @@ protected:
      */
     bool InitializePreparedStatements(){ return false;} //TODO implement PreparedStatements for GetAssignmentShort functions
 
+	/** @brief Selects assignment the way GetAssignmentShort does
+	 *
+	 * @param [in] loadBlob - if false the vault is not selected, only its id is set by SetDataVaultId
+	 */
+	Assignment* QueryAssignmentShort(int run, const string& path, time_t time, const string& variationName, bool loadColumns, bool loadBlob);
+
 	//read of row fields
 	bool IsNullOrUnreadable(int fieldNum);		///Check if the field is NULL or is unreadable. If it is Unreadable
 	int				ReadInt(int fieldNum);		///Reads int	from the last query row
@@ -647,6 +696,15 @@ protected:
 	double			ReadDouble(int fieldNum);	///Reads double from the last query row
 	string			ReadString(int fieldNum);	///Reads string from the last query row
 	time_t			ReadUnixTime(int fieldNum); ///Reads string from the last query row
+
+	/** @brief Gives the text of the field right from the statement buffer without copying it
+	 *
+	 * The pointer is valid until the next FetchRow/sqlite3_step or finalize of mStatement
+	 * @param [in]  fieldNum - field index
+	 * @param [out] data     - pointer to the text, "" if the field is NULL or unreadable
+	 * @param [out] length   - text length in bytes
+	 */
+	void			ReadStringBuffer(int fieldNum, const char*& data, size_t& length);
 	void BuildDirectoryDependencies(){DataProvider::BuildDirectoryDependencies();}			///Builds directory relational structure. Used right at the end of RetriveDirectories().
 	bool CheckDirectoryListActual(){return DataProvider::CheckDirectoryListActual();}			///Checks if directory list is actual i.e. nobody changed directories in database
 	bool UpdateDirectoriesIfNeeded(){return DataProvider::UpdateDirectoriesIfNeeded();}
@@ -703,6 +761,19 @@ private:
     //VARIATIONs WORK
     Variation* mLastVariation;                    ///Last requested variation. Used for caching
 
+	//HISTORY ARCHIVE
+	bool IsArchiveRequest(int run, time_t time) const;	///The request can't be answered by the hot database
+	bool OpenArchive();									///Opens the archive if it is not opened. Reports errors
+	void CopyArchiveErrors();							///Copies errors of the archive to this provider
+	void ReadHotWindow();								///Reads runs the hot database has all constants for
+
+	string mArchivePath;				//archive=<file> option. Empty - no archive
+	SQLiteDataProvider* mArchive;		//NULL until the first archive request
+	int mHotRunMin;						//runs of the hot database window
+	int mHotRunMax;
+
+	string mMemoryName;					//name of the copy in memory, @see GetMemoryName
+
 };
 }
 
@@ -0,0 +1,109 @@
+#ifndef _ShardedDataProvider_
+#define _ShardedDataProvider_
+
+#include <string>
+#include <vector>
+
+#include "CCDB/Providers/CatalogDataProvider.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+
+using namespace std;
+
+namespace ccdb
+{
+
+/** @brief Read only provider over several SQLite files (shards), i.e. one per run period or subsystem
+ *
+ * Shards are listed in an index file, one record per line, fields are separated by blanks:
+ *
+ *   shard  <file>  <run min>  <run max>  <path prefix>
+ *
+ * <file> is a path to the SQLite file (relative to the index directory) or a sqlite:// connection string.
+ * <run max> may be 'inf'. The shard is used for runs [run min, run max] and for tables under the
+ * prefix, i.e. '/CDC' or '/' for all tables. Lines starting with '#' are comments.
+ *
+ * A lookup goes only to shards whose runs and prefix match. Shards are opened on the first use,
+ * so a job touches the files it needs only. If several shards match, they are queried in parallel
+ * and the newest assignment is taken (the greatest created time, then the greatest id), as one
+ * database with all the shards would give.
+ *
+ * The catalog (directories and type tables) is read from all shards on the first catalog request.
+ * Run ranges and assignment history are not served.
+ */
+class ShardedDataProvider: public CatalogDataProvider
+{
+public:
+	ShardedDataProvider(void);
+	virtual ~ShardedDataProvider(void);
+
+	/**
+	 * @brief Reads the index of shards. Shards are not opened
+	 *
+	 * @param connectionString "shards://<path to the index file>"
+	 * @return true if the index is read and is correct
+	 */
+	virtual bool Connect(string connectionString);
+
+	/** @brief Closes all shards */
+	virtual void Disconnect();
+
+	virtual Directory* GetDirectory(const string& path);
+	virtual bool SearchDirectories(vector<Directory *>& resultDirectories, const string& searchPattern, const string& parentPath="", int take=0, int startWith=0);
+	using CatalogDataProvider::SearchDirectories;
+	virtual bool SearchConstantsTypeTables(vector<ConstantsTypeTable *>& typeTables, const string& pattern, const string& parentPath = "", bool loadColumns=false, int take=0, int startWith=0 );
+	using CatalogDataProvider::SearchConstantsTypeTables;
+
+	/** @brief Gets variation. Variations are taken from the shards on the first use */
+	virtual Variation* GetVariation(const string& name);
+
+	virtual Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation="default", bool loadColumns=false);
+	using CatalogDataProvider::GetAssignmentShort;
+
+	/** Number of shards in the index */
+	size_t GetShardsCount() const { return mShards.size(); }
+
+	/** Number of shards opened so far */
+	size_t GetOpenedShardsCount() const;
+
+	/** Number of lookups that queried several shards in parallel */
+	size_t GetParallelLookups() const { return mParallelLookups; }
+
+private:
+
+	struct Shard
+	{
+		string ConnectionString;        // sqlite:// connection string of the file
+		int RunMin;
+		int RunMax;
+		string PathPrefix;              // '/' or a path without the trailing '/'
+		SQLiteDataProvider* Provider;   // NULL until the shard is used
+	};
+
+	/** @brief Reads shard records of the index. Reports errors */
+	bool ReadIndex(const string& index, const string& indexDirectory);
+
+	/** @brief Opens the shard if it is not opened. Reports errors */
+	bool OpenShard(size_t shardIndex);
+
+	/** @brief Finds shards for the run and the table path in the order of the index
+	 *  @param [out] isPathKnown - some shard has the path prefix, regardless of runs
+	 */
+	void FindShards(int run, const string& path, vector<size_t>& shardIndexes, bool& isPathKnown) const;
+
+	/** @brief Adds type tables of all shards to the catalog */
+	bool LoadCatalog();
+
+	/** @brief Copies errors of the shard to this provider */
+	void CopyShardErrors(SQLiteDataProvider* shard);
+
+	vector<Shard> mShards;              // shards in the order of the index
+	bool mIsCatalogLoaded;              // tables of all shards are in the catalog
+	size_t mParallelLookups;
+
+	ShardedDataProvider(const ShardedDataProvider& rhs);
+	ShardedDataProvider& operator=(const ShardedDataProvider& rhs);
+};
+
+}
+
+#endif // _ShardedDataProvider_
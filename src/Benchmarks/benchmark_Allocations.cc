@@ -0,0 +1,124 @@
+#pragma warning(disable:4800)
+#include "Benchmarks/benchmarks.h"
+
+#include <atomic>
+#include <new>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+
+#include "CCDB/Console.h"
+#include "CCDB/Helpers/StopWatch.h"
+#include "CCDB/Model/Assignment.h"
+#include "CCDB/Model/ConstantsTypeTable.h"
+#include "CCDB/Model/ConstantsTypeColumn.h"
+#include "CCDB/Model/Variation.h"
+#include "CCDB/Model/RunRange.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+
+using namespace std;
+using namespace ccdb;
+
+namespace
+{
+    std::atomic<unsigned long> gAllocationsCount(0);
+
+    /** Makes and deletes the model objects of a lookup as each thread of a multithreaded job does */
+    void MakeLookupObjects(int lookupsCount)
+    {
+        for (int i=0; i<lookupsCount; i++)
+        {
+            ConstantsTypeTable* table = new ConstantsTypeTable();
+            for (int column=0; column<3; column++) table->AddColumn(new ConstantsTypeColumn(table));
+
+            Assignment* assignment = new Assignment();
+            assignment->SetTypeTable(table);
+            new RunRange(assignment);
+            new Variation(assignment);
+
+            delete assignment;
+            delete table;
+        }
+    }
+
+    /** Runs MakeLookupObjects in threadsCount threads at once */
+    void MakeLookupObjectsInThreads(int threadsCount, int lookupsCount)
+    {
+        vector<thread> threads;
+        for (int i=0; i<threadsCount; i++) threads.push_back(thread(MakeLookupObjects, lookupsCount));
+        for (size_t i=0; i<threads.size(); i++) threads[i].join();
+    }
+}
+
+//Every heap allocation of the program is counted
+void* operator new(size_t size)
+{
+    gAllocationsCount++;
+    void* memory = malloc(size ? size : 1);
+    if(!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+
+/**
+ * @brief Heap allocations made by model objects of lookups
+ *
+ * Each lookup makes an assignment with its run range and variation and a type table with columns.
+ * The objects are allocated from the pools of their classes and are tracked by the owners in
+ * index based lists, so the numbers should show a fraction of an allocation per object
+ */
+bool benchmark_Allocations()
+{
+    BENCHMARK_INIT();
+
+    const int lookupsCount = 100000;
+    BENCHMARK_START("100000 sets of model objects of a lookup");
+    unsigned long allocations = gAllocationsCount;
+    MakeLookupObjects(lookupsCount);
+    BENCHMARK_FINISH("100000 sets of model objects of a lookup done in ");
+    gConsole.WriteLine(Console::cGreen, " heap allocations per set %f", (gAllocationsCount - allocations) / (double)lookupsCount);
+
+    //the same sets in many threads. Threads take objects from their own free lists of pools,
+    //so the time per set should stay close to the single thread time
+    int threadsCount = (int)thread::hardware_concurrency();
+    if(threadsCount < 2) threadsCount = 2;
+    if(threadsCount > 16) threadsCount = 16;
+    BENCHMARK_START("100000 sets of model objects per thread in many threads");
+    allocations = gAllocationsCount;
+    MakeLookupObjectsInThreads(threadsCount, lookupsCount);
+    double elapsed = BENCHMARK_ELAPSED_SEC();
+    BENCHMARK_FINISH("100000 sets of model objects per thread in many threads done in ");
+    gConsole.WriteLine(Console::cGreen, " threads %i, microseconds per set %f, heap allocations per set %f",
+        threadsCount,
+        elapsed * 1000000.0 / ((double)lookupsCount * threadsCount),
+        (gAllocationsCount - allocations) / ((double)lookupsCount * threadsCount));
+
+    //lookups of a real provider, if the test database is there
+    const char* home = getenv("CCDB_HOME");
+    if(!home) return true;
+
+    SQLiteDataProvider provider;
+    if(!provider.Connect("sqlite://" + string(home) + "/sql/ccdb.sqlite")) return true;
+
+    const int queriesCount = 10000;
+    BENCHMARK_START("10000 SQLite GetAssignmentShort");
+    allocations = gAllocationsCount;
+    for (int i=0; i<queriesCount; i++)
+    {
+        delete provider.GetAssignmentShort(100, "/test/test_vars/test_table", "default", true);
+    }
+    BENCHMARK_FINISH("10000 SQLite GetAssignmentShort done in ");
+    gConsole.WriteLine(Console::cGreen, " heap allocations per lookup %f", (gAllocationsCount - allocations) / (double)queriesCount);
+
+    return true;
+}
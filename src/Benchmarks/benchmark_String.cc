@@ -4,7 +4,9 @@
 #include "CCDB/Console.h"
 #include "CCDB/Helpers/StringUtils.h"
 #include "CCDB/Helpers/StopWatch.h"
+#include "CCDB/Model/Assignment.h"
 #include <sstream>
+#include <stdlib.h>
 
 using namespace std;
 using namespace ccdb;
@@ -62,5 +64,68 @@ bool benchmark_String()
           string query = ss.str();
     }
     BENCHMARK_FINISH("100000 of stringstream formatting do in ");
+
+    //Blob parsing throughput. The same blob is split by the old Split + DecodeBlobSeparator way
+    //and by one pass SplitBlob, then every cell is parsed as double
+    for (int cellsCount = 1000; cellsCount <= 1000000; cellsCount *= 10)
+    {
+        string blob;
+        for (int i=0; i<cellsCount; i++)
+        {
+            if(i) blob.append("|");
+            blob.append(StringUtils::Format("%.6e", i * 0.001234));
+        }
+        double megaBytes = blob.size() / (1024.0 * 1024.0);
+        int repeats = cellsCount >= 1000000 ? 1 : 1000000 / cellsCount;
+        vector<string> tokens;
+        double sum = 0;
+
+        gConsole.WriteLine(Console::cBrightBlue,"\n[ Blob of %i cells, %.3f MB, %i repeats ]", cellsCount, megaBytes, repeats);
+
+        stopwatch.Restart();
+        for (int r=0; r<repeats; r++)
+        {
+            tokens.clear();
+            StringUtils::Split(blob, tokens, "|");
+            for (size_t i = 0; i < tokens.size(); i++) sum += atof(Assignment::DecodeBlobSeparator(tokens[i]).c_str());
+        }
+        gConsole.WriteLine(Console::cGreen, " Split + DecodeBlobSeparator + atof  %f MB/s", megaBytes * repeats / BENCHMARK_ELAPSED_SEC());
+
+        stopwatch.Restart();
+        for (int r=0; r<repeats; r++)
+        {
+            StringUtils::SplitBlob(blob, tokens);
+            for (size_t i = 0; i < tokens.size(); i++) sum += StringUtils::ParseDouble(tokens[i]);
+        }
+        gConsole.WriteLine(Console::cGreen, " SplitBlob + ParseDouble             %f MB/s", megaBytes * repeats / BENCHMARK_ELAPSED_SEC());
+
+        if(sum == 0) gConsole.WriteLine("sum is 0"); //don't let the compiler throw the loops away
+    }
+
+    //Serial vs parallel chunked blob splitting
+    for (int cellsCount = 10000; cellsCount <= 10000000; cellsCount *= 10)
+    {
+        string blob;
+        for (int i=0; i<cellsCount; i++)
+        {
+            if(i) blob.append("|");
+            blob.append(StringUtils::Format("%.6e", i * 0.001234));
+        }
+        double megaBytes = blob.size() / (1024.0 * 1024.0);
+        int repeats = cellsCount >= 1000000 ? 1 : 1000000 / cellsCount;
+        vector<string> tokens;
+
+        gConsole.WriteLine(Console::cBrightBlue,"\n[ Parallel split. Blob of %i cells, %.3f MB, %i repeats ]", cellsCount, megaBytes, repeats);
+
+        stopwatch.Restart();
+        for (int r=0; r<repeats; r++) StringUtils::SplitBlob(blob, tokens);
+        double serialTime = BENCHMARK_ELAPSED_SEC();
+        gConsole.WriteLine(Console::cGreen, " SplitBlob          %f MB/s", megaBytes * repeats / serialTime);
+
+        stopwatch.Restart();
+        for (int r=0; r<repeats; r++) StringUtils::SplitBlobParallel(blob.data(), blob.size(), tokens);
+        double parallelTime = BENCHMARK_ELAPSED_SEC();
+        gConsole.WriteLine(Console::cGreen, " SplitBlobParallel  %f MB/s, speedup x%.2f", megaBytes * repeats / parallelTime, serialTime / parallelTime);
+    }
     return true;
 }
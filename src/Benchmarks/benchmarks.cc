@@ -52,6 +52,7 @@ bool benchmark_PreparedStatements();    //prepared statements benchmark
 bool banchmark_UserAPIMultithread();
 bool benchmark_String();
 bool benchmark_AllHallDConstants();
+bool benchmark_Allocations();
 /**
  * Run various benchmarks
  */
@@ -62,6 +63,7 @@ bool RunBenchmarks()
     banchmark_UserAPIMultithread();
     //benchmark_AllHallDConstants();
     //benchmark_String();
+    benchmark_Allocations();
   //  result = result && benchmark_Providers();       //providers benchmark
     //result = result && benchmark_PreparedStatements();
 
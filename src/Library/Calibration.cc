@@ -2,16 +2,59 @@
 #include <assert.h>
 #include <iostream>
 #include <memory>
+#include <chrono>
 
 #include "CCDB/Calibration.h"
 #include "CCDB/GlobalMutex.h"
 #include "CCDB/Providers/DataProvider.h"
 #include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Helpers/StringUtils.h"
 #include "CCDB/Helpers/TimeProvider.h"
 #include "CCDB/Helpers/PerfLog.h"
 
 using namespace std;
 
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    struct CacheEntry
+    {
+        ccdb::Assignment* Value;            // NULL if the table was not found
+        ccdb::Assignment* Retired;          // the value it replaced. A caller may still read it, so it is deleted at the next replacement
+        const ccdb::Calibration* Loader;    // type tables of the values belong to the provider of this calibration
+        Clock::time_point LoadTime;
+    };
+
+    // The cache is shared by all calibrations and owns the assignments
+    std::mutex gCacheMutex;
+    std::map<std::string, CacheEntry> gCache;                    // namepath:run:variation:time => assignment
+
+    thread_local unsigned gThreadDeadline = 0;                   // set by Calibration::DeadlineScope
+
+    /** The connection string may have a password, so only its hash goes to shared keys */
+    std::string HashConnectionString(const std::string& str)
+    {
+        return ccdb::StringUtils::Format("%016llx", (unsigned long long)ccdb::StringUtils::Hash64(str));
+    }
+
+    /** Finds the cached assignment. gCacheMutex should be locked. Returns false if it is not cached */
+    bool FindCached(const std::string& key, double maxAge, ccdb::Assignment*& assignment, bool& isExpired)
+    {
+        std::map<std::string, CacheEntry>::iterator it = gCache.find(key);
+        if(it == gCache.end()) return false;
+
+        assignment = it->second.Value;
+        isExpired = maxAge > 0 && std::chrono::duration<double>(Clock::now() - it->second.LoadTime).count() > maxAge;
+        return true;
+    }
+
+    /** Converts the cell of Lookup rows */
+    void ParseCell(const std::string& cell, std::string& value) { value = cell; }
+    void ParseCell(const std::string& cell, double& value) { value = ccdb::StringUtils::ParseDouble(cell); }
+    void ParseCell(const std::string& cell, int& value) { value = ccdb::StringUtils::ParseInt(cell); }
+}
+
 namespace ccdb
 {
 
@@ -21,12 +64,20 @@ Calibration::Calibration()
     //Constructor 
 
     mProvider = NULL;
+    mReadPool = NULL;
     mProviderIsLocked = false; //by default we assume that we own the provider
     mDefaultRun = 0;
 	mDefaultTime = 0;
     mDefaultVariation = "default";
     mIsAutoReconnect = true;
     mLastActivityTime=0;
+    mSharedCache = NULL;
+    mForkSnapshot = NULL;
+    mDeadline = 0;
+    mCacheMaxAge = 0;
+    mHitsCount = 0;
+    mStaleCount = 0;
+    mTimeoutsCount = 0;
 
 #ifdef CCDB_CACHE_ON
     mIsCacheEnabled = true;
@@ -46,11 +97,19 @@ Calibration::Calibration(int defaultRun, string defaultVariation/*="default"*/,
 	mDefaultTime = defaultTime;
 
     mProvider = NULL;
+    mReadPool = NULL;
     mProviderIsLocked = false;      // by default we assume that we own the provider
     PthreadSyncObject * x = NULL;
     x = new PthreadSyncObject();
     mIsAutoReconnect = true;
     mLastActivityTime=0;
+    mSharedCache = NULL;
+    mForkSnapshot = NULL;
+    mDeadline = 0;
+    mCacheMaxAge = 0;
+    mHitsCount = 0;
+    mStaleCount = 0;
+    mTimeoutsCount = 0;
 
 #ifdef CCDB_CACHE_ON
     mIsCacheEnabled = true;
@@ -64,6 +123,28 @@ Calibration::Calibration(int defaultRun, string defaultVariation/*="default"*/,
 Calibration::~Calibration()
 {
     //Destructor
+    WaitForRefreshes();
+
+    // Cached assignments refer to type tables of the provider that is deleted
+    if(!mProviderIsLocked && mProvider!=NULL)
+    {
+        std::lock_guard<std::mutex> lock(gCacheMutex);
+        for(map<string, CacheEntry>::iterator it = gCache.begin(); it != gCache.end();)
+        {
+            if(it->second.Loader != this)
+            {
+                ++it;
+                continue;
+            }
+            delete it->second.Value;
+            delete it->second.Retired;
+            it = gCache.erase(it);
+        }
+    }
+
+    delete mReadPool;
+    delete mSharedCache;
+    delete mForkSnapshot;
     if(!mProviderIsLocked && mProvider!=NULL) delete mProvider;
 }
 
@@ -234,16 +315,58 @@ bool Calibration::GetCalib( vector< vector<double> > &values, const string & nam
 {
     //TODO right now the function works through copy. One has to check, maybe it needs to be reimplemented
 
-    vector< vector<string> > rawValues;
-    try
+    //the table may be packed before fork or decoded by another process already
+    string sharedKey;
+    time_t minLoadTime = 0;         //shared latest constants added before it are loaded again, as in the cache of this process
+    if(mForkSnapshot || mSharedCache)
     {
-        if(!GetCalib(rawValues, namepath)) return false;
+        sharedKey = GetSharedCacheKey(namepath);
+        RequestParseResult request = PathUtils::ParseRequest(namepath);
+        bool isLatest = (request.WasParsedTime ? request.Time : mDefaultTime) == 0;
+        if(isLatest && mCacheMaxAge > 0) minLoadTime = time(NULL) - (time_t)mCacheMaxAge;
+
+        SharedMemoryCache::Table table;
+        bool isInSnapshot = mForkSnapshot && mForkSnapshot->Find(sharedKey, table);
+        bool isShared = !isInSnapshot && mSharedCache && mSharedCache->Find(sharedKey, table) && table.LoadTime >= minLoadTime;
+        if(isInSnapshot || isShared)
+        {
+            values.resize(table.Rows);
+            for (uint32_t rowIter = 0; rowIter < table.Rows; rowIter++)
+            {
+                const double* row = table.Values + (size_t)rowIter * table.Columns;
+                values[rowIter].assign(row, row + table.Columns);
+            }
+
+            //the segment could be reset by another process while the values were copied
+            if(isInSnapshot || mSharedCache->IsUnchanged(table)) return true;
+            values.clear();
+        }
     }
-    catch (std::exception &)
+
+    //the provider may keep the numbers already. They are mapped from a file shared by processes,
+    //so they are not put to the shared cache
+    CheckConnection();
+    if(mProvider->HasDecodedValues())
     {
-        throw;
+        UpdateActivityTime();
+        RequestParseResult request = PathUtils::ParseRequest(namepath);
+        string variation = (request.WasParsedVariation ? request.Variation : mDefaultVariation);
+        int run  = (request.WasParsedRunNumber ? request.RunNumber : mDefaultRun);
+        time_t time = request.WasParsedTime ? request.Time: mDefaultTime;
+
+        //the provider keeps errors of the last call, so calls are serialized
+        std::lock_guard<std::mutex> lock(mReadMutex);
+        values.clear();
+        return mProvider->GetDecodedValues(values, run, PathUtils::MakeAbsolute(request.Path), time, variation);
     }
 
+    //the same as GetCalib(vector<vector<string>>), the assignment is needed for the shared cache key
+    Assignment* assignment = GetAssignment(namepath, false);
+    if(!assignment) return false;
+
+    vector< vector<string> > rawValues;
+    assignment->GetData(rawValues);
+
     assert(values.empty());
 
     int rowsNum = rawValues.size();
@@ -261,6 +384,28 @@ bool Calibration::GetCalib( vector< vector<double> > &values, const string & nam
         }
     }
 
+    if(mSharedCache)
+    {
+        vector<double> flatValues;
+        flatValues.reserve(rowsNum * columnsNum);
+        for (int rowIter = 0; rowIter < rowsNum; rowIter++)
+        {
+            flatValues.insert(flatValues.end(), values[rowIter].begin(), values[rowIter].end());
+        }
+
+        //the values are kept once per assignment, requests of each run are aliases of it.
+        //Providers without ids keep the values by the request key
+        if(assignment->GetId() > 0)
+        {
+            string assignmentKey = HashConnectionString(GetConnectionString()) + "|assignment:" + to_string(assignment->GetId());
+            if(mSharedCache->Add(assignmentKey, flatValues.data(), rowsNum, columnsNum)) mSharedCache->AddAlias(sharedKey, assignmentKey, minLoadTime);
+        }
+        else
+        {
+            mSharedCache->Add(sharedKey, flatValues.data(), rowsNum, columnsNum, minLoadTime);
+        }
+    }
+
     return true;
 }
 
@@ -299,6 +444,153 @@ bool Calibration::GetCalib( vector< vector<int> > &values, const string & namepa
 }
 
 
+//______________________________________________________________________________
+bool Calibration::GetCalib( vector< vector<string> > &values, const string & namepath, const vector<string> & columns )
+{
+    vector<int> columnIndexes;
+    auto assignment = GetAssignmentColumns(namepath, columns, columnIndexes);
+    if(!assignment) return false;
+
+    assignment->GetData(values, columnIndexes);
+    return true;
+}
+
+
+//______________________________________________________________________________
+bool Calibration::GetCalib( vector< vector<double> > &values, const string & namepath, const vector<string> & columns )
+{
+    vector<int> columnIndexes;
+    auto assignment = GetAssignmentColumns(namepath, columns, columnIndexes);
+    if(!assignment) return false;
+
+    //only the selected cells are converted, right from the assignment
+    size_t rowsNum = assignment->GetCellsCount() / assignment->GetColumnsCount();
+    values.clear();
+    values.resize(rowsNum);
+    for (size_t rowIter = 0; rowIter < rowsNum; rowIter++)
+    {
+        values[rowIter].reserve(columnIndexes.size());
+        for (size_t i = 0; i < columnIndexes.size(); i++)
+        {
+            values[rowIter].push_back(StringUtils::ParseDouble(assignment->GetCell(rowIter, columnIndexes[i])));
+        }
+    }
+    return true;
+}
+
+
+//______________________________________________________________________________
+bool Calibration::GetCalib( vector< vector<int> > &values, const string & namepath, const vector<string> & columns )
+{
+    vector<int> columnIndexes;
+    auto assignment = GetAssignmentColumns(namepath, columns, columnIndexes);
+    if(!assignment) return false;
+
+    //only the selected cells are converted, right from the assignment
+    size_t rowsNum = assignment->GetCellsCount() / assignment->GetColumnsCount();
+    values.clear();
+    values.resize(rowsNum);
+    for (size_t rowIter = 0; rowIter < rowsNum; rowIter++)
+    {
+        values[rowIter].reserve(columnIndexes.size());
+        for (size_t i = 0; i < columnIndexes.size(); i++)
+        {
+            values[rowIter].push_back(StringUtils::ParseInt(assignment->GetCell(rowIter, columnIndexes[i])));
+        }
+    }
+    return true;
+}
+
+
+//______________________________________________________________________________
+template<class TCell, class TKey>
+bool Calibration::LookupRow( vector<TCell> &row, const string & namepath, const string & keyColumn, const TKey & key )
+{
+    vector<string> columns(1, keyColumn);
+    vector<int> columnIndexes;
+    auto assignment = GetAssignmentColumns(namepath, columns, columnIndexes);
+    if(!assignment) return false;
+
+    int rowIndex = assignment->Lookup(columnIndexes[0], key);
+    if(rowIndex < 0) return false;
+
+    size_t columnsNum = assignment->GetColumnsCount();
+    row.resize(columnsNum);
+    for (size_t columnsIter = 0; columnsIter < columnsNum; columnsIter++)
+    {
+        ParseCell(assignment->GetCell(rowIndex, columnsIter), row[columnsIter]);
+    }
+    return true;
+}
+
+
+//______________________________________________________________________________
+bool Calibration::Lookup( vector<string> &row, const string & namepath, const string & keyColumn, const string & key )
+{
+    return LookupRow(row, namepath, keyColumn, key);
+}
+
+
+//______________________________________________________________________________
+bool Calibration::Lookup( vector<double> &row, const string & namepath, const string & keyColumn, const string & key )
+{
+    return LookupRow(row, namepath, keyColumn, key);
+}
+
+
+//______________________________________________________________________________
+bool Calibration::Lookup( vector<int> &row, const string & namepath, const string & keyColumn, const string & key )
+{
+    return LookupRow(row, namepath, keyColumn, key);
+}
+
+
+//______________________________________________________________________________
+bool Calibration::Lookup( vector<string> &row, const string & namepath, const string & keyColumn, long key )
+{
+    return LookupRow(row, namepath, keyColumn, key);
+}
+
+
+//______________________________________________________________________________
+bool Calibration::Lookup( vector<double> &row, const string & namepath, const string & keyColumn, long key )
+{
+    return LookupRow(row, namepath, keyColumn, key);
+}
+
+
+//______________________________________________________________________________
+bool Calibration::Lookup( vector<int> &row, const string & namepath, const string & keyColumn, long key )
+{
+    return LookupRow(row, namepath, keyColumn, key);
+}
+
+
+//______________________________________________________________________________
+Assignment* Calibration::GetAssignmentColumns( const string & namepath, const vector<string> & columns, vector<int> & columnIndexes )
+{
+    auto assignment = GetAssignment(namepath, true);
+    if(!assignment) return NULL;
+
+    if(assignment->GetColumnsCount() <= 0)
+    {
+        throw std::logic_error("Calibration::GetCalib(..., const vector<string> & columns). Type table has no columns. Zero columns are not supposed to be.");
+    }
+
+    columnIndexes.clear();
+    for (size_t i = 0; i < columns.size(); i++)
+    {
+        int index = assignment->GetColumnIndex(columns[i]);
+        if(index < 0)
+        {
+            throw std::logic_error("Calibration::GetCalib(..., const vector<string> & columns). No column '" + columns[i] + "' in '" + namepath + "'");
+        }
+        columnIndexes.push_back(index);
+    }
+    return assignment;
+}
+
+
 //______________________________________________________________________________
 bool Calibration::GetCalib( map<string, string> &values, const string & namepath )
 {
@@ -473,6 +765,16 @@ bool Calibration::GetCalib( vector<string> &values, const string & namepath )
 //______________________________________________________________________________
 bool Calibration::GetCalib( vector<double> &values, const string & namepath )
 {
+    if(mForkSnapshot || mSharedCache)
+    {
+        vector< vector<double> > table;
+        if(!GetCalib(table, namepath)) return false;
+        if(table.size() != 1)
+            throw std::logic_error("Calibration::GetCalib(vector<double> &, const string &). logic_error: Calling of single row vector<dataType> version of GetCalib method on dataset that has more than one rows. Use GetCalib vector<vector<dataType> > instead.");
+        values.swap(table[0]);
+        return true;
+    }
+
     vector<string> rawValues;
     try
     {
@@ -594,7 +896,6 @@ string Calibration::GetConnectionString() const
      */
 
     auto pl = PerfLog("Calibration::GetAssignment=>" + namepath );
-    static std::map<std::string, Assignment*> cache;
 
 	UpdateActivityTime();
 
@@ -607,37 +908,343 @@ string Calibration::GetConnectionString() const
     auto time = result.WasParsedTime ? result.Time: mDefaultTime;
 
     CheckConnection();  // Check if is connected and reconnect if needed (and allowed)
-	
-    //Lock();Unlock();
-    std::lock_guard<std::mutex> lock(mReadMutex);
 
-    // Check if we have this value in the cache
+    string path = PathUtils::MakeAbsolute(result.Path);
     string cache_key = namepath + ":" + to_string(run) + ":" + variation + ":" + to_string(time);
+    string table_key = path + ":" + to_string(run) + ":" + variation;
+
+    // Check if we have this value in the cache. The expired value is still given if the load is late
+    Assignment* stale = NULL;
     if(mIsCacheEnabled)
     {
-        if (  cache.find(cache_key) != cache.end() ) {
-            return cache[cache_key];
+        std::lock_guard<std::mutex> lock(gCacheMutex);
+        Assignment* cached;
+        bool isExpired;
+        if(FindCached(cache_key, mCacheMaxAge, cached, isExpired))
+        {
+            if(!isExpired)
+            {
+                mHitsCount++;
+                return cached;
+            }
+            stale = cached;
+        }
+    }
+
+    unsigned deadline = gThreadDeadline ? gThreadDeadline : mDeadline.load();
+    if(deadline == 0) return LoadAssignment(cache_key, table_key, run, path, variation, time, loadColumns);
+
+    // The database is waited until the deadline only. Then the load goes on in background
+    std::shared_future<Assignment*> refresh = StartRefresh(cache_key, table_key, run, path, variation, time, loadColumns);
+    if(refresh.wait_for(std::chrono::milliseconds(deadline)) == std::future_status::ready) return refresh.get();
+
+    if(!stale)
+    {
+        LastGood lastGood;
+        bool isLastGoodFound = false;
+        {
+            std::lock_guard<std::mutex> lock(mRefreshMutex);
+            map<string, LastGood>::iterator it = mLastGood.find(table_key);
+            isLastGoodFound = it != mLastGood.end();
+            if(isLastGoodFound) lastGood = it->second;
         }
+
+        // The cached assignment of the key may be replaced meanwhile, so it is taken from the cache
+        if(isLastGoodFound && mIsCacheEnabled)
+        {
+            std::lock_guard<std::mutex> lock(gCacheMutex);
+            Assignment* cached;
+            bool isExpired;
+            if(FindCached(lastGood.CacheKey, 0, cached, isExpired)) stale = cached;
+        }
+        else if(isLastGoodFound)
+        {
+            stale = lastGood.Value;
+        }
+    }
+    if(stale)
+    {
+        mStaleCount++;
+        return stale;
+    }
+
+    // There is nothing to give instead
+    mTimeoutsCount++;
+    return refresh.get();
+}
+
+
+//______________________________________________________________________________
+Assignment* Calibration::LoadAssignment( const string& cacheKey, const string& tableKey, int run, const string& path, const string& variation, time_t time, bool loadColumns )
+{
+    if(mReadPool)
+    {
+        // Read through own connection. Other threads read in parallel
+        DataProviderPool::Lease lease(*mReadPool);
+        if(lease.Get())
+        {
+            Assignment* assigment = time > 0 ? lease.Get()->GetAssignmentShort(run, path, time, variation, loadColumns)
+                                             : lease.Get()->GetAssignmentShort(run, path, variation, loadColumns);
+
+            // The lease is still held, so our provider (the owner of the assignment) is not used by anybody else
+            return StoreAssignment(cacheKey, tableKey, assigment);
+        }
+
+        // The pool failed to connect. Fall back to the main provider
+    }
+
+    std::lock_guard<std::mutex> lock(mReadMutex);
+
+    // Other thread could load the same constants while we waited for the provider
+    if(mIsCacheEnabled)
+    {
+        std::lock_guard<std::mutex> cacheLock(gCacheMutex);
+        Assignment* cached;
+        bool isExpired;
+        if(FindCached(cacheKey, mCacheMaxAge, cached, isExpired) && !isExpired) return cached;
     }
 
     Assignment* assigment;
 
     if(time > 0)
     {
-		assigment = (mProvider->GetAssignmentShort(run, PathUtils::MakeAbsolute(result.Path), time, variation,loadColumns));
+		assigment = (mProvider->GetAssignmentShort(run, path, time, variation,loadColumns));
 	}
     else
 	{
-		assigment = (mProvider->GetAssignmentShort(run, PathUtils::MakeAbsolute(result.Path), variation,loadColumns));
+		assigment = (mProvider->GetAssignmentShort(run, path, variation,loadColumns));
 	}
 
+    return StoreAssignment(cacheKey, tableKey, assigment);
+}
+
+
+//______________________________________________________________________________
+Assignment* Calibration::StoreAssignment( const string& cacheKey, const string& tableKey, Assignment* assignment )
+{
+    // Other threads read the data of the given assignment without locks, so it is never set again
+    if(assignment) assignment->SetDataReadOnly();
+
     if(mIsCacheEnabled)
     {
+        std::lock_guard<std::mutex> lock(gCacheMutex);
+
+        Assignment* cached = NULL;
+        bool isExpired = false;
+        bool isCached = FindCached(cacheKey, mCacheMaxAge, cached, isExpired);
+        if(isCached && !isExpired)
+        {
+            // Other thread has loaded the same constants in parallel
+            if(cached != assignment) delete assignment;
+            assignment = cached;
+        }
+        else
+        {
+            // The caller holds the provider, so the assignment is taken from its objects safely
+            if(assignment) assignment->ReleaseOwning();
+
+            CacheEntry& entry = gCache[cacheKey];
+            delete entry.Retired;
+            entry.Retired = entry.Value;
+            entry.Value = assignment;
+            entry.Loader = this;
+            entry.LoadTime = Clock::now();
+        }
+    }
+
+    if(assignment)
+    {
+        std::lock_guard<std::mutex> lock(mRefreshMutex);
+        LastGood& lastGood = mLastGood[tableKey];
+        lastGood.CacheKey = cacheKey;
+        lastGood.Value = assignment;
+    }
+    return assignment;
+}
+
+
+//______________________________________________________________________________
+std::shared_future<Assignment*> Calibration::StartRefresh( const string& cacheKey, const string& tableKey, int run, const string& path, const string& variation, time_t time, bool loadColumns )
+{
+    std::lock_guard<std::mutex> lock(mRefreshMutex);
+
+    // Requests of the same constants wait for one load
+    map<string, std::shared_future<Assignment*> >::iterator it = mRefreshes.find(cacheKey);
+    if(it != mRefreshes.end())
+    {
+        if(it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return it->second;
+        mRefreshes.erase(it);
+    }
+
+    std::shared_future<Assignment*> refresh = std::async(std::launch::async, &Calibration::LoadAssignment, this,
+                                                         cacheKey, tableKey, run, path, variation, time, loadColumns).share();
+    mRefreshes[cacheKey] = refresh;
+    return refresh;
+}
+
+
+//______________________________________________________________________________
+void Calibration::WaitForRefreshes()
+{
+    map<string, std::shared_future<Assignment*> > refreshes;
+    {
+        std::lock_guard<std::mutex> lock(mRefreshMutex);
+        refreshes.swap(mRefreshes);
+    }
+
+    // Errors of background loads are not interesting here, the requests that waited got them
+    for (auto &refresh : refreshes) refresh.second.wait();
+}
+
+
+//______________________________________________________________________________
+Calibration::LookupStats Calibration::GetLookupStats() const
+{
+    LookupStats stats;
+    stats.Hits = mHitsCount;
+    stats.Stale = mStaleCount;
+    stats.Timeouts = mTimeoutsCount;
+    return stats;
+}
+
+
+//______________________________________________________________________________
+Calibration::DeadlineScope::DeadlineScope( unsigned milliseconds )
+    :mPrevious(gThreadDeadline)
+{
+    gThreadDeadline = milliseconds;
+}
+
+
+//______________________________________________________________________________
+Calibration::DeadlineScope::~DeadlineScope()
+{
+    gThreadDeadline = mPrevious;
+}
+
+
+//______________________________________________________________________________
+BlobCursor* Calibration::OpenCursor(const string& namepath)
+{
+    /** @brief Opens a cursor that reads constants row by row
+     *
+     * @remark the cursor goes around the cache, the caller should delete it
+     *
+     * @parameter [in] namepath - full namepath is /path/to/data:run:variation:time but usually it is only /path/to/data
+     * @return new BlobCursor or NULL if namepath was not found
+     */
+
+    auto pl = PerfLog("Calibration::OpenCursor=>" + namepath );
+
+    UpdateActivityTime();
+
+    RequestParseResult result = PathUtils::ParseRequest(namepath);
+    string variation = (result.WasParsedVariation ? result.Variation : mDefaultVariation);
+    int run  = (result.WasParsedRunNumber ? result.RunNumber : mDefaultRun);
+    auto time = result.WasParsedTime ? result.Time: mDefaultTime;
+
+    CheckConnection();  // Check if is connected and reconnect if needed (and allowed)
+
+    string path = PathUtils::MakeAbsolute(result.Path);
+    if(mReadPool)
+    {
+        // The cursor reads through its own connection, which goes back to the pool when the cursor is deleted
+        DataProvider* provider = mReadPool->Acquire();
+        if(provider)
+        {
+            BlobCursor* cursor = provider->GetAssignmentCursor(run, path, time, variation);
+            if(!cursor)
+            {
+                mReadPool->Release(provider);
+                return NULL;
+            }
+
+            DataProviderPool* pool = mReadPool;
+            cursor->SetCloseAction([pool, provider]() { pool->Release(provider); });
+            return cursor;
+        }
 
-        cache[cache_key] = assigment;
+        // The pool failed to connect. Fall back to the main provider
     }
 
-    return assigment;
+    // The main provider is used by other readers after the lock is released,
+    // so the blob is read at once instead of streaming it through the connection
+    std::lock_guard<std::mutex> lock(mReadMutex);
+    return mProvider->DataProvider::GetAssignmentCursor(run, path, time, variation);
+}
+
+
+//______________________________________________________________________________
+void Calibration::EnableSharedCache( const string& segmentName, size_t size /*=SharedMemoryCache::DefaultSize*/ )
+{
+    SharedMemoryCache* cache = new SharedMemoryCache();
+    try
+    {
+        cache->Open(segmentName, size);
+    }
+    catch (std::exception &)
+    {
+        delete cache;
+        throw;
+    }
+
+    delete mSharedCache;
+    mSharedCache = cache;
+}
+
+
+//______________________________________________________________________________
+bool Calibration::PrepareForFork( const vector<string> & namepaths )
+{
+    //a locked provider is controlled by its owner, its connection can't be closed and opened again here
+    if(mProviderIsLocked)
+    {
+        throw std::logic_error("PrepareForFork can't close the connection of a locked provider. Disconnect it in the owner of the provider before fork");
+    }
+    CheckConnection();
+
+    vector<string> tables(namepaths);
+    if(tables.empty()) GetListOfNamepaths(tables);
+
+    //tables are read from the database (or the shared cache), not from the old snapshot
+    delete mForkSnapshot;
+    mForkSnapshot = NULL;
+
+    std::unique_ptr<ConstantsSnapshot> snapshot(new ConstantsSnapshot());
+    bool isAllFound = true;
+    for (size_t i = 0; i < tables.size(); i++)
+    {
+        vector< vector<double> > values;
+        if(!GetCalib(values, tables[i]))
+        {
+            //not every table of the whole list has constants for the run
+            if(!namepaths.empty()) isAllFound = false;
+            continue;
+        }
+        snapshot->Add(GetSharedCacheKey(tables[i]), values);
+    }
+    snapshot->Seal();
+    mForkSnapshot = snapshot.release();
+
+    //sockets and file handles must not be shared by processes. Connections are opened again on demand
+    WaitForRefreshes();
+    if(mReadPool) mReadPool->Disconnect();
+    if(IsConnected()) Disconnect();
+
+    return isAllFound;
+}
+
+
+//______________________________________________________________________________
+string Calibration::GetSharedCacheKey( const string & namepath )
+{
+    //the same table may be requested with different namepaths, so the key is made of resolved parts
+    RequestParseResult result = PathUtils::ParseRequest(namepath);
+    string variation = (result.WasParsedVariation ? result.Variation : mDefaultVariation);
+    int run  = (result.WasParsedRunNumber ? result.RunNumber : mDefaultRun);
+    auto time = result.WasParsedTime ? result.Time: mDefaultTime;
+
+    return HashConnectionString(GetConnectionString()) + "|" + PathUtils::MakeAbsolute(result.Path) + ":" + to_string(run) + ":" + variation + ":" + to_string(time);
 }
 
 
@@ -1,9 +1,17 @@
 #include <iostream>
 #include <sstream>
+#include <stdlib.h>
 
 #include "CCDB/CalibrationGenerator.h"
 #include "CCDB/SQLiteCalibration.h"
+#include "CCDB/ProviderCalibration.h"
 #include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/PackDataProvider.h"
+#include "CCDB/Providers/FileDataProvider.h"
+#include "CCDB/Providers/MemoryDataProvider.h"
+#include "CCDB/Providers/ShardedDataProvider.h"
+#include "CCDB/Providers/DaemonDataProvider.h"
+#include "CCDB/Providers/CachingDataProvider.h"
 #include "CCDB/Helpers/TimeProvider.h"
 #ifdef CCDB_MYSQL
 #include "CCDB/MySQLCalibration.h"
@@ -12,6 +20,23 @@
 
 using namespace std;
 
+namespace
+{
+	/** Enables the shared cache of decoded tables if CCDB_SHARED_CACHE has the segment name */
+	void EnableSharedCacheFromEnvironment(ccdb::Calibration* calib)
+	{
+		const char* segmentName = getenv(CCDB_ENV_SHARED_CACHE);
+		if(segmentName && *segmentName) calib->EnableSharedCache(segmentName);
+	}
+
+	/** Provider factory of ProviderCalibration */
+	template<class TProvider>
+	ccdb::DataProvider* NewProvider()
+	{
+		return new TProvider();
+	}
+}
+
 namespace ccdb
 {
 
@@ -29,28 +54,8 @@ Calibration* CalibrationGenerator::CreateCalibration(const std::string & connect
 	 */
 
 
-	//is it sqlite or mysql
-	bool isMySql = false; //if false SQlite provider is used		
-	if(connectionString.find("mysql://")==0)
-	{		
-		isMySql = true;  //It is mysql
-		
-		#ifndef CCDB_MYSQL
-		throw std::logic_error("Cannot be used with MySQL database. CCDB was compiled without MySQL support! Recompile CCDB using with-mysql=true flag. The connection string: " + connectionString);
-		#endif //CCDB_MYSQL
-	}
-	else
-	{
-		//It should be sqlite, but lets check then...
-		if(connectionString.find("sqlite://")!=0)
-		{	
-			//something wrong here!!!
-			throw std::logic_error("Unknown connection string type. mysql:// and sqlite:// are only known types now. The connection string: " + connectionString);
-		}
-	}
-	
-	//now we create calibration
-	Calibration * calib = CreateCalibration(isMySql, run, variation, time);    
+	//now we create calibration of the connection string type
+	Calibration * calib = NewCalibration(connectionString, run, variation, time);    
 
     //Connect!
     if(!calib->Connect(connectionString))
@@ -59,6 +64,8 @@ Calibration* CalibrationGenerator::CreateCalibration(const std::string & connect
         throw std::logic_error(message);
     }
 
+    EnableSharedCacheFromEnvironment(calib);
+
 	return calib;
 }
     
@@ -71,6 +78,12 @@ bool CalibrationGenerator::CheckOpenable( const std::string & str)
 	#endif
 
 	if(str.find("sqlite://")== 0) return true;
+	if(str.find("ccdbpack://")== 0) return true;
+	if(str.find("file://")== 0) return true;
+	if(str.find("memory://")== 0) return CheckOpenable(str.substr(9));
+	if(str.find("cache://")== 0) return CheckOpenable(str.substr(8));
+	if(str.find("ccdbd://")== 0) return true;
+	if(str.find("shards://")== 0) return true;
     return false;
 }
 
@@ -112,28 +125,8 @@ Calibration* CalibrationGenerator::MakeCalibration( const std::string & connecti
 		return mCalibrationsByHash[calibHash];
 	}
 
-	//is it sqlite or mysql
-	bool isMySql = false; //if false SQlite provider is used		
-	if(connectionString.find("mysql://")==0)
-	{		
-		isMySql = true;  //It is mysql
-		
-		#ifndef CCDB_MYSQL
-		throw std::logic_error("Cannot be used with MySQL database. CCDB was compiled without MySQL support! Recompile CCDB using with-mysql=true flag. The connection string: " + connectionString);
-		#endif //CCDB_MYSQL
-	}
-	else
-	{
-		//It should be sqlite, but lets check then...
-		if(connectionString.find("sqlite://")!=0)
-		{	
-			//something wrong here!!!
-			throw std::logic_error("Unknown connection string type. mysql:// and sqlite:// are only known types now. The connection string: " + connectionString);
-		}
-	}
-	
-	//now we create calibration
-	Calibration * calib = CreateCalibration(isMySql, run, variation, time);
+	//now we create calibration of the connection string type
+	Calibration * calib = NewCalibration(connectionString, run, variation, time);
 
     //Connect!
     if(!calib->Connect(connectionString))
@@ -142,6 +135,8 @@ Calibration* CalibrationGenerator::MakeCalibration( const std::string & connecti
         throw std::logic_error(message);
     }
 
+    EnableSharedCacheFromEnvironment(calib);
+
 	//add it to arrays
 	mCalibrationsByHash[calibHash] = calib;
 	mCalibrations.push_back(calib);
@@ -151,21 +146,55 @@ Calibration* CalibrationGenerator::MakeCalibration( const std::string & connecti
 
 
 //______________________________________________________________________________
-Calibration* CalibrationGenerator::CreateCalibration( bool isMySQL, int run, const std::string& variation, const time_t time )
-{	
-	
-	if (isMySQL)
+Calibration* CalibrationGenerator::NewCalibration( const std::string & connectionString, int run, const std::string& variation, const time_t time )
+{
+	//Creates not connected calibration by type of the connection string
+	if(connectionString.find("mysql://")==0)
 	{
         #ifdef CCDB_MYSQL
 			return new MySQLCalibration(run, variation, time);
 		#else
-			return NULL;
+			throw std::logic_error("Cannot be used with MySQL database. CCDB was compiled without MySQL support! Recompile CCDB using with-mysql=true flag. The connection string: " + connectionString);
 		#endif //CCDB_MYSQL
 	}
-	else
+
+	if(connectionString.find("sqlite://")==0)
 	{
 		return new SQLiteCalibration(run, variation, time);
 	}
+
+	if(connectionString.find("ccdbpack://")==0)
+	{
+		return new ProviderCalibration(&NewProvider<PackDataProvider>, run, variation, time);
+	}
+
+	if(connectionString.find("file://")==0)
+	{
+		return new ProviderCalibration(&NewProvider<FileDataProvider>, run, variation, time);
+	}
+
+	if(connectionString.find("memory://")==0)
+	{
+		return new ProviderCalibration(&NewProvider<MemoryDataProvider>, run, variation, time);
+	}
+
+	if(connectionString.find("cache://")==0)
+	{
+		return new ProviderCalibration(&NewProvider<CachingDataProvider>, run, variation, time);
+	}
+
+	if(connectionString.find("ccdbd://")==0)
+	{
+		return new ProviderCalibration(&NewProvider<DaemonDataProvider>, run, variation, time);
+	}
+
+	if(connectionString.find("shards://")==0)
+	{
+		return new ProviderCalibration(&NewProvider<ShardedDataProvider>, run, variation, time);
+	}
+
+	//something wrong here!!!
+	throw std::logic_error("Unknown connection string type. mysql://, sqlite://, ccdbpack://, file://, memory://, cache://, ccdbd:// and shards:// are only known types now. The connection string: " + connectionString);
 }
 
 
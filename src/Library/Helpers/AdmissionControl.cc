@@ -0,0 +1,150 @@
+#include <map>
+#include <tuple>
+#include <random>
+#include <thread>
+
+#include "CCDB/Helpers/AdmissionControl.h"
+
+using namespace std;
+
+namespace
+{
+    /** host, rate, burst, max in flight */
+    typedef tuple<string, double, size_t, size_t> HostLimits;
+
+    mutex gHostsMutex;
+    map<HostLimits, ccdb::AdmissionControl*> gHosts; // controllers live until the process ends
+
+    mutex gRandomMutex;
+
+    /** Jobs started at the same second should get different delays, so the seed is not the time */
+    mt19937& RandomGenerator()
+    {
+        static mt19937 generator(random_device{}());
+        return generator;
+    }
+}
+
+
+//______________________________________________________________________________
+ccdb::AdmissionControl::AdmissionControl( double rate, size_t burst, size_t maxInFlight )
+    :mRate(rate),
+    mBurst(burst > 0 ? (double)burst : 1.0),
+    mMaxInFlight(maxInFlight),
+    mTokens(burst > 0 ? (double)burst : 1.0),
+    mLastRefill(Clock::now()),
+    mInFlight(0)
+{
+}
+
+
+//______________________________________________________________________________
+ccdb::AdmissionControl* ccdb::AdmissionControl::GetForHost( const std::string& host, double rate, size_t burst, size_t maxInFlight )
+{
+    HostLimits key(host, rate, burst, maxInFlight);
+
+    lock_guard<mutex> lock(gHostsMutex);
+    map<HostLimits, AdmissionControl*>::iterator it = gHosts.find(key);
+    if(it != gHosts.end()) return it->second;
+
+    AdmissionControl* control = new AdmissionControl(rate, burst, maxInFlight);
+    gHosts[key] = control;
+    return control;
+}
+
+
+//______________________________________________________________________________
+void ccdb::AdmissionControl::Refill( Clock::time_point now )
+{
+    double seconds = chrono::duration<double>(now - mLastRefill).count();
+    mLastRefill = now;
+    mTokens += seconds * mRate;
+    if(mTokens > mBurst) mTokens = mBurst;
+}
+
+
+//______________________________________________________________________________
+bool ccdb::AdmissionControl::TryAcquireToken()
+{
+    if(mRate <= 0) return true;
+
+    lock_guard<mutex> lock(mMutex);
+    Refill(Clock::now());
+    if(mTokens < 1) return false;
+    mTokens -= 1;
+    return true;
+}
+
+
+//______________________________________________________________________________
+void ccdb::AdmissionControl::AcquireToken()
+{
+    if(mRate <= 0) return;
+
+    //the token is taken right away, the debt is waited out without the lock.
+    //So waiters are served in order and the rate holds for any number of threads
+    double wait;
+    {
+        lock_guard<mutex> lock(mMutex);
+        Refill(Clock::now());
+        mTokens -= 1;
+        wait = mTokens < 0 ? -mTokens / mRate : 0;
+    }
+    if(wait > 0) this_thread::sleep_for(chrono::duration<double>(wait));
+}
+
+
+//______________________________________________________________________________
+void ccdb::AdmissionControl::Enter()
+{
+    if(mMaxInFlight == 0)
+    {
+        lock_guard<mutex> lock(mMutex);
+        mInFlight++;
+        return;
+    }
+
+    unique_lock<mutex> lock(mMutex);
+    while(mInFlight >= mMaxInFlight) mInFlightFreed.wait(lock);
+    mInFlight++;
+}
+
+
+//______________________________________________________________________________
+void ccdb::AdmissionControl::Leave()
+{
+    {
+        lock_guard<mutex> lock(mMutex);
+        if(mInFlight > 0) mInFlight--;
+    }
+    mInFlightFreed.notify_one();
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::AdmissionControl::GetInFlight() const
+{
+    lock_guard<mutex> lock(mMutex);
+    return mInFlight;
+}
+
+
+//______________________________________________________________________________
+unsigned ccdb::AdmissionControl::RandomMilliseconds( unsigned maxMilliseconds )
+{
+    if(maxMilliseconds == 0) return 0;
+
+    lock_guard<mutex> lock(gRandomMutex);
+    uniform_int_distribution<unsigned> distribution(0, maxMilliseconds);
+    return distribution(RandomGenerator());
+}
+
+
+//______________________________________________________________________________
+unsigned ccdb::AdmissionControl::GetBackoffMilliseconds( unsigned attempt, unsigned baseMilliseconds, unsigned capMilliseconds )
+{
+    unsigned long long limit = baseMilliseconds;
+    for(unsigned i = 0; i < attempt && limit < capMilliseconds; i++) limit *= 2;
+    if(limit > capMilliseconds) limit = capMilliseconds;
+    return RandomMilliseconds((unsigned)limit);
+}
@@ -0,0 +1,163 @@
+#include <string.h>
+
+#include "CCDB/Helpers/BlobCursor.h"
+#include "CCDB/Helpers/StringUtils.h"
+
+using namespace std;
+
+
+//______________________________________________________________________________
+ccdb::BlobCursor::BlobCursor( size_t columnsCount, size_t bufferSize /*= 64*1024*/ )
+{
+    //the buffer should hold at least one encoded separator
+    if(bufferSize < 4*StringUtils::cBlobEscapeLength) bufferSize = 4*StringUtils::cBlobEscapeLength;
+
+    mColumnsCount = columnsCount;
+    mRowsRead = 0;
+    mBuffer.resize(bufferSize);
+    mPos = 0;
+    mEnd = 0;
+    mIsEof = false;
+}
+
+
+//______________________________________________________________________________
+ccdb::BlobCursor::~BlobCursor()
+{
+    if(mCloseAction) mCloseAction();
+}
+
+
+//______________________________________________________________________________
+bool ccdb::BlobCursor::Fill( size_t needed )
+{
+    if(mEnd - mPos >= needed) return true;
+    if(mIsEof) return false;
+
+    //move the rest to the beginning of the buffer
+    if(mPos > 0)
+    {
+        memmove(&mBuffer[0], &mBuffer[mPos], mEnd - mPos);
+        mEnd -= mPos;
+        mPos = 0;
+    }
+
+    while(mEnd - mPos < needed && !mIsEof)
+    {
+        size_t read = ReadChunk(&mBuffer[mEnd], mBuffer.size() - mEnd);
+        if(read == 0) mIsEof = true;
+        mEnd += read;
+    }
+    return mEnd - mPos >= needed;
+}
+
+
+//______________________________________________________________________________
+bool ccdb::BlobCursor::NextCell( std::string& cell )
+{
+    cell.clear();
+    while(true)
+    {
+        if(mPos == mEnd && !Fill(1))
+        {
+            //end of the blob. The last cell has no delimiter after it
+            return !cell.empty();
+        }
+
+        //find next '|' or '&'
+        const char* begin = &mBuffer[mPos];
+        const char* end = &mBuffer[0] + mEnd;
+        const char* special = StringUtils::FindBlobSpecial(begin, end);
+
+        cell.append(begin, special);
+        mPos += special - begin;
+        if(special == end) continue;
+
+        if(*special == StringUtils::cBlobDelimiter)
+        {
+            mPos++;
+            if(!cell.empty()) return true;
+            continue;                       //empty cells are skipped as SplitBlob does
+        }
+
+        //it is '&', is it an encoded separator? It might be cut by the chunk border
+        Fill(StringUtils::cBlobEscapeLength);
+        if(mEnd - mPos >= StringUtils::cBlobEscapeLength && memcmp(&mBuffer[mPos], StringUtils::cBlobEscape, StringUtils::cBlobEscapeLength) == 0)
+        {
+            cell.push_back(StringUtils::cBlobDelimiter);
+            mPos += StringUtils::cBlobEscapeLength;
+        }
+        else
+        {
+            cell.push_back('&');
+            mPos++;
+        }
+    }
+}
+
+
+//______________________________________________________________________________
+bool ccdb::BlobCursor::NextRow( std::vector<std::string>& row )
+{
+    if(mColumnsCount == 0) return false;
+
+    row.resize(mColumnsCount);
+    for (size_t i = 0; i < mColumnsCount; i++)
+    {
+        if(!NextCell(row[i])) return false;
+    }
+    mRowsRead++;
+    return true;
+}
+
+
+//______________________________________________________________________________
+bool ccdb::BlobCursor::NextRow( std::vector<double>& row )
+{
+    if(mColumnsCount == 0) return false;
+
+    row.resize(mColumnsCount);
+    for (size_t i = 0; i < mColumnsCount; i++)
+    {
+        if(!NextCell(mCell)) return false;
+        row[i] = StringUtils::ParseDouble(mCell);
+    }
+    mRowsRead++;
+    return true;
+}
+
+
+//______________________________________________________________________________
+bool ccdb::BlobCursor::NextRow( std::vector<int>& row )
+{
+    if(mColumnsCount == 0) return false;
+
+    row.resize(mColumnsCount);
+    for (size_t i = 0; i < mColumnsCount; i++)
+    {
+        if(!NextCell(mCell)) return false;
+        row[i] = StringUtils::ParseInt(mCell);
+    }
+    mRowsRead++;
+    return true;
+}
+
+
+//______________________________________________________________________________
+ccdb::StringBlobCursor::StringBlobCursor( const std::string& blob, size_t columnsCount, size_t bufferSize /*= 64*1024*/ )
+    :BlobCursor(columnsCount, bufferSize),
+    mBlob(blob),
+    mReadPos(0)
+{
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::StringBlobCursor::ReadChunk( char* buffer, size_t size )
+{
+    size_t left = mBlob.size() - mReadPos;
+    if(size > left) size = left;
+    memcpy(buffer, mBlob.data() + mReadPos, size);
+    mReadPos += size;
+    return size;
+}
@@ -0,0 +1,123 @@
+#include <string.h>
+
+#include "CCDB/Helpers/BlobPool.h"
+#include "CCDB/Helpers/StringUtils.h"
+
+using namespace std;
+
+
+//______________________________________________________________________________
+ccdb::BlobPool& ccdb::BlobPool::Instance()
+{
+    //blobs of static objects may be released at exit, so the pool is never destroyed
+    static BlobPool* pool = new BlobPool();
+    return *pool;
+}
+
+
+//______________________________________________________________________________
+void ccdb::BlobPool::Deleter::operator()( ccdb::DecodedBlob* blob ) const
+{
+    ccdb::BlobPool::Instance().Remove(blob);
+}
+
+
+//______________________________________________________________________________
+uint64_t ccdb::BlobPool::Hash( const char* data, size_t length )
+{
+    return StringUtils::Hash64(data, length);
+}
+
+
+//______________________________________________________________________________
+std::shared_ptr<const ccdb::DecodedBlob> ccdb::BlobPool::Empty()
+{
+    static shared_ptr<const DecodedBlob> empty(new DecodedBlob{string(), vector<string>(), Hash("", 0)});
+    return empty;
+}
+
+
+//______________________________________________________________________________
+std::shared_ptr<const ccdb::DecodedBlob> ccdb::BlobPool::Find( const char* data, size_t length, uint64_t hash )
+{
+    lock_guard<mutex> lock(mMutex);
+    return FindLocked(data, length, hash);
+}
+
+
+//______________________________________________________________________________
+std::shared_ptr<const ccdb::DecodedBlob> ccdb::BlobPool::FindLocked( const char* data, size_t length, uint64_t hash )
+{
+    //Blobs are deleted only after Remove takes the mutex, so the addresses are valid here.
+    //A blob is locked only when it matches, so its last reference is never dropped under the mutex
+    auto range = mBlobs.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        const DecodedBlob* candidate = it->second.Address;
+        if(candidate->RawData.size() != length) continue;
+        if(length && memcmp(candidate->RawData.data(), data, length) != 0) continue;
+
+        //the blob may be being deleted, then it is not found
+        shared_ptr<const DecodedBlob> blob = it->second.Blob.lock();
+        if(!blob) continue;
+
+        mSharedCount++;
+        return blob;
+    }
+    return shared_ptr<const DecodedBlob>();
+}
+
+
+//______________________________________________________________________________
+std::shared_ptr<const ccdb::DecodedBlob> ccdb::BlobPool::Add( DecodedBlob* blob )
+{
+    lock_guard<mutex> lock(mMutex);
+
+    //other thread could decode the same blob in parallel
+    shared_ptr<const DecodedBlob> found = FindLocked(blob->RawData.data(), blob->RawData.size(), blob->Hash);
+    if(found)
+    {
+        delete blob;
+        return found;
+    }
+
+    shared_ptr<const DecodedBlob> added(blob, Deleter());
+    Entry entry;
+    entry.Address = blob;
+    entry.Blob = added;
+    mBlobs.insert(make_pair(blob->Hash, entry));
+    return added;
+}
+
+
+//______________________________________________________________________________
+void ccdb::BlobPool::Remove( DecodedBlob* blob )
+{
+    {
+        lock_guard<mutex> lock(mMutex);
+        auto range = mBlobs.equal_range(blob->Hash);
+        for(auto it = range.first; it != range.second; ++it)
+        {
+            if(it->second.Address != blob) continue;
+            mBlobs.erase(it);
+            break;
+        }
+    }
+    delete blob;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::BlobPool::GetBlobsCount() const
+{
+    lock_guard<mutex> lock(mMutex);
+    return mBlobs.size();
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::BlobPool::GetSharedCount() const
+{
+    lock_guard<mutex> lock(mMutex);
+    return mSharedCount;
+}
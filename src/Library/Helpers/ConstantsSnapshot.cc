@@ -0,0 +1,167 @@
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <unordered_set>
+#include <stdexcept>
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
+#include "CCDB/Helpers/ConstantsSnapshot.h"
+#include "CCDB/Helpers/StringUtils.h"
+
+using namespace std;
+
+namespace
+{
+    uint64_t Align8(uint64_t value) { return (value + 7) & ~(uint64_t)7; }
+
+    /** Index goes at the start of the memory, sorted by hash */
+    struct IndexEntry
+    {
+        uint64_t Hash;
+        uint64_t Offset;            // offset of the table
+
+        bool operator<(const IndexEntry& rhs) const { return Hash < rhs.Hash; }
+    };
+
+    /** Table header. The key (padded to 8 bytes) and values go right after it */
+    struct TableHeader
+    {
+        uint32_t KeyLength;
+        uint32_t Rows;
+        uint32_t Columns;
+        uint32_t Reserved;
+
+        const char* Key() const { return (const char*)(this + 1); }
+        const double* Values() const { return (const double*)(Key() + Align8(KeyLength)); }
+    };
+}
+
+
+//______________________________________________________________________________
+ccdb::ConstantsSnapshot::ConstantsSnapshot()
+    :mBase(NULL), mSize(0), mTablesCount(0)
+{
+}
+
+
+//______________________________________________________________________________
+ccdb::ConstantsSnapshot::~ConstantsSnapshot()
+{
+#ifndef WIN32
+    if(mBase) munmap(mBase, mSize);
+#else
+    free(mBase);
+#endif
+}
+
+
+//______________________________________________________________________________
+void ccdb::ConstantsSnapshot::Add( const std::string& key, const std::vector< std::vector<double> >& values )
+{
+    if(IsSealed()) throw std::logic_error("ConstantsSnapshot::Add. The snapshot is sealed already");
+
+    PendingTable table;
+    table.Key = key;
+    table.Rows = (uint32_t)values.size();
+    table.Columns = values.empty() ? 0 : (uint32_t)values[0].size();
+    table.Values.reserve((size_t)table.Rows * table.Columns);
+    for(size_t i = 0; i < values.size(); i++)
+    {
+        if(values[i].size() != table.Columns) throw std::logic_error("ConstantsSnapshot::Add. Rows of table '" + key + "' have different sizes");
+        table.Values.insert(table.Values.end(), values[i].begin(), values[i].end());
+    }
+    mPending.push_back(table);
+}
+
+
+//______________________________________________________________________________
+void ccdb::ConstantsSnapshot::Seal()
+{
+    if(IsSealed()) throw std::logic_error("ConstantsSnapshot::Seal. The snapshot is sealed already");
+
+    //the same table may be added twice, the first one is kept
+    vector<IndexEntry> index;
+    vector<size_t> tables;
+    unordered_set<string> keys;
+    uint64_t size = 0;
+    for(size_t i = 0; i < mPending.size(); i++)
+    {
+        if(!keys.insert(mPending[i].Key).second) continue;
+
+        IndexEntry entry;
+        entry.Hash = ccdb::StringUtils::Hash64(mPending[i].Key);
+        entry.Offset = size;
+        index.push_back(entry);
+        tables.push_back(i);
+        size += sizeof(TableHeader) + Align8(mPending[i].Key.size()) + mPending[i].Values.size() * sizeof(double);
+    }
+
+    //table offsets are known now, the index goes before them
+    uint64_t indexSize = sizeof(uint64_t) + index.size() * sizeof(IndexEntry);
+    for(size_t i = 0; i < index.size(); i++) index[i].Offset += indexSize;
+    size += indexSize;
+
+#ifndef WIN32
+    void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED) throw std::logic_error("ConstantsSnapshot::Seal. Can't map memory for constants");
+#else
+    void* memory = malloc(size);
+    if(!memory) throw std::logic_error("ConstantsSnapshot::Seal. Can't allocate memory for constants");
+#endif
+    char* base = (char*)memory;
+
+    for(size_t i = 0; i < tables.size(); i++)
+    {
+        const PendingTable& pending = mPending[tables[i]];
+        TableHeader* header = (TableHeader*)(base + index[i].Offset);
+        header->KeyLength = (uint32_t)pending.Key.size();
+        header->Rows = pending.Rows;
+        header->Columns = pending.Columns;
+        header->Reserved = 0;
+        memcpy((char*)header->Key(), pending.Key.data(), pending.Key.size());
+        if(!pending.Values.empty()) memcpy((double*)header->Values(), &pending.Values[0], pending.Values.size() * sizeof(double));
+    }
+
+    sort(index.begin(), index.end());
+    *(uint64_t*)base = index.size();
+    if(!index.empty()) memcpy(base + sizeof(uint64_t), &index[0], index.size() * sizeof(IndexEntry));
+
+#ifndef WIN32
+    mprotect(memory, size, PROT_READ);
+#endif
+
+    mBase = base;
+    mSize = size;
+    mTablesCount = index.size();
+    vector<PendingTable>().swap(mPending);
+}
+
+
+//______________________________________________________________________________
+bool ccdb::ConstantsSnapshot::Find( const std::string& key, Table& table ) const
+{
+    if(!IsSealed()) return false;
+
+    const IndexEntry* first = (const IndexEntry*)(mBase + sizeof(uint64_t));
+    const IndexEntry* last = first + *(const uint64_t*)mBase;
+    IndexEntry searched;
+    searched.Hash = ccdb::StringUtils::Hash64(key);
+    searched.Offset = 0;
+
+    for(const IndexEntry* entry = lower_bound(first, last, searched); entry != last && entry->Hash == searched.Hash; ++entry)
+    {
+        const TableHeader* header = (const TableHeader*)(mBase + entry->Offset);
+        if(header->KeyLength == key.size() && memcmp(header->Key(), key.data(), key.size()) == 0)
+        {
+            table.Values = header->Values();
+            table.Rows = header->Rows;
+            table.Columns = header->Columns;
+            table.LoadTime = 0;
+            table.Generation = 0;
+            return true;
+        }
+    }
+    return false;
+}
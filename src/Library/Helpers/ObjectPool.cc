@@ -0,0 +1,247 @@
+#include "CCDB/Helpers/ObjectPool.h"
+
+using namespace std;
+
+namespace
+{
+    /** Blocks are aligned as malloc aligns, so any object fits */
+    const size_t BlockAlignment = alignof(max_align_t);
+
+    /** Live pools by ids. Free lists of exiting threads go back only to pools that are still there */
+    mutex& GetPoolsMutex()
+    {
+        static mutex* poolsMutex = new mutex();
+        return *poolsMutex;
+    }
+
+    vector<ccdb::FixedSizePool*>& GetPools()
+    {
+        static vector<ccdb::FixedSizePool*>* pools = new vector<ccdb::FixedSizePool*>();
+        return *pools;
+    }
+}
+
+
+struct ccdb::FixedSizePool::ThreadLists
+{
+    explicit ThreadLists(bool* isExited): IsExited(isExited) {}
+
+    ~ThreadLists()
+    {
+        lock_guard<mutex> poolsLock(GetPoolsMutex());
+        for(size_t id = 0; id < Lists.size(); id++)
+        {
+            ThreadList* list = Lists[id];
+            if(list == NULL) continue;
+
+            FixedSizePool* pool = GetPools()[id];
+            if(pool != NULL)
+            {
+                pool->Drain(list, list->Count.load(memory_order_relaxed));
+                lock_guard<mutex> lock(pool->mMutex);
+                for(size_t i = 0; i < pool->mThreadLists.size(); i++)
+                {
+                    if(pool->mThreadLists[i] != list) continue;
+                    pool->mThreadLists.erase(pool->mThreadLists.begin() + i);
+                    break;
+                }
+            }
+            delete list;
+        }
+
+        //objects deleted later by this thread go to the shared lists
+        *IsExited = true;
+    }
+
+    vector<ThreadList*> Lists;
+    bool* IsExited;
+};
+
+
+//______________________________________________________________________________
+ccdb::FixedSizePool::FixedSizePool( size_t blockSize, size_t blocksPerChunk/*=128*/ )
+    :mBlocksPerChunk(blocksPerChunk > 0 ? blocksPerChunk : 1),
+    mFreeList(NULL),
+    mUsedCount(0)
+{
+    if(blockSize < sizeof(FreeBlock)) blockSize = sizeof(FreeBlock);
+    mBlockSize = (blockSize + BlockAlignment - 1) / BlockAlignment * BlockAlignment;
+
+    lock_guard<mutex> poolsLock(GetPoolsMutex());
+    mId = GetPools().size();
+    GetPools().push_back(this);
+}
+
+
+//______________________________________________________________________________
+ccdb::FixedSizePool::~FixedSizePool()
+{
+    {
+        //ids are not reused, free lists of threads for this pool are just dropped at thread exit
+        lock_guard<mutex> poolsLock(GetPoolsMutex());
+        GetPools()[mId] = NULL;
+    }
+
+    for(size_t i = 0; i < mChunks.size(); i++) ::operator delete(mChunks[i]);
+}
+
+
+//______________________________________________________________________________
+ccdb::FixedSizePool::ThreadList* ccdb::FixedSizePool::GetThreadList()
+{
+    static thread_local bool isExited = false;
+    static thread_local ThreadLists* lists = NULL;
+
+    if(isExited) return NULL;
+    if(lists == NULL)
+    {
+        static thread_local ThreadLists threadLists(&isExited);
+        lists = &threadLists;
+    }
+
+    if(mId >= lists->Lists.size()) lists->Lists.resize(mId + 1, NULL);
+    ThreadList* list = lists->Lists[mId];
+    if(list == NULL)
+    {
+        list = new ThreadList();
+        list->FreeList = NULL;
+        list->Count.store(0, memory_order_relaxed);
+        lists->Lists[mId] = list;
+
+        lock_guard<mutex> lock(mMutex);
+        mThreadLists.push_back(list);
+    }
+    return list;
+}
+
+
+//______________________________________________________________________________
+void ccdb::FixedSizePool::CutChunk()
+{
+    char* chunk = static_cast<char*>(::operator new(mBlockSize * mBlocksPerChunk));
+    mChunks.push_back(chunk);
+    for(size_t i = mBlocksPerChunk; i > 0; i--)
+    {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + (i - 1) * mBlockSize);
+        block->Next = mFreeList;
+        mFreeList = block;
+    }
+}
+
+
+//______________________________________________________________________________
+void ccdb::FixedSizePool::Refill( ThreadList* list )
+{
+    FreeBlock* first;
+    FreeBlock* last;
+    size_t count = 0;
+    {
+        lock_guard<mutex> lock(mMutex);
+        if(mFreeList == NULL) CutChunk();
+
+        first = last = mFreeList;
+        count = 1;
+        while(count < cThreadBatchSize && last->Next != NULL)
+        {
+            last = last->Next;
+            count++;
+        }
+        mFreeList = last->Next;
+        mUsedCount += count;
+    }
+
+    last->Next = list->FreeList;
+    list->FreeList = first;
+    list->Count.store(list->Count.load(memory_order_relaxed) + count, memory_order_relaxed);
+}
+
+
+//______________________________________________________________________________
+void ccdb::FixedSizePool::Drain( ThreadList* list, size_t count )
+{
+    if(count == 0 || list->FreeList == NULL) return;
+
+    FreeBlock* first = list->FreeList;
+    FreeBlock* last = first;
+    size_t drained = 1;
+    while(drained < count && last->Next != NULL)
+    {
+        last = last->Next;
+        drained++;
+    }
+    list->FreeList = last->Next;
+    list->Count.store(list->Count.load(memory_order_relaxed) - drained, memory_order_relaxed);
+
+    lock_guard<mutex> lock(mMutex);
+    last->Next = mFreeList;
+    mFreeList = first;
+    mUsedCount -= drained;
+}
+
+
+//______________________________________________________________________________
+void* ccdb::FixedSizePool::Allocate()
+{
+    ThreadList* list = GetThreadList();
+    if(list == NULL)
+    {
+        //the thread exits and has no list anymore
+        lock_guard<mutex> lock(mMutex);
+        if(mFreeList == NULL) CutChunk();
+        FreeBlock* block = mFreeList;
+        mFreeList = block->Next;
+        mUsedCount++;
+        return block;
+    }
+
+    if(list->FreeList == NULL) Refill(list);
+
+    FreeBlock* block = list->FreeList;
+    list->FreeList = block->Next;
+    list->Count.store(list->Count.load(memory_order_relaxed) - 1, memory_order_relaxed);
+    return block;
+}
+
+
+//______________________________________________________________________________
+void ccdb::FixedSizePool::Free( void* block )
+{
+    if(block == NULL) return;
+
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    ThreadList* list = GetThreadList();
+    if(list == NULL)
+    {
+        lock_guard<mutex> lock(mMutex);
+        freed->Next = mFreeList;
+        mFreeList = freed;
+        mUsedCount--;
+        return;
+    }
+
+    freed->Next = list->FreeList;
+    list->FreeList = freed;
+    size_t count = list->Count.load(memory_order_relaxed) + 1;
+    list->Count.store(count, memory_order_relaxed);
+
+    //blocks freed by this thread but allocated by others must not pile up here
+    if(count > 2 * cThreadBatchSize) Drain(list, cThreadBatchSize);
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::FixedSizePool::GetChunksCount() const
+{
+    lock_guard<mutex> lock(mMutex);
+    return mChunks.size();
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::FixedSizePool::GetUsedCount() const
+{
+    lock_guard<mutex> lock(mMutex);
+    size_t cachedCount = 0;
+    for(size_t i = 0; i < mThreadLists.size(); i++) cachedCount += mThreadLists[i]->Count.load(memory_order_relaxed);
+    return mUsedCount > cachedCount ? mUsedCount - cachedCount : 0;
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "CCDB/Helpers/ReplicaSelector.h"
+
+using namespace std;
+
+namespace
+{
+    /** Weight of a new sample in the moving average */
+    const double LatencyWeight = 0.2;
+}
+
+
+//______________________________________________________________________________
+ccdb::ReplicaSelector::ReplicaSelector( size_t replicasCount, size_t samplesCount/*=64*/ )
+    :mReplicas(replicasCount),
+    mSamplesCount(samplesCount > MinSamplesCount ? samplesCount : MinSamplesCount),
+    mRetryDelay(10)
+{
+    if(replicasCount == 0) throw std::logic_error("ReplicaSelector. At least one replica is needed");
+
+    for(size_t i = 0; i < mReplicas.size(); i++)
+    {
+        mReplicas[i].Latency = 0;
+        mReplicas[i].NextSample = 0;
+        mReplicas[i].IsFailed = false;
+    }
+}
+
+
+//______________________________________________________________________________
+int ccdb::ReplicaSelector::Select( const std::vector<size_t>& excluded/*=std::vector<size_t>()*/ ) const
+{
+    int best = -1;              // the fastest healthy one
+    int firstDue = -1;          // the failed one that is retried first
+    for(size_t i = 0; i < mReplicas.size(); i++)
+    {
+        if(find(excluded.begin(), excluded.end(), i) != excluded.end()) continue;
+
+        const Replica& replica = mReplicas[i];
+        if(!IsHealthy(i))
+        {
+            if(firstDue < 0 || replica.RetryTime < mReplicas[firstDue].RetryTime) firstDue = (int)i;
+            continue;
+        }
+
+        //not measured replicas go first
+        if(best >= 0 && mReplicas[best].Samples.empty()) continue;
+        if(best < 0 || replica.Samples.empty() || replica.Latency < mReplicas[best].Latency) best = (int)i;
+    }
+    return best >= 0 ? best : firstDue;
+}
+
+
+//______________________________________________________________________________
+void ccdb::ReplicaSelector::AddLatency( size_t replica, double milliseconds )
+{
+    Replica& entry = mReplicas[replica];
+    entry.IsFailed = false;
+    entry.Latency = entry.Samples.empty() ? milliseconds : entry.Latency + LatencyWeight * (milliseconds - entry.Latency);
+
+    if(entry.Samples.size() < mSamplesCount)
+    {
+        entry.Samples.push_back(milliseconds);
+    }
+    else
+    {
+        entry.Samples[entry.NextSample] = milliseconds;
+        entry.NextSample = (entry.NextSample + 1) % mSamplesCount;
+    }
+}
+
+
+//______________________________________________________________________________
+void ccdb::ReplicaSelector::MarkFailed( size_t replica )
+{
+    mReplicas[replica].IsFailed = true;
+    mReplicas[replica].RetryTime = Clock::now() + chrono::duration_cast<Clock::duration>(chrono::duration<double>(mRetryDelay));
+}
+
+
+//______________________________________________________________________________
+bool ccdb::ReplicaSelector::IsHealthy( size_t replica ) const
+{
+    return !mReplicas[replica].IsFailed || Clock::now() >= mReplicas[replica].RetryTime;
+}
+
+
+//______________________________________________________________________________
+double ccdb::ReplicaSelector::GetPercentile( size_t replica, double percentile ) const
+{
+    vector<double> samples(mReplicas[replica].Samples);
+    if(samples.size() < MinSamplesCount) return -1;
+
+    if(percentile < 0) percentile = 0;
+    if(percentile > 100) percentile = 100;
+    size_t index = (size_t)(percentile / 100.0 * (samples.size() - 1) + 0.5);
+    nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
@@ -0,0 +1,429 @@
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <atomic>
+#include <stdexcept>
+#ifndef WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "CCDB/Helpers/SharedMemoryCache.h"
+#include "CCDB/Helpers/StringUtils.h"
+
+using namespace std;
+
+namespace
+{
+    const uint32_t cMagic = 0x43484343;                 // "CCHC"
+    const uint32_t cVersion = 3;
+
+    /** Milliseconds to wait for the process that creates the segment */
+    const int cInitTimeout = 2000;
+
+    uint64_t Align8(uint64_t value) { return (value + 7) & ~(uint64_t)7; }
+}
+
+#ifndef WIN32
+
+/** Start of the segment. Buckets go right after it, then entries */
+struct ccdb::SharedMemoryCache::Header
+{
+    std::atomic<uint32_t> Magic;            // set the last, when the segment is ready
+    uint32_t Version;
+    uint64_t Size;                          // size of the segment
+    uint64_t BucketsCount;                  // power of 2
+    uint64_t DataOffset;                    // offset of the first entry
+    std::atomic<uint64_t> Used;             // end of the last entry
+    std::atomic<uint64_t> TablesCount;
+    std::atomic<uint64_t> Generation;       // odd while the segment is reset
+    std::atomic<uint64_t> ResetsCount;
+    pthread_mutex_t WriteMutex;             // serializes writers only
+
+    std::atomic<uint64_t>* Buckets() { return (std::atomic<uint64_t>*)(this + 1); }
+};
+
+
+/** Entry header. The key (padded to 8 bytes) and values (or the target key of an alias) go right after it */
+struct ccdb::SharedMemoryCache::Entry
+{
+    uint64_t Next;                          // offset of the next entry in the bucket, 0 - the last
+    uint64_t Hash;
+    uint32_t KeyLength;
+    uint32_t Rows;
+    uint32_t Columns;
+    uint32_t LoadTime;                      // seconds since epoch
+    uint32_t TargetLength;                  // length of the target key of an alias, 0 - the entry is a table
+    uint32_t Reserved;
+
+    const char* Key() const { return (const char*)(this + 1); }
+    const double* Values() const { return (const double*)(Key() + Align8(KeyLength)); }
+    const char* Target() const { return Key() + Align8(KeyLength); }
+    uint64_t GetSize() const { return sizeof(Entry) + Align8(KeyLength) + (TargetLength ? Align8(TargetLength) : (uint64_t)Rows * Columns * sizeof(double)); }
+};
+
+
+namespace
+{
+    /** Locks the write mutex. If the previous owner died, its entry was not published, so the cache is consistent */
+    class WriteLock
+    {
+    public:
+        explicit WriteLock(pthread_mutex_t* mutex): mMutex(mutex)
+        {
+            int result = pthread_mutex_lock(mMutex);
+#ifdef __linux__
+            if(result == EOWNERDEAD) pthread_mutex_consistent(mMutex);
+#else
+            (void)result;
+#endif
+        }
+        ~WriteLock() { pthread_mutex_unlock(mMutex); }
+    private:
+        pthread_mutex_t* mMutex;
+    };
+}
+
+#endif //WIN32
+
+
+//______________________________________________________________________________
+ccdb::SharedMemoryCache::SharedMemoryCache()
+    :mBase(NULL), mMappedSize(0), mHeader(NULL)
+{
+}
+
+
+//______________________________________________________________________________
+ccdb::SharedMemoryCache::~SharedMemoryCache()
+{
+    Close();
+}
+
+
+//______________________________________________________________________________
+void ccdb::SharedMemoryCache::Open( const std::string& name, size_t size /*= DefaultSize*/ )
+{
+#ifndef WIN32
+    if(IsOpen()) throw std::logic_error("Shared cache is already opened: '" + mName + "'");
+
+    uint64_t bucketsCount = 1024;
+    while(bucketsCount * 4096 < size) bucketsCount *= 2;
+    uint64_t dataOffset = Align8(sizeof(Header) + bucketsCount * sizeof(std::atomic<uint64_t>));
+    if(size < dataOffset * 2) throw std::logic_error("Shared cache size is too small");
+
+    //the first process creates the segment, others wait until it is ready.
+    //Only processes of the same user may read and change the tables
+    bool isCreator = true;
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd < 0 && errno == EEXIST)
+    {
+        isCreator = false;
+        fd = shm_open(name.c_str(), O_RDWR, 0600);
+    }
+    if(fd < 0) throw std::logic_error("Can't open shared memory segment '" + name + "'");
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_uid != geteuid() || (info.st_mode & (S_IRWXG | S_IRWXO)) != 0)
+    {
+        close(fd);
+        throw std::logic_error("Shared memory segment '" + name + "' is not owned by this user or is open to others");
+    }
+
+    if(isCreator && ftruncate(fd, size) != 0)
+    {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::logic_error("Can't allocate shared memory segment '" + name + "'");
+    }
+
+    for(int i = 0; !isCreator && i < cInitTimeout && fstat(fd, &info) == 0 && info.st_size == 0; i++) usleep(1000);
+    size_t mappedSize = isCreator ? size : (fstat(fd, &info) == 0 ? (size_t)info.st_size : 0);
+    if(mappedSize < sizeof(Header))
+    {
+        close(fd);
+        throw std::logic_error("Shared memory segment '" + name + "' is not initialized");
+    }
+
+    void* base = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) throw std::logic_error("Can't map shared memory segment '" + name + "'");
+    Header* header = (Header*)base;
+
+    if(isCreator)
+    {
+        //ftruncate fills the segment with zeros, so buckets are empty
+        header->Version = cVersion;
+        header->Size = size;
+        header->BucketsCount = bucketsCount;
+        header->DataOffset = dataOffset;
+        header->Used.store(dataOffset);
+        header->TablesCount.store(0);
+        header->Generation.store(0);
+        header->ResetsCount.store(0);
+
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+#ifdef __linux__
+        pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+#endif
+        pthread_mutex_init(&header->WriteMutex, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+
+        header->Magic.store(cMagic, std::memory_order_release);
+    }
+    else
+    {
+        for(int i = 0; i < cInitTimeout && header->Magic.load(std::memory_order_acquire) != cMagic; i++) usleep(1000);
+        if(header->Magic.load(std::memory_order_acquire) != cMagic || header->Version != cVersion || header->Size != mappedSize)
+        {
+            munmap(base, mappedSize);
+            throw std::logic_error("Shared memory segment '" + name + "' is not a ccdb cache of this version");
+        }
+    }
+
+    mName = name;
+    mBase = (char*)base;
+    mMappedSize = mappedSize;
+    mHeader = header;
+#else
+    throw std::logic_error("Shared memory cache is not supported on this platform");
+#endif
+}
+
+
+//______________________________________________________________________________
+void ccdb::SharedMemoryCache::Close()
+{
+#ifndef WIN32
+    if(mBase) munmap(mBase, mMappedSize);
+#endif
+    mBase = NULL;
+    mMappedSize = 0;
+    mHeader = NULL;
+}
+
+
+//______________________________________________________________________________
+void ccdb::SharedMemoryCache::Remove( const std::string& name )
+{
+#ifndef WIN32
+    shm_unlink(name.c_str());
+#endif
+}
+
+
+//______________________________________________________________________________
+uint64_t ccdb::SharedMemoryCache::FindEntry( const std::string& key, uint64_t hash ) const
+{
+#ifndef WIN32
+    //entries are written before they are published in the bucket and are not changed until the reset.
+    //The reset may go on meanwhile, so offsets are checked and the walk is limited
+    uint64_t offset = mHeader->Buckets()[hash & (mHeader->BucketsCount - 1)].load(std::memory_order_acquire);
+    uint64_t stepsLeft = (mHeader->Size - mHeader->DataOffset) / sizeof(Entry);
+    while(offset && stepsLeft--)
+    {
+        if(offset < mHeader->DataOffset || offset > mHeader->Size - sizeof(Entry)) return 0;
+        const Entry* entry = (const Entry*)(mBase + offset);
+        if(entry->KeyLength > mHeader->Size || entry->GetSize() > mHeader->Size - offset) return 0;
+        if(entry->Hash == hash && entry->KeyLength == key.size() && memcmp(entry->Key(), key.data(), key.size()) == 0)
+        {
+            return offset;
+        }
+        offset = entry->Next;
+    }
+#endif
+    return 0;
+}
+
+
+//______________________________________________________________________________
+bool ccdb::SharedMemoryCache::Find( const std::string& key, Table& table ) const
+{
+#ifndef WIN32
+    if(!IsOpen()) return false;
+
+    uint64_t generation = mHeader->Generation.load(std::memory_order_acquire);
+    if(generation & 1) return false;
+
+    uint64_t offset = FindEntry(key, ccdb::StringUtils::Hash64(key));
+    if(!offset) return false;
+
+    //the alias gives its load time: it tells when the request was answered with this table
+    const Entry* entry = (const Entry*)(mBase + offset);
+    table.LoadTime = entry->LoadTime;
+    if(entry->TargetLength)
+    {
+        string target(entry->Target(), entry->TargetLength);
+        offset = FindEntry(target, ccdb::StringUtils::Hash64(target));
+        if(!offset) return false;
+        entry = (const Entry*)(mBase + offset);
+        if(entry->TargetLength) return false;
+    }
+
+    table.Values = entry->Values();
+    table.Rows = entry->Rows;
+    table.Columns = entry->Columns;
+    table.Generation = generation;
+    return IsUnchanged(table);
+#else
+    return false;
+#endif
+}
+
+
+//______________________________________________________________________________
+bool ccdb::SharedMemoryCache::IsUnchanged( const Table& table ) const
+{
+#ifndef WIN32
+    if(!IsOpen()) return false;
+
+    //values are read before the generation is checked again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return mHeader->Generation.load(std::memory_order_relaxed) == table.Generation;
+#else
+    return false;
+#endif
+}
+
+
+//______________________________________________________________________________
+bool ccdb::SharedMemoryCache::Add( const std::string& key, const double* values, uint32_t rows, uint32_t columns, time_t minLoadTime /*= 0*/ )
+{
+    return AddEntry(key, string(), values, rows, columns, minLoadTime);
+}
+
+
+//______________________________________________________________________________
+bool ccdb::SharedMemoryCache::AddAlias( const std::string& key, const std::string& targetKey, time_t minLoadTime /*= 0*/ )
+{
+    if(targetKey.empty()) return false;
+    return AddEntry(key, targetKey, NULL, 0, 0, minLoadTime);
+}
+
+
+//______________________________________________________________________________
+bool ccdb::SharedMemoryCache::AddEntry( const string& key, const string& target, const double* values, uint32_t rows, uint32_t columns, time_t minLoadTime )
+{
+#ifndef WIN32
+    if(!IsOpen()) return false;
+
+    uint64_t hash = ccdb::StringUtils::Hash64(key);
+    uint64_t dataSize = target.empty() ? (uint64_t)rows * columns * sizeof(double) : Align8(target.size());
+    uint64_t entrySize = sizeof(Entry) + Align8(key.size()) + dataSize;
+    if(entrySize > mHeader->Size - mHeader->DataOffset) return false;
+
+    WriteLock lock(&mHeader->WriteMutex);
+    uint64_t existing = FindEntry(key, hash);
+    if(existing)
+    {
+        const Entry* existingEntry = (const Entry*)(mBase + existing);
+        bool isSame = existingEntry->TargetLength == target.size() && memcmp(existingEntry->Target(), target.data(), target.size()) == 0;
+        if(existingEntry->LoadTime >= minLoadTime && (target.empty() || isSame)) return true;
+    }
+
+    uint64_t offset = mHeader->Used.load(std::memory_order_relaxed);
+    if(offset + entrySize > mHeader->Size)
+    {
+        Reset();
+        existing = 0;
+        offset = mHeader->Used.load(std::memory_order_relaxed);
+    }
+
+    Entry* entry = (Entry*)(mBase + offset);
+    std::atomic<uint64_t>& bucket = mHeader->Buckets()[hash & (mHeader->BucketsCount - 1)];
+    entry->Next = bucket.load(std::memory_order_relaxed);
+    entry->Hash = hash;
+    entry->KeyLength = (uint32_t)key.size();
+    entry->Rows = rows;
+    entry->Columns = columns;
+    entry->LoadTime = (uint32_t)time(NULL);
+    entry->TargetLength = (uint32_t)target.size();
+    entry->Reserved = 0;
+    memcpy((char*)entry->Key(), key.data(), key.size());
+    if(target.empty()) memcpy((double*)entry->Values(), values, (size_t)rows * columns * sizeof(double));
+    else memcpy((char*)entry->Target(), target.data(), target.size());
+
+    //if the process dies before this point, the next writer takes the same place.
+    //A replaced entry stays in the bucket after the new one, so readers don't find it any more
+    mHeader->Used.store(offset + entrySize, std::memory_order_relaxed);
+    bucket.store(offset, std::memory_order_release);
+    if(target.empty() && !(existing && ((const Entry*)(mBase + existing))->TargetLength == 0))
+    {
+        mHeader->TablesCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+//______________________________________________________________________________
+void ccdb::SharedMemoryCache::Reset()
+{
+#ifndef WIN32
+    //readers that find tables meanwhile see the generation changed (@see IsUnchanged)
+    mHeader->Generation.fetch_add(1, std::memory_order_acq_rel);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::atomic<uint64_t>* buckets = mHeader->Buckets();
+    for(uint64_t i = 0; i < mHeader->BucketsCount; i++) buckets[i].store(0, std::memory_order_relaxed);
+    mHeader->Used.store(mHeader->DataOffset, std::memory_order_relaxed);
+    mHeader->TablesCount.store(0, std::memory_order_relaxed);
+    mHeader->ResetsCount.fetch_add(1, std::memory_order_relaxed);
+
+    mHeader->Generation.fetch_add(1, std::memory_order_release);
+#endif
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::SharedMemoryCache::GetSize() const
+{
+    return mMappedSize;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::SharedMemoryCache::GetUsedBytes() const
+{
+#ifndef WIN32
+    if(IsOpen()) return (size_t)mHeader->Used.load(std::memory_order_relaxed);
+#endif
+    return 0;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::SharedMemoryCache::GetFreeBytes() const
+{
+#ifndef WIN32
+    if(IsOpen()) return (size_t)(mHeader->Size - mHeader->Used.load(std::memory_order_relaxed));
+#endif
+    return 0;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::SharedMemoryCache::GetTablesCount() const
+{
+#ifndef WIN32
+    if(IsOpen()) return (size_t)mHeader->TablesCount.load(std::memory_order_relaxed);
+#endif
+    return 0;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::SharedMemoryCache::GetResetsCount() const
+{
+#ifndef WIN32
+    if(IsOpen()) return (size_t)mHeader->ResetsCount.load(std::memory_order_relaxed);
+#endif
+    return 0;
+}
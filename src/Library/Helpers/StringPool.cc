@@ -0,0 +1,37 @@
+#include "CCDB/Helpers/StringPool.h"
+
+using namespace std;
+
+
+//______________________________________________________________________________
+ccdb::StringPool& ccdb::StringPool::Instance()
+{
+    //handles may be used by static objects at exit, so the pool is never destroyed
+    static StringPool* pool = new StringPool();
+    return *pool;
+}
+
+
+//______________________________________________________________________________
+ccdb::StringPool::Handle ccdb::StringPool::Intern( const std::string& value )
+{
+    lock_guard<mutex> lock(mMutex);
+    return &*mStrings.insert(value).first;
+}
+
+
+//______________________________________________________________________________
+ccdb::StringPool::Handle ccdb::StringPool::Find( const std::string& value ) const
+{
+    lock_guard<mutex> lock(mMutex);
+    unordered_set<string>::const_iterator it = mStrings.find(value);
+    return it == mStrings.end() ? NULL : &*it;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::StringPool::GetCount() const
+{
+    lock_guard<mutex> lock(mMutex);
+    return mStrings.size();
+}
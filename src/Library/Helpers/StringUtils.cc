@@ -1,4 +1,13 @@
 #include <cstdlib>
+#include <climits>
+#include <string.h>
+#include <thread>
+#include <atomic>
+#include <system_error>
+#include <functional>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "CCDB/Helpers/StringUtils.h"
 
@@ -15,6 +24,105 @@ struct DHTMLReplace {
     {"\"","&quot;"}
 };
 
+namespace
+{
+    //decoder threads of all SplitBlobParallel calls that run now
+    std::atomic<unsigned int> gDecoderThreadsCount(0);
+
+    //the process doesn't run more decoder threads than cores, whatever number of threads decode blobs
+    unsigned int GetMaxDecoderThreads()
+    {
+        unsigned int coresCount = std::thread::hardware_concurrency();
+        return coresCount > 0 ? coresCount : 2;
+    }
+
+    //takes up to 'count' decoder threads of the process. Returns the number of taken threads
+    unsigned int ReserveDecoderThreads(unsigned int count)
+    {
+        static const unsigned int maxCount = GetMaxDecoderThreads();
+        unsigned int current = gDecoderThreadsCount.load();
+        for(;;)
+        {
+            unsigned int taken = current < maxCount ? maxCount - current : 0;
+            if(taken > count) taken = count;
+            if(taken == 0) return 0;
+            if(gDecoderThreadsCount.compare_exchange_weak(current, current + taken)) return taken;
+        }
+    }
+
+    //10^0..10^22 are exactly representable in double
+    const double cExactPowersOf10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    inline bool IsDigit(char c)
+    {
+        return static_cast<unsigned char>(c - '0') < 10;
+    }
+
+    //true if there is nothing but blank characters in [pos, end)
+    inline bool IsBlankTail(const char* pos, const char* end)
+    {
+        while(pos < end && CCDB_CHECK_CHAR_IS_BLANK(*pos)) pos++;
+        return pos == end || *pos == '\0';
+    }
+
+    //Reads [blanks][sign]digits the way strtol does. 'pos' is moved to the first not parsed character.
+    //If digits don't fit unsigned long, value is ULONG_MAX and isOverflow is true. returns false if there were no digits
+    inline bool ScanSignedDecimal(const char*& pos, const char* end, bool& isNegative, unsigned long& value, bool& isOverflow, bool skipBlanks = true)
+    {
+        const char* cur = pos;
+        if(skipBlanks) while(cur < end && CCDB_CHECK_CHAR_IS_BLANK(*cur)) cur++;
+
+        isNegative = false;
+        if(cur < end && (*cur == '-' || *cur == '+'))
+        {
+            isNegative = (*cur == '-');
+            cur++;
+        }
+
+        const char* digitsStart = cur;
+        value = 0;
+        isOverflow = false;
+        for(; cur < end && IsDigit(*cur); cur++)
+        {
+            unsigned long digit = static_cast<unsigned long>(*cur - '0');
+            if(value > (ULONG_MAX - digit) / 10) isOverflow = true;
+            value = isOverflow ? ULONG_MAX : value * 10 + digit;
+        }
+
+        if(cur == digitsStart) return false;
+        pos = cur;
+        return true;
+    }
+}
+
+const char   ccdb::StringUtils::cBlobDelimiter;
+const char   ccdb::StringUtils::cBlobEscape[12] = "&delimiter;";
+const size_t ccdb::StringUtils::cBlobEscapeLength;
+static_assert(sizeof(ccdb::StringUtils::cBlobEscape) - 1 == ccdb::StringUtils::cBlobEscapeLength, "cBlobEscapeLength should be the length of cBlobEscape");
+
+
+//______________________________________________________________________________
+const char* ccdb::StringUtils::FindBlobSpecial( const char* pos, const char* end )
+{
+#if defined(__SSE2__) && defined(__GNUC__)
+    const __m128i delimiters = _mm_set1_epi8(cBlobDelimiter);
+    const __m128i ampersands = _mm_set1_epi8('&');
+    while(end - pos >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, delimiters), _mm_cmpeq_epi8(chunk, ampersands)));
+        if(mask) return pos + __builtin_ctz(mask);
+        pos += 16;
+    }
+#endif
+    while(pos < end && *pos != cBlobDelimiter && *pos != '&') pos++;
+    return pos;
+}
+
+
 std::string ccdb::StringUtils::Decode(const string& source )
 {
     string rs = source;
@@ -337,47 +445,319 @@ vector<string> & ccdb::StringUtils::Split( const string& str, vector<string>& to
 }
 
 
+//______________________________________________________________________________
+size_t ccdb::StringUtils::SplitBlob( const char* data, size_t length, vector<string>& tokens )
+{
+    tokens.clear();
+
+    const char* pos = data;
+    const char* end = data + length;
+    string cell;            //used only for cells that contain encoded separators
+
+    while(pos < end)
+    {
+        const char* special = FindBlobSpecial(pos, end);
+
+        if(special == end)
+        {
+            cell.append(pos, special);
+            break;
+        }
+
+        if(*special == cBlobDelimiter)
+        {
+            if(cell.empty())
+            {
+                //regular cell, copied right from the blob
+                if(special != pos) tokens.push_back(string(pos, special));
+            }
+            else
+            {
+                cell.append(pos, special);
+                tokens.push_back(cell);
+                cell.clear();
+            }
+            pos = special + 1;
+            continue;
+        }
+
+        //it is '&', is it an encoded separator?
+        cell.append(pos, special);
+        if(static_cast<size_t>(end - special) >= cBlobEscapeLength && memcmp(special, cBlobEscape, cBlobEscapeLength) == 0)
+        {
+            cell.push_back(cBlobDelimiter);
+            pos = special + cBlobEscapeLength;
+        }
+        else
+        {
+            cell.push_back('&');
+            pos = special + 1;
+        }
+    }
+
+    if(!cell.empty()) tokens.push_back(cell);
+    return tokens.size();
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::StringUtils::SplitBlobParallel( const char* data, size_t length, vector<string>& tokens, unsigned int chunksCount /*=0*/ )
+{
+    if(chunksCount == 0) chunksCount = std::thread::hardware_concurrency();
+
+    //there is no reason to start a thread for less than a few kilobytes
+    const size_t minChunkLength = 16*1024;
+    if(chunksCount > length / minChunkLength) chunksCount = static_cast<unsigned int>(length / minChunkLength);
+    if(chunksCount <= 1) return SplitBlob(data, length, tokens);
+
+    //the calling thread takes one chunk, other chunks need free decoder threads of the process
+    unsigned int reservedCount = ReserveDecoderThreads(chunksCount - 1);
+    if(reservedCount == 0) return SplitBlob(data, length, tokens);
+    chunksCount = reservedCount + 1;
+
+    //chunk borders. Each border is moved forward to the nearest delimiter, so no cell is cut.
+    //'&delimiter;' doesn't contain '|' so encoded separators are never cut either
+    const char* end = data + length;
+    vector<const char*> borders;
+    borders.push_back(data);
+    for(unsigned int i = 1; i < chunksCount; i++)
+    {
+        const char* border = data + (length / chunksCount) * i;
+        if(border < borders.back()) border = borders.back();
+        border = static_cast<const char*>(memchr(border, cBlobDelimiter, end - border));
+        if(!border) break;
+        borders.push_back(border + 1);
+    }
+    borders.push_back(end);
+
+    //split chunks
+    size_t partsCount = borders.size() - 1;
+    vector<vector<string> > parts(partsCount);
+    vector<std::thread> threads;
+    for(size_t i = 1; i < partsCount; i++)
+    {
+        try
+        {
+            threads.push_back(std::thread(
+                static_cast<size_t(*)(const char*, size_t, vector<string>&)>(&StringUtils::SplitBlob),
+                borders[i], static_cast<size_t>(borders[i+1] - borders[i]), std::ref(parts[i])));
+        }
+        catch(const std::system_error&)
+        {
+            //no more threads for us, do it here
+            SplitBlob(borders[i], borders[i+1] - borders[i], parts[i]);
+        }
+    }
+    SplitBlob(borders[0], borders[1] - borders[0], parts[0]);
+    for(size_t i = 0; i < threads.size(); i++) threads[i].join();
+    gDecoderThreadsCount -= reservedCount;
+
+    //join results in order
+    size_t cellsCount = 0;
+    for(size_t i = 0; i < partsCount; i++) cellsCount += parts[i].size();
+
+    tokens.clear();
+    tokens.reserve(cellsCount);
+    for(size_t i = 0; i < partsCount; i++)
+    {
+        for(size_t j = 0; j < parts[i].size(); j++)
+        {
+            tokens.push_back(string());
+            tokens.back().swap(parts[i][j]);
+        }
+    }
+    return tokens.size();
+}
+
+
+//______________________________________________________________________________
+unsigned int ccdb::StringUtils::GetDecoderThreadsCount()
+{
+    return gDecoderThreadsCount.load();
+}
+
+
+//______________________________________________________________________________
+uint64_t ccdb::StringUtils::Hash64( const char* data, size_t length )
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < length; i++)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+//______________________________________________________________________________
+long ccdb::StringUtils::ParseLong( const char* source, size_t length, bool *result/*=NULL*/ )
+{
+    const char* pos = source;
+    const char* end = source + length;
+
+    bool isNegative = false;
+    bool isOverflow = false;
+    unsigned long value = 0;
+    bool isParsed = ScanSignedDecimal(pos, end, isNegative, value, isOverflow);
+
+    //out of range values are clamped as strtol does
+    unsigned long maxValue = isNegative ? static_cast<unsigned long>(LONG_MAX) + 1 : static_cast<unsigned long>(LONG_MAX);
+    if(value > maxValue)
+    {
+        isOverflow = true;
+        value = maxValue;
+    }
+
+    if(result) *result = isParsed && !isOverflow && IsBlankTail(pos, end);
+    if(!isNegative) return static_cast<long>(value);
+    return value == 0 ? 0 : -static_cast<long>(value - 1) - 1;
+}
+
+
+//______________________________________________________________________________
+unsigned long ccdb::StringUtils::ParseULong( const char* source, size_t length, bool *result/*=NULL*/ )
+{
+    const char* pos = source;
+    const char* end = source + length;
+
+    bool isNegative = false;
+    bool isOverflow = false;
+    unsigned long value = 0;
+    bool isParsed = ScanSignedDecimal(pos, end, isNegative, value, isOverflow);
+
+    if(result) *result = isParsed && !isOverflow && IsBlankTail(pos, end);
+    return isNegative ? 0UL - value : value;
+}
+
+
+//______________________________________________________________________________
+double ccdb::StringUtils::ParseDouble( const char* source, size_t length, bool *result/*=NULL*/ )
+{
+    const char* pos = source;
+    const char* end = source + length;
+
+    //blanks and sign
+    while(pos < end && CCDB_CHECK_CHAR_IS_BLANK(*pos)) pos++;
+    bool isNegative = false;
+    if(pos < end && (*pos == '-' || *pos == '+'))
+    {
+        isNegative = (*pos == '-');
+        pos++;
+    }
+
+    //mantissa. Only 19 significant digits fit into 64 bits
+    unsigned long long mantissa = 0;
+    int significantDigits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    bool isExact = true;
+
+    for(; pos < end && IsDigit(*pos); pos++)
+    {
+        hasDigits = true;
+        if(mantissa == 0 && *pos == '0') continue;
+        if(significantDigits < 19) { mantissa = mantissa * 10 + (*pos - '0'); significantDigits++; }
+        else { exponent++; isExact = false; }
+    }
+
+    if(pos < end && *pos == '.')
+    {
+        for(pos++; pos < end && IsDigit(*pos); pos++)
+        {
+            hasDigits = true;
+            if(mantissa == 0 && *pos == '0') { exponent--; continue; }
+            if(significantDigits < 19) { mantissa = mantissa * 10 + (*pos - '0'); significantDigits++; exponent--; }
+            else isExact = false;
+        }
+    }
+
+    //exponent is taken only if it has digits, "1e" is read as 1 as strtod does
+    if(hasDigits && pos < end && (*pos == 'e' || *pos == 'E'))
+    {
+        const char* expPos = pos + 1;
+        bool isExpNegative = false;
+        bool isExpOverflow = false;
+        unsigned long expValue = 0;
+        if(ScanSignedDecimal(expPos, end, isExpNegative, expValue, isExpOverflow, false))
+        {
+            if(expValue > 100000) expValue = 100000;   //it is inf or 0 anyway
+            exponent += isExpNegative ? -static_cast<int>(expValue) : static_cast<int>(expValue);
+            pos = expPos;
+        }
+    }
+
+    //Fast path: mantissa and 10^exponent are both exact doubles so one multiplication or division is correctly rounded
+    if(hasDigits && isExact && IsBlankTail(pos, end) && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22)
+    {
+        if(result) *result = true;
+        double value = static_cast<double>(mantissa);
+        value = exponent < 0 ? value / cExactPowersOf10[-exponent] : value * cExactPowersOf10[exponent];
+        return isNegative ? -value : value;
+    }
+
+    //Slow path: strtod needs null terminated string
+    string copy(source, length);
+    char* strtodEnd = NULL;
+    double value = strtod(copy.c_str(), &strtodEnd);
+    if(result)
+    {
+        *result = strtodEnd != copy.c_str() && IsBlankTail(strtodEnd, copy.c_str() + copy.size());
+    }
+    return value;
+}
+
+
 //______________________________________________________________________________
 int ccdb::StringUtils::ParseInt( const string& source, bool *result/*=NULL*/  )
 {
-    return atoi(source.c_str()); //ugly isn't it?
+    long value = ParseLong(source.data(), source.size(), result);
+    if(value >= INT_MIN && value <= INT_MAX) return static_cast<int>(value);
+
+    if(result) *result = false;
+    return value < 0 ? INT_MIN : INT_MAX;
 }
 
 
 //______________________________________________________________________________
 unsigned int ccdb::StringUtils::ParseUInt( const string& source, bool *result/*=NULL*/  )
 {
-    return static_cast<unsigned int>(atoi(source.c_str())); //ugly isn't it?
+    //negative values are taken modulo 2^32, as strtoul does
+    long value = ParseLong(source.data(), source.size(), result);
+    if(value >= -static_cast<long>(UINT_MAX) && value <= static_cast<long>(UINT_MAX)) return static_cast<unsigned int>(value);
+
+    if(result) *result = false;
+    return UINT_MAX;
 }
 
 
 //______________________________________________________________________________
 long ccdb::StringUtils::ParseLong( const string& source, bool *result/*=NULL*/  )
 {
-    return atol(source.c_str()); //ugly isn't it?
+    return ParseLong(source.data(), source.size(), result);
 }
 
 
 //______________________________________________________________________________
 unsigned long ccdb::StringUtils::ParseULong( const string& source, bool *result/*=NULL*/  )
 {
-    return static_cast<unsigned long>(atol(source.c_str())); //ugly isn't it?
+    return ParseULong(source.data(), source.size(), result);
 }
 
 
 //______________________________________________________________________________
 bool ccdb::StringUtils::ParseBool( const string& source, bool *result/*=NULL*/  )
 {
-    if(source=="true") return true;
-    if(source=="false") return false;
+    if(source=="true") { if(result) *result = true; return true; }
+    if(source=="false") { if(result) *result = true; return false; }
 
-    return static_cast<bool>(atoi(source.c_str())!=0); //ugly isn't it?
+    return ParseLong(source.data(), source.size(), result) != 0;
 }
 
 //___________________________________________________________________________________
 double ccdb::StringUtils::ParseDouble( const string& source, bool *result/*=NULL*/  )
 {
-    return atof(source.c_str()); //ugly isn't it?
+    return ParseDouble(source.data(), source.size(), result);
 }
 
 //_______________________________________________________________________________________
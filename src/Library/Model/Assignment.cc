@@ -6,6 +6,8 @@
  */
 #include <vector>
 #include <sstream>
+#include <stdexcept>
+#include <unordered_set>
 #include <assert.h>
 
 #include "CCDB/Model/Assignment.h"
@@ -15,12 +17,15 @@
 using namespace ccdb;
 using namespace std;
 
+//Blob of 4MB is roughly 400k cells. Below that threads cost more than they give
+size_t ccdb::Assignment::mParallelDecodingThreshold = 4*1024*1024;
+
 
 //______________________________________________________________________________
 ccdb::Assignment::Assignment( ObjectsOwner * owner/*=NULL*/, DataProvider *provider/*=NULL*/ )
 :StoredObject(owner, provider)
 {
-	mRawData = string(); 	// data blob
+	mBlob = BlobPool::Empty();	// data blob
 	mId=0;					// id in database
 	mDataBlobId   = 0;		// blob id in database
 	mVariationId  = 0;		// database ID of variation
@@ -28,6 +33,7 @@ ccdb::Assignment::Assignment( ObjectsOwner * owner/*=NULL*/, DataProvider *provi
 	mDataVaultId  = 0;		// database ID of data blob
 	mEventRangeId = 0;		// event range ID
 	mRequestedRun = 0;		// Run than was requested for user
+	mIsDataReadOnly = false; // data can be set
 
 	mRunRange   = NULL;		// Run range object, is NULL if not set
 	mEventRange = NULL;		// Event range object, is NULL if not set
@@ -269,6 +275,168 @@ void ccdb::Assignment::GetData(std::vector<std::vector<std::string> >& data) con
 }
 
 
+//______________________________________________________________________________
+void ccdb::Assignment::GetData(std::vector<std::vector<std::string> >& data, const vector<int>& columnIndexes) const
+{
+	data.clear();
+	if(mTypeTable == NULL || mTypeTable->GetColumnsCount() <= 0)
+	{
+		//WARNING table type not loaded
+		return;
+	}
+
+	size_t columnsCount = mTypeTable->GetColumnsCount();
+	size_t rowsCount = mBlob->Cells.size() / columnsCount;
+	data.resize(rowsCount);
+	for (size_t rowIter = 0; rowIter < rowsCount; rowIter++)
+	{
+		data[rowIter].reserve(columnIndexes.size());
+		for (size_t i = 0; i < columnIndexes.size(); i++)
+		{
+			data[rowIter].push_back(mBlob->Cells[rowIter*columnsCount + columnIndexes[i]]);
+		}
+	}
+}
+
+
+//______________________________________________________________________________
+int ccdb::Assignment::GetColumnIndex(const string& columnName) const
+{
+	if(mTypeTable == NULL) return -1;
+	return mTypeTable->GetColumnIndex(columnName);
+}
+
+
+//______________________________________________________________________________
+const string& ccdb::Assignment::RowView::at(const string& columnName) const
+{
+	int columnIndex = mAssignment->GetColumnIndex(columnName);
+	if(columnIndex < 0) throw std::out_of_range("Assignment has no column '" + columnName + "'");
+	return mAssignment->GetCell(mRowIndex, columnIndex);
+}
+
+
+//______________________________________________________________________________
+const string& ccdb::Assignment::RowView::at(StringPool::Handle columnName) const
+{
+	const vector<ConstantsTypeColumn *>& columns = mAssignment->GetTypeTable()->GetColumns();
+	for (size_t i = 0; i < columns.size(); i++)
+	{
+		if(columns[i]->GetNameHandle() == columnName) return mAssignment->GetCell(mRowIndex, i);
+	}
+	throw std::out_of_range("Assignment has no column '" + (columnName ? *columnName : string()) + "'");
+}
+
+
+//______________________________________________________________________________
+const ccdb::Assignment::RowIndex& ccdb::Assignment::GetRowIndex(size_t keyColumnIndex)
+{
+	std::lock_guard<std::mutex> lock(mRowIndexesMutex);
+
+	std::map<size_t, RowIndex>::iterator found = mRowIndexes.find(keyColumnIndex);
+	if(found != mRowIndexes.end()) return found->second;
+
+	//build it
+	RowIndex& index = mRowIndexes[keyColumnIndex];
+	size_t columnsCount = GetColumnsCount();
+	if(columnsCount == 0 || keyColumnIndex >= columnsCount) return index;
+
+	size_t rowsCount = mBlob->Cells.size() / columnsCount;
+	index.reserve(rowsCount);
+	for (size_t rowIter = 0; rowIter < rowsCount; rowIter++)
+	{
+		index.insert(RowIndex::value_type(mBlob->Cells[rowIter*columnsCount + keyColumnIndex], rowIter));
+	}
+	return index;
+}
+
+
+//______________________________________________________________________________
+int ccdb::Assignment::Lookup(size_t keyColumnIndex, const string& key)
+{
+	const RowIndex& index = GetRowIndex(keyColumnIndex);
+	RowIndex::const_iterator found = index.find(key);
+	if(found == index.end()) return -1;
+	return static_cast<int>(found->second);
+}
+
+
+//______________________________________________________________________________
+const ccdb::Assignment::IntRowIndex& ccdb::Assignment::GetIntRowIndex(size_t keyColumnIndex)
+{
+	std::lock_guard<std::mutex> lock(mRowIndexesMutex);
+
+	std::map<size_t, IntRowIndex>::iterator found = mIntRowIndexes.find(keyColumnIndex);
+	if(found != mIntRowIndexes.end()) return found->second;
+
+	//build it
+	IntRowIndex& index = mIntRowIndexes[keyColumnIndex];
+	size_t columnsCount = GetColumnsCount();
+	if(columnsCount == 0 || keyColumnIndex >= columnsCount) return index;
+
+	size_t rowsCount = mBlob->Cells.size() / columnsCount;
+	index.reserve(rowsCount);
+	for (size_t rowIter = 0; rowIter < rowsCount; rowIter++)
+	{
+		bool isParsed = false;
+		long key = StringUtils::ParseLong(mBlob->Cells[rowIter*columnsCount + keyColumnIndex], &isParsed);
+		if(isParsed) index.insert(IntRowIndex::value_type(key, rowIter));
+	}
+	return index;
+}
+
+
+//______________________________________________________________________________
+int ccdb::Assignment::Lookup(size_t keyColumnIndex, long key)
+{
+	const IntRowIndex& index = GetIntRowIndex(keyColumnIndex);
+	IntRowIndex::const_iterator found = index.find(key);
+	if(found == index.end()) return -1;
+	return static_cast<int>(found->second);
+}
+
+
+//______________________________________________________________________________
+const vector<ccdb::StringPool::Handle>& ccdb::Assignment::GetColumnHandles(size_t columnIndex)
+{
+	std::lock_guard<std::mutex> lock(mRowIndexesMutex);
+
+	std::map<size_t, vector<StringPool::Handle> >::iterator found = mColumnHandles.find(columnIndex);
+	if(found != mColumnHandles.end()) return found->second;
+
+	//make it
+	vector<StringPool::Handle>& handles = mColumnHandles[columnIndex];
+	size_t columnsCount = GetColumnsCount();
+	if(columnsCount == 0 || columnIndex >= columnsCount) return handles;
+
+	size_t rowsCount = mBlob->Cells.size() / columnsCount;
+
+	//interned strings live until the process ends, columns of many values would grow the pool with every assignment
+	const vector<ConstantsTypeColumn *>& columns = mTypeTable->GetColumns();
+	bool isDeclared = columnIndex < columns.size() && columns[columnIndex]->IsLowCardinality();
+	if(!isDeclared)
+	{
+		ConstantsTypeColumn::ColumnTypes type = columnIndex < columns.size() ? columns[columnIndex]->GetType() : ConstantsTypeColumn::cDoubleColumn;
+		if(type != ConstantsTypeColumn::cStringColumn && type != ConstantsTypeColumn::cBoolColumn) return handles;
+
+		std::unordered_set<string> distinctCells;
+		for (size_t rowIter = 0; rowIter < rowsCount && distinctCells.size() <= cMaxDetectedDistinctCells; rowIter++)
+		{
+			distinctCells.insert(mBlob->Cells[rowIter*columnsCount + columnIndex]);
+		}
+		if(distinctCells.size() > cMaxDetectedDistinctCells) return handles;
+	}
+
+	handles.reserve(rowsCount);
+	StringPool& pool = StringPool::Instance();
+	for (size_t rowIter = 0; rowIter < rowsCount; rowIter++)
+	{
+		handles.push_back(pool.Intern(mBlob->Cells[rowIter*columnsCount + columnIndex]));
+	}
+	return handles;
+}
+
+
 //______________________________________________________________________________
 string ccdb::Assignment::DecodeBlobSeparator(string str)
 {
@@ -297,58 +465,95 @@ vector<string> ccdb::Assignment::GetVectorData() const
 //______________________________________________________________________________
 void ccdb::Assignment::GetVectorData(vector<string>& vectorData) const
 {
-	//split data
-	vectorData.clear();
-	vector<string>::const_iterator iter = mVectorData.begin();
-	while (iter<mVectorData.end())
-	{	
-		vectorData.push_back(DecodeBlobSeparator(*iter));
-		iter++;
-	}
+	//blob separators are already decoded by SetRawData
+	vectorData = mBlob->Cells;
 }
 
 //______________________________________________________________________________
-void ccdb::Assignment::SetRawData(std::string val)
+void ccdb::Assignment::SetRawData(const std::string& val)
 {
-	mVectorData.clear();
-	mRows.clear();
-	mRawData = val;
+	SetRawData(val.data(), val.size());
+}
 
-	mVectorData = StringUtils::Split(mRawData, CCDB_DATA_BLOB_DELIMETER);
-	for (size_t i = 0; i < mVectorData.size(); i++)
+//______________________________________________________________________________
+void ccdb::Assignment::SetRawData(const char* data, size_t length)
+{
+	ResetData();
+	if(data == NULL)
 	{
-		mVectorData[i] = DecodeBlobSeparator(mVectorData[i]); //Decode blob separators
+		data = "";
+		length = 0;
 	}
+
+	//identical blob may be decoded already
+	uint64_t hash = BlobPool::Hash(data, length);
+	mBlob = BlobPool::Instance().Find(data, length, hash);
+	if(mBlob) return;
+
+	DecodedBlob* blob = new DecodedBlob();
+	blob->RawData.assign(data, length);
+	blob->Hash = hash;
+
+	//split and decode blob separators in one pass
+	if(mParallelDecodingThreshold && blob->RawData.size() > mParallelDecodingThreshold)
+	{
+		StringUtils::SplitBlobParallel(blob->RawData.data(), blob->RawData.size(), blob->Cells);
+	}
+	else
+	{
+		StringUtils::SplitBlob(blob->RawData, blob->Cells);
+	}
+	mBlob = BlobPool::Instance().Add(blob);
+}
+
+//______________________________________________________________________________
+void ccdb::Assignment::SetRawData(const std::string& rawData, vector<string>&& cells)
+{
+	ResetData();
+	uint64_t hash = BlobPool::Hash(rawData.data(), rawData.size());
+	mBlob = BlobPool::Instance().Find(rawData.data(), rawData.size(), hash);
+	if(mBlob) return;
+
+	DecodedBlob* blob = new DecodedBlob();
+	blob->RawData = rawData;
+	blob->Cells = std::move(cells);
+	blob->Hash = hash;
+	mBlob = BlobPool::Instance().Add(blob);
+}
+
+//______________________________________________________________________________
+void ccdb::Assignment::ResetData()
+{
+	//other threads may hold references to the blob cells and the indexes
+	if(mIsDataReadOnly) throw std::logic_error("Assignment::SetRawData. The data of the assignment is read only");
+
+	std::lock_guard<std::mutex> lock(mRowIndexesMutex);
+	mRowIndexes.clear();
+	mIntRowIndexes.clear();
+	mColumnHandles.clear();
 }
 
 std::string ccdb::Assignment::GetValue(string columnName)
 {
-	if (mRows.size() == 0)
-	{
-		//fill data
-		MapData(mRows, GetVectorData(), mTypeTable->GetColumnNames());
-	}
-	return mRows[0][columnName];
+	return GetValue(0, columnName);
 }
 
 std::string ccdb::Assignment::GetValue(size_t rowIndex, string columnName)
 {
-	if (mRows.size() == 0)
-	{
-		//fill data
-		MapData(mRows, GetVectorData(), mTypeTable->GetColumnNames());
-	}
-	return GetMappedData()[0][columnName];
+	//the cell is taken by the column index, rows are not mapped by names
+	int columnIndex = GetColumnIndex(columnName);
+	if (columnIndex < 0 || (rowIndex + 1) * GetColumnsCount() > mBlob->Cells.size()) return string();
+	return GetCell(rowIndex, columnIndex);
 }
 
 std::string ccdb::Assignment::GetValue(size_t rowIndex, size_t columnIndex)
 {
-	return GetData()[rowIndex][columnIndex];
+	return GetCell(rowIndex, columnIndex);
 }
 
 std::string ccdb::Assignment::GetValue(size_t columnIndex)
 {
-	return GetVectorData()[columnIndex];
+	return mBlob->Cells[columnIndex];
 }
 
 ConstantsTypeColumn::ColumnTypes ccdb::Assignment::GetValueType(const string& columnName)
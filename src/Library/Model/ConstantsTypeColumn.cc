@@ -11,6 +11,8 @@ ConstantsTypeColumn::ConstantsTypeColumn( ObjectsOwner * owner/*=NULL*/, DataPro
 StoredObject(owner, provider)
 {
 	mId = 0;			//database table uniq id;
+	mNameHandle = StringPool::Instance().Intern(mName);
+	mIsLowCardinality = false;
 
 	mCreatedTime = 0;	//mCreatedTime time
 	mModifiedTime = 0;	//mModifiedTime time
@@ -78,6 +80,8 @@ std::string ConstantsTypeColumn::GetName() const
 void ConstantsTypeColumn::SetName( std::string val )
 {
 	mName = val;
+	mNameHandle = StringPool::Instance().Intern(mName);
+	if(mTypeTable) mTypeTable->IndexColumns();
 }
 
 std::string ConstantsTypeColumn::GetComment() const
@@ -90,6 +90,7 @@ void ConstantsTypeTable::AddColumn( ConstantsTypeColumn *col, int order )
 		mColumns.push_back(col);
 	}
 	col->SetTypeTable(this);
+	IndexColumns();
 }
 
 void ConstantsTypeTable::AddColumn( ConstantsTypeColumn *col )
@@ -97,6 +98,7 @@ void ConstantsTypeTable::AddColumn( ConstantsTypeColumn *col )
 	mColumns.push_back(col);
 	col->SetOrder(mColumns.size()-1);
 	col->SetTypeTable(this);
+	IndexColumns();
 }
 
 void ConstantsTypeTable::AddColumn( const std::string& name, const std::string& type )
@@ -130,6 +132,7 @@ ConstantsTypeColumn * ConstantsTypeTable::RemoveColumn( int order )
 	vector<ConstantsTypeColumn *>::iterator it= mColumns.begin();
 	ConstantsTypeColumn *col = *it;
 	mColumns.erase(it + order);
+	IndexColumns();
 	return *it;
 
 }
@@ -258,6 +261,23 @@ void ConstantsTypeTable::SetName(const string& name)
 	void ConstantsTypeTable::ClearColumns()
 	{
 		mColumns.clear();
+		mColumnIndexes.clear();
+	}
+
+	int ConstantsTypeTable::GetColumnIndex( const string& name ) const
+	{
+		unordered_map<string, int>::const_iterator found = mColumnIndexes.find(name);
+		return found == mColumnIndexes.end() ? -1 : found->second;
+	}
+
+	void ConstantsTypeTable::IndexColumns()
+	{
+		//if names repeat, the first column is found as before
+		mColumnIndexes.clear();
+		for (size_t i = 0; i < mColumns.size(); i++)
+		{
+			mColumnIndexes.insert(make_pair(*mColumns[i]->GetNameHandle(), (int)i));
+		}
 	}
 
 	int ConstantsTypeTable::GetNColumnsFromDB() const
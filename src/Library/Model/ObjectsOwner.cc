@@ -9,18 +9,14 @@ ObjectsOwner::ObjectsOwner()
 
 ObjectsOwner::~ObjectsOwner()
 {
-	//delete owned objects
-	if(mOwnedObjects.size()>0)	//do we need to delete objects?
+	//delete owned objects. Deleted objects may release other objects of the list,
+	//so the list is taken from the end every time
+	while(!mOwnedObjects.empty())
 	{
-
-		//iterate through list and delete
-		map<unsigned long, StoredObject *>::iterator it = mOwnedObjects.begin();
-		while(it != mOwnedObjects.end())
-		{
-			StoredObject *obj = it->second;
-			mOwnedObjects.erase(it++);
-			delete obj;
-		}
+		StoredObject *obj = mOwnedObjects.back();
+		mOwnedObjects.pop_back();
+		obj->mOwnerIndex = NotOwnedIndex;
+		delete obj;
 	}
 }
 
@@ -37,26 +33,36 @@ void ObjectsOwner::BeOwner( StoredObject * object )
 	else
 	{
 		//if we are here the only need is to add object to a list
-		mOwnedObjects[object->GetTempUID()]=object;
+		size_t index = object->mOwnerIndex;
+		if(index < mOwnedObjects.size() && mOwnedObjects[index] == object) return;
+
+		//assignments own a run range and a variation, so the first allocation fits them
+		if(mOwnedObjects.capacity() == 0) mOwnedObjects.reserve(4);
+
+		object->mOwnerIndex = mOwnedObjects.size();
+		mOwnedObjects.push_back(object);
 	}
 }
 
 void ObjectsOwner::ReleaseOwnership( StoredObject * object )
 {
-	//get iterator
-	map<unsigned long, StoredObject *>::iterator it=mOwnedObjects.find(object->GetTempUID());
+	size_t index = object->mOwnerIndex;
 
 	//if it is found
-	if(it!=mOwnedObjects.end())
+	if(index < mOwnedObjects.size() && mOwnedObjects[index] == object)
 	{	
 		//check and release
-		if(it->second->GetOwner() == this && it->second->GetIsOwned())
+		if(object->GetOwner() == this && object->GetIsOwned())
 		{
-			it->second->SetOwner(this, false);
+			object->SetOwner(this, false);
 		}
 
-		//delete from the list
-		mOwnedObjects.erase(it);
+		//delete from the list. The last object takes its place
+		StoredObject *last = mOwnedObjects.back();
+		mOwnedObjects[index] = last;
+		last->mOwnerIndex = index;
+		mOwnedObjects.pop_back();
+		object->mOwnerIndex = NotOwnedIndex;
 	}
 }
 
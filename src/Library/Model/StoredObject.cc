@@ -1,14 +1,16 @@
 #include "CCDB/Model/StoredObject.h"
 #include "CCDB/Providers/DataProvider.h"
+#include "CCDB/Model/ObjectsOwner.h"
 
 using namespace ccdb;
 //class DDataProvider;
 
-unsigned long ccdb::StoredObject::mLastTempId=0;
+std::atomic<unsigned long> ccdb::StoredObject::mLastTempId(0);
 
 ccdb::StoredObject::StoredObject( ObjectsOwner * owner/*=NULL*/, DataProvider *provider/*=NULL*/ )
 {
 	mOwner = NULL;
+	mOwnerIndex = ObjectsOwner::NotOwnedIndex;
 	mTempId = ++mLastTempId;
 	mProvider = provider;
 	SetOwner(owner, owner!=NULL);
@@ -93,6 +93,28 @@ bool MySQLCalibration::Connect( std::string connectionString )
     }
 
     bool result = mProvider->Connect(connectionString);
+
+    //Read connections for parallel GetAssignment are made only if ?pool=N with N > 1 is given:
+    //each is a connection to the server, one is the main provider already.
+    //With replicas the main provider has a connection per replica and reads them in parallel,
+    //a pool would make a replica set for each of its providers
+    if(result)
+    {
+        MySQLConnectionInfo connection;
+        MySQLDataProvider::ParseConnectionString(connectionString, connection);
+        bool isPoolNeeded = connection.PoolSize > 1 && connection.ReplicaHosts.empty();
+
+        if(mReadPool == NULL && isPoolNeeded)
+        {
+            mReadPool = new DataProviderPool(connectionString, [](){ return new MySQLDataProvider(); }, connection.PoolSize);
+        }
+        else if(mReadPool)
+        {
+            //providers of the pool own assignments users may hold, so the pool is kept. One connection is like no pool
+            mReadPool->SetConnectionString(connectionString);
+            mReadPool->SetMaxSize(isPoolNeeded ? connection.PoolSize : 1);
+        }
+    }
     Unlock();
     return result;
     //TODO decide maybe to throw an exception here?
@@ -116,7 +138,9 @@ void MySQLCalibration::Disconnect()
         throw std::logic_error(ERRMSG_CONNECT_LOCKED); //TODO ERRMSG_DISCONECT_LOCKED
     }
 
+    WaitForRefreshes();
     mProvider->Disconnect();
+    if(mReadPool) mReadPool->Disconnect();
 }
 
 
@@ -0,0 +1,105 @@
+#include <stdexcept>
+
+#include "CCDB/ProviderCalibration.h"
+
+namespace ccdb
+{
+
+
+//______________________________________________________________________________
+ProviderCalibration::ProviderCalibration( ProviderFactory factory )
+    :mFactory(factory)
+{	
+}
+
+//______________________________________________________________________________
+ProviderCalibration::ProviderCalibration( ProviderFactory factory, int defaultRun, string defaultVariation/*="default"*/ , time_t defaultTime/*=0*/ )
+    :Calibration(defaultRun,defaultVariation, defaultTime),
+    mFactory(factory)
+{
+}
+
+
+//______________________________________________________________________________
+ProviderCalibration::~ProviderCalibration()
+{   
+}
+
+
+//______________________________________________________________________________
+bool ProviderCalibration::Connect( std::string connectionString )
+{
+    /**
+	 * @brief Connects the provider, makes it by the factory if needed
+	 * 
+	 * @param connectionString the connection string of the provider
+	 * @return true if connected
+	 */
+    Lock();
+
+    UpdateActivityTime();
+
+    //Create provider if needed
+    if(mProvider == NULL)
+    {
+        if(!mProviderIsLocked)
+        {
+            mProvider = mFactory();
+        }
+        else
+        {
+            Unlock();
+            throw std::logic_error((const char*)ERRMSG_INVALID_CONNECT_USAGE);
+        }
+    }
+
+    //Maybe we are connected?
+    if(mProvider->IsConnected())
+    {
+        Unlock();
+
+        //But where we connected to?
+        if(mProvider->GetConnectionString() == connectionString)
+        {   
+            return true;
+        }
+        else
+        {
+            throw std::logic_error(ERRMSG_CONNECTED_TO_ANOTHER);
+        }
+    }
+
+    if(mProviderIsLocked)
+    {
+        Unlock();
+        throw std::logic_error(ERRMSG_CONNECT_LOCKED);
+    }
+
+    //The providers are fast by themselves or serve all readers of the node, so no read pool is used
+    bool result = mProvider->Connect(connectionString);
+    Unlock();
+    return result;
+}
+
+
+//______________________________________________________________________________
+void ProviderCalibration::Disconnect()
+{
+    if(mProviderIsLocked)
+    {
+        throw std::logic_error(ERRMSG_CONNECT_LOCKED);
+    }
+
+    WaitForRefreshes();
+    mProvider->Disconnect();
+}
+
+
+//______________________________________________________________________________
+bool ProviderCalibration::IsConnected()
+{
+    if(mProvider==NULL) return false;
+    return mProvider->IsConnected();
+}
+
+}
@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <map>
+#include <vector>
+#include <stdexcept>
+#include <sqlite3.h>
+
+#include "CCDB/Providers/ArchiveSplitter.h"
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+
+namespace
+{
+    /** Closes the database when goes out of scope */
+    class DatabaseHolder
+    {
+    public:
+        DatabaseHolder(): Database(NULL) {}
+        ~DatabaseHolder() { if(Database) sqlite3_close(Database); }
+
+        sqlite3* Database;
+    };
+
+
+    void Open(DatabaseHolder& holder, const string& path, int flags)
+    {
+        if(sqlite3_open_v2(path.c_str(), &holder.Database, flags, NULL) != SQLITE_OK)
+        {
+            throw std::logic_error("Can't open SQLite file '" + path + "': " + string(sqlite3_errmsg(holder.Database)));
+        }
+    }
+
+
+    void Execute(sqlite3* database, const string& query)
+    {
+        char* message = NULL;
+        if(sqlite3_exec(database, query.c_str(), NULL, NULL, &message) != SQLITE_OK)
+        {
+            string error = message ? message : "unknown error";
+            sqlite3_free(message);
+            throw std::logic_error("SQLite query '" + query + "' failed: " + error);
+        }
+    }
+
+
+    /** Copies the whole database by backup API */
+    void Copy(sqlite3* source, const string& targetPath)
+    {
+        remove(targetPath.c_str());
+
+        DatabaseHolder target;
+        Open(target, targetPath, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+
+        sqlite3_backup* backup = sqlite3_backup_init(target.Database, "main", source, "main");
+        int result = SQLITE_ERROR;
+        if(backup)
+        {
+            sqlite3_backup_step(backup, -1);
+            result = sqlite3_backup_finish(backup);
+        }
+        if(result != SQLITE_OK)
+        {
+            throw std::logic_error("Can't copy database to '" + targetPath + "': " + string(sqlite3_errmsg(target.Database)));
+        }
+    }
+
+
+    /** Runs covered by newer assignments of one table and variation. Intervals don't overlap and don't touch */
+    class CoveredRuns
+    {
+    public:
+
+        bool IsCovered(int runMin, int runMax) const
+        {
+            map<long long, long long>::const_iterator it = mIntervals.upper_bound(runMin);
+            if(it == mIntervals.begin()) return false;
+            --it;
+            return it->second >= runMax;
+        }
+
+        void Add(int runMin, int runMax)
+        {
+            long long first = runMin;
+            long long last = runMax;
+
+            //merge intervals that overlap or touch the new one
+            map<long long, long long>::iterator it = mIntervals.upper_bound(first);
+            if(it != mIntervals.begin())
+            {
+                --it;
+                if(it->second + 1 < first) ++it;
+            }
+            while(it != mIntervals.end() && it->first <= last + 1)
+            {
+                if(it->first < first) first = it->first;
+                if(it->second > last) last = it->second;
+                mIntervals.erase(it++);
+            }
+            mIntervals[first] = last;
+        }
+
+    private:
+        map<long long, long long> mIntervals;   // run min -> run max
+    };
+}
+
+
+//______________________________________________________________________________
+ccdb::ArchiveSplitter::ArchiveSplitter()
+    :mRunMin(0),
+    mRunMax(INFINITE_RUN),
+    mAssignmentsCount(0),
+    mMovedAssignmentsCount(0),
+    mMovedConstantSetsCount(0)
+{
+}
+
+
+//______________________________________________________________________________
+void ccdb::ArchiveSplitter::SetRunWindow( int runMin, int runMax )
+{
+    if(runMin > runMax) throw std::logic_error(StringUtils::Format("Wrong run window %i-%i", runMin, runMax));
+    mRunMin = runMin;
+    mRunMax = runMax;
+}
+
+
+//______________________________________________________________________________
+void ccdb::ArchiveSplitter::Split( const std::string& sourcePath, const std::string& hotPath, const std::string& archivePath )
+{
+    if(hotPath == sourcePath || archivePath == sourcePath || hotPath == archivePath)
+    {
+        throw std::logic_error("Source, hot and archive files should be different files");
+    }
+
+    //both files start as copies of the source
+    {
+        DatabaseHolder source;
+        Open(source, sourcePath, SQLITE_OPEN_READONLY);
+        Copy(source.Database, archivePath);
+        Copy(source.Database, hotPath);
+    }
+
+    DatabaseHolder hot;
+    Open(hot, hotPath, SQLITE_OPEN_READWRITE);
+
+    //newest assignments go first, so older ones are checked against runs of the newer
+    sqlite3_stmt* statement = NULL;
+    int result = sqlite3_prepare_v2(hot.Database,
+        "SELECT `assignments`.`id`, `assignments`.`variationId`, `constantSets`.`constantTypeId`, `runRanges`.`runMin`, `runRanges`.`runMax` "
+        "FROM `assignments` "
+        "INNER JOIN `runRanges` ON `assignments`.`runRangeId` = `runRanges`.`id` "
+        "INNER JOIN `constantSets` ON `assignments`.`constantSetId` = `constantSets`.`id` "
+        "ORDER BY `assignments`.`id` DESC", -1, &statement, 0);
+    if(result != SQLITE_OK) throw std::logic_error("Can't select assignments: " + string(sqlite3_errmsg(hot.Database)));
+
+    map<pair<sqlite3_int64, sqlite3_int64>, CoveredRuns> coveredRuns;   // (table, variation) -> runs
+    vector<sqlite3_int64> movedIds;
+    mAssignmentsCount = 0;
+    while((result = sqlite3_step(statement)) == SQLITE_ROW)
+    {
+        mAssignmentsCount++;
+        sqlite3_int64 id = sqlite3_column_int64(statement, 0);
+        CoveredRuns& covered = coveredRuns[make_pair(sqlite3_column_int64(statement, 2), sqlite3_column_int64(statement, 1))];
+        int runMin = sqlite3_column_int(statement, 3);
+        int runMax = sqlite3_column_int(statement, 4);
+
+        int windowMin = runMin > mRunMin ? runMin : mRunMin;
+        int windowMax = runMax < mRunMax ? runMax : mRunMax;
+        if(windowMin > windowMax || covered.IsCovered(windowMin, windowMax)) movedIds.push_back(id);
+
+        covered.Add(runMin, runMax);
+    }
+    sqlite3_finalize(statement);
+    if(result != SQLITE_DONE) throw std::logic_error("Can't select assignments: " + string(sqlite3_errmsg(hot.Database)));
+
+    Execute(hot.Database, "BEGIN");
+    Execute(hot.Database, "CREATE TEMP TABLE `movedAssignments` (`id` INTEGER PRIMARY KEY)");
+    result = sqlite3_prepare_v2(hot.Database, "INSERT INTO `movedAssignments` (`id`) VALUES (?1)", -1, &statement, 0);
+    for(size_t i = 0; result == SQLITE_OK && i < movedIds.size(); i++)
+    {
+        sqlite3_bind_int64(statement, 1, movedIds[i]);
+        result = sqlite3_step(statement) == SQLITE_DONE ? SQLITE_OK : SQLITE_ERROR;
+        sqlite3_reset(statement);
+    }
+    sqlite3_finalize(statement);
+    if(result != SQLITE_OK) throw std::logic_error("Can't list moved assignments: " + string(sqlite3_errmsg(hot.Database)));
+
+    Execute(hot.Database, "DELETE FROM `assignments` WHERE `id` IN (SELECT `id` FROM `movedAssignments`)");
+    mMovedAssignmentsCount = (size_t)sqlite3_changes(hot.Database);
+    Execute(hot.Database, "DELETE FROM `constantSets` WHERE `id` NOT IN (SELECT `constantSetId` FROM `assignments`)");
+    mMovedConstantSetsCount = (size_t)sqlite3_changes(hot.Database);
+
+    Execute(hot.Database, "DROP TABLE IF EXISTS `archiveWindow`");
+    Execute(hot.Database, "CREATE TABLE `archiveWindow` (`runMin` INTEGER NOT NULL, `runMax` INTEGER NOT NULL)");
+    Execute(hot.Database, StringUtils::Format("INSERT INTO `archiveWindow` (`runMin`, `runMax`) VALUES (%i, %i)", mRunMin, mRunMax));
+    Execute(hot.Database, "COMMIT");
+
+    //give the space of moved constants back
+    Execute(hot.Database, "VACUUM");
+}
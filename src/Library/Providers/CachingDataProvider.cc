@@ -0,0 +1,834 @@
+#include <stdlib.h>
+
+#include "CCDB/Providers/CachingDataProvider.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#ifdef CCDB_MYSQL
+#include "CCDB/Providers/MySQLDataProvider.h"
+#endif
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Helpers/TimeProvider.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+
+namespace
+{
+	/** Tables of the cache file. Entries of different remotes are kept apart by the remote key */
+	const char* const CacheFileSchema =
+		"CREATE TABLE IF NOT EXISTS cachedTables ("
+		" remote TEXT NOT NULL, path TEXT NOT NULL, nRows INTEGER, comment TEXT, columnNames TEXT, columnTypes TEXT,"
+		" PRIMARY KEY(remote, path));"
+		"CREATE TABLE IF NOT EXISTS cachedAssignments ("
+		" remote TEXT NOT NULL, request TEXT NOT NULL, fetched INTEGER, id INTEGER, created INTEGER, modified INTEGER,"
+		" comment TEXT, dataVaultId INTEGER, hasRelations INTEGER, runRangeId INTEGER, runRangeName TEXT, runMin INTEGER,"
+		" runMax INTEGER, variationId INTEGER, variationName TEXT, data TEXT, firstRun INTEGER, lastRun INTEGER,"
+		" PRIMARY KEY(remote, request, firstRun));";
+
+	/** Version of the cache file tables. Entries of version 1 were kept for one run and are dropped */
+	const int CacheFileVersion = 2;
+
+	/** Milliseconds to wait while another process of the node writes the cache file */
+	const int CacheFileBusyTimeout = 5000;
+
+	/** The connection string may have a password, so only its hash is written to the file */
+	string HashConnectionString(const string& str)
+	{
+		return ccdb::StringUtils::Format("%016llx", (unsigned long long)ccdb::StringUtils::Hash64(str));
+	}
+
+	string ColumnText(sqlite3_stmt* statement, int column)
+	{
+		const unsigned char* text = sqlite3_column_text(statement, column);
+		return text ? string((const char*)text, sqlite3_column_bytes(statement, column)) : string();
+	}
+
+	string JoinColumns(const vector<string>& values)
+	{
+		string result;
+		for(size_t i = 0; i < values.size(); i++)
+		{
+			if(i) result += '|';
+			result += values[i];
+		}
+		return result;
+	}
+}
+
+#pragma region constructors
+
+ccdb::CachingDataProvider::CachingDataProvider(const string& cacheFilePath/*=""*/)
+{
+	mCacheFilePath = cacheFilePath;
+	if(mCacheFilePath.empty())
+	{
+		const char* envPath = getenv(CCDB_ENV_CACHE_FILE);
+		if(envPath) mCacheFilePath = envPath;
+	}
+
+	mRemote = NULL;
+	mMaxAge = 3600;
+	mCacheFile = NULL;
+	mSelectTable = NULL;
+	mInsertTable = NULL;
+	mSelectAssignment = NULL;
+	mInsertAssignment = NULL;
+	mDeleteAssignments = NULL;
+	mMemoryHits = 0;
+	mFileHits = 0;
+	mRemoteFetches = 0;
+}
+
+
+ccdb::CachingDataProvider::~CachingDataProvider(void)
+{
+	if(IsConnected())
+	{
+		Disconnect();
+	}
+}
+#pragma endregion constructors
+
+#pragma region Connection
+
+bool ccdb::CachingDataProvider::Connect( string connectionString )
+{
+	ClearErrors();
+
+	if(IsConnected())
+	{
+		Error(CCDB_ERROR_CONNECTION_ALREADY_OPENED, "CachingDataProvider::Connect", "Connection already opened");
+		return false;
+	}
+
+	if(connectionString.find("cache://") != 0)
+	{
+		Error(CCDB_ERROR_PARSE_CONNECTION_STRING, "CachingDataProvider::Connect", "Connection string should start with cache://");
+		return false;
+	}
+
+	string remoteString = connectionString.substr(8);
+	bool isKnownRemote = remoteString.find("sqlite://") == 0;
+#ifdef CCDB_MYSQL
+	isKnownRemote = isKnownRemote || remoteString.find("mysql://") == 0;
+#endif
+	if(!isKnownRemote)
+	{
+		Error(CCDB_ERROR_PARSE_CONNECTION_STRING, "CachingDataProvider::Connect", "Remote should be sqlite:// or mysql:// connection string. It is: '" + remoteString + "'");
+		return false;
+	}
+
+	mRemoteConnectionString = remoteString;
+	mRemoteKey = HashConnectionString(remoteString);
+
+	//without the cache file constants are still cached in memory
+	if(!mCacheFilePath.empty()) OpenCacheFile();
+
+	mIsConnected = true;
+	mConnectionString = connectionString;
+	return true;
+}
+
+
+void ccdb::CachingDataProvider::Disconnect()
+{
+	if(!IsConnected()) return;
+
+	CloseCacheFile();
+	mAssignments.clear();
+	ClearCatalog();
+
+	if(mRemote)
+	{
+		mRemote->Disconnect();
+		delete mRemote;
+		mRemote = NULL;
+	}
+	mIsConnected = false;
+}
+
+
+ccdb::DataProvider* ccdb::CachingDataProvider::GetRemote( const string& errorSource )
+{
+	if(!CheckConnection(errorSource)) return NULL;
+	if(mRemote) return mRemote;
+
+	DataProvider* remote;
+#ifdef CCDB_MYSQL
+	if(mRemoteConnectionString.find("mysql://") == 0)
+	{
+		remote = new MySQLDataProvider();
+	}
+	else
+#endif
+	{
+		remote = new SQLiteDataProvider();
+	}
+
+	if(!remote->Connect(mRemoteConnectionString))
+	{
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, errorSource, "Can't connect to the remote '" + mRemoteConnectionString + "'");
+		delete remote;
+		return NULL;
+	}
+
+	mRemote = remote;
+	return mRemote;
+}
+
+
+void ccdb::CachingDataProvider::CopyRemoteErrors()
+{
+	if(!mRemote) return;
+
+	//the remote has logged the messages already
+	const vector<int>& codes = mRemote->GetErrorCodes();
+	for(size_t i = 0; i < codes.size(); i++)
+	{
+		mErrorCodes.push_back(codes[i]);
+		mLastError = codes[i];
+	}
+}
+#pragma endregion Connection
+
+#pragma region Cache file
+
+bool ccdb::CachingDataProvider::OpenCacheFile()
+{
+	int result = sqlite3_open_v2(mCacheFilePath.c_str(), &mCacheFile, SQLITE_OPEN_READWRITE|SQLITE_OPEN_CREATE|SQLITE_OPEN_NOMUTEX|SQLITE_OPEN_PRIVATECACHE, NULL);
+	if(result != SQLITE_OK)
+	{
+		CacheFileWarning("CachingDataProvider::OpenCacheFile");
+		CloseCacheFile();
+		return false;
+	}
+
+	//many processes of the node read and write the file at the same time
+	sqlite3_busy_timeout(mCacheFile, CacheFileBusyTimeout);
+	sqlite3_exec(mCacheFile, "PRAGMA journal_mode = WAL;", NULL, 0, 0);
+
+	sqlite3_stmt* versionStatement = NULL;
+	int version = 0;
+	if(sqlite3_prepare_v2(mCacheFile, "PRAGMA user_version;", -1, &versionStatement, 0) == SQLITE_OK &&
+	   sqlite3_step(versionStatement) == SQLITE_ROW)
+	{
+		version = sqlite3_column_int(versionStatement, 0);
+	}
+	sqlite3_finalize(versionStatement);
+	if(version < CacheFileVersion)
+	{
+		string upgrade = StringUtils::Format("DROP TABLE IF EXISTS cachedAssignments; PRAGMA user_version = %i;", CacheFileVersion);
+		sqlite3_exec(mCacheFile, upgrade.c_str(), NULL, 0, 0);
+	}
+
+	bool isOk = sqlite3_exec(mCacheFile, CacheFileSchema, NULL, 0, 0) == SQLITE_OK;
+	isOk = isOk && sqlite3_prepare_v2(mCacheFile,
+		"SELECT nRows, comment, columnNames, columnTypes FROM cachedTables WHERE remote = ?1 AND path = ?2;",
+		-1, &mSelectTable, 0) == SQLITE_OK;
+	isOk = isOk && sqlite3_prepare_v2(mCacheFile,
+		"INSERT OR REPLACE INTO cachedTables (remote, path, nRows, comment, columnNames, columnTypes) VALUES (?1, ?2, ?3, ?4, ?5, ?6);",
+		-1, &mInsertTable, 0) == SQLITE_OK;
+	isOk = isOk && sqlite3_prepare_v2(mCacheFile,
+		"SELECT fetched, id, created, modified, comment, dataVaultId, hasRelations, runRangeId, runRangeName, runMin, runMax, variationId, variationName, data, firstRun, lastRun "
+		"FROM cachedAssignments WHERE remote = ?1 AND request = ?2 AND firstRun <= ?3 AND lastRun >= ?3 ORDER BY fetched DESC LIMIT 1;",
+		-1, &mSelectAssignment, 0) == SQLITE_OK;
+	isOk = isOk && sqlite3_prepare_v2(mCacheFile,
+		"INSERT OR REPLACE INTO cachedAssignments (remote, request, fetched, id, created, modified, comment, dataVaultId, hasRelations, "
+		"runRangeId, runRangeName, runMin, runMax, variationId, variationName, data, firstRun, lastRun) "
+		"VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14, ?15, ?16, ?17, ?18);",
+		-1, &mInsertAssignment, 0) == SQLITE_OK;
+	isOk = isOk && sqlite3_prepare_v2(mCacheFile,
+		"DELETE FROM cachedAssignments WHERE remote = ?1 AND request = ?2 AND firstRun <= ?4 AND lastRun >= ?3;",
+		-1, &mDeleteAssignments, 0) == SQLITE_OK;
+
+	if(!isOk)
+	{
+		CacheFileWarning("CachingDataProvider::OpenCacheFile");
+		CloseCacheFile();
+		return false;
+	}
+	return true;
+}
+
+
+void ccdb::CachingDataProvider::CloseCacheFile()
+{
+	sqlite3_finalize(mSelectTable);
+	sqlite3_finalize(mInsertTable);
+	sqlite3_finalize(mSelectAssignment);
+	sqlite3_finalize(mInsertAssignment);
+	sqlite3_finalize(mDeleteAssignments);
+	mSelectTable = mInsertTable = mSelectAssignment = mInsertAssignment = mDeleteAssignments = NULL;
+
+	if(mCacheFile) sqlite3_close(mCacheFile);
+	mCacheFile = NULL;
+}
+
+
+void ccdb::CachingDataProvider::CacheFileWarning( const string& errorSource )
+{
+	string message = "Cache file '" + mCacheFilePath + "' error";
+	if(mCacheFile) message += StringUtils::Format(" %i: %s", sqlite3_errcode(mCacheFile), sqlite3_errmsg(mCacheFile));
+	Warning(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, errorSource, message);
+}
+
+
+bool ccdb::CachingDataProvider::ReadCachedAssignment( const string& key, int run, CachedAssignment& cached )
+{
+	if(!mCacheFile) return false;
+
+	sqlite3_reset(mSelectAssignment);
+	sqlite3_bind_text(mSelectAssignment, 1, mRemoteKey.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_text(mSelectAssignment, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int(mSelectAssignment, 3, run);
+
+	int result = sqlite3_step(mSelectAssignment);
+	if(result == SQLITE_ROW)
+	{
+		cached.FetchedTime = (time_t)sqlite3_column_int64(mSelectAssignment, 0);
+		cached.Id = sqlite3_column_int(mSelectAssignment, 1);
+		cached.CreatedTime = (time_t)sqlite3_column_int64(mSelectAssignment, 2);
+		cached.ModifiedTime = (time_t)sqlite3_column_int64(mSelectAssignment, 3);
+		cached.Comment = ColumnText(mSelectAssignment, 4);
+		cached.DataVaultId = sqlite3_column_int(mSelectAssignment, 5);
+		cached.HasRelations = sqlite3_column_int(mSelectAssignment, 6) != 0;
+		cached.RunRangeId = sqlite3_column_int(mSelectAssignment, 7);
+		cached.RunRangeName = ColumnText(mSelectAssignment, 8);
+		cached.RunMin = sqlite3_column_int(mSelectAssignment, 9);
+		cached.RunMax = sqlite3_column_int(mSelectAssignment, 10);
+		cached.VariationId = sqlite3_column_int(mSelectAssignment, 11);
+		cached.VariationName = ColumnText(mSelectAssignment, 12);
+		cached.RawData = ColumnText(mSelectAssignment, 13);
+		cached.FirstRun = sqlite3_column_int(mSelectAssignment, 14);
+		cached.LastRun = sqlite3_column_int(mSelectAssignment, 15);
+	}
+	else if(result != SQLITE_DONE)
+	{
+		CacheFileWarning("CachingDataProvider::ReadCachedAssignment");
+	}
+	sqlite3_reset(mSelectAssignment);
+	return result == SQLITE_ROW;
+}
+
+
+void ccdb::CachingDataProvider::WriteCachedAssignment( const string& key, const CachedAssignment& cached )
+{
+	if(!mCacheFile) return;
+
+	//entries of older fetches may be kept for some of the runs
+	sqlite3_reset(mDeleteAssignments);
+	sqlite3_bind_text(mDeleteAssignments, 1, mRemoteKey.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_text(mDeleteAssignments, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int(mDeleteAssignments, 3, cached.FirstRun);
+	sqlite3_bind_int(mDeleteAssignments, 4, cached.LastRun);
+	if(sqlite3_step(mDeleteAssignments) != SQLITE_DONE) CacheFileWarning("CachingDataProvider::WriteCachedAssignment");
+	sqlite3_reset(mDeleteAssignments);
+
+	sqlite3_reset(mInsertAssignment);
+	sqlite3_bind_text(mInsertAssignment, 1, mRemoteKey.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_text(mInsertAssignment, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int64(mInsertAssignment, 3, (sqlite3_int64)cached.FetchedTime);
+	sqlite3_bind_int(mInsertAssignment, 4, cached.Id);
+	sqlite3_bind_int64(mInsertAssignment, 5, (sqlite3_int64)cached.CreatedTime);
+	sqlite3_bind_int64(mInsertAssignment, 6, (sqlite3_int64)cached.ModifiedTime);
+	sqlite3_bind_text(mInsertAssignment, 7, cached.Comment.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int(mInsertAssignment, 8, cached.DataVaultId);
+	sqlite3_bind_int(mInsertAssignment, 9, cached.HasRelations ? 1 : 0);
+	sqlite3_bind_int(mInsertAssignment, 10, cached.RunRangeId);
+	sqlite3_bind_text(mInsertAssignment, 11, cached.RunRangeName.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int(mInsertAssignment, 12, cached.RunMin);
+	sqlite3_bind_int(mInsertAssignment, 13, cached.RunMax);
+	sqlite3_bind_int(mInsertAssignment, 14, cached.VariationId);
+	sqlite3_bind_text(mInsertAssignment, 15, cached.VariationName.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_text(mInsertAssignment, 16, cached.RawData.data(), (int)cached.RawData.size(), SQLITE_TRANSIENT);
+	sqlite3_bind_int(mInsertAssignment, 17, cached.FirstRun);
+	sqlite3_bind_int(mInsertAssignment, 18, cached.LastRun);
+
+	if(sqlite3_step(mInsertAssignment) != SQLITE_DONE) CacheFileWarning("CachingDataProvider::WriteCachedAssignment");
+	sqlite3_reset(mInsertAssignment);
+}
+
+
+bool ccdb::CachingDataProvider::FindMemoryAssignment( const string& key, int run, CachedAssignment& cached )
+{
+	unordered_map<string, map<int, CachedAssignment> >::iterator it = mAssignments.find(key);
+	if(it == mAssignments.end()) return false;
+
+	//entries of a request don't overlap, the one that starts at the run or before it is the only candidate
+	map<int, CachedAssignment>::iterator runIt = it->second.upper_bound(run);
+	if(runIt == it->second.begin()) return false;
+	--runIt;
+	if(runIt->second.LastRun < run) return false;
+
+	cached = runIt->second;
+	return true;
+}
+
+
+void ccdb::CachingDataProvider::StoreMemoryAssignment( const string& key, const CachedAssignment& cached )
+{
+	map<int, CachedAssignment>& entries = mAssignments[key];
+
+	//entries of older fetches may be kept for some of the runs
+	map<int, CachedAssignment>::iterator it = entries.upper_bound(cached.LastRun);
+	while(it != entries.begin())
+	{
+		--it;
+		if(it->second.LastRun < cached.FirstRun) break;
+		it = entries.erase(it);
+	}
+	entries[cached.FirstRun] = cached;
+}
+#pragma endregion Cache file
+
+#pragma region Directories
+
+ccdb::Directory* ccdb::CachingDataProvider::GetDirectory( const string& path )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::GetDirectory");
+	if(!remote) return NULL;
+
+	Directory* result = remote->GetDirectory(path);
+	CopyRemoteErrors();
+	return result;
+}
+
+
+ccdb::Directory* const ccdb::CachingDataProvider::GetRootDirectory()
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::GetRootDirectory");
+	if(!remote) return NULL;
+
+	Directory* result = remote->GetRootDirectory();
+	CopyRemoteErrors();
+	return result;
+}
+
+
+bool ccdb::CachingDataProvider::SearchDirectories( vector<Directory *>& resultDirectories, const string& searchPattern, const string& parentPath/*=""*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::SearchDirectories");
+	if(!remote) return false;
+
+	bool result = remote->SearchDirectories(resultDirectories, searchPattern, parentPath, take, startWith);
+	CopyRemoteErrors();
+	return result;
+}
+#pragma endregion Directories
+
+#pragma region Type Tables
+
+int ccdb::CachingDataProvider::CacheTable( const string& path )
+{
+	const char* thisFunc = "CachingDataProvider::CacheTable";
+
+	int tableIndex = FindTable(path);
+	if(tableIndex >= 0) return tableIndex;
+
+	//the cache file
+	if(mCacheFile)
+	{
+		sqlite3_reset(mSelectTable);
+		sqlite3_bind_text(mSelectTable, 1, mRemoteKey.c_str(), -1, SQLITE_TRANSIENT);
+		sqlite3_bind_text(mSelectTable, 2, path.c_str(), -1, SQLITE_TRANSIENT);
+
+		int result = sqlite3_step(mSelectTable);
+		if(result == SQLITE_ROW)
+		{
+			vector<string> columnNames = StringUtils::Split(ColumnText(mSelectTable, 2), "|");
+			vector<string> columnTypes = StringUtils::Split(ColumnText(mSelectTable, 3), "|");
+			if(columnNames.size() == columnTypes.size())
+			{
+				tableIndex = (int)AddTable(path, columnNames, columnTypes, sqlite3_column_int(mSelectTable, 0), ColumnText(mSelectTable, 1));
+			}
+		}
+		else if(result != SQLITE_DONE)
+		{
+			CacheFileWarning(thisFunc);
+		}
+		sqlite3_reset(mSelectTable);
+		if(tableIndex >= 0) return tableIndex;
+	}
+
+	//the remote
+	DataProvider* remote = GetRemote(thisFunc);
+	if(!remote) return -1;
+
+	ConstantsTypeTable* table = remote->GetConstantsTypeTable(path, true);
+	CopyRemoteErrors();
+	if(!table)
+	{
+		if(GetNErrors() == 0) Error(CCDB_ERROR_NO_TYPETABLE, thisFunc, "Type table was not found: '" + path + "'");
+		return -1;
+	}
+
+	tableIndex = AddCachedTable(path, table);
+	delete table;
+	return tableIndex;
+}
+
+
+int ccdb::CachingDataProvider::AddCachedTable( const string& path, ConstantsTypeTable* table )
+{
+	int tableIndex = (int)AddTable(path, table->GetColumnNames(), table->GetColumnTypeStrings(), table->GetRowsCount(), table->GetComment());
+	if(!mCacheFile) return tableIndex;
+
+	const CatalogTable& catalogTable = mTables[tableIndex];
+	sqlite3_reset(mInsertTable);
+	sqlite3_bind_text(mInsertTable, 1, mRemoteKey.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_text(mInsertTable, 2, path.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_int(mInsertTable, 3, catalogTable.RowsCount);
+	sqlite3_bind_text(mInsertTable, 4, catalogTable.Comment.c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_text(mInsertTable, 5, JoinColumns(catalogTable.ColumnNames).c_str(), -1, SQLITE_TRANSIENT);
+	sqlite3_bind_text(mInsertTable, 6, JoinColumns(catalogTable.ColumnTypes).c_str(), -1, SQLITE_TRANSIENT);
+	if(sqlite3_step(mInsertTable) != SQLITE_DONE) CacheFileWarning("CachingDataProvider::AddCachedTable");
+	sqlite3_reset(mInsertTable);
+	return tableIndex;
+}
+
+
+ccdb::ConstantsTypeTable * ccdb::CachingDataProvider::GetConstantsTypeTable( const string& path, bool loadColumns/*=false*/ )
+{
+	if(!CheckConnection("CachingDataProvider::GetConstantsTypeTable")) return NULL;
+
+	string fullPath(path);
+	PathUtils::MakeAbsolute(fullPath);
+	int tableIndex = CacheTable(fullPath);
+	if(tableIndex < 0) return NULL;
+	return CreateTypeTable(tableIndex, loadColumns);
+}
+
+
+ccdb::ConstantsTypeTable * ccdb::CachingDataProvider::GetConstantsTypeTable( const string& name, Directory *parentDir, bool loadColumns/*=false*/ )
+{
+	if(parentDir == NULL)
+	{
+		ClearErrors();
+		Error(CCDB_ERROR_NO_PARENT_DIRECTORY, "CachingDataProvider::GetConstantsTypeTable", "Parent directory is null");
+		return NULL;
+	}
+	return GetConstantsTypeTable(PathUtils::CombinePath(parentDir->GetFullPath(), name), loadColumns);
+}
+
+
+bool ccdb::CachingDataProvider::GetConstantsTypeTables( vector<ConstantsTypeTable *>& typeTables, const string& parentDirPath, bool loadColumns/*=false*/ )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::GetConstantsTypeTables");
+	if(!remote) return false;
+
+	bool result = remote->GetConstantsTypeTables(typeTables, parentDirPath, loadColumns);
+	CopyRemoteErrors();
+	return result;
+}
+
+
+vector<ccdb::ConstantsTypeTable *> ccdb::CachingDataProvider::GetConstantsTypeTables( Directory *parentDir, bool loadColumns/*=false*/ )
+{
+	vector<ConstantsTypeTable *> tables;
+	GetConstantsTypeTables(tables, parentDir, loadColumns);
+	return tables;
+}
+
+
+bool ccdb::CachingDataProvider::GetConstantsTypeTables( vector<ConstantsTypeTable *>& typeTables, Directory *parentDir, bool loadColumns/*=false*/ )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::GetConstantsTypeTables");
+	if(!remote) return false;
+
+	bool result = remote->GetConstantsTypeTables(typeTables, parentDir, loadColumns);
+	CopyRemoteErrors();
+	return result;
+}
+
+
+bool ccdb::CachingDataProvider::SearchConstantsTypeTables( vector<ConstantsTypeTable *>& typeTables, const string& pattern, const string& parentPath /*= ""*/, bool loadColumns/*=false*/, int take/*=0*/, int startWith/*=0 */ )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::SearchConstantsTypeTables");
+	if(!remote) return false;
+
+	bool result = remote->SearchConstantsTypeTables(typeTables, pattern, parentPath, loadColumns, take, startWith);
+	CopyRemoteErrors();
+	return result;
+}
+
+
+vector<ccdb::ConstantsTypeTable *> ccdb::CachingDataProvider::SearchConstantsTypeTables( const string& pattern, const string& parentPath /*= ""*/, bool loadColumns/*=false*/, int take/*=0*/, int startWith/*=0 */ )
+{
+	vector<ConstantsTypeTable *> tables;
+	SearchConstantsTypeTables(tables, pattern, parentPath, loadColumns, take, startWith);
+	return tables;
+}
+
+
+int ccdb::CachingDataProvider::CountConstantsTypeTables( Directory *dir )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::CountConstantsTypeTables");
+	if(!remote) return 0;
+
+	int result = remote->CountConstantsTypeTables(dir);
+	CopyRemoteErrors();
+	return result;
+}
+
+
+bool ccdb::CachingDataProvider::LoadColumns( ConstantsTypeTable* table )
+{
+	if(!CheckConnection("CachingDataProvider::LoadColumns")) return false;
+
+	//tables of the remote have the same columns as the cached ones
+	if(table && CacheTable(table->GetFullPath()) < 0) return false;
+	return CatalogDataProvider::LoadColumns(table);
+}
+#pragma endregion Type Tables
+
+#pragma region Run ranges
+
+ccdb::RunRange* ccdb::CachingDataProvider::GetRunRange( int min, int max, const string& name /*= ""*/ )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::GetRunRange");
+	if(!remote) return NULL;
+
+	RunRange* result = remote->GetRunRange(min, max, name);
+	CopyRemoteErrors();
+	return result;
+}
+
+
+bool ccdb::CachingDataProvider::GetRunRanges( vector<RunRange *>& resultRunRanges, ConstantsTypeTable *table, const string& variation/*=""*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::GetRunRanges");
+	if(!remote) return false;
+
+	//ids of cached tables are not ids of the remote
+	ConstantsTypeTable* remoteTable = table ? remote->GetConstantsTypeTable(table->GetFullPath()) : NULL;
+	bool result = remote->GetRunRanges(resultRunRanges, remoteTable, variation, take, startWith);
+	CopyRemoteErrors();
+	delete remoteTable;
+	return result;
+}
+
+
+ccdb::RunRange* ccdb::CachingDataProvider::GetRunRange( const string& name )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::GetRunRange");
+	if(!remote) return NULL;
+
+	RunRange* result = remote->GetRunRange(name);
+	CopyRemoteErrors();
+	return result;
+}
+#pragma endregion Run ranges
+
+#pragma region Variations
+
+ccdb::Variation* ccdb::CachingDataProvider::GetVariation( const string& name )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::GetVariation");
+	if(!remote) return NULL;
+
+	Variation* result = remote->GetVariation(name);
+	CopyRemoteErrors();
+	return result;
+}
+
+
+bool ccdb::CachingDataProvider::GetVariations( vector<Variation *>& resultVariations, ConstantsTypeTable *table, int run/*=0*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::GetVariations");
+	if(!remote) return false;
+
+	//ids of cached tables are not ids of the remote
+	ConstantsTypeTable* remoteTable = table ? remote->GetConstantsTypeTable(table->GetFullPath()) : NULL;
+	bool result = remote->GetVariations(resultVariations, remoteTable, run, take, startWith);
+	CopyRemoteErrors();
+	delete remoteTable;
+	return result;
+}
+
+
+vector<ccdb::Variation *> ccdb::CachingDataProvider::GetVariations( ConstantsTypeTable *table, int run/*=0*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	vector<Variation *> variations;
+	GetVariations(variations, table, run, take, startWith);
+	return variations;
+}
+#pragma endregion Variations
+
+#pragma region Assignments
+
+bool ccdb::CachingDataProvider::IsExpired( const CachedAssignment& cached, time_t requestTime, time_t now ) const
+{
+	//constants at a time before the fetch can't change
+	if(requestTime > 0 && requestTime <= cached.FetchedTime) return false;
+	return mMaxAge > 0 && now - cached.FetchedTime > mMaxAge;
+}
+
+
+ccdb::Assignment* ccdb::CachingDataProvider::CreateCachedAssignment( size_t tableIndex, const CachedAssignment& cached, int run, bool loadColumns )
+{
+	Assignment* assignment = CreateAssignment(tableIndex, run, loadColumns);
+	assignment->SetId(cached.Id);
+	assignment->SetCreatedTime(cached.CreatedTime);
+	assignment->SetModifiedTime(cached.ModifiedTime);
+	assignment->SetComment(cached.Comment);
+	assignment->SetDataVaultId(cached.DataVaultId);
+	assignment->SetRawData(cached.RawData);
+
+	if(cached.HasRelations)
+	{
+		RunRange* runRange = new RunRange(assignment, this);
+		runRange->SetId(cached.RunRangeId);
+		runRange->SetName(cached.RunRangeName);
+		runRange->SetRange(cached.RunMin, cached.RunMax);
+		assignment->SetRunRange(runRange);
+
+		Variation* variation = new Variation(assignment, this);
+		variation->SetId(cached.VariationId);
+		variation->SetName(cached.VariationName);
+		assignment->SetVariation(variation);
+	}
+	return assignment;
+}
+
+
+ccdb::Assignment* ccdb::CachingDataProvider::QueryAssignment( int run, const string& path, time_t time, const string& variation, bool loadColumns, bool full )
+{
+	const char* thisFunc = full ? "CachingDataProvider::GetAssignmentFull" : "CachingDataProvider::GetAssignmentShort";
+	if(!CheckConnection(thisFunc)) return NULL;
+
+	string fullPath(path);
+	PathUtils::MakeAbsolute(fullPath);
+	string key = StringUtils::Format("%s|%s|%lld|%s", fullPath.c_str(), variation.c_str(), (long long)time, full ? "full" : "short");
+	time_t now = TimeProvider::GetUnixTimeStamp(ClockSources::Realtime);
+
+	//memory, then the cache file
+	CachedAssignment cached;
+	bool isCached = false;
+	if(FindMemoryAssignment(key, run, cached))
+	{
+		isCached = true;
+		if(!IsExpired(cached, time, now))
+		{
+			int tableIndex = CacheTable(fullPath);
+			if(tableIndex < 0) return NULL;
+			mMemoryHits++;
+			return CreateCachedAssignment(tableIndex, cached, run, loadColumns);
+		}
+	}
+	else if(ReadCachedAssignment(key, run, cached))
+	{
+		isCached = true;
+		if(!IsExpired(cached, time, now))
+		{
+			int tableIndex = CacheTable(fullPath);
+			if(tableIndex < 0) return NULL;
+			StoreMemoryAssignment(key, cached);
+			mFileHits++;
+			return CreateCachedAssignment(tableIndex, cached, run, loadColumns);
+		}
+	}
+
+	//the remote. The entry is kept for all runs that get the same assignment
+	DataProvider* remote = GetRemote(thisFunc);
+	Assignment* assignment = NULL;
+	int firstRun = run;
+	int lastRun = run;
+	if(remote)
+	{
+		assignment = remote->GetAssignmentForRuns(run, fullPath, time, variation, !full, firstRun, lastRun);
+		CopyRemoteErrors();
+	}
+
+	//the table usually comes with the assignment, so it is not requested again
+	int tableIndex = -1;
+	if(assignment)
+	{
+		tableIndex = FindTable(fullPath);
+		ConstantsTypeTable* table = assignment->GetTypeTable();
+		if(tableIndex < 0 && table && table->GetColumns().size() > 0) tableIndex = AddCachedTable(fullPath, table);
+		if(tableIndex < 0) tableIndex = CacheTable(fullPath);
+	}
+
+	if(!assignment || tableIndex < 0)
+	{
+		delete assignment;
+		if(isCached && GetNErrors() > 0)
+		{
+			//better old constants than none
+			tableIndex = CacheTable(fullPath);
+			if(tableIndex < 0) return NULL;
+			Warning(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, thisFunc, "The remote failed, expired constants from the cache are used for '" + key + "'");
+			return CreateCachedAssignment(tableIndex, cached, run, loadColumns);
+		}
+		return NULL;
+	}
+
+	cached.FetchedTime = now;
+	cached.Id = assignment->GetId();
+	cached.CreatedTime = assignment->GetCreatedTime();
+	cached.ModifiedTime = assignment->GetModifiedTime();
+	cached.Comment = assignment->GetComment();
+	cached.DataVaultId = assignment->GetDataVaultId();
+	cached.RawData = assignment->GetRawData();
+	cached.HasRelations = assignment->GetRunRange() != NULL && assignment->GetVariation() != NULL;
+	cached.RunRangeId = cached.HasRelations ? assignment->GetRunRange()->GetId() : 0;
+	cached.RunRangeName = cached.HasRelations ? assignment->GetRunRange()->GetName() : "";
+	cached.RunMin = cached.HasRelations ? assignment->GetRunRange()->GetMin() : 0;
+	cached.RunMax = cached.HasRelations ? assignment->GetRunRange()->GetMax() : 0;
+	cached.VariationId = cached.HasRelations ? assignment->GetVariation()->GetId() : 0;
+	cached.VariationName = cached.HasRelations ? assignment->GetVariation()->GetName() : "";
+	cached.FirstRun = firstRun;
+	cached.LastRun = lastRun;
+	delete assignment;
+
+	StoreMemoryAssignment(key, cached);
+	WriteCachedAssignment(key, cached);
+	mRemoteFetches++;
+	return CreateCachedAssignment(tableIndex, cached, run, loadColumns);
+}
+
+
+ccdb::Assignment* ccdb::CachingDataProvider::GetAssignmentShort( int run, const string& path, time_t time, const string& variation/*="default"*/, bool loadColumns/*=false*/ )
+{
+	return QueryAssignment(run, path, time, variation, loadColumns, false);
+}
+
+
+ccdb::Assignment* ccdb::CachingDataProvider::GetAssignmentFull( int run, const string& path, const string& variation/*="default"*/ )
+{
+	return QueryAssignment(run, path, 0, variation, true, true);
+}
+
+
+ccdb::Assignment* ccdb::CachingDataProvider::GetAssignmentFull( int run, const string& path, int version, const string& variation/*="default"*/ )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::GetAssignmentFull");
+	if(!remote) return NULL;
+
+	Assignment* result = remote->GetAssignmentFull(run, path, version, variation);
+	CopyRemoteErrors();
+	return result;
+}
+
+
+bool ccdb::CachingDataProvider::GetAssignments( vector<Assignment *> &assingments,const string& path, int runMin, int runMax, const string& runRangeName, const string& variation, time_t beginTime, time_t endTime, int sortBy/*=0*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::GetAssignments");
+	if(!remote) return false;
+
+	bool result = remote->GetAssignments(assingments, path, runMin, runMax, runRangeName, variation, beginTime, endTime, sortBy, take, startWith);
+	CopyRemoteErrors();
+	return result;
+}
+
+
+bool ccdb::CachingDataProvider::FillAssignment( Assignment* assignment )
+{
+	DataProvider* remote = GetRemote("CachingDataProvider::FillAssignment");
+	if(!remote) return false;
+
+	bool result = remote->FillAssignment(assignment);
+	CopyRemoteErrors();
+	return result;
+}
+#pragma endregion Assignments
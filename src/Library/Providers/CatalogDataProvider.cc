@@ -0,0 +1,481 @@
+#include "CCDB/Providers/CatalogDataProvider.h"
+#include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+
+namespace
+{
+	/** Takes 'take' objects starting from 'startWith' as SQL LIMIT does. take=0 means all */
+	template<class T> void TakePage(vector<T>& objects, int take, int startWith)
+	{
+		if(startWith > 0) objects.erase(objects.begin(), objects.begin() + min((size_t)startWith, objects.size()));
+		if(take > 0 && (size_t)take < objects.size()) objects.resize(take);
+	}
+}
+
+#pragma region constructors
+
+ccdb::CatalogDataProvider::CatalogDataProvider(void)
+{
+	mIsConnected = false;
+	mRootDir = new Directory(this, this);
+	mRootDir->SetFullPath("/");
+	mDirectoriesByFullPath["/"] = mRootDir;
+	mDirsAreLoaded = false;
+	mNeedCheckDirectoriesUpdate = false;
+}
+
+
+ccdb::CatalogDataProvider::~CatalogDataProvider(void)
+{
+}
+#pragma endregion constructors
+
+#pragma region Connection
+
+bool ccdb::CatalogDataProvider::IsConnected()
+{
+	return mIsConnected;
+}
+
+
+bool ccdb::CatalogDataProvider::CheckConnection( const string& errorSource )
+{
+	ClearErrors(); //Clear error in function that can produce new ones
+
+	if(!IsConnected())
+	{
+		Error(CCDB_ERROR_NOT_CONNECTED, errorSource, "Provider is not connected.");
+		return false;
+	}
+	return true;
+}
+#pragma endregion Connection
+
+#pragma region Catalog
+
+size_t ccdb::CatalogDataProvider::AddTable( const string& fullPath, const vector<string>& columnNames, const vector<string>& columnTypes, int rowsCount, const string& comment/*=""*/ )
+{
+	string path(fullPath);
+	PathUtils::MakeAbsolute(path);
+
+	unordered_map<string, size_t>::iterator it = mTablesByPath.find(path);
+	if(it != mTablesByPath.end()) return it->second;
+
+	CatalogTable table;
+	table.FullPath = path;
+	table.Name = PathUtils::ExtractObjectname(path);
+	table.Parent = AddDirectories(PathUtils::ExtractDirectory(path));
+	table.Comment = comment;
+	table.RowsCount = rowsCount;
+	table.ColumnNames = columnNames;
+	table.ColumnTypes = columnTypes;
+
+	mTables.push_back(table);
+	mTablesByPath[path] = mTables.size() - 1;
+	mDirsAreLoaded = true;
+	return mTables.size() - 1;
+}
+
+
+ccdb::Directory* ccdb::CatalogDataProvider::AddDirectories( const string& path )
+{
+	if(path.empty() || path == "/") return mRootDir;
+
+	map<string, Directory*>::iterator it = mDirectoriesByFullPath.find(path);
+	if(it != mDirectoriesByFullPath.end()) return it->second;
+
+	Directory* parent = AddDirectories(PathUtils::ExtractDirectory(path));
+
+	Directory* dir = new Directory(this, this);
+	dir->SetId(mDirectories.size() + 1);
+	dir->SetName(PathUtils::ExtractObjectname(path));
+	dir->SetParentId(parent == mRootDir ? 0 : parent->GetId());
+	dir->SetFullPath(path);
+	parent->AddSubdirectory(dir);
+
+	mDirectories.push_back(dir);
+	mDirectoriesById[dir->GetId()] = dir;
+	mDirectoriesByFullPath[path] = dir;
+	return dir;
+}
+
+
+ccdb::Variation* ccdb::CatalogDataProvider::AddVariation( const string& name, const string& parentName/*=""*/ )
+{
+	map<string, Variation*>::iterator it = mVariationsByName.find(name);
+	if(it != mVariationsByName.end()) return it->second;
+
+	Variation* variation = new Variation(this, this);
+	variation->SetId(mVariationsByName.size() + 1);
+	variation->SetName(name);
+
+	it = mVariationsByName.find(parentName);
+	if(it != mVariationsByName.end())
+	{
+		variation->SetParent(it->second);
+		variation->SetParentDbId(it->second->GetId());
+	}
+
+	mVariationsByName[name] = variation;
+	mVariationsById[variation->GetId()] = variation;
+	return variation;
+}
+
+
+void ccdb::CatalogDataProvider::ClearCatalog()
+{
+	mRootDir->DisposeSubdirectories();
+	mDirectories.clear();
+	mDirectoriesById.clear();
+	mDirectoriesByFullPath.clear();
+	mDirectoriesByFullPath["/"] = mRootDir;
+	mDirsAreLoaded = false;
+
+	mTables.clear();
+	mTablesByPath.clear();
+
+	for(map<string, Variation*>::iterator it = mVariationsByName.begin(); it != mVariationsByName.end(); ++it)
+	{
+		delete it->second;
+	}
+	mVariationsByName.clear();
+	mVariationsById.clear();
+}
+
+
+int ccdb::CatalogDataProvider::FindTable( const string& fullPath ) const
+{
+	unordered_map<string, size_t>::const_iterator it = mTablesByPath.find(fullPath);
+	if(it == mTablesByPath.end()) return -1;
+	return (int)it->second;
+}
+
+
+ccdb::ConstantsTypeTable* ccdb::CatalogDataProvider::CreateTypeTable( size_t tableIndex, bool loadColumns )
+{
+	const CatalogTable& catalogTable = mTables[tableIndex];
+
+	ConstantsTypeTable* table = new ConstantsTypeTable(this, this);
+	table->SetId(tableIndex + 1);
+	table->SetName(catalogTable.Name);
+	table->SetDirectory(catalogTable.Parent);
+	table->SetDirectoryId(catalogTable.Parent->GetId());
+	table->SetComment(catalogTable.Comment);
+	table->SetNRows(catalogTable.RowsCount);
+	table->SetNColumnsFromDB(catalogTable.ColumnNames.size());
+	SetObjectLoaded(table);
+
+	if(loadColumns) LoadColumns(table);
+	return table;
+}
+
+
+ccdb::Assignment* ccdb::CatalogDataProvider::CreateAssignment( size_t tableIndex, int run, bool loadColumns )
+{
+	ConstantsTypeTable* table = CreateTypeTable(tableIndex, loadColumns);
+
+	Assignment* assignment = new Assignment(this, this);
+	assignment->SetRequestedRun(run);
+	assignment->SetTypeTable(table);
+	assignment->BeOwner(table);
+	return assignment;
+}
+
+
+bool ccdb::CatalogDataProvider::LoadDirectories()
+{
+	return mDirsAreLoaded;
+}
+#pragma endregion Catalog
+
+#pragma region Directories
+
+ccdb::Directory* ccdb::CatalogDataProvider::GetDirectory( const string& path )
+{
+	return DataProvider::GetDirectory(path);
+}
+
+
+bool ccdb::CatalogDataProvider::SearchDirectories( vector<Directory *>& resultDirectories, const string& searchPattern, const string& parentPath/*=""*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	if(!CheckConnection("CatalogDataProvider::SearchDirectories")) return false;
+
+	Directory* parentDir = NULL;
+	if(parentPath != "" && !(parentDir = GetDirectory(parentPath)))
+	{
+		Error(CCDB_ERROR_DIRECTORY_NOT_FOUND, "CatalogDataProvider::SearchDirectories", "Path to search is not found");
+		return false;
+	}
+
+	resultDirectories.clear();
+	for(size_t i = 0; i < mDirectories.size(); i++)
+	{
+		Directory* dir = mDirectories[i];
+		if(parentDir && dir->GetParentDirectory() != parentDir) continue;
+		if(StringUtils::WildCardCheck(searchPattern.c_str(), dir->GetName().c_str())) resultDirectories.push_back(dir);
+	}
+	TakePage(resultDirectories, take, startWith);
+	return true;
+}
+
+
+vector<ccdb::Directory *> ccdb::CatalogDataProvider::SearchDirectories( const string& searchPattern, const string& parentPath/*=""*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	vector<Directory *> result;
+	SearchDirectories(result, searchPattern, parentPath, take, startWith);
+	return result;
+}
+#pragma endregion Directories
+
+#pragma region Type Tables
+
+ccdb::ConstantsTypeTable * ccdb::CatalogDataProvider::GetConstantsTypeTable( const string& path, bool loadColumns/*=false*/ )
+{
+	return DataProvider::GetConstantsTypeTable(path, loadColumns);
+}
+
+
+ccdb::ConstantsTypeTable * ccdb::CatalogDataProvider::GetConstantsTypeTable( const string& name, Directory *parentDir, bool loadColumns/*=false*/ )
+{
+	if(!CheckConnection("CatalogDataProvider::GetConstantsTypeTable")) return NULL;
+
+	if(parentDir == NULL)
+	{
+		Error(CCDB_ERROR_NO_PARENT_DIRECTORY, "CatalogDataProvider::GetConstantsTypeTable", "Parent directory is null");
+		return NULL;
+	}
+
+	int tableIndex = FindTable(PathUtils::CombinePath(parentDir->GetFullPath(), name));
+	if(tableIndex < 0) return NULL;
+	return CreateTypeTable(tableIndex, loadColumns);
+}
+
+
+bool ccdb::CatalogDataProvider::GetConstantsTypeTables( vector<ConstantsTypeTable *>& typeTables, const string& parentDirPath, bool loadColumns/*=false*/ )
+{
+	return GetConstantsTypeTables(typeTables, GetDirectory(parentDirPath), loadColumns);
+}
+
+
+vector<ccdb::ConstantsTypeTable *> ccdb::CatalogDataProvider::GetConstantsTypeTables( Directory *parentDir, bool loadColumns/*=false*/ )
+{
+	vector<ConstantsTypeTable *> tables;
+	GetConstantsTypeTables(tables, parentDir, loadColumns);
+	return tables;
+}
+
+
+bool ccdb::CatalogDataProvider::GetConstantsTypeTables( vector<ConstantsTypeTable *>& typeTables, Directory *parentDir, bool loadColumns/*=false*/ )
+{
+	if(!CheckConnection("CatalogDataProvider::GetConstantsTypeTables")) return false;
+
+	if(parentDir == NULL)
+	{
+		Error(CCDB_ERROR_DIRECTORY_NOT_FOUND, "CatalogDataProvider::GetConstantsTypeTables", "Parent directory is not found");
+		return false;
+	}
+
+	typeTables.clear();
+	for(size_t i = 0; i < mTables.size(); i++)
+	{
+		if(mTables[i].Parent == parentDir) typeTables.push_back(CreateTypeTable(i, loadColumns));
+	}
+	return true;
+}
+
+
+bool ccdb::CatalogDataProvider::SearchConstantsTypeTables( vector<ConstantsTypeTable *>& typeTables, const string& pattern, const string& parentPath /*= ""*/, bool loadColumns/*=false*/, int take/*=0*/, int startWith/*=0 */ )
+{
+	if(!CheckConnection("CatalogDataProvider::SearchConstantsTypeTables")) return false;
+
+	Directory* parentDir = NULL;
+	if(parentPath != "" && !(parentDir = GetDirectory(parentPath)))
+	{
+		Error(CCDB_ERROR_DIRECTORY_NOT_FOUND, "CatalogDataProvider::SearchConstantsTypeTables", "Path to search is not found");
+		return false;
+	}
+
+	//tables are returned sorted by name as SQL providers do
+	map<string, size_t> found;
+	for(size_t i = 0; i < mTables.size(); i++)
+	{
+		if(parentDir && mTables[i].Parent != parentDir) continue;
+		if(StringUtils::WildCardCheck(pattern.c_str(), mTables[i].Name.c_str())) found[mTables[i].Name + '\n' + mTables[i].FullPath] = i;
+	}
+
+	vector<size_t> indexes;
+	for(map<string, size_t>::iterator it = found.begin(); it != found.end(); ++it) indexes.push_back(it->second);
+	TakePage(indexes, take, startWith);
+
+	typeTables.clear();
+	for(size_t i = 0; i < indexes.size(); i++) typeTables.push_back(CreateTypeTable(indexes[i], loadColumns));
+	return true;
+}
+
+
+vector<ccdb::ConstantsTypeTable *> ccdb::CatalogDataProvider::SearchConstantsTypeTables( const string& pattern, const string& parentPath /*= ""*/, bool loadColumns/*=false*/, int take/*=0*/, int startWith/*=0 */ )
+{
+	vector<ConstantsTypeTable *> tables;
+	SearchConstantsTypeTables(tables, pattern, parentPath, loadColumns, take, startWith);
+	return tables;
+}
+
+
+int ccdb::CatalogDataProvider::CountConstantsTypeTables( Directory *dir )
+{
+	int count = 0;
+	for(size_t i = 0; i < mTables.size(); i++)
+	{
+		if(mTables[i].Parent == dir) count++;
+	}
+	return count;
+}
+
+
+bool ccdb::CatalogDataProvider::LoadColumns( ConstantsTypeTable* table )
+{
+	int tableIndex = table ? FindTable(table->GetFullPath()) : -1;
+	if(tableIndex < 0)
+	{
+		Error(CCDB_ERROR_NO_TYPETABLE, "CatalogDataProvider::LoadColumns", "Type table is not in the catalog");
+		return false;
+	}
+
+	const CatalogTable& catalogTable = mTables[tableIndex];
+	for(size_t i = 0; i < catalogTable.ColumnNames.size(); i++)
+	{
+		ConstantsTypeColumn* column = new ConstantsTypeColumn(table, this);
+		column->SetId(i + 1);
+		column->SetName(catalogTable.ColumnNames[i]);
+		column->SetType(catalogTable.ColumnTypes[i]);
+		column->SetDBTypeTableId(table->GetId());
+		SetObjectLoaded(column);
+		table->AddColumn(column);
+	}
+	return true;
+}
+#pragma endregion Type Tables
+
+#pragma region Run ranges
+
+ccdb::RunRange* ccdb::CatalogDataProvider::GetRunRange( int min, int max, const string& name /*= ""*/ )
+{
+	Error(CCDB_ERROR_NOT_IMPLEMENTED, "CatalogDataProvider::GetRunRange", "Run ranges are not kept by this provider");
+	return NULL;
+}
+
+
+bool ccdb::CatalogDataProvider::GetRunRanges( vector<RunRange *>& resultRunRanges, ConstantsTypeTable *table, const string& variation/*=""*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	Error(CCDB_ERROR_NOT_IMPLEMENTED, "CatalogDataProvider::GetRunRanges", "Run ranges are not kept by this provider");
+	return false;
+}
+
+
+ccdb::RunRange* ccdb::CatalogDataProvider::GetRunRange( const string& name )
+{
+	Error(CCDB_ERROR_NOT_IMPLEMENTED, "CatalogDataProvider::GetRunRange", "Run ranges are not kept by this provider");
+	return NULL;
+}
+#pragma endregion Run ranges
+
+#pragma region Variations
+
+ccdb::Variation* ccdb::CatalogDataProvider::GetVariation( const string& name )
+{
+	map<string, Variation*>::iterator it = mVariationsByName.find(name);
+	if(it == mVariationsByName.end()) return NULL;
+	return it->second;
+}
+
+
+bool ccdb::CatalogDataProvider::GetVariations( vector<Variation *>& resultVariations, ConstantsTypeTable *table, int run/*=0*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	if(!CheckConnection("CatalogDataProvider::GetVariations")) return false;
+
+	resultVariations.clear();
+	for(map<string, Variation*>::iterator it = mVariationsByName.begin(); it != mVariationsByName.end(); ++it)
+	{
+		resultVariations.push_back(it->second);
+	}
+	TakePage(resultVariations, take, startWith);
+	return true;
+}
+
+
+vector<ccdb::Variation *> ccdb::CatalogDataProvider::GetVariations( ConstantsTypeTable *table, int run/*=0*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	vector<Variation *> variations;
+	GetVariations(variations, table, run, take, startWith);
+	return variations;
+}
+#pragma endregion Variations
+
+#pragma region Assignments
+
+ccdb::Assignment* ccdb::CatalogDataProvider::GetAssignmentShort( int run, const string& path, const string& variation/*="default"*/, bool loadColumns/*=false*/ )
+{
+	return GetAssignmentShort(run, path, 0, variation, loadColumns);
+}
+
+
+ccdb::Assignment* ccdb::CatalogDataProvider::GetAssignmentFull( int run, const string& path, const string& variation/*="default"*/ )
+{
+	return GetAssignmentShort(run, path, 0, variation, true);
+}
+
+
+ccdb::Assignment* ccdb::CatalogDataProvider::GetAssignmentFull( int run, const string& path, int version, const string& variation/*="default"*/ )
+{
+	//only the latest version is kept
+	if(version == 0) return GetAssignmentFull(run, path, variation);
+
+	Error(CCDB_ERROR_NOT_IMPLEMENTED, "CatalogDataProvider::GetAssignmentFull", "Only the latest version of constants is kept by this provider");
+	return NULL;
+}
+
+
+bool ccdb::CatalogDataProvider::GetAssignments( vector<Assignment *> &assingments,const string& path, int runMin, int runMax, const string& runRangeName, const string& variation, time_t beginTime, time_t endTime, int sortBy/*=0*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	Error(CCDB_ERROR_NOT_IMPLEMENTED, "CatalogDataProvider::GetAssignments", "Assignments history is not kept by this provider");
+	return false;
+}
+
+
+bool ccdb::CatalogDataProvider::GetAssignments( vector<Assignment *> &assingments,const string& path, int run, const string& variation/*=""*/, time_t date/*=0*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	return GetAssignments(assingments, path, run, run, "", variation, 0, date, 0, take, startWith);
+}
+
+
+vector<ccdb::Assignment *> ccdb::CatalogDataProvider::GetAssignments( const string& path, int run, const string& variation/*=""*/, time_t date/*=0*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	vector<Assignment *> assignments;
+	GetAssignments(assignments, path, run, variation, date, take, startWith);
+	return assignments;
+}
+
+
+bool ccdb::CatalogDataProvider::GetAssignments( vector<Assignment *> &assingments,const string& path, const string& runName, const string& variation/*=""*/, time_t date/*=0*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	return GetAssignments(assingments, path, 0, 0, runName, variation, 0, date, 0, take, startWith);
+}
+
+
+vector<ccdb::Assignment *> ccdb::CatalogDataProvider::GetAssignments( const string& path, const string& runName, const string& variation/*=""*/, time_t date/*=0*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	vector<Assignment *> assignments;
+	GetAssignments(assignments, path, runName, variation, date, take, startWith);
+	return assignments;
+}
+
+
+bool ccdb::CatalogDataProvider::FillAssignment( Assignment* assignment )
+{
+	Error(CCDB_ERROR_NOT_IMPLEMENTED, "CatalogDataProvider::FillAssignment", "Assignments can't be filled by this provider");
+	return false;
+}
+#pragma endregion Assignments
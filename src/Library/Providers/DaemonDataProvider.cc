@@ -0,0 +1,311 @@
+#include <string.h>
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include "CCDB/Providers/DaemonDataProvider.h"
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+using namespace ccdb::DaemonProtocol;
+
+#pragma region constructors
+
+ccdb::DaemonDataProvider::DaemonDataProvider(void)
+{
+	mSocket = -1;
+}
+
+
+ccdb::DaemonDataProvider::~DaemonDataProvider(void)
+{
+	if(IsConnected())
+	{
+		Disconnect();
+	}
+}
+#pragma endregion constructors
+
+#pragma region Connection
+
+bool ccdb::DaemonDataProvider::Connect( string connectionString )
+{
+	ClearErrors();
+
+	if(IsConnected())
+	{
+		Error(CCDB_ERROR_CONNECTION_ALREADY_OPENED, "DaemonDataProvider::Connect", "Connection already opened");
+		return false;
+	}
+
+	if(connectionString.find("ccdbd://") != 0)
+	{
+		Error(CCDB_ERROR_PARSE_CONNECTION_STRING, "DaemonDataProvider::Connect", "Connection string should start with ccdbd://");
+		return false;
+	}
+	mSocketPath = connectionString.substr(8);
+
+	if(!OpenSocket()) return false;
+
+	mIsConnected = true;
+	if(!ReadCatalog() || !GetVariation("default"))
+	{
+		if(GetNErrors() == 0) Error(CCDB_ERROR_VARIATION_INVALID, "DaemonDataProvider::Connect", "The daemon has no 'default' variation");
+		Disconnect();
+		return false;
+	}
+
+	mConnectionString = connectionString;
+	return true;
+}
+
+
+void ccdb::DaemonDataProvider::Disconnect()
+{
+	if(!IsConnected()) return;
+
+	CloseSocket();
+	ClearCatalog();
+	mIsConnected = false;
+}
+
+
+bool ccdb::DaemonDataProvider::OpenSocket()
+{
+#ifndef WIN32
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(mSocketPath.size() >= sizeof(address.sun_path))
+	{
+		Error(CCDB_ERROR_PARSE_CONNECTION_STRING, "DaemonDataProvider::OpenSocket", "Socket path is too long: '" + mSocketPath + "'");
+		return false;
+	}
+	strcpy(address.sun_path, mSocketPath.c_str());
+
+	mSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(mSocket < 0 || connect(mSocket, (sockaddr*)&address, sizeof(address)) != 0)
+	{
+		CloseSocket();
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "DaemonDataProvider::OpenSocket", "Can't connect to the daemon socket '" + mSocketPath + "'");
+		return false;
+	}
+
+	MessageWriter hello(cHello);
+	hello.WriteUInt32(cMagic);
+	hello.WriteUInt32(cVersion);
+	string reply;
+	bool isOk = WriteFrame(mSocket, hello.GetPayload()) && ReadFrame(mSocket, reply);
+
+	MessageReader reader(reply);
+	isOk = isOk && reader.ReadUInt8() == cHello && reader.ReadUInt8() == cOk;
+	if(!isOk)
+	{
+		CloseSocket();
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "DaemonDataProvider::OpenSocket", StringUtils::Format("The daemon doesn't support protocol version %i", (int)cVersion));
+		return false;
+	}
+	return true;
+#else
+	Error(CCDB_ERROR_NOT_IMPLEMENTED, "DaemonDataProvider::OpenSocket", "Unix domain sockets are not supported on this platform");
+	return false;
+#endif
+}
+
+
+void ccdb::DaemonDataProvider::CloseSocket()
+{
+#ifndef WIN32
+	if(mSocket >= 0) close(mSocket);
+#endif
+	mSocket = -1;
+}
+
+
+bool ccdb::DaemonDataProvider::Exchange( const string& request, string& reply, const string& errorSource )
+{
+	//the daemon may be restarted since the last request
+	if(mSocket < 0 && !OpenSocket()) return false;
+
+	if(!WriteFrame(mSocket, request) || !ReadFrame(mSocket, reply) || reply.empty() || reply[0] != request[0])
+	{
+		CloseSocket();
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, errorSource, "Connection to the daemon '" + mSocketPath + "' is lost");
+		return false;
+	}
+	return true;
+}
+#pragma endregion Connection
+
+#pragma region Catalog
+
+bool ccdb::DaemonDataProvider::ReadCatalog()
+{
+	const char* thisFunc = "DaemonDataProvider::ReadCatalog";
+
+	string reply;
+	if(!Exchange(MessageWriter(cCatalog).GetPayload(), reply, thisFunc)) return false;
+
+	MessageReader reader(reply);
+	reader.ReadUInt8();
+	uint8_t status = reader.ReadUInt8();
+	if(status != cOk)
+	{
+		Error(status == cError ? reader.ReadInt32() : CCDB_ERROR_QUERY_SELECT, thisFunc, "The daemon failed to read type tables");
+		return false;
+	}
+
+	uint32_t tablesCount = reader.ReadUInt32();
+	vector<string> columnNames;
+	vector<string> columnTypes;
+	for(uint32_t i = 0; i < tablesCount && reader.IsOk(); i++)
+	{
+		string path = reader.ReadString();
+		int rowsCount = reader.ReadInt32();
+		string comment = reader.ReadString();
+		uint32_t columnsCount = reader.ReadUInt32();
+		columnNames.clear();
+		columnTypes.clear();
+		for(uint32_t j = 0; j < columnsCount && reader.IsOk(); j++)
+		{
+			columnNames.push_back(reader.ReadString());
+			columnTypes.push_back(reader.ReadString());
+		}
+		if(reader.IsOk()) AddTable(path, columnNames, columnTypes, rowsCount, comment);
+	}
+
+	if(!reader.IsOk() || !reader.IsAtEnd())
+	{
+		Error(CCDB_ERROR_FILE_FORMAT, thisFunc, "Wrong catalog message from the daemon");
+		return false;
+	}
+	return true;
+}
+
+
+ccdb::Variation* ccdb::DaemonDataProvider::GetVariation( const string& name )
+{
+	map<string, Variation*>::iterator it = mVariationsByName.find(name);
+	if(it != mVariationsByName.end()) return it->second;
+	if(!IsConnected()) return NULL;
+
+	MessageWriter request(cVariation);
+	request.WriteString(name);
+	string reply;
+	if(!Exchange(request.GetPayload(), reply, "DaemonDataProvider::GetVariation")) return NULL;
+
+	MessageReader reader(reply);
+	reader.ReadUInt8();
+	if(reader.ReadUInt8() != cOk) return NULL;
+	string parentName = reader.ReadString();
+	if(!reader.IsOk()) return NULL;
+
+	//parents go to the catalog first
+	if(!parentName.empty() && !GetVariation(parentName)) return NULL;
+	return AddVariation(name, parentName);
+}
+#pragma endregion Catalog
+
+#pragma region Assignments
+
+ccdb::Assignment* ccdb::DaemonDataProvider::GetAssignmentShort( int run, const string& path, time_t time, const string& variation/*="default"*/, bool loadColumns/*=false*/ )
+{
+	vector<ConstantsRequest> requests(1);
+	requests[0].Run = run;
+	requests[0].Time = time;
+	requests[0].Path = path;
+	requests[0].Variation = variation;
+
+	vector<Assignment*> assignments;
+	if(!GetAssignmentsBatch(requests, assignments, loadColumns)) return NULL;
+	return assignments[0];
+}
+
+
+bool ccdb::DaemonDataProvider::GetAssignmentsBatch( const vector<ConstantsRequest>& requests, vector<Assignment*>& assignments, bool loadColumns/*=false*/ )
+{
+	const char* thisFunc = "DaemonDataProvider::GetAssignmentsBatch";
+	if(!CheckConnection(thisFunc)) return false;
+
+	//requests of unknown tables are not sent
+	vector<int> tableIndexes(requests.size());
+	MessageWriter request(cAssignments);
+	uint32_t sentCount = 0;
+	for(size_t i = 0; i < requests.size(); i++)
+	{
+		string path(requests[i].Path);
+		PathUtils::MakeAbsolute(path);
+		tableIndexes[i] = FindTable(path);
+		if(tableIndexes[i] >= 0) sentCount++;
+	}
+	request.WriteUInt32(sentCount);
+	for(size_t i = 0; i < requests.size(); i++)
+	{
+		if(tableIndexes[i] < 0) continue;
+		request.WriteInt32(requests[i].Run);
+		request.WriteInt64((int64_t)requests[i].Time);
+		request.WriteString(mTables[tableIndexes[i]].FullPath);
+		request.WriteString(requests[i].Variation);
+	}
+
+	string reply;
+	if(sentCount > 0 && !Exchange(request.GetPayload(), reply, thisFunc)) return false;
+
+	MessageReader reader(reply);
+	if(sentCount > 0)
+	{
+		reader.ReadUInt8();
+		if(reader.ReadUInt32() != sentCount)
+		{
+			Error(CCDB_ERROR_FILE_FORMAT, thisFunc, "Wrong reply from the daemon");
+			return false;
+		}
+	}
+
+	assignments.assign(requests.size(), NULL);
+	for(size_t i = 0; i < requests.size(); i++)
+	{
+		if(tableIndexes[i] < 0)
+		{
+			Error(CCDB_ERROR_NO_TYPETABLE, thisFunc, "Type table was not found: '" + requests[i].Path + "'");
+			continue;
+		}
+
+		uint8_t status = reader.ReadUInt8();
+		if(status == cError)
+		{
+			Error(reader.ReadInt32(), thisFunc, "The daemon failed to get constants of '" + requests[i].Path + "' for variation '" + requests[i].Variation + "'");
+			continue;
+		}
+		if(status != cOk) continue;     //No constants is not an error, as for other providers
+
+		int id = reader.ReadInt32();
+		time_t createdTime = (time_t)reader.ReadInt64();
+		time_t modifiedTime = (time_t)reader.ReadInt64();
+		int dataVaultId = reader.ReadInt32();
+		string comment = reader.ReadString();
+		string blob = reader.ReadString();
+		if(!reader.IsOk()) break;
+
+		Assignment* assignment = CreateAssignment(tableIndexes[i], requests[i].Run, loadColumns);
+		assignment->SetId(id);
+		assignment->SetCreatedTime(createdTime);
+		assignment->SetModifiedTime(modifiedTime);
+		assignment->SetDataVaultId(dataVaultId);
+		assignment->SetComment(comment);
+		assignment->SetRawData(blob);
+		assignments[i] = assignment;
+	}
+
+	if(!reader.IsOk())
+	{
+		Error(CCDB_ERROR_FILE_FORMAT, thisFunc, "Wrong reply from the daemon");
+		return false;
+	}
+	return true;
+}
+#pragma endregion Assignments
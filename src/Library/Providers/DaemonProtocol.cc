@@ -0,0 +1,165 @@
+#include <string.h>
+#include <errno.h>
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#endif
+
+#include "CCDB/Providers/DaemonProtocol.h"
+
+using namespace std;
+
+namespace
+{
+#ifndef WIN32
+	bool WriteAll(int socket, const char* data, size_t length)
+	{
+		while(length > 0)
+		{
+			ssize_t written = send(socket, data, length, MSG_NOSIGNAL);
+			if(written < 0 && errno == EINTR) continue;
+			if(written <= 0) return false;
+			data += written;
+			length -= (size_t)written;
+		}
+		return true;
+	}
+
+	bool ReadAll(int socket, char* data, size_t length)
+	{
+		while(length > 0)
+		{
+			ssize_t received = recv(socket, data, length, 0);
+			if(received < 0 && errno == EINTR) continue;
+			if(received <= 0) return false;
+			data += received;
+			length -= (size_t)received;
+		}
+		return true;
+	}
+#endif
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonProtocol::MessageWriter::WriteString( const string& value )
+{
+	WriteUInt32((uint32_t)value.size());
+	mBuffer.append(value);
+}
+
+
+//______________________________________________________________________________
+bool ccdb::DaemonProtocol::MessageReader::Read( void* data, size_t length )
+{
+	if(!mIsOk || mPayload.size() - mPosition < length)
+	{
+		mIsOk = false;
+		memset(data, 0, length);
+		return false;
+	}
+	memcpy(data, mPayload.data() + mPosition, length);
+	mPosition += length;
+	return true;
+}
+
+
+//______________________________________________________________________________
+uint8_t ccdb::DaemonProtocol::MessageReader::ReadUInt8()
+{
+	uint8_t value;
+	Read(&value, sizeof(value));
+	return value;
+}
+
+
+//______________________________________________________________________________
+int32_t ccdb::DaemonProtocol::MessageReader::ReadInt32()
+{
+	int32_t value;
+	Read(&value, sizeof(value));
+	return value;
+}
+
+
+//______________________________________________________________________________
+uint32_t ccdb::DaemonProtocol::MessageReader::ReadUInt32()
+{
+	uint32_t value;
+	Read(&value, sizeof(value));
+	return value;
+}
+
+
+//______________________________________________________________________________
+int64_t ccdb::DaemonProtocol::MessageReader::ReadInt64()
+{
+	int64_t value;
+	Read(&value, sizeof(value));
+	return value;
+}
+
+
+//______________________________________________________________________________
+string ccdb::DaemonProtocol::MessageReader::ReadString()
+{
+	uint32_t length = ReadUInt32();
+	if(!mIsOk || mPayload.size() - mPosition < length)
+	{
+		mIsOk = false;
+		return string();
+	}
+	string value = mPayload.substr(mPosition, length);
+	mPosition += length;
+	return value;
+}
+
+
+//______________________________________________________________________________
+bool ccdb::DaemonProtocol::WriteFrame( int socket, const string& payload )
+{
+#ifndef WIN32
+	uint32_t length = (uint32_t)payload.size();
+	return WriteAll(socket, (const char*)&length, sizeof(length)) && WriteAll(socket, payload.data(), payload.size());
+#else
+	return false;
+#endif
+}
+
+
+//______________________________________________________________________________
+bool ccdb::DaemonProtocol::ReadFrame( int socket, string& payload )
+{
+#ifndef WIN32
+	uint32_t length;
+	if(!ReadAll(socket, (char*)&length, sizeof(length)) || length == 0 || length > cMaxFrameLength) return false;
+	payload.resize(length);
+	return ReadAll(socket, &payload[0], length);
+#else
+	return false;
+#endif
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonProtocol::AppendFrame( string& buffer, const string& payload )
+{
+	uint32_t length = (uint32_t)payload.size();
+	buffer.append((const char*)&length, sizeof(length));
+	buffer.append(payload);
+}
+
+
+//______________________________________________________________________________
+int ccdb::DaemonProtocol::TakeFrame( string& buffer, string& payload )
+{
+	uint32_t length;
+	if(buffer.size() < sizeof(length)) return 0;
+	memcpy(&length, buffer.data(), sizeof(length));
+	if(length == 0 || length > cMaxFrameLength) return -1;
+	if(buffer.size() - sizeof(length) < length) return 0;
+
+	payload.assign(buffer, sizeof(length), length);
+	buffer.erase(0, sizeof(length) + length);
+	return 1;
+}
@@ -0,0 +1,665 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <stdexcept>
+#ifndef WIN32
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include "CCDB/Providers/DaemonServer.h"
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Helpers/TimeProvider.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+using namespace ccdb::DaemonProtocol;
+
+namespace
+{
+	/** Milliseconds poll waits, so Stop is noticed in time */
+	const int PollTimeout = 200;
+
+	/** Bytes the cache takes by default */
+	const size_t DefaultMaxCacheBytes = 256*1024*1024;
+
+	/** Bytes a client may send ahead before it is not read */
+	const size_t MaxInputBytes = ccdb::DaemonProtocol::cMaxFrameLength + 4;
+
+	void WriteError(MessageWriter& writer, int errorCode)
+	{
+		writer.WriteUInt8(cError);
+		writer.WriteInt32(errorCode);
+	}
+
+	/** Results of requests for different runs are kept apart by the runs of each result */
+	string GetRequestKey(const ConstantsRequest& request)
+	{
+		return ccdb::StringUtils::Format("%s|%s|%lld", request.Path.c_str(), request.Variation.c_str(), (long long)request.Time);
+	}
+
+#ifndef WIN32
+	void SetNonBlocking(int socket)
+	{
+		fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+	}
+#endif
+}
+
+
+//______________________________________________________________________________
+ccdb::DaemonServer::DaemonServer( DataProvider* upstream )
+    :mUpstream(upstream), mListenSocket(-1), mIsStopping(false), mMaxAge(3600),
+    mCacheBytes(0), mMaxCacheBytes(DefaultMaxCacheBytes), mLastPurgeTime(0), mUpstreamRequests(0),
+    mIsUpstreamStopping(false)
+{
+    mWakePipe[0] = mWakePipe[1] = -1;
+}
+
+
+//______________________________________________________________________________
+ccdb::DaemonServer::~DaemonServer()
+{
+#ifndef WIN32
+    for(map<int, Client>::iterator it = mClients.begin(); it != mClients.end(); ++it) close(it->first);
+    if(mListenSocket >= 0)
+    {
+        close(mListenSocket);
+        unlink(mSocketPath.c_str());
+    }
+#endif
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonServer::Listen( const std::string& socketPath )
+{
+#ifndef WIN32
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(socketPath.size() >= sizeof(address.sun_path)) throw std::logic_error("Socket path is too long: '" + socketPath + "'");
+    strcpy(address.sun_path, socketPath.c_str());
+
+    mListenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(mListenSocket < 0) throw std::logic_error("Can't create socket");
+
+    //the socket file of a daemon that was killed is left behind
+    unlink(socketPath.c_str());
+    if(bind(mListenSocket, (sockaddr*)&address, sizeof(address)) != 0 || listen(mListenSocket, 128) != 0)
+    {
+        close(mListenSocket);
+        mListenSocket = -1;
+        throw std::logic_error("Can't listen on socket '" + socketPath + "'");
+    }
+    SetNonBlocking(mListenSocket);
+    mSocketPath = socketPath;
+#else
+    throw std::logic_error("Unix domain sockets are not supported on this platform");
+#endif
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonServer::Run()
+{
+#ifndef WIN32
+    if(mListenSocket < 0) throw std::logic_error("DaemonServer::Listen should be called before Run");
+    if(pipe(mWakePipe) != 0) throw std::logic_error("Can't create pipe");
+    SetNonBlocking(mWakePipe[0]);
+    SetNonBlocking(mWakePipe[1]);
+
+    mIsUpstreamStopping = false;
+    mUpstreamThread = std::thread(&DaemonServer::RunUpstream, this);
+
+    vector<pollfd> fds;
+    vector<int> sockets;
+    while(!mIsStopping)
+    {
+        fds.resize(mClients.size() + 2);
+        sockets.clear();
+        fds[0].fd = mListenSocket;
+        fds[0].events = POLLIN;
+        fds[1].fd = mWakePipe[0];
+        fds[1].events = POLLIN;
+        size_t fdIndex = 2;
+        for(map<int, Client>::iterator it = mClients.begin(); it != mClients.end(); ++it, ++fdIndex)
+        {
+            //a client that doesn't take its replies is not read either
+            Client& client = it->second;
+            bool hasOutput = client.OutputSent < client.Output.size();
+            fds[fdIndex].fd = it->first;
+            fds[fdIndex].events = (hasOutput ? POLLOUT : 0) | (hasOutput || client.Input.size() > MaxInputBytes ? 0 : POLLIN);
+            sockets.push_back(it->first);
+        }
+        for(size_t i = 0; i < fds.size(); i++) fds[i].revents = 0;
+
+        int ready = poll(&fds[0], fds.size(), PollTimeout);
+
+        //expired results are dropped even if nobody asks them again
+        time_t now = TimeProvider::GetUnixTimeStamp(ClockSources::Realtime);
+        if(mMaxAge > 0 && now - mLastPurgeTime >= mMaxAge)
+        {
+            PurgeExpired(now);
+            mLastPurgeTime = now;
+        }
+        if(ready <= 0) continue;
+
+        if(fds[1].revents)
+        {
+            char buffer[256];
+            while(read(mWakePipe[0], buffer, sizeof(buffer)) > 0) {}
+            TakeFinishedFetches();
+        }
+
+        //clients are served before new ones are accepted, so fds and sockets match
+        for(size_t i = 0; i < sockets.size(); i++)
+        {
+            short revents = fds[i + 2].revents;
+            map<int, Client>::iterator it = mClients.find(sockets[i]);
+            if(!revents || it == mClients.end()) continue;
+
+            Client& client = it->second;
+            bool isOk = (!(revents & POLLOUT) || SendOutput(client)) &&
+                        (!(revents & (POLLIN|POLLHUP|POLLERR)) || ReceiveInput(client)) &&
+                        ServeClient(client) && SendOutput(client);
+            if(isOk) continue;
+
+            //the fetch goes on, its result is cached but not sent
+            if(client.Pending) client.Pending->Client = -1;
+            close(it->first);
+            mClients.erase(it);
+        }
+
+        if(fds[0].revents & POLLIN)
+        {
+            int socket;
+            while((socket = accept(mListenSocket, NULL, NULL)) >= 0)
+            {
+                SetNonBlocking(socket);
+                mClients[socket].Socket = socket;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mFetchesMutex);
+        mIsUpstreamStopping = true;
+        mFetches.clear();
+    }
+    mFetchesCondition.notify_one();
+    mUpstreamThread.join();
+
+    //messages that wait are not answered, their clients get the reply from the next Run
+    mFinished.clear();
+    mInFlight.clear();
+    for(map<int, Client>::iterator it = mClients.begin(); it != mClients.end(); ++it) it->second.Pending.reset();
+    close(mWakePipe[0]);
+    close(mWakePipe[1]);
+    mWakePipe[0] = mWakePipe[1] = -1;
+    mIsStopping = false;
+#endif
+}
+
+
+//______________________________________________________________________________
+bool ccdb::DaemonServer::ReceiveInput( Client& client )
+{
+#ifndef WIN32
+    char buffer[64*1024];
+    while(client.Input.size() <= MaxInputBytes)
+    {
+        ssize_t received = recv(client.Socket, buffer, sizeof(buffer), 0);
+        if(received > 0)
+        {
+            client.Input.append(buffer, (size_t)received);
+            continue;
+        }
+        if(received < 0 && errno == EINTR) continue;
+        return received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+#endif
+    return true;
+}
+
+
+//______________________________________________________________________________
+bool ccdb::DaemonServer::SendOutput( Client& client )
+{
+#ifndef WIN32
+    while(client.OutputSent < client.Output.size())
+    {
+        ssize_t sent = send(client.Socket, client.Output.data() + client.OutputSent, client.Output.size() - client.OutputSent, MSG_NOSIGNAL);
+        if(sent > 0)
+        {
+            client.OutputSent += (size_t)sent;
+            continue;
+        }
+        if(sent < 0 && errno == EINTR) continue;
+        return sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    client.Output.clear();
+    client.OutputSent = 0;
+#endif
+    return true;
+}
+
+
+//______________________________________________________________________________
+bool ccdb::DaemonServer::ServeClient( Client& client )
+{
+    //messages of a client are answered in order, one at a time
+    string request;
+    while(!client.Pending && client.Output.empty())
+    {
+        int taken = TakeFrame(client.Input, request);
+        if(taken == 0) return true;
+        if(taken < 0 || !HandleMessage(client, request)) return false;
+    }
+    return true;
+}
+
+
+//______________________________________________________________________________
+bool ccdb::DaemonServer::HandleMessage( Client& client, const std::string& request )
+{
+    MessageReader reader(request);
+    uint8_t type = reader.ReadUInt8();
+
+    shared_ptr<PendingMessage> message(new PendingMessage());
+    message->Client = client.Socket;
+    message->Type = type;
+    message->MissingCount = 0;
+
+    Fetch fetch;
+    fetch.Type = type;
+    fetch.IsCacheable = false;
+    fetch.FirstRun = fetch.LastRun = 0;
+
+    if(type == cHello)
+    {
+        bool isOk = reader.ReadUInt32() == cMagic;
+        uint32_t version = reader.ReadUInt32();
+        MessageWriter writer(cHello);
+        writer.WriteUInt8(isOk && version == cVersion ? cOk : cError);
+        writer.WriteUInt32(cVersion);
+        AppendFrame(client.Output, writer.GetPayload());
+        return isOk && reader.IsAtEnd();
+    }
+
+    if(type == cCatalog)
+    {
+        if(!reader.IsAtEnd()) return false;
+
+        //the catalog is the same for all clients. Errors are not kept, the next client tries again
+        if(!mCatalog.empty())
+        {
+            AppendFrame(client.Output, mCatalog);
+            return true;
+        }
+        message->Results.resize(1);
+        fetch.Key = "catalog";
+        WaitFor(message, 0, fetch);
+    }
+    else if(type == cVariation)
+    {
+        fetch.Request.Path = reader.ReadString();
+        if(!reader.IsOk() || !reader.IsAtEnd()) return false;
+
+        message->Results.resize(1);
+        fetch.Key = "variation|" + fetch.Request.Path;
+        WaitFor(message, 0, fetch);
+    }
+    else if(type == cAssignments)
+    {
+        uint32_t count = reader.ReadUInt32();
+        vector<ConstantsRequest> requests;
+        for(uint32_t i = 0; i < count && reader.IsOk(); i++)
+        {
+            ConstantsRequest constantsRequest;
+            constantsRequest.Run = reader.ReadInt32();
+            constantsRequest.Time = (time_t)reader.ReadInt64();
+            constantsRequest.Path = reader.ReadString();
+            constantsRequest.Variation = reader.ReadString();
+            requests.push_back(constantsRequest);
+        }
+        if(!reader.IsOk() || !reader.IsAtEnd()) return false;
+
+        time_t now = TimeProvider::GetUnixTimeStamp(ClockSources::Realtime);
+        message->Results.resize(requests.size());
+        for(size_t i = 0; i < requests.size(); i++)
+        {
+            const ConstantsRequest& constantsRequest = requests[i];
+            CacheEntry* entry = FindCached(GetRequestKey(constantsRequest), constantsRequest.Run);
+            if(entry && !IsExpired(*entry, now))
+            {
+                mUseOrder.splice(mUseOrder.begin(), mUseOrder, entry->Use);
+                message->Results[i] = entry->Result;
+                continue;
+            }
+
+            //a fetch of the run is shared, requests of other runs of the same range may be fetched meanwhile
+            fetch.Key = StringUtils::Format("%s|%i", GetRequestKey(constantsRequest).c_str(), constantsRequest.Run);
+            fetch.Request = constantsRequest;
+            WaitFor(message, i, fetch);
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    if(message->MissingCount == 0) Reply(client, *message);
+    else client.Pending = message;
+    return true;
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonServer::WaitFor( const shared_ptr<PendingMessage>& message, size_t index, const Fetch& fetch )
+{
+    Waiter waiter;
+    waiter.Message = message;
+    waiter.Index = index;
+    message->MissingCount++;
+
+    //the key is fetched already, the message gets the same result
+    vector<Waiter>& waiters = mInFlight[fetch.Key];
+    waiters.push_back(waiter);
+    if(waiters.size() > 1) return;
+
+    if(fetch.Type == cAssignments) mUpstreamRequests++;
+    {
+        std::lock_guard<std::mutex> lock(mFetchesMutex);
+        mFetches.push_back(fetch);
+    }
+    mFetchesCondition.notify_one();
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonServer::TakeFinishedFetches()
+{
+    deque<Fetch> finished;
+    {
+        std::lock_guard<std::mutex> lock(mFetchesMutex);
+        finished.swap(mFinished);
+    }
+
+    for(size_t i = 0; i < finished.size(); i++)
+    {
+        Fetch& fetch = finished[i];
+        if(fetch.IsCacheable && fetch.Type == cAssignments) StoreCached(GetRequestKey(fetch.Request), fetch.FirstRun, fetch.LastRun, fetch.Request.Time, fetch.Result);
+        if(fetch.IsCacheable && fetch.Type == cCatalog) mCatalog = fetch.Result;
+
+        unordered_map<string, vector<Waiter> >::iterator it = mInFlight.find(fetch.Key);
+        if(it == mInFlight.end()) continue;
+        vector<Waiter> waiters;
+        waiters.swap(it->second);
+        mInFlight.erase(it);
+
+        for(size_t j = 0; j < waiters.size(); j++)
+        {
+            PendingMessage& message = *waiters[j].Message;
+            message.Results[waiters[j].Index] = fetch.Result;
+            if(--message.MissingCount > 0 || message.Client < 0) continue;
+
+            map<int, Client>::iterator clientIt = mClients.find(message.Client);
+            if(clientIt == mClients.end()) continue;
+
+            //the client goes on with messages it has sent meanwhile
+            Client& client = clientIt->second;
+            Reply(client, message);
+            client.Pending.reset();
+            if(!ServeClient(client) || !SendOutput(client))
+            {
+                if(client.Pending) client.Pending->Client = -1;
+                close(clientIt->first);
+                mClients.erase(clientIt);
+            }
+        }
+    }
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonServer::Reply( Client& client, const PendingMessage& message )
+{
+    //catalog and variation results are whole replies
+    if(message.Type != cAssignments)
+    {
+        AppendFrame(client.Output, message.Results[0]);
+        return;
+    }
+
+    MessageWriter writer(cAssignments);
+    writer.WriteUInt32((uint32_t)message.Results.size());
+    for(size_t i = 0; i < message.Results.size(); i++) writer.WriteBytes(message.Results[i].data(), message.Results[i].size());
+    AppendFrame(client.Output, writer.GetPayload());
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonServer::RunUpstream()
+{
+    for(;;)
+    {
+        Fetch fetch;
+        {
+            std::unique_lock<std::mutex> lock(mFetchesMutex);
+            mFetchesCondition.wait(lock, [this]() { return mIsUpstreamStopping || !mFetches.empty(); });
+            if(mIsUpstreamStopping) return;
+            fetch = mFetches.front();
+            mFetches.pop_front();
+        }
+
+        DoFetch(fetch);
+
+        {
+            std::lock_guard<std::mutex> lock(mFetchesMutex);
+            mFinished.push_back(fetch);
+        }
+#ifndef WIN32
+        char wake = 0;
+        if(write(mWakePipe[1], &wake, 1) < 0) {}    //the pipe is full, poll wakes up anyway
+#endif
+    }
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonServer::DoFetch( Fetch& fetch )
+{
+    if(fetch.Type == cAssignments)
+    {
+        fetch.IsCacheable = FetchAssignment(fetch.Request, fetch.Result, fetch.FirstRun, fetch.LastRun);
+        return;
+    }
+
+    if(fetch.Type == cCatalog)
+    {
+        MessageWriter writer(cCatalog);
+        MakeCatalog(writer);
+        fetch.Result = writer.GetPayload();
+        fetch.IsCacheable = fetch.Result[1] == cOk;
+        return;
+    }
+
+    MessageWriter writer(cVariation);
+    Variation* variation = mUpstream->GetVariation(fetch.Request.Path);
+    if(variation)
+    {
+        writer.WriteUInt8(cOk);
+        writer.WriteString(variation->GetParent() ? variation->GetParent()->GetName() : "");
+    }
+    else
+    {
+        writer.WriteUInt8(cNotFound);
+    }
+    fetch.Result = writer.GetPayload();
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonServer::MakeCatalog( MessageWriter& writer )
+{
+    vector<ConstantsTypeTable*> tables;
+    if(!mUpstream->SearchConstantsTypeTables(tables, "*", "", true))
+    {
+        WriteError(writer, mUpstream->GetLastError());
+        return;
+    }
+
+    writer.WriteUInt8(cOk);
+    writer.WriteUInt32((uint32_t)tables.size());
+    for(size_t i = 0; i < tables.size(); i++)
+    {
+        ConstantsTypeTable* table = tables[i];
+        vector<string> names = table->GetColumnNames();
+        vector<string> types = table->GetColumnTypeStrings();
+
+        writer.WriteString(table->GetFullPath());
+        writer.WriteInt32(table->GetRowsCount());
+        writer.WriteString(table->GetComment());
+        writer.WriteUInt32((uint32_t)names.size());
+        for(size_t j = 0; j < names.size(); j++)
+        {
+            writer.WriteString(names[j]);
+            writer.WriteString(types[j]);
+        }
+        delete table;
+    }
+}
+
+
+//______________________________________________________________________________
+bool ccdb::DaemonServer::FetchAssignment( const ConstantsRequest& request, string& result, int& firstRun, int& lastRun )
+{
+    Assignment* assignment = mUpstream->GetAssignmentForRuns(request.Run, request.Path, request.Time, request.Variation, true, firstRun, lastRun);
+
+    //the first byte of the payload is the message type, the result goes after it
+    MessageWriter writer(0);
+    bool isCacheable = true;
+    if(assignment)
+    {
+        writer.WriteUInt8(cOk);
+        writer.WriteInt32(assignment->GetId());
+        writer.WriteInt64((int64_t)assignment->GetCreatedTime());
+        writer.WriteInt64((int64_t)assignment->GetModifiedTime());
+        writer.WriteInt32((int32_t)assignment->GetDataVaultId());
+        writer.WriteString(assignment->GetComment());
+        writer.WriteString(assignment->GetRawData());
+        delete assignment;
+    }
+    else if(mUpstream->GetNErrors() > 0)
+    {
+        //errors are not cached, the next request tries again
+        WriteError(writer, mUpstream->GetLastError());
+        isCacheable = false;
+    }
+    else
+    {
+        writer.WriteUInt8(cNotFound);
+    }
+
+    result = writer.GetPayload().substr(1);
+    return isCacheable;
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonServer::StoreCached( const string& key, int firstRun, int lastRun, time_t requestTime, const string& result )
+{
+    //results of older fetches may be kept for some of the runs
+    map<int, CacheEntry>& entries = mCache[key];
+    map<int, CacheEntry>::iterator it = entries.upper_bound(lastRun);
+    while(it != entries.begin())
+    {
+        --it;
+        if(it->second.LastRun < firstRun) break;
+        mCacheBytes -= key.size() + it->second.Result.size();
+        mUseOrder.erase(it->second.Use);
+        it = entries.erase(it);
+    }
+
+    CacheEntry& entry = entries[firstRun];
+    entry.FetchedTime = TimeProvider::GetUnixTimeStamp(ClockSources::Realtime);
+    entry.RequestTime = requestTime;
+    entry.LastRun = lastRun;
+    entry.Result = result;
+    mUseOrder.push_front(CacheKey(key, firstRun));
+    entry.Use = mUseOrder.begin();
+    mCacheBytes += key.size() + entry.Result.size();
+
+    //the new result is kept even if it alone is bigger than the limit
+    while(mMaxCacheBytes > 0 && mCacheBytes > mMaxCacheBytes && mUseOrder.size() > 1)
+    {
+        CacheKey oldest = mUseOrder.back();
+        EraseCached(oldest);
+    }
+}
+
+
+//______________________________________________________________________________
+ccdb::DaemonServer::CacheEntry* ccdb::DaemonServer::FindCached( const string& key, int run )
+{
+    unordered_map<string, map<int, CacheEntry> >::iterator it = mCache.find(key);
+    if(it == mCache.end()) return NULL;
+
+    //results of a request don't overlap, the one that starts at the run or before it is the only candidate
+    map<int, CacheEntry>::iterator runIt = it->second.upper_bound(run);
+    if(runIt == it->second.begin()) return NULL;
+    --runIt;
+    return runIt->second.LastRun >= run ? &runIt->second : NULL;
+}
+
+
+//______________________________________________________________________________
+bool ccdb::DaemonServer::IsExpired( const CacheEntry& entry, time_t now ) const
+{
+    //constants at a time before the fetch can't change
+    bool isPast = entry.RequestTime > 0 && entry.RequestTime <= entry.FetchedTime;
+    return !isPast && mMaxAge > 0 && now - entry.FetchedTime > mMaxAge;
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonServer::EraseCached( const CacheKey& key )
+{
+    unordered_map<string, map<int, CacheEntry> >::iterator it = mCache.find(key.first);
+    if(it == mCache.end()) return;
+    map<int, CacheEntry>::iterator runIt = it->second.find(key.second);
+    if(runIt == it->second.end()) return;
+
+    mCacheBytes -= key.first.size() + runIt->second.Result.size();
+    mUseOrder.erase(runIt->second.Use);
+    it->second.erase(runIt);
+    if(it->second.empty()) mCache.erase(it);
+}
+
+
+//______________________________________________________________________________
+void ccdb::DaemonServer::PurgeExpired( time_t now )
+{
+    for(unordered_map<string, map<int, CacheEntry> >::iterator it = mCache.begin(); it != mCache.end();)
+    {
+        map<int, CacheEntry>& entries = it->second;
+        for(map<int, CacheEntry>::iterator runIt = entries.begin(); runIt != entries.end();)
+        {
+            if(!IsExpired(runIt->second, now))
+            {
+                ++runIt;
+                continue;
+            }
+            mCacheBytes -= it->first.size() + runIt->second.Result.size();
+            mUseOrder.erase(runIt->second.Use);
+            runIt = entries.erase(runIt);
+        }
+        if(entries.empty()) it = mCache.erase(it);
+        else ++it;
+    }
+}
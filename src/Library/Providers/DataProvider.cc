@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <limits.h>
 
 
 #include "CCDB/Providers/DataProvider.h"
@@ -12,6 +13,15 @@
 using namespace ccdb;
 using namespace std;
 
+namespace
+{
+	/** Parents of a variation GetAssignmentForRuns goes through */
+	const size_t cMaxVariationsDepth = 32;
+
+	/** Newer assignments GetAssignmentForRuns checks. If there are more, the assignment is given for the run only */
+	const size_t cMaxAssignmentsToCut = 100;
+}
+
 namespace ccdb
 {
 
@@ -89,6 +99,16 @@ std::string DataProvider::GetConnectionString()
     return mConnectionString;
 }
 
+
+bool DataProvider::Ping()
+{
+    /** @brief checks that the connection is still alive
+     *
+     * @return true if connection is open and alive
+     */
+    return IsConnected();
+}
+
 //----------------------------------------------------------------------------------------
 //	D I R E C T O R Y   M A N G E M E N T
 //----------------------------------------------------------------------------------------
@@ -310,6 +330,21 @@ bool DataProvider::GetVariations(vector<Variation*>& resultVariations, const str
 #pragma region Assignments
 
 
+BlobCursor* DataProvider::GetAssignmentCursor( int run, const string& path, time_t time, const string& variation/*= "default"*/ )
+{
+	/** @brief Get cursor that reads the data blob of the assignment row by row
+	 *
+	 * The base implementation takes the blob from GetAssignmentShort. It still keeps the blob
+	 * in memory but decoded cells live only one row at a time.
+	 */
+	Assignment* assignment = time > 0 ? GetAssignmentShort(run, path, time, variation, false) : GetAssignmentShort(run, path, variation, false);
+	if(!assignment) return NULL;
+
+	BlobCursor* cursor = new StringBlobCursor(assignment->GetRawData(), assignment->GetColumnsCount());
+	delete assignment;
+	return cursor;
+}
+
 Assignment* DataProvider::GetAssignmentFull( int run, const string& path, const string& variation )
 {
 	/** @brief Get last Assignment with all related objects
@@ -354,6 +389,86 @@ Assignment* DataProvider::GetAssignmentFull( int run, const string& path,int ver
 	return *assigments.begin();
 }
 
+//______________________________________________________________________________
+Assignment* DataProvider::GetAssignmentForRuns( int run, const string& path, time_t time, const string& variation, bool useParents, int& runMin, int& runMax )
+{
+	/** @brief Gets assignment with all related objects and the runs the same request gives it for
+	 *
+	 * The assignment is selected as GetAssignmentShort does it, run by run through the variation and its parents.
+	 * Then assignments that could be selected instead of it for other runs of its range cut these runs off
+	 */
+	runMin = runMax = run;
+
+	//run 0 in GetAssignments means all run ranges
+	if(run == 0)
+	{
+		if(!useParents) return GetAssignmentFull(run, path, variation);
+		return time > 0 ? GetAssignmentShort(run, path, time, variation) : GetAssignmentShort(run, path, variation);
+	}
+
+	//the variation and its parents until one has the assignment
+	vector<string> variations;
+	string current = variation;
+	Assignment* assignment = NULL;
+	while(!assignment && variations.size() < cMaxVariationsDepth)
+	{
+		vector<Assignment *> found;
+		if(!GetAssignments(found, path, run, run, "", current, 0, time, 0, 1, 0))
+		{
+			if(GetLastError() != CCDB_ERROR_NOT_IMPLEMENTED) return NULL;
+
+			//the provider keeps no history, the assignment is known for the run only
+			ClearErrors();
+			if(!useParents) return GetAssignmentFull(run, path, variation);
+			return time > 0 ? GetAssignmentShort(run, path, time, variation) : GetAssignmentShort(run, path, variation);
+		}
+		variations.push_back(current);
+		if(!found.empty())
+		{
+			assignment = found[0];
+			break;
+		}
+
+		Variation* parent = useParents ? GetVariation(current) : NULL;
+		if(parent) parent = parent->GetParent();
+		if(!parent) return NULL;
+		current = parent->GetName();
+	}
+	if(!assignment || !assignment->GetRunRange()) return assignment;
+
+	//newer assignments of its variation and any assignments of more specific variations are selected first
+	runMin = assignment->GetRunRange()->GetMin();
+	runMax = assignment->GetRunRange()->GetMax();
+	for(size_t i = 0; i < variations.size() && runMin < runMax; i++)
+	{
+		bool isOwnVariation = i + 1 == variations.size();
+		time_t beginTime = isOwnVariation ? assignment->GetCreatedTime() : 0;
+		time_t endTime = time > 0 ? time : (isOwnVariation ? INT_MAX : 0);
+
+		vector<Assignment *> others;
+		bool isListed = GetAssignments(others, path, 0, 0, "", variations[i], beginTime, endTime, 0, cMaxAssignmentsToCut + 1, 0);
+		if(!isListed || others.size() > cMaxAssignmentsToCut)
+		{
+			ClearErrors();
+			runMin = runMax = run;
+		}
+
+		for(size_t j = 0; j < others.size(); j++)
+		{
+			RunRange* range = others[j]->GetRunRange();
+			bool isOther = others[j]->GetId() != assignment->GetId() && range;
+			if(isOther && range->GetMax() >= runMin && range->GetMin() <= runMax)
+			{
+				if(range->GetMax() < run) runMin = range->GetMax() + 1;
+				else if(range->GetMin() > run) runMax = range->GetMin() - 1;
+				else runMin = runMax = run;	//created in the same second
+			}
+			delete others[j];
+		}
+	}
+	return assignment;
+}
+
 //______________________________________________________________________________
 
 #pragma endregion Assignments
@@ -0,0 +1,191 @@
+#include <thread>
+
+#include "CCDB/Providers/DataProviderPool.h"
+#include "CCDB/Helpers/TimeProvider.h"
+
+using namespace std;
+
+
+//______________________________________________________________________________
+ccdb::DataProviderPool::DataProviderPool( const std::string& connectionString, ProviderFactory factory, size_t maxSize/*=0*/ )
+    :mConnectionString(connectionString),
+    mFactory(factory),
+    mMaxSize(maxSize ? maxSize : GetDefaultSize()),
+    mPingInterval(60),
+    mAcquiresCount(0),
+    mWaitsCount(0),
+    mReconnectsCount(0)
+{
+}
+
+
+//______________________________________________________________________________
+ccdb::DataProviderPool::~DataProviderPool()
+{
+    for (size_t i = 0; i < mProviders.size(); i++)
+    {
+        if(mProviders[i]->IsConnected()) mProviders[i]->Disconnect();
+        delete mProviders[i];
+    }
+}
+
+
+//______________________________________________________________________________
+ccdb::DataProvider* ccdb::DataProviderPool::Acquire()
+{
+    DataProvider* provider = NULL;
+    string connectionString;
+    bool needPing = false;
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mAcquiresCount++;
+
+        if(mFree.empty() && mProviders.size() >= mMaxSize)
+        {
+            mWaitsCount++;
+            while(mFree.empty()) mReleased.wait(lock);
+        }
+
+        if(!mFree.empty())
+        {
+            provider = mFree.back();
+            mFree.pop_back();
+
+            time_t now = TimeProvider::GetUnixTimeStamp(ClockSources::Monotonic);
+            needPing = mPingInterval >= 0 && now - mReleaseTimes[provider] >= mPingInterval;
+        }
+        else
+        {
+            provider = mFactory();
+            mProviders.push_back(provider);
+        }
+        connectionString = mConnectionString;
+    }
+
+    //the provider is ours now, check and connect it out of the lock
+    if(needPing && provider->IsConnected() && !provider->Ping())
+    {
+        provider->Disconnect();
+        std::lock_guard<std::mutex> lock(mMutex);
+        mReconnectsCount++;
+    }
+
+    if(!provider->IsConnected() && !provider->Connect(connectionString))
+    {
+        Release(provider);
+        return NULL;
+    }
+    return provider;
+}
+
+
+//______________________________________________________________________________
+void ccdb::DataProviderPool::Release( DataProvider* provider )
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFree.push_back(provider);
+        mReleaseTimes[provider] = TimeProvider::GetUnixTimeStamp(ClockSources::Monotonic);
+    }
+    mReleased.notify_one();
+}
+
+
+//______________________________________________________________________________
+void ccdb::DataProviderPool::Disconnect()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < mFree.size(); i++)
+    {
+        if(mFree[i]->IsConnected()) mFree[i]->Disconnect();
+    }
+}
+
+
+//______________________________________________________________________________
+std::string ccdb::DataProviderPool::GetConnectionString()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mConnectionString;
+}
+
+
+//______________________________________________________________________________
+void ccdb::DataProviderPool::SetConnectionString( const std::string& connectionString )
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mConnectionString = connectionString;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::DataProviderPool::GetMaxSize()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMaxSize;
+}
+
+
+//______________________________________________________________________________
+void ccdb::DataProviderPool::SetMaxSize( size_t maxSize )
+{
+    //Already created providers are kept even if there are more of them than maxSize
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMaxSize = maxSize ? maxSize : GetDefaultSize();
+}
+
+
+//______________________________________________________________________________
+int ccdb::DataProviderPool::GetPingInterval()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPingInterval;
+}
+
+
+//______________________________________________________________________________
+void ccdb::DataProviderPool::SetPingInterval( int seconds )
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPingInterval = seconds;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::DataProviderPool::GetSize()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mProviders.size();
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::DataProviderPool::GetAcquiresCount()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mAcquiresCount;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::DataProviderPool::GetWaitsCount()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mWaitsCount;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::DataProviderPool::GetReconnectsCount()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mReconnectsCount;
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::DataProviderPool::GetDefaultSize()
+{
+    unsigned int threads = std::thread::hardware_concurrency();
+    return threads ? threads : 4;
+}
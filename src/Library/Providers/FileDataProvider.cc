@@ -1,30 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "CCDB/Providers/FileDataProvider.h"
-namespace ccdb
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+
+namespace
+{
+	/** Splits the line by tabs. Unlike StringUtils::Split keeps empty fields */
+	void SplitFields(const string& line, vector<string>& fields)
+	{
+		fields.clear();
+		size_t start = 0;
+		while(true)
+		{
+			size_t tabPos = line.find('\t', start);
+			fields.push_back(line.substr(start, tabPos == string::npos ? string::npos : tabPos - start));
+			if(tabPos == string::npos) break;
+			start = tabPos + 1;
+		}
+	}
+
+	bool ParseNumber(const string& str, long long& value)
+	{
+		if(str.empty()) return false;
+		char* end;
+		value = strtoll(str.c_str(), &end, 10);
+		return *end == '\0';
+	}
+}
+
+#pragma region constructors
+
+ccdb::FileDataProvider::FileDataProvider(void)
+{
+	mCreatedTime = 0;
+}
+
+
+ccdb::FileDataProvider::~FileDataProvider(void)
+{
+	if(IsConnected())
+	{
+		Disconnect();
+	}
+}
+#pragma endregion constructors
+
+#pragma region Connection
+
+bool ccdb::FileDataProvider::Connect( string connectionString )
 {
+	ClearErrors();
+
+	if(IsConnected())
+	{
+		Error(CCDB_ERROR_CONNECTION_ALREADY_OPENED, "FileDataProvider::Connect", "Connection already opened");
+		return false;
+	}
+
+	if(connectionString.find("file://") != 0)
+	{
+		Error(CCDB_ERROR_PARSE_CONNECTION_STRING, "FileDataProvider::Connect", "Connection string should start with file://");
+		return false;
+	}
+	mDirectory = connectionString.substr(7);
+	if(mDirectory.empty()) mDirectory = ".";
+
+	//read the whole index
+	string indexPath = mDirectory + "/" + GetIndexFileName();
+	FILE* file = fopen(indexPath.c_str(), "rb");
+	if(!file)
+	{
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "FileDataProvider::Connect", "Can't open index file '" + indexPath + "'");
+		return false;
+	}
+	string index;
+	char chunk[64*1024];
+	size_t read;
+	while((read = fread(chunk, 1, sizeof(chunk), file)) > 0) index.append(chunk, read);
+	fclose(file);
+
+	mIsConnected = true;
+	if(!ReadIndex(index))
+	{
+		Disconnect();
+		return false;
+	}
 
+	mConnectionString = connectionString;
+	return true;
+}
 
 
-FileDataProvider::FileDataProvider(void)
+void ccdb::FileDataProvider::Disconnect()
 {
+	if(!IsConnected()) return;
 
+	mIntervals.clear();
+	ClearCatalog();
+	mIsConnected = false;
 }
+#pragma endregion Connection
 
+#pragma region Index
 
-FileDataProvider::~FileDataProvider(void)
+bool ccdb::FileDataProvider::ReadIndex( const string& index )
 {
+	const char* thisFunc = "FileDataProvider::ReadIndex";
+
+	vector<string> fields;
+	long long numbers[6];
+	size_t lineStart = 0;
+	int lineNumber = 0;
+	bool hasHeader = false;
+	while(lineStart < index.size())
+	{
+		size_t lineEnd = index.find('\n', lineStart);
+		if(lineEnd == string::npos) lineEnd = index.size();
+		string line = index.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+		lineNumber++;
+
+		if(!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+		if(line.empty() || line[0] == '#') continue;
+		SplitFields(line, fields);
+
+		const string& record = fields[0];
+		bool isOk = true;
+		if(!hasHeader)
+		{
+			isOk = record == "ccdbfiles" && fields.size() == 3 && ParseNumber(fields[1], numbers[0]) && ParseNumber(fields[2], numbers[1]);
+			if(isOk && numbers[0] != GetFormatVersion())
+			{
+				Error(CCDB_ERROR_FILE_FORMAT, thisFunc, StringUtils::Format("Index version %i is not supported. Supported version is %i", (int)numbers[0], GetFormatVersion()));
+				return false;
+			}
+			mCreatedTime = (time_t)numbers[1];
+			hasHeader = isOk;
+		}
+		else if(record == "variation" && fields.size() == 3)
+		{
+			isOk = mVariationsByName.find(fields[1]) == mVariationsByName.end() &&
+			       (fields[2].empty() || mVariationsByName.find(fields[2]) != mVariationsByName.end());
+			if(isOk) AddVariation(fields[1], fields[2]);
+		}
+		else if(record == "table" && fields.size() == 4)
+		{
+			isOk = ParseNumber(fields[2], numbers[0]) && FindTable(fields[1]) < 0;
+			if(isOk)
+			{
+				AddTable(fields[1], vector<string>(), vector<string>(), (int)numbers[0], fields[3]);
+				mIntervals.push_back(VariationIntervals());
+			}
+		}
+		else if(record == "column" && fields.size() == 3)
+		{
+			isOk = !mTables.empty();
+			if(isOk)
+			{
+				mTables.back().ColumnNames.push_back(fields[1]);
+				mTables.back().ColumnTypes.push_back(fields[2]);
+			}
+		}
+		else if(record == "interval" && fields.size() == 8)
+		{
+			isOk = !mTables.empty() && mVariationsByName.find(fields[1]) != mVariationsByName.end();
+			for(size_t i = 0; isOk && i < 6; i++) isOk = ParseNumber(fields[i + 2], numbers[i]);
+			isOk = isOk && numbers[0] <= numbers[1] && numbers[4] >= 0 && numbers[5] >= 0;
+			if(isOk)
+			{
+				FileInterval interval;
+				interval.RunMin = (int)numbers[0];
+				interval.RunMax = (int)numbers[1];
+				interval.AssignmentId = (int)numbers[2];
+				interval.CreatedTime = (time_t)numbers[3];
+				interval.Offset = (uint64_t)numbers[4];
+				interval.Length = (uint64_t)numbers[5];
+				mIntervals.back()[fields[1]].push_back(interval);
+			}
+		}
+		else
+		{
+			isOk = false;
+		}
+
+		if(!isOk)
+		{
+			Error(CCDB_ERROR_FILE_FORMAT, thisFunc, StringUtils::Format("Wrong record at line %i of the index", lineNumber));
+			return false;
+		}
+	}
+
+	if(!hasHeader)
+	{
+		Error(CCDB_ERROR_FILE_FORMAT, thisFunc, "The index is empty");
+		return false;
+	}
+
+	//intervals are sorted by the writer, but lets not rely on that
+	for(size_t i = 0; i < mIntervals.size(); i++)
+	{
+		for(VariationIntervals::iterator it = mIntervals[i].begin(); it != mIntervals[i].end(); ++it)
+		{
+			vector<FileInterval>& intervals = it->second;
+			sort(intervals.begin(), intervals.end());
+			for(size_t j = 1; j < intervals.size(); j++)
+			{
+				if(intervals[j - 1].RunMax >= intervals[j].RunMin)
+				{
+					Error(CCDB_ERROR_FILE_FORMAT, thisFunc, "Run ranges of '" + mTables[i].FullPath + "' overlap in variation '" + it->first + "'");
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
 }
+#pragma endregion Index
 
-bool FileDataProvider::Connect( std::string connectionString )
+#pragma region Assignments
+
+const ccdb::FileDataProvider::FileInterval* ccdb::FileDataProvider::FindInterval( size_t tableIndex, Variation* variation, int run ) const
 {
-	//
-	return false;
+	FileInterval key;
+	key.RunMin = run;
+
+	//if the variation has no constants for the run, its parent is searched
+	for(; variation != NULL; variation = variation->GetParent())
+	{
+		VariationIntervals::const_iterator it = mIntervals[tableIndex].find(variation->GetName());
+		if(it == mIntervals[tableIndex].end()) continue;
 
+		//the last interval that starts not after the run
+		const vector<FileInterval>& intervals = it->second;
+		vector<FileInterval>::const_iterator next = upper_bound(intervals.begin(), intervals.end(), key);
+		if(next != intervals.begin() && (next - 1)->RunMax >= run) return &*(next - 1);
+	}
+	return NULL;
 }
 
-void FileDataProvider::Disconnect()
+
+bool ccdb::FileDataProvider::ReadBlob( size_t tableIndex, const FileInterval& interval, string& blob )
 {
-	//
+	//The file is opened for each read, so the number of open files doesn't depend on the number of tables
+	string filePath = mDirectory + mTables[tableIndex].FullPath + GetTableFileExtension();
+	blob.resize((size_t)interval.Length);
 
+	bool isOk;
+#ifndef WIN32
+	int fd = open(filePath.c_str(), O_RDONLY);
+	if(fd < 0)
+	{
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "FileDataProvider::ReadBlob", "Can't open file '" + filePath + "'");
+		return false;
+	}
+	isOk = blob.empty() || pread(fd, &blob[0], blob.size(), (off_t)interval.Offset) == (ssize_t)blob.size();
+	close(fd);
+#else
+	FILE* file = fopen(filePath.c_str(), "rb");
+	if(!file)
+	{
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "FileDataProvider::ReadBlob", "Can't open file '" + filePath + "'");
+		return false;
+	}
+	isOk = blob.empty() || (_fseeki64(file, (__int64)interval.Offset, SEEK_SET) == 0 && fread(&blob[0], 1, blob.size(), file) == blob.size());
+	fclose(file);
+#endif
 
+	if(!isOk)
+	{
+		Error(CCDB_ERROR_FILE_FORMAT, "FileDataProvider::ReadBlob", "File '" + filePath + "' is shorter than the index tells");
+	}
+	return isOk;
 }
+
+
+ccdb::Assignment* ccdb::FileDataProvider::GetAssignmentShort( int run, const string& path, time_t time, const string& variation/*="default"*/, bool loadColumns/*=false*/ )
+{
+	const char* thisFunc = "FileDataProvider::GetAssignmentShort";
+	if(!CheckConnection(thisFunc)) return NULL;
+
+	if(time > 0 && time < mCreatedTime)
+	{
+		Error(CCDB_ERROR_NO_ASSIGMENT, thisFunc, StringUtils::Format("The directory has the latest constants at time %lld only", (long long)mCreatedTime));
+		return NULL;
+	}
+
+	Variation* variationObj = GetVariation(variation);
+	if(!variationObj)
+	{
+		Error(CCDB_ERROR_VARIATION_INVALID, thisFunc, "Variation was not found: '" + variation + "'");
+		return NULL;
+	}
+
+	int tableIndex = FindTable(path);
+	if(tableIndex < 0)
+	{
+		Error(CCDB_ERROR_NO_TYPETABLE, thisFunc, "Type table was not found: '" + path + "'");
+		return NULL;
+	}
+
+	const FileInterval* interval = FindInterval(tableIndex, variationObj, run);
+	if(!interval)
+	{
+		//No constants is not an error, as for other providers
+		return NULL;
+	}
+
+	string blob;
+	if(!ReadBlob(tableIndex, *interval, blob)) return NULL;
+
+	Assignment* assignment = CreateAssignment(tableIndex, run, loadColumns);
+	assignment->SetId(interval->AssignmentId);
+	assignment->SetCreatedTime(interval->CreatedTime);
+	assignment->SetRawData(blob);
+	return assignment;
 }
+#pragma endregion Assignments
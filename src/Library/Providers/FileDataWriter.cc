@@ -0,0 +1,293 @@
+#include <stdio.h>
+#include <errno.h>
+#include <algorithm>
+#include <stdexcept>
+#include <sys/stat.h>
+#ifdef WIN32
+#include <direct.h>
+#endif
+
+#include "CCDB/Providers/FileDataWriter.h"
+#include "CCDB/Providers/FileDataProvider.h"
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Helpers/TimeProvider.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+
+namespace
+{
+    /** Index fields are separated by tabs and records by new lines, so they can't be in comments */
+    string ToIndexField(const string& str)
+    {
+        string result(str);
+        replace(result.begin(), result.end(), '\t', ' ');
+        replace(result.begin(), result.end(), '\n', ' ');
+        replace(result.begin(), result.end(), '\r', ' ');
+        return result;
+    }
+
+    /** Writes to a temporary file and renames it, so nobody reads a half written file */
+    void WriteFile(const string& filePath, const string& content)
+    {
+        string tempPath = filePath + ".tmp";
+        FILE* target = fopen(tempPath.c_str(), "wb");
+        if(!target) throw std::logic_error("Can't open file '" + tempPath + "' for writing");
+
+        bool isOk = fwrite(content.data(), 1, content.size(), target) == content.size();
+        isOk = (fclose(target) == 0) && isOk;
+        if(!isOk || rename(tempPath.c_str(), filePath.c_str()) != 0)
+        {
+            remove(tempPath.c_str());
+            throw std::logic_error("Can't write file '" + filePath + "'");
+        }
+    }
+}
+
+
+//______________________________________________________________________________
+ccdb::FileDataWriter::FileDataWriter( DataProvider* source )
+    :mSource(source)
+{
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::FileDataWriter::GetIntervalsCount() const
+{
+    size_t count = 0;
+    for(map<string, TableEntry>::const_iterator it = mTables.begin(); it != mTables.end(); ++it)
+    {
+        count += it->second.Intervals.size();
+    }
+    return count;
+}
+
+
+//______________________________________________________________________________
+void ccdb::FileDataWriter::AddAllTables()
+{
+    vector<ConstantsTypeTable*> tables;
+    if(!mSource->SearchConstantsTypeTables(tables, "*"))
+    {
+        throw std::logic_error(GetSourceErrors("Error selecting all type tables"));
+    }
+
+    vector<string> paths;
+    for(size_t i = 0; i < tables.size(); i++)
+    {
+        paths.push_back(tables[i]->GetFullPath());
+        delete tables[i];
+    }
+
+    for(size_t i = 0; i < paths.size(); i++) AddTable(paths[i]);
+}
+
+
+//______________________________________________________________________________
+void ccdb::FileDataWriter::AddTable( const std::string& tablePath )
+{
+    string path(tablePath);
+    PathUtils::MakeAbsolute(path);
+    if(mTables.find(path) != mTables.end()) return;
+
+    ConstantsTypeTable* typeTable = mSource->GetConstantsTypeTable(path, true);
+    if(!typeTable) throw std::logic_error(GetSourceErrors("Type table was not found: '" + path + "'"));
+
+    TableEntry table;
+    table.Path = path;
+    table.Comment = typeTable->GetComment();
+    table.RowsCount = typeTable->GetRowsCount();
+    table.ColumnNames = typeTable->GetColumnNames();
+    table.ColumnTypes = typeTable->GetColumnTypeStrings();
+    delete typeTable;
+
+    //All assignments of all variations with their blobs in one request
+    vector<Assignment*> assignments;
+    if(!mSource->GetAssignments(assignments, path, 0, 0, "", "", 0, 0))
+    {
+        throw std::logic_error(GetSourceErrors("Error selecting assignments of '" + path + "'"));
+    }
+
+    //group by variation. In each group the assignment with the biggest id is the latest one
+    map<string, vector<Assignment*> > byVariation;
+    for(size_t i = 0; i < assignments.size(); i++)
+    {
+        Assignment* assignment = assignments[i];
+        if(assignment->GetVariation() && assignment->GetRunRange())
+        {
+            byVariation[assignment->GetVariation()->GetName()].push_back(assignment);
+        }
+    }
+
+    map<int, size_t> blobsByAssignment;
+    for(map<string, vector<Assignment*> >::iterator it = byVariation.begin(); it != byVariation.end(); ++it)
+    {
+        const vector<Assignment*>& group = it->second;
+        AddVariation(it->first);
+
+        //Constants can change only on borders of run ranges
+        set<int> borders;
+        for(size_t i = 0; i < group.size(); i++)
+        {
+            borders.insert(group[i]->GetRunRange()->GetMin());
+            if(group[i]->GetRunRange()->GetMax() < INFINITE_RUN) borders.insert(group[i]->GetRunRange()->GetMax() + 1);
+        }
+
+        for(set<int>::iterator border = borders.begin(); border != borders.end(); ++border)
+        {
+            int runMin = *border;
+            set<int>::iterator next = border;
+            ++next;
+            int runMax = next == borders.end() ? INFINITE_RUN : *next - 1;
+
+            Assignment* latest = NULL;
+            for(size_t i = 0; i < group.size(); i++)
+            {
+                RunRange* runRange = group[i]->GetRunRange();
+                if(runRange->GetMin() <= runMin && runRange->GetMax() >= runMin && (!latest || group[i]->GetId() > latest->GetId()))
+                {
+                    latest = group[i];
+                }
+            }
+            if(!latest) continue;     //a hole between run ranges
+
+            size_t blobIndex;
+            map<int, size_t>::iterator blobIt = blobsByAssignment.find(latest->GetId());
+            if(blobIt != blobsByAssignment.end())
+            {
+                blobIndex = blobIt->second;
+            }
+            else
+            {
+                BlobEntry blob;
+                blob.AssignmentId = latest->GetId();
+                blob.CreatedTime = latest->GetCreatedTime();
+                blob.RawData = latest->GetRawData();
+                table.Blobs.push_back(blob);
+                blobIndex = table.Blobs.size() - 1;
+                blobsByAssignment[blob.AssignmentId] = blobIndex;
+            }
+
+            //merge with the previous interval if it has the same constants
+            if(!table.Intervals.empty())
+            {
+                IntervalEntry& last = table.Intervals.back();
+                if(last.Variation == it->first && last.Blob == blobIndex && last.RunMax + 1 == runMin)
+                {
+                    last.RunMax = runMax;
+                    continue;
+                }
+            }
+
+            IntervalEntry interval;
+            interval.Variation = it->first;
+            interval.RunMin = runMin;
+            interval.RunMax = runMax;
+            interval.Blob = blobIndex;
+            table.Intervals.push_back(interval);
+        }
+    }
+
+    for(size_t i = 0; i < assignments.size(); i++) delete assignments[i];
+
+    mTables[path] = table;
+}
+
+
+//______________________________________________________________________________
+void ccdb::FileDataWriter::AddVariation( const std::string& name )
+{
+    if(mVariationNames.find(name) != mVariationNames.end()) return;
+
+    Variation* variation = mSource->GetVariation(name);
+    if(!variation) throw std::logic_error(GetSourceErrors("Variation was not found: '" + name + "'"));
+
+    string parentName = variation->GetParent() ? variation->GetParent()->GetName() : "";
+    if(!parentName.empty()) AddVariation(parentName);
+
+    mVariations.push_back(make_pair(name, parentName));
+    mVariationNames.insert(name);
+}
+
+
+//______________________________________________________________________________
+std::string ccdb::FileDataWriter::GetSourceErrors( const std::string& message )
+{
+    string result(message);
+    vector<CCDBError *> errors = mSource->GetErrors();
+    for(size_t i = 0; i < errors.size(); i++)
+    {
+        result += ". " + errors[i]->GetMessage();
+    }
+    return result;
+}
+
+
+//______________________________________________________________________________
+void ccdb::FileDataWriter::MakeDirectories( const std::string& dirPath )
+{
+    size_t pos = 0;
+    while(pos != string::npos)
+    {
+        pos = dirPath.find('/', pos + 1);
+        string part = dirPath.substr(0, pos);
+
+#ifdef WIN32
+        int result = _mkdir(part.c_str());
+#else
+        int result = mkdir(part.c_str(), 0755);
+#endif
+        if(result != 0 && errno != EEXIST) throw std::logic_error("Can't create directory '" + part + "'");
+    }
+}
+
+
+//______________________________________________________________________________
+void ccdb::FileDataWriter::Write( const std::string& dirPath )
+{
+    MakeDirectories(dirPath);
+
+    string index = StringUtils::Format("ccdbfiles\t%i\t%lld\n", FileDataProvider::GetFormatVersion(),
+                                       (long long)TimeProvider::GetUnixTimeStamp(ClockSources::Realtime));
+
+    for(size_t i = 0; i < mVariations.size(); i++)
+    {
+        index += "variation\t" + mVariations[i].first + "\t" + mVariations[i].second + "\n";
+    }
+
+    for(map<string, TableEntry>::const_iterator it = mTables.begin(); it != mTables.end(); ++it)
+    {
+        const TableEntry& table = it->second;
+
+        //blobs are separated by new lines just to make the file readable
+        string data;
+        vector<pair<size_t, size_t> > blobRefs;   //offset and length
+        for(size_t i = 0; i < table.Blobs.size(); i++)
+        {
+            blobRefs.push_back(make_pair(data.size(), table.Blobs[i].RawData.size()));
+            data += table.Blobs[i].RawData;
+            data += '\n';
+        }
+        MakeDirectories(dirPath + PathUtils::ExtractDirectory(table.Path));
+        WriteFile(dirPath + table.Path + FileDataProvider::GetTableFileExtension(), data);
+
+        index += StringUtils::Format("table\t%s\t%i\t", table.Path.c_str(), table.RowsCount) + ToIndexField(table.Comment) + "\n";
+        for(size_t i = 0; i < table.ColumnNames.size(); i++)
+        {
+            index += "column\t" + table.ColumnNames[i] + "\t" + table.ColumnTypes[i] + "\n";
+        }
+        for(size_t i = 0; i < table.Intervals.size(); i++)
+        {
+            const IntervalEntry& interval = table.Intervals[i];
+            const BlobEntry& blob = table.Blobs[interval.Blob];
+            index += StringUtils::Format("interval\t%s\t%i\t%i\t%i\t%lld\t%llu\t%llu\n", interval.Variation.c_str(),
+                interval.RunMin, interval.RunMax, blob.AssignmentId, (long long)blob.CreatedTime,
+                (unsigned long long)blobRefs[interval.Blob].first, (unsigned long long)blobRefs[interval.Blob].second);
+        }
+    }
+
+    //the index goes last, so it never refers to table files that are not written yet
+    WriteFile(dirPath + "/" + FileDataProvider::GetIndexFileName(), index);
+}
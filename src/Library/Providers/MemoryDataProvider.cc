@@ -0,0 +1,685 @@
+#include <algorithm>
+#include <set>
+
+#include "CCDB/Providers/MemoryDataProvider.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#ifdef CCDB_MYSQL
+#include "CCDB/Providers/MySQLDataProvider.h"
+#endif
+#include "CCDB/Model/Directory.h"
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+
+namespace
+{
+	/** Takes 'take' objects starting from 'startWith' as SQL LIMIT does. take=0 means all */
+	template<class T> void TakePage(vector<T>& objects, int take, int startWith)
+	{
+		if(startWith > 0) objects.erase(objects.begin(), objects.begin() + min((size_t)startWith, objects.size()));
+		if(take > 0 && (size_t)take < objects.size()) objects.resize(take);
+	}
+
+	/** Adds the directory and all its subdirectories to the list */
+	void CollectDirectories(ccdb::Directory* dir, vector<string>& paths)
+	{
+		const vector<ccdb::Directory*>& subdirectories = dir->GetSubdirectories();
+		for(size_t i = 0; i < subdirectories.size(); i++)
+		{
+			paths.push_back(subdirectories[i]->GetFullPath());
+			CollectDirectories(subdirectories[i], paths);
+		}
+	}
+}
+
+#pragma region constructors
+
+ccdb::MemoryDataProvider::MemoryDataProvider(bool loadLazily/*=false*/)
+{
+	mLoadLazily = loadLazily;
+	mSource = NULL;
+	mIsSourceOwned = false;
+	mLoadedTablesCount = 0;
+}
+
+
+ccdb::MemoryDataProvider::~MemoryDataProvider(void)
+{
+	if(IsConnected())
+	{
+		Disconnect();
+	}
+}
+#pragma endregion constructors
+
+#pragma region Connection
+
+bool ccdb::MemoryDataProvider::Connect( string connectionString )
+{
+	ClearErrors();
+
+	if(IsConnected())
+	{
+		Error(CCDB_ERROR_CONNECTION_ALREADY_OPENED, "MemoryDataProvider::Connect", "Connection already opened");
+		return false;
+	}
+
+	if(connectionString.find("memory://") != 0)
+	{
+		Error(CCDB_ERROR_PARSE_CONNECTION_STRING, "MemoryDataProvider::Connect", "Connection string should start with memory://");
+		return false;
+	}
+	string sourceString = connectionString.substr(9);
+
+	DataProvider* source = NULL;
+	if(sourceString.find("sqlite://") == 0)
+	{
+		source = new SQLiteDataProvider();
+	}
+#ifdef CCDB_MYSQL
+	else if(sourceString.find("mysql://") == 0)
+	{
+		source = new MySQLDataProvider();
+	}
+#endif
+	else
+	{
+		Error(CCDB_ERROR_PARSE_CONNECTION_STRING, "MemoryDataProvider::Connect", "Source should be sqlite:// or mysql:// connection string. It is: '" + sourceString + "'");
+		return false;
+	}
+
+	if(!source->Connect(sourceString))
+	{
+		mSource = source;
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "MemoryDataProvider::Connect", GetSourceErrors("Can't connect to the source '" + sourceString + "'"));
+		mSource = NULL;
+		delete source;
+		return false;
+	}
+
+	mIsSourceOwned = true;
+	if(!LoadSource(source)) return false;
+
+	mConnectionString = connectionString;
+	return true;
+}
+
+
+bool ccdb::MemoryDataProvider::Load( DataProvider* source )
+{
+	ClearErrors();
+
+	if(IsConnected())
+	{
+		Error(CCDB_ERROR_CONNECTION_ALREADY_OPENED, "MemoryDataProvider::Load", "Connection already opened");
+		return false;
+	}
+
+	if(!source || !source->IsConnected())
+	{
+		Error(CCDB_ERROR_NOT_CONNECTED, "MemoryDataProvider::Load", "Source provider is not connected");
+		return false;
+	}
+
+	mIsSourceOwned = false;
+	if(!LoadSource(source)) return false;
+
+	mConnectionString = "memory://" + source->GetConnectionString();
+	return true;
+}
+
+
+void ccdb::MemoryDataProvider::Disconnect()
+{
+	if(!IsConnected()) return;
+
+	mMemoryTables.clear();
+	mRunRanges.clear();
+	mRunRangesById.clear();
+	mBlobs.clear();
+	mBlobsByVaultId.clear();
+	mAssignmentsById.clear();
+	mLoadedTablesCount = 0;
+	ClearCatalog();
+
+	if(mSource && mIsSourceOwned)
+	{
+		mSource->Disconnect();
+		delete mSource;
+	}
+	mSource = NULL;
+	mIsSourceOwned = false;
+	mIsConnected = false;
+}
+#pragma endregion Connection
+
+#pragma region Loading
+
+bool ccdb::MemoryDataProvider::LoadSource( DataProvider* source )
+{
+	const char* thisFunc = "MemoryDataProvider::LoadSource";
+	mSource = source;
+	mIsConnected = true;
+
+	//directories, even if they have no tables
+	vector<string> dirPaths;
+	Directory* rootDir = source->GetDirectory("/");
+	if(rootDir) CollectDirectories(rootDir, dirPaths);
+	for(size_t i = 0; i < dirPaths.size(); i++) AddDirectories(dirPaths[i]);
+
+	vector<ConstantsTypeTable*> tables;
+	if(!source->SearchConstantsTypeTables(tables, "*", "", true))
+	{
+		Error(CCDB_ERROR_QUERY_SELECT, thisFunc, GetSourceErrors("Error selecting type tables of the source"));
+		Disconnect();
+		return false;
+	}
+	for(size_t i = 0; i < tables.size(); i++)
+	{
+		AddTable(tables[i]->GetFullPath(), tables[i]->GetColumnNames(), tables[i]->GetColumnTypeStrings(), tables[i]->GetRowsCount(), tables[i]->GetComment());
+		delete tables[i];
+	}
+
+	MemoryTable emptyTable;
+	emptyTable.IsLoaded = false;
+	mMemoryTables.assign(mTables.size(), emptyTable);
+
+	if(!AddSourceVariation("default"))
+	{
+		Error(CCDB_ERROR_VARIATION_INVALID, thisFunc, GetSourceErrors("The source has no 'default' variation"));
+		Disconnect();
+		return false;
+	}
+
+	if(mLoadLazily) return true;
+
+	for(size_t i = 0; i < mMemoryTables.size(); i++)
+	{
+		if(!LoadTable(i))
+		{
+			Disconnect();
+			return false;
+		}
+	}
+
+	//everything is loaded, the source is not needed any more
+	if(mIsSourceOwned)
+	{
+		mSource->Disconnect();
+		delete mSource;
+	}
+	mSource = NULL;
+	mIsSourceOwned = false;
+	return true;
+}
+
+
+bool ccdb::MemoryDataProvider::LoadTable( size_t tableIndex )
+{
+	MemoryTable& table = mMemoryTables[tableIndex];
+	if(table.IsLoaded) return true;
+
+	const string& path = mTables[tableIndex].FullPath;
+	if(!mSource)
+	{
+		Error(CCDB_ERROR_NOT_CONNECTED, "MemoryDataProvider::LoadTable", "No source to load '" + path + "' from");
+		return false;
+	}
+
+	//all assignments of all variations with their blobs in one request
+	vector<Assignment*> assignments;
+	if(!mSource->GetAssignments(assignments, path, 0, 0, "", "", 0, 0))
+	{
+		Error(CCDB_ERROR_QUERY_SELECT, "MemoryDataProvider::LoadTable", GetSourceErrors("Error selecting assignments of '" + path + "'"));
+		return false;
+	}
+
+	for(size_t i = 0; i < assignments.size(); i++)
+	{
+		Assignment* assignment = assignments[i];
+		RunRange* runRange = assignment->GetRunRange();
+		Variation* variation = assignment->GetVariation() ? AddSourceVariation(assignment->GetVariation()->GetName()) : NULL;
+		if(!runRange || !variation) continue;
+
+		MemoryAssignment memAssignment;
+		memAssignment.Id = assignment->GetId();
+		memAssignment.CreatedTime = assignment->GetCreatedTime();
+		memAssignment.ModifiedTime = assignment->GetModifiedTime();
+		memAssignment.Comment = assignment->GetComment();
+		memAssignment.VariationObject = variation;
+		memAssignment.DataVaultId = assignment->GetDataVaultId();
+
+		unordered_map<int, size_t>::iterator runRangeIt = mRunRangesById.find(runRange->GetId());
+		if(runRangeIt == mRunRangesById.end())
+		{
+			MemoryRunRange memRunRange;
+			memRunRange.Id = runRange->GetId();
+			memRunRange.Name = runRange->GetName();
+			memRunRange.Min = runRange->GetMin();
+			memRunRange.Max = runRange->GetMax();
+			memRunRange.Comment = runRange->GetComment();
+			memRunRange.CreatedTime = runRange->GetCreatedTime();
+			memRunRange.ModifiedTime = runRange->GetModifiedTime();
+			mRunRanges.push_back(memRunRange);
+			runRangeIt = mRunRangesById.insert(make_pair(memRunRange.Id, mRunRanges.size() - 1)).first;
+		}
+		memAssignment.RunRangeIndex = runRangeIt->second;
+
+		//assignments may share one data vault
+		unordered_map<int, size_t>::iterator blobIt = mBlobsByVaultId.find(memAssignment.DataVaultId);
+		if(blobIt == mBlobsByVaultId.end())
+		{
+			mBlobs.push_back(assignment->GetRawData());
+			blobIt = mBlobsByVaultId.insert(make_pair(memAssignment.DataVaultId, mBlobs.size() - 1)).first;
+		}
+		memAssignment.BlobIndex = blobIt->second;
+
+		table.Assignments.push_back(memAssignment);
+	}
+	for(size_t i = 0; i < assignments.size(); i++) delete assignments[i];
+
+	IndexTable(table);
+	for(size_t i = 0; i < table.Assignments.size(); i++)
+	{
+		mAssignmentsById[table.Assignments[i].Id] = make_pair(tableIndex, i);
+	}
+
+	table.IsLoaded = true;
+	mLoadedTablesCount++;
+	return true;
+}
+
+
+ccdb::Variation* ccdb::MemoryDataProvider::AddSourceVariation( const string& name )
+{
+	map<string, Variation*>::iterator it = mVariationsByName.find(name);
+	if(it != mVariationsByName.end()) return it->second;
+
+	Variation* sourceVariation = mSource->GetVariation(name);
+	if(!sourceVariation) return NULL;
+
+	string parentName = sourceVariation->GetParent() ? sourceVariation->GetParent()->GetName() : "";
+	if(!parentName.empty()) AddSourceVariation(parentName);
+
+	return AddVariation(name, parentName);
+}
+
+
+void ccdb::MemoryDataProvider::IndexTable( MemoryTable& table )
+{
+	struct IdLess
+	{
+		bool operator()(const MemoryAssignment& lhs, const MemoryAssignment& rhs) const { return lhs.Id < rhs.Id; }
+	};
+	sort(table.Assignments.begin(), table.Assignments.end(), IdLess());
+
+	table.ByVariation.clear();
+	for(size_t i = 0; i < table.Assignments.size(); i++)
+	{
+		table.ByVariation[table.Assignments[i].VariationObject->GetName()].push_back(i);
+	}
+
+	//The latest constants can change only on borders of run ranges.
+	//For each interval between borders the assignment with the biggest id wins, as in the database.
+	//Borders are swept in the run order once, keeping the assignments that cover the current run
+	struct Border
+	{
+		int Run;
+		bool IsBegin;               //the run range begins here or ends right before
+		size_t Position;            //position in the indexes of the variation
+		bool operator<(const Border& rhs) const { return Run < rhs.Run; }
+	};
+
+	table.Latest.clear();
+	for(map<string, vector<size_t> >::iterator it = table.ByVariation.begin(); it != table.ByVariation.end(); ++it)
+	{
+		const vector<size_t>& indexes = it->second;
+		vector<Border> borders;
+		borders.reserve(indexes.size() * 2);
+		for(size_t i = 0; i < indexes.size(); i++)
+		{
+			const MemoryRunRange& runRange = mRunRanges[table.Assignments[indexes[i]].RunRangeIndex];
+			if(runRange.Max < runRange.Min) continue;       //covers no run
+
+			Border begin = { runRange.Min, true, i };
+			borders.push_back(begin);
+			if(runRange.Max < INFINITE_RUN)
+			{
+				Border end = { runRange.Max + 1, false, i };
+				borders.push_back(end);
+			}
+		}
+		sort(borders.begin(), borders.end());
+
+		//indexes are sorted by id, so the biggest position that covers the run is the latest
+		set<size_t> covering;
+		vector<LatestInterval>& latest = table.Latest[it->first];
+		for(size_t border = 0; border < borders.size(); )
+		{
+			int runMin = borders[border].Run;
+			for(; border < borders.size() && borders[border].Run == runMin; border++)
+			{
+				if(borders[border].IsBegin) covering.insert(borders[border].Position);
+				else covering.erase(borders[border].Position);
+			}
+			int runMax = border < borders.size() ? borders[border].Run - 1 : INFINITE_RUN;
+			if(covering.empty()) continue;     //a hole between run ranges
+
+			size_t found = indexes[*covering.rbegin()];
+			if(!latest.empty() && latest.back().AssignmentIndex == found && latest.back().RunMax + 1 == runMin)
+			{
+				latest.back().RunMax = runMax;
+				continue;
+			}
+
+			LatestInterval interval;
+			interval.RunMin = runMin;
+			interval.RunMax = runMax;
+			interval.AssignmentIndex = found;
+			latest.push_back(interval);
+		}
+	}
+}
+
+
+std::string ccdb::MemoryDataProvider::GetSourceErrors( const string& message )
+{
+	string result(message);
+	if(!mSource) return result;
+
+	vector<CCDBError *> errors = mSource->GetErrors();
+	for(size_t i = 0; i < errors.size(); i++)
+	{
+		result += ". " + errors[i]->GetMessage();
+	}
+	return result;
+}
+#pragma endregion Loading
+
+#pragma region Run ranges
+
+ccdb::RunRange* ccdb::MemoryDataProvider::CreateRunRange( const MemoryRunRange& memRunRange, ObjectsOwner* owner )
+{
+	RunRange* runRange = new RunRange(owner, this);
+	runRange->SetId(memRunRange.Id);
+	runRange->SetName(memRunRange.Name);
+	runRange->SetRange(memRunRange.Min, memRunRange.Max);
+	runRange->SetComment(memRunRange.Comment);
+	runRange->SetCreatedTime(memRunRange.CreatedTime);
+	runRange->SetModifiedTime(memRunRange.ModifiedTime);
+	return runRange;
+}
+
+
+ccdb::RunRange* ccdb::MemoryDataProvider::GetRunRange( int min, int max, const string& name /*= ""*/ )
+{
+	if(!CheckConnection("MemoryDataProvider::GetRunRange")) return NULL;
+
+	for(size_t i = 0; i < mRunRanges.size(); i++)
+	{
+		if(mRunRanges[i].Min == min && mRunRanges[i].Max == max && mRunRanges[i].Name == name) return CreateRunRange(mRunRanges[i], this);
+	}
+	return NULL;
+}
+
+
+ccdb::RunRange* ccdb::MemoryDataProvider::GetRunRange( const string& name )
+{
+	if(!CheckConnection("MemoryDataProvider::GetRunRange")) return NULL;
+
+	for(size_t i = 0; i < mRunRanges.size(); i++)
+	{
+		if(mRunRanges[i].Name == name) return CreateRunRange(mRunRanges[i], this);
+	}
+	return NULL;
+}
+
+
+bool ccdb::MemoryDataProvider::GetRunRanges( vector<RunRange *>& resultRunRanges, ConstantsTypeTable *table, const string& variation/*=""*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	if(!CheckConnection("MemoryDataProvider::GetRunRanges")) return false;
+
+	int tableIndex = table ? FindTable(table->GetFullPath()) : -1;
+	if(tableIndex < 0)
+	{
+		Error(CCDB_ERROR_NO_TYPETABLE, "MemoryDataProvider::GetRunRanges", "Type table is null or is not in the catalog");
+		return false;
+	}
+	if(!LoadTable(tableIndex)) return false;
+
+	//Ok, lets cleanup result list
+	for(size_t i = 0; i < resultRunRanges.size(); i++)
+	{
+		if(IsOwner(resultRunRanges[i])) delete resultRunRanges[i];   //delete objects if this provider is owner
+	}
+	resultRunRanges.clear();
+
+	//distinct run ranges of the table ordered by min run
+	const MemoryTable& memTable = mMemoryTables[tableIndex];
+	set<pair<int, size_t> > runRanges;
+	for(size_t i = 0; i < memTable.Assignments.size(); i++)
+	{
+		const MemoryAssignment& memAssignment = memTable.Assignments[i];
+		if(!variation.empty() && memAssignment.VariationObject->GetName() != variation) continue;
+		runRanges.insert(make_pair(mRunRanges[memAssignment.RunRangeIndex].Min, memAssignment.RunRangeIndex));
+	}
+
+	vector<size_t> indexes;
+	for(set<pair<int, size_t> >::iterator it = runRanges.begin(); it != runRanges.end(); ++it) indexes.push_back(it->second);
+	TakePage(indexes, take, startWith);
+
+	for(size_t i = 0; i < indexes.size(); i++) resultRunRanges.push_back(CreateRunRange(mRunRanges[indexes[i]], this));
+	return true;
+}
+#pragma endregion Run ranges
+
+#pragma region Variations
+
+ccdb::Variation* ccdb::MemoryDataProvider::GetVariation( const string& name )
+{
+	map<string, Variation*>::iterator it = mVariationsByName.find(name);
+	if(it != mVariationsByName.end()) return it->second;
+
+	//variations of not loaded tables are not in the catalog yet
+	if(mSource && IsConnected()) return AddSourceVariation(name);
+	return NULL;
+}
+#pragma endregion Variations
+
+#pragma region Assignments
+
+const ccdb::MemoryDataProvider::MemoryAssignment* ccdb::MemoryDataProvider::FindAssignment( const MemoryTable& table, Variation* variation, int run, time_t time ) const
+{
+	LatestInterval key;
+	key.RunMin = run;
+
+	//if the variation has no constants for the run, its parent is searched
+	for(; variation != NULL; variation = variation->GetParent())
+	{
+		if(time <= 0)
+		{
+			map<string, vector<LatestInterval> >::const_iterator it = table.Latest.find(variation->GetName());
+			if(it == table.Latest.end()) continue;
+
+			//the last interval that starts not after the run
+			const vector<LatestInterval>& intervals = it->second;
+			vector<LatestInterval>::const_iterator next = upper_bound(intervals.begin(), intervals.end(), key);
+			if(next != intervals.begin() && (next - 1)->RunMax >= run) return &table.Assignments[(next - 1)->AssignmentIndex];
+		}
+		else
+		{
+			map<string, vector<size_t> >::const_iterator it = table.ByVariation.find(variation->GetName());
+			if(it == table.ByVariation.end()) continue;
+
+			//the latest assignment that was created not after the time
+			const vector<size_t>& indexes = it->second;
+			for(size_t i = indexes.size(); i-- > 0; )
+			{
+				const MemoryAssignment& memAssignment = table.Assignments[indexes[i]];
+				const MemoryRunRange& runRange = mRunRanges[memAssignment.RunRangeIndex];
+				if(memAssignment.CreatedTime <= time && runRange.Min <= run && runRange.Max >= run) return &memAssignment;
+			}
+		}
+	}
+	return NULL;
+}
+
+
+void ccdb::MemoryDataProvider::FillRelations( Assignment* assignment, const MemoryAssignment& memAssignment )
+{
+	assignment->SetRunRange(CreateRunRange(mRunRanges[memAssignment.RunRangeIndex], assignment));
+
+	Variation* variation = new Variation(assignment, this);
+	variation->SetId(memAssignment.VariationObject->GetId());
+	variation->SetName(memAssignment.VariationObject->GetName());
+	variation->SetParentDbId(memAssignment.VariationObject->GetParentDbId());
+	assignment->SetVariation(variation);
+}
+
+
+ccdb::Assignment* ccdb::MemoryDataProvider::CreateMemoryAssignment( size_t tableIndex, const MemoryAssignment& memAssignment, int run, bool loadColumns, bool full )
+{
+	Assignment* assignment = CreateAssignment(tableIndex, run, loadColumns);
+	assignment->SetId(memAssignment.Id);
+	assignment->SetCreatedTime(memAssignment.CreatedTime);
+	assignment->SetModifiedTime(memAssignment.ModifiedTime);
+	assignment->SetComment(memAssignment.Comment);
+	assignment->SetDataVaultId(memAssignment.DataVaultId);
+	assignment->SetRawData(mBlobs[memAssignment.BlobIndex]);
+	if(full) FillRelations(assignment, memAssignment);
+	return assignment;
+}
+
+
+ccdb::Assignment* ccdb::MemoryDataProvider::QueryAssignment( int run, const string& path, time_t time, const string& variation, bool loadColumns, bool full )
+{
+	const char* thisFunc = "MemoryDataProvider::GetAssignmentShort";
+	if(!CheckConnection(thisFunc)) return NULL;
+
+	int tableIndex = FindTable(path);
+	if(tableIndex < 0)
+	{
+		Error(CCDB_ERROR_NO_TYPETABLE, thisFunc, "Type table was not found: '" + path + "'");
+		return NULL;
+	}
+	if(!LoadTable(tableIndex)) return NULL;
+
+	Variation* variationObj = GetVariation(variation);
+	if(!variationObj)
+	{
+		Error(CCDB_ERROR_VARIATION_INVALID, thisFunc, "No variation '" + variation + "' was found");
+		return NULL;
+	}
+
+	const MemoryAssignment* memAssignment = FindAssignment(mMemoryTables[tableIndex], variationObj, run, time);
+	if(!memAssignment)
+	{
+		//No constants is not an error, as for other providers
+		return NULL;
+	}
+
+	return CreateMemoryAssignment(tableIndex, *memAssignment, run, loadColumns, full);
+}
+
+
+ccdb::Assignment* ccdb::MemoryDataProvider::GetAssignmentShort( int run, const string& path, time_t time, const string& variation/*="default"*/, bool loadColumns/*=false*/ )
+{
+	return QueryAssignment(run, path, time, variation, loadColumns, false);
+}
+
+
+ccdb::Assignment* ccdb::MemoryDataProvider::GetAssignmentFull( int run, const string& path, const string& variation/*="default"*/ )
+{
+	return QueryAssignment(run, path, 0, variation, true, true);
+}
+
+
+ccdb::Assignment* ccdb::MemoryDataProvider::GetAssignmentFull( int run, const string& path, int version, const string& variation/*="default"*/ )
+{
+	if(!CheckConnection("MemoryDataProvider::GetAssignmentFull")) return NULL;
+	return DataProvider::GetAssignmentFull(run, path, version, variation);
+}
+
+
+bool ccdb::MemoryDataProvider::GetAssignments( vector<Assignment *> &assingments,const string& path, int runMin, int runMax, const string& runRangeName, const string& variation, time_t beginTime, time_t endTime, int sortBy/*=0*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	if(!CheckConnection("MemoryDataProvider::GetAssignments")) return false;
+
+	int tableIndex = FindTable(path);
+	if(tableIndex < 0)
+	{
+		Error(CCDB_ERROR_NO_TYPETABLE, "MemoryDataProvider::GetAssignments", "Type table was not found");
+		return false;
+	}
+	if(!LoadTable(tableIndex)) return false;
+
+	//Ok, lets cleanup result list
+	for(size_t i = 0; i < assingments.size(); i++)
+	{
+		if(IsOwner(assingments[i])) delete assingments[i];   //delete objects if this provider is owner
+	}
+	assingments.clear();
+
+	//the same filters as in the database providers
+	const MemoryTable& memTable = mMemoryTables[tableIndex];
+	vector<pair<time_t, size_t> > selected;
+	for(size_t i = 0; i < memTable.Assignments.size(); i++)
+	{
+		const MemoryAssignment& memAssignment = memTable.Assignments[i];
+		const MemoryRunRange& runRange = mRunRanges[memAssignment.RunRangeIndex];
+
+		if(!runRangeName.empty())
+		{
+			if(runRange.Name != runRangeName) continue;
+		}
+		else if(runMin != 0 || runMax != 0)
+		{
+			if(runRange.Min > runMin || runRange.Max < runMax) continue;
+		}
+		if(!variation.empty() && memAssignment.VariationObject->GetName() != variation) continue;
+		if((beginTime != 0 || endTime != 0) && (memAssignment.CreatedTime < beginTime || memAssignment.CreatedTime > endTime)) continue;
+
+		selected.push_back(make_pair(memAssignment.CreatedTime, i));
+	}
+
+	//sortBy=0 - the latest first, 1 - the oldest first
+	stable_sort(selected.begin(), selected.end());
+	if(sortBy != 1) reverse(selected.begin(), selected.end());
+	TakePage(selected, take, startWith);
+
+	for(size_t i = 0; i < selected.size(); i++)
+	{
+		assingments.push_back(CreateMemoryAssignment(tableIndex, memTable.Assignments[selected[i].second], 0, true, true));
+	}
+	return true;
+}
+
+
+bool ccdb::MemoryDataProvider::FillAssignment( Assignment* assignment )
+{
+	if(!CheckConnection("MemoryDataProvider::FillAssignment")) return false;
+
+	unordered_map<int, pair<size_t, size_t> >::iterator it = assignment ? mAssignmentsById.find(assignment->GetId()) : mAssignmentsById.end();
+	if(it == mAssignmentsById.end())
+	{
+		Error(CCDB_ERROR_ASSIGMENT_INVALID_ID, "MemoryDataProvider::FillAssignment", "Assignment is NULL or is not loaded");
+		return false;
+	}
+
+	const MemoryAssignment& memAssignment = mMemoryTables[it->second.first].Assignments[it->second.second];
+	assignment->SetCreatedTime(memAssignment.CreatedTime);
+	assignment->SetModifiedTime(memAssignment.ModifiedTime);
+	assignment->SetComment(memAssignment.Comment);
+	assignment->SetDataVaultId(memAssignment.DataVaultId);
+	assignment->SetRawData(mBlobs[memAssignment.BlobIndex]);
+	FillRelations(assignment, memAssignment);
+	if(!assignment->GetTypeTable())
+	{
+		ConstantsTypeTable* table = CreateTypeTable(it->second.first, true);
+		assignment->SetTypeTable(table);
+		assignment->BeOwner(table);
+	}
+	return true;
+}
+#pragma endregion Assignments
@@ -5,11 +5,19 @@
 #include <time.h>
 #include <string.h>
 #include <limits.h>
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
 
 #include "CCDB/Globals.h"
 #include "CCDB/Log.h"
 #include "CCDB/Helpers/StringUtils.h"
 #include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Helpers/ReplicaSelector.h"
+#include "CCDB/Helpers/StopWatch.h"
+#include "CCDB/Helpers/TimeProvider.h"
 #include "CCDB/Providers/MySQLDataProvider.h"
 #include "CCDB/Model/ConstantsTypeTable.h"
 #include "CCDB/Model/RunRange.h"
@@ -23,6 +31,140 @@
 using namespace ccdb;
 
 
+/** Read replicas of the connection. Each replica has its own provider, so reads of different replicas go in parallel */
+struct ccdb::MySQLDataProvider::ReplicaSet
+{
+	struct Answer
+	{
+		Assignment* Result;
+		double Milliseconds;
+		bool IsFailed;					//the replica can't be used, not just has no such constants
+		vector<int> ErrorCodes;
+	};
+
+	/** Tells which of the raced reads finished first, so the race is waited for without polling */
+	struct RaceSignal
+	{
+		RaceSignal(): Winner(-1) {}
+
+		mutex Mutex;
+		condition_variable Finished;
+		int Winner;						//replica of the first finished read, -1 while both are running
+	};
+
+	explicit ReplicaSet(const vector<MySQLConnectionInfo>& connections)
+		:Selector(connections.size()),
+		Connections(connections),
+		Providers(connections.size(), (MySQLDataProvider*)NULL),
+		Pending(connections.size()),
+		HedgePercentile(0),
+		HedgedRequests(0),
+		LastReplica(-1)
+	{
+	}
+
+	/** Waits for the late reads and deletes providers. Assignments of the providers are deleted with them */
+	~ReplicaSet()
+	{
+		for(size_t i = 0; i < Providers.size(); i++)
+		{
+			Collect(i);
+			delete Providers[i];
+		}
+	}
+
+	/** Reads the assignment from the replica. The replica is connected on the first read */
+	Answer Read(size_t replica, int run, const string& path, time_t time, const string& variation, bool loadColumns)
+	{
+		StopWatch watch;
+		Answer answer;
+		answer.Result = NULL;
+
+		MySQLDataProvider*& provider = Providers[replica];
+		if(!provider) provider = new MySQLDataProvider();
+		if(!provider->IsConnected() && !provider->Connect(Connections[replica]))
+		{
+			answer.IsFailed = true;
+		}
+		else
+		{
+			answer.Result = provider->GetAssignmentShort(run, path, time, variation, loadColumns);
+			const vector<int>& codes = provider->GetErrorCodes();
+			answer.IsFailed = !answer.Result && find(codes.begin(), codes.end(), CCDB_ERROR_QUERY_SELECT) != codes.end();
+		}
+		answer.ErrorCodes = provider->GetErrorCodes();
+		answer.Milliseconds = watch.ElapsedUs() / 1000.0;
+
+		//the next read connects again. The provider is kept, assignments it gave may be cached by users
+		if(answer.IsFailed) provider->Disconnect();
+		return answer;
+	}
+
+	/** Reads the assignment in a thread of its own. If there is a race signal, the finished read is told by it */
+	future<Answer> ReadAsync(size_t replica, int run, const string& path, time_t time, const string& variation, bool loadColumns, shared_ptr<RaceSignal> race = shared_ptr<RaceSignal>())
+	{
+		return async(launch::async, [=]()
+		{
+			mysql_thread_init();
+			Answer answer = Read(replica, run, path, time, variation, loadColumns);
+			mysql_thread_end();
+			if(race)
+			{
+				lock_guard<mutex> lock(race->Mutex);
+				if(race->Winner < 0) race->Winner = static_cast<int>(replica);
+				race->Finished.notify_all();
+			}
+			return answer;
+		});
+	}
+
+	/** Waits for the read that lost the hedge race on the replica and counts its latency */
+	void Collect(size_t replica)
+	{
+		if(!Pending[replica].valid()) return;
+
+		Answer answer = Pending[replica].get();
+		delete answer.Result;
+		if(answer.IsFailed) Selector.MarkFailed(replica);
+		else Selector.AddLatency(replica, answer.Milliseconds);
+	}
+
+	/** Collects the late reads that have finished. Doesn't wait
+	 * @return replicas that are still busy with late reads
+	 */
+	vector<size_t> CollectFinished()
+	{
+		vector<size_t> busy;
+		for(size_t i = 0; i < Pending.size(); i++)
+		{
+			if(!Pending[i].valid()) continue;
+			if(Pending[i].wait_for(chrono::seconds(0)) == future_status::ready) Collect(i);
+			else busy.push_back(i);
+		}
+		return busy;
+	}
+
+	/** Is the replica set made of the same addresses */
+	bool IsSameAddresses(const vector<MySQLConnectionInfo>& connections) const
+	{
+		if(connections.size() != Connections.size()) return false;
+		for(size_t i = 0; i < connections.size(); i++)
+		{
+			if(connections[i].HostName != Connections[i].HostName || connections[i].Port != Connections[i].Port) return false;
+		}
+		return true;
+	}
+
+	ReplicaSelector Selector;
+	vector<MySQLConnectionInfo> Connections;	//one address each
+	vector<MySQLDataProvider*> Providers;		//NULL until the replica is read. Kept until the set is deleted
+	vector<future<Answer> > Pending;			//reads that lost the hedge race
+	int HedgePercentile;
+	size_t HedgedRequests;
+	int LastReplica;
+};
+
+
 #pragma region constructors
 
 ccdb::MySQLDataProvider::MySQLDataProvider(void)
@@ -35,7 +177,9 @@ ccdb::MySQLDataProvider::MySQLDataProvider(void)
 	mLastFullQuerry="";
 	mLastShortQuerry="";
     mLastVariation = NULL; 
-    
+	mReplicas = NULL;
+	mIsReplicaSetActive = false;
+	mAdmission = NULL;
 }
 
 
@@ -45,6 +189,8 @@ ccdb::MySQLDataProvider::~MySQLDataProvider(void)
 	{
 		Disconnect();
 	}
+	delete mReplicas;
+	for(size_t i = 0; i < mRetiredReplicas.size(); i++) delete mRetiredReplicas[i];
 }
 #pragma endregion constructors
 
@@ -86,6 +232,7 @@ bool ccdb::MySQLDataProvider::Connect(MySQLConnectionInfo connection)
 		return false;
 	}
 
+	if(connection.ReplicaHosts.size() > 1) return ConnectReplicas(connection);
 
 	//verbose...
 	Log::Verbose("ccdb::MySQLDataProvider::Connect", StringUtils::Format("Connecting to database:\n UserName: %s \n Password: %i symbols \n HostName: %s Database: %s Port: %i",
@@ -99,22 +246,52 @@ bool ccdb::MySQLDataProvider::Connect(MySQLConnectionInfo connection)
 		return false;
 	}
 	
+	//client side limits of the host, shared by all connections of the process with the same limits
+	mAdmission = NULL;
+	if(connection.RateLimit > 0 || connection.MaxInFlight > 0)
+	{
+		string host = StringUtils::Format("%s:%i", connection.HostName.c_str(), connection.Port);
+		mAdmission = AdmissionControl::GetForHost(host, connection.RateLimit, connection.RateBurst, connection.MaxInFlight);
+	}
+
+	//jobs that start together should not connect at the same instant
+	if(connection.ConnectJitter > 0) TimeProvider::Delay(AdmissionControl::RandomMilliseconds(connection.ConnectJitter));
+
 	//Try to connect to server
-	if(!mysql_real_connect (
-		mMySQLHnd,						//pointer to connection handler
-		connection.HostName.c_str(),	//host to connect to
-		connection.UserName.c_str(),	//user name
-		connection.Password.c_str(),	//password
-		connection.Database.c_str(),	//database to use
-		connection.Port, 				//port
-		NULL,							//socket (use default)
-		0))								//flags (none)
+	for(int attempt = 0; ; attempt++)
 	{
+		bool isConnected;
+		{
+			AdmissionControl::Ticket ticket(mAdmission);
+			isConnected = mysql_real_connect (
+				mMySQLHnd,						//pointer to connection handler
+				connection.HostName.c_str(),	//host to connect to
+				connection.UserName.c_str(),	//user name
+				connection.Password.c_str(),	//password
+				connection.Database.c_str(),	//database to use
+				connection.Port, 				//port
+				NULL,							//socket (use default)
+				0) != NULL;						//flags (none)
+		}
+		if(isConnected) break;
+
 		string errStr = ComposeMySQLError("mysql_real_connect()");
-		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR,"bool MySQLDataProvider::Connect(MySQLConnectionInfo)",errStr.c_str());
+		mysql_close(mMySQLHnd);
+		mMySQLHnd = NULL;
+		if(attempt >= connection.ConnectRetries)
+		{
+			Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR,"bool MySQLDataProvider::Connect(MySQLConnectionInfo)",errStr.c_str());
+			return false;
+		}
 
-		mMySQLHnd=NULL;		//some compilers dont set NULL after delete
-		return false;
+		//randomized exponential backoff, so failed jobs don't come back together
+		TimeProvider::Delay(AdmissionControl::GetBackoffMilliseconds(attempt, 100, 10000));
+		mMySQLHnd = mysql_init(NULL);
+		if(mMySQLHnd == NULL)
+		{
+			Error(CCDB_ERROR_CONNECTION_INITIALIZATION, "MySQLDataProvider::Connect(DMySQLConnectionInfo)", "mysql_init() returned NULL, probably memory allocation problem");
+			return false;
+		}
 	}
 	mIsConnected = true;
 	return true;
@@ -180,9 +357,53 @@ bool ccdb::MySQLDataProvider::ParseConnectionString(std::string conStr, MySQLCon
 	{
 		connection.Database = conStr.substr(whitePos+1);
 		conStr.erase(whitePos);
+
+		//options like ?pool=8
+		size_t questionPos = connection.Database.find('?');
+		if(questionPos!=string::npos)
+		{
+			vector<string> options = StringUtils::Split(connection.Database.substr(questionPos+1), "&");
+			connection.Database.erase(questionPos);
+
+			for (size_t i = 0; i < options.size(); i++)
+			{
+				size_t equalPos = options[i].find('=');
+				if(equalPos == string::npos) continue;
+
+				string name = options[i].substr(0, equalPos);
+				string value = options[i].substr(equalPos+1);
+				if(name == "pool") connection.PoolSize = StringUtils::ParseInt(value);
+				else if(name == "hedge") connection.HedgePercentile = StringUtils::ParseInt(value);
+				else if(name == "rate") connection.RateLimit = StringUtils::ParseDouble(value);
+				else if(name == "burst") connection.RateBurst = StringUtils::ParseInt(value);
+				else if(name == "inflight") connection.MaxInFlight = StringUtils::ParseInt(value);
+				else if(name == "jitter") connection.ConnectJitter = StringUtils::ParseInt(value);
+				else if(name == "retries") connection.ConnectRetries = StringUtils::ParseInt(value);
+			}
+		}
 	}
 
-	//2) deal with port
+	//2) several addresses are read replicas, the first one is used as the main address
+	if(conStr.find(',')!=string::npos)
+	{
+		vector<string> hosts = StringUtils::Split(conStr, ",");
+		for (size_t i = 0; i < hosts.size(); i++)
+		{
+			string host = hosts[i];
+			int port = 0;
+			size_t portPos = host.find(':');
+			if(portPos!=string::npos)
+			{
+				port = atoi(host.substr(portPos+1).c_str());
+				host.erase(portPos);
+			}
+			connection.ReplicaHosts.push_back(host);
+			connection.ReplicaPorts.push_back(port);
+		}
+		conStr = hosts.empty() ? string() : hosts[0];
+	}
+
+	//3) deal with port
 	int colonPos = conStr.find(':');
 	if(colonPos!=string::npos)
 	{
@@ -192,7 +413,7 @@ bool ccdb::MySQLDataProvider::ParseConnectionString(std::string conStr, MySQLCon
 		connection.Port =atoi(portStr.c_str());
 	}
 
-	//3) everything that is last whould be address
+	//4) everything that is last whould be address
 	connection.HostName = conStr;
 
 	return true;
@@ -210,6 +431,7 @@ void ccdb::MySQLDataProvider::Disconnect()
 	if(IsConnected())
 	{
 		FreeMySQLResult();	//it would free the result or do nothing
+		CloseReplicas();
 		
 		mysql_close(mMySQLHnd);
 		mMySQLHnd = NULL;
@@ -218,6 +440,13 @@ void ccdb::MySQLDataProvider::Disconnect()
 }
 
 
+bool ccdb::MySQLDataProvider::Ping()
+{
+	if(!IsConnected()) return false;
+	return mysql_ping(mMySQLHnd) == 0;
+}
+
+
 bool ccdb::MySQLDataProvider::CheckConnection( const string& errorSource/*=""*/ )
 {
 	ClearErrors(); //Clear error in function that can produce new ones
@@ -230,6 +459,68 @@ bool ccdb::MySQLDataProvider::CheckConnection( const string& errorSource/*=""*/
 	}
 	return true;
 }
+
+
+bool ccdb::MySQLDataProvider::ConnectReplicas( const MySQLConnectionInfo& connection )
+{
+	vector<MySQLConnectionInfo> replicas;
+	for(size_t i = 0; i < connection.ReplicaHosts.size(); i++)
+	{
+		MySQLConnectionInfo replica(connection);
+		replica.ReplicaHosts.clear();
+		replica.ReplicaPorts.clear();
+		replica.HostName = connection.ReplicaHosts[i];
+		replica.Port = connection.ReplicaPorts[i];
+		replicas.push_back(replica);
+	}
+
+	//the catalog is taken from the first address that answers
+	for(size_t i = 0; i < replicas.size() && !IsConnected(); i++) Connect(replicas[i]);
+	if(!IsConnected()) return false;
+
+	//providers of the old set live as long as this one, users may hold assignments they gave
+	if(mReplicas && !mReplicas->IsSameAddresses(replicas))
+	{
+		mRetiredReplicas.push_back(mReplicas);
+		mReplicas = NULL;
+	}
+	if(!mReplicas) mReplicas = new ReplicaSet(replicas);
+	mReplicas->HedgePercentile = connection.HedgePercentile;
+	mIsReplicaSetActive = true;
+	return true;
+}
+
+
+void ccdb::MySQLDataProvider::CloseReplicas()
+{
+	if(!mReplicas) return;
+
+	//connections are closed, providers are kept with their assignments
+	for(size_t i = 0; i < mReplicas->Providers.size(); i++)
+	{
+		mReplicas->Collect(i);
+		if(mReplicas->Providers[i]) mReplicas->Providers[i]->Disconnect();
+	}
+	mIsReplicaSetActive = false;
+}
+
+
+size_t ccdb::MySQLDataProvider::GetReplicasCount() const
+{
+	return mReplicas && mIsReplicaSetActive ? mReplicas->Connections.size() : 0;
+}
+
+
+size_t ccdb::MySQLDataProvider::GetHedgedRequestsCount() const
+{
+	return mReplicas ? mReplicas->HedgedRequests : 0;
+}
+
+
+int ccdb::MySQLDataProvider::GetLastReplica() const
+{
+	return mReplicas ? mReplicas->LastReplica : -1;
+}
 #pragma endregion Connection
 
 #pragma region Directories
@@ -1102,6 +1393,8 @@ Assignment* ccdb::MySQLDataProvider::GetAssignmentShort(int run, const string& p
      * @return new DAssignment object or 
      */
 
+	if(mReplicas && mIsReplicaSetActive) return GetAssignmentFromReplicas(run, path, time, variationName, loadColumns);
+
 	ClearErrors(); //Clear error in function that can produce new ones
 
 	if(!CheckConnection("MySQLDataProvider::GetAssignmentShort( int run, const char* path, const char* variation, int version /*= -1*/ )")) return NULL;
@@ -1179,7 +1472,13 @@ Assignment* ccdb::MySQLDataProvider::GetAssignmentShort(int run, const string& p
 	//ok lets read the data...
 	Assignment *result = new Assignment(this, this);
 	result->SetId( ReadIndex(0) );
-	result->SetRawData( ReadString(1) );
+	{
+		//the blob goes to the assignment right from the MySQL result buffer
+		const char* blob;
+		size_t blobLength;
+		ReadStringBuffer(1, blob, blobLength);
+		result->SetRawData(blob, blobLength);
+	}
 	
 	//additional fill
 	result->SetRequestedRun(run);
@@ -1200,6 +1499,113 @@ Assignment* ccdb::MySQLDataProvider::GetAssignmentShort(int run, const string& p
 
 }
 
+Assignment* ccdb::MySQLDataProvider::GetAssignmentFromReplicas( int run, const string& path, time_t time, const string& variation, bool loadColumns )
+{
+	if(!CheckConnection("MySQLDataProvider::GetAssignmentShort")) return NULL;
+
+	ReplicaSet& replicas = *mReplicas;
+	replicas.LastReplica = -1;
+
+	//replicas that are still busy with late hedged reads are not waited for, unless no other replica is left
+	vector<size_t> busy = replicas.CollectFinished();
+	vector<size_t> tried(busy);
+	vector<int> failureCodes;
+	int replica;
+	while((replica = replicas.Selector.Select(tried)) >= 0 || !busy.empty())
+	{
+		if(replica < 0)
+		{
+			for(size_t i = 0; i < busy.size(); i++)
+			{
+				replicas.Collect(busy[i]);
+				tried.erase(find(tried.begin(), tried.end(), busy[i]));
+			}
+			busy.clear();
+			continue;
+		}
+		tried.push_back(replica);
+
+		//a read is hedged when the replica has enough latency samples and there is another replica
+		double threshold = replicas.HedgePercentile > 0 ? replicas.Selector.GetPercentile(replica, replicas.HedgePercentile) : -1;
+		int second = threshold >= 0 ? replicas.Selector.Select(tried) : -1;
+
+		ReplicaSet::Answer answer;
+		int answered = replica;
+		if(second < 0)
+		{
+			answer = replicas.Read(replica, run, path, time, variation, loadColumns);
+		}
+		else
+		{
+			shared_ptr<ReplicaSet::RaceSignal> race = make_shared<ReplicaSet::RaceSignal>();
+			future<ReplicaSet::Answer> first = replicas.ReadAsync(replica, run, path, time, variation, loadColumns, race);
+			if(first.wait_for(chrono::duration<double, milli>(threshold)) == future_status::ready)
+			{
+				answer = first.get();
+			}
+			else
+			{
+				//the replica is slower than its percentile now, it is ranked by that until the late read is collected
+				replicas.Selector.AddLatency(replica, threshold);
+				replicas.HedgedRequests++;
+				StopWatch hedgeWatch;
+				future<ReplicaSet::Answer> hedged = replicas.ReadAsync(second, run, path, time, variation, loadColumns, race);
+
+				//the first answer is taken, the other read is collected when its replica is used again
+				bool isFirstReady;
+				{
+					unique_lock<mutex> lock(race->Mutex);
+					race->Finished.wait(lock, [&race]() { return race->Winner >= 0; });
+					isFirstReady = race->Winner == replica;
+				}
+				future<ReplicaSet::Answer>& winner = isFirstReady ? first : hedged;
+				future<ReplicaSet::Answer>& loser = isFirstReady ? hedged : first;
+				answered = isFirstReady ? replica : second;
+				int other = isFirstReady ? second : replica;
+				answer = winner.get();
+
+				if(answer.IsFailed)
+				{
+					//the other read is the only one left
+					replicas.Selector.MarkFailed(answered);
+					failureCodes.insert(failureCodes.end(), answer.ErrorCodes.begin(), answer.ErrorCodes.end());
+					answer = loser.get();
+					answered = other;
+				}
+				else
+				{
+					//the loser is at least as slow as the winner was
+					replicas.Selector.AddLatency(other, isFirstReady ? hedgeWatch.ElapsedUs() / 1000.0 : threshold + hedgeWatch.ElapsedUs() / 1000.0);
+					replicas.Pending[other] = move(loser);
+				}
+				tried.push_back(second);
+			}
+		}
+
+		if(answer.IsFailed)
+		{
+			replicas.Selector.MarkFailed(answered);
+			failureCodes.insert(failureCodes.end(), answer.ErrorCodes.begin(), answer.ErrorCodes.end());
+			continue;
+		}
+
+		//no constants is an answer too. The replica has logged the errors already
+		replicas.Selector.AddLatency(answered, answer.Milliseconds);
+		replicas.LastReplica = answered;
+		for(size_t i = 0; i < answer.ErrorCodes.size(); i++)
+		{
+			mErrorCodes.push_back(answer.ErrorCodes[i]);
+			mLastError = answer.ErrorCodes[i];
+		}
+		return answer.Result;
+	}
+
+	for(size_t i = 0; i < failureCodes.size(); i++) mErrorCodes.push_back(failureCodes[i]);
+	Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "MySQLDataProvider::GetAssignmentShort", "No read replica answered");
+	return NULL;
+}
+
+
 Assignment* ccdb::MySQLDataProvider::GetAssignmentFull( int run, const string& path, const string& variation )
 {
 	if(!CheckConnection("MySQLDataProvider::GetAssignmentFull(int run, cconst string& path, const string& variation")) return NULL;
@@ -1471,7 +1877,10 @@ void ccdb::MySQLDataProvider::FetchAssignment(Assignment* assignment, ConstantsT
 	assignment->SetModifiedTime(ReadUnixTime(2));	/*02  " UNIX_TIMESTAMP(`assignments`.`modified`) as `asModified`,	"*/
 	assignment->SetComment(ReadString(3));			/*03  " `assignments`.`comment) as `asComment`,	"					 */
 	assignment->SetDataVaultId(ReadIndex(4));		/*04  " `constantSets`.`id` AS `constId`, "							 */
-	assignment->SetRawData(ReadString(5));			/*05  " `constantSets`.`vault` AS `blob`, "							 */
+	const char* blob;
+	size_t blobLength;
+	ReadStringBuffer(5, blob, blobLength);
+	assignment->SetRawData(blob, blobLength);		/*05  " `constantSets`.`vault` AS `blob`, "							 */
 	
 	RunRange * runRange = new RunRange(assignment, this);	
 	runRange->SetId(ReadIndex(6));					/*06  " `runRanges`.`id`   AS `rrId`, "	*/
@@ -1571,58 +1980,66 @@ bool ccdb::MySQLDataProvider::IsNullOrUnreadable( int fieldNum )
 
 int ccdb::MySQLDataProvider::ReadInt( int fieldNum )
 {	
-	if(IsNullOrUnreadable(fieldNum)) return 0;
-
-	return atoi(mRow[fieldNum]); //ugly isn't it?
+	return static_cast<int>(ReadLong(fieldNum));
 }
 
 unsigned int ccdb::MySQLDataProvider::ReadUInt( int fieldNum )
 {	
-	if(IsNullOrUnreadable(fieldNum)) return 0;
-
-	return static_cast<unsigned int>(atoi(mRow[fieldNum])); //ugly isn't it?
+	return static_cast<unsigned int>(ReadLong(fieldNum));
 }
 
 long ccdb::MySQLDataProvider::ReadLong( int fieldNum )
 {
-	if(IsNullOrUnreadable(fieldNum)) return 0;
-
-	return atol(mRow[fieldNum]); //ugly isn't it?
+	const char* str;
+	size_t length;
+	ReadStringBuffer(fieldNum, str, length);
+	return StringUtils::ParseLong(str, length);
 }
 
 unsigned long ccdb::MySQLDataProvider::ReadULong( int fieldNum )
 {
-	if(IsNullOrUnreadable(fieldNum)) return 0;
-
-	return static_cast<unsigned long>(atol(mRow[fieldNum])); //ugly isn't it?
+	const char* str;
+	size_t length;
+	ReadStringBuffer(fieldNum, str, length);
+	return StringUtils::ParseULong(str, length);
 }
 
 dbkey_t ccdb::MySQLDataProvider::ReadIndex( int fieldNum )
 {
-	if(IsNullOrUnreadable(fieldNum)) return 0;
-
-	return static_cast<dbkey_t>(atol(mRow[fieldNum])); //ugly isn't it?
+	return static_cast<dbkey_t>(ReadLong(fieldNum));
 }
 
 bool ccdb::MySQLDataProvider::ReadBool( int fieldNum )
 {
-	if(IsNullOrUnreadable(fieldNum)) return false;
-
-	return static_cast<bool>(atoi(mRow[fieldNum])!=0); //ugly isn't it?
-
+	return ReadLong(fieldNum)!=0;
 }
 
 double ccdb::MySQLDataProvider::ReadDouble( int fieldNum )
 {
-	if(IsNullOrUnreadable(fieldNum)) return 0;
-
-	return atof(mRow[fieldNum]); //ugly isn't it?
+	const char* str;
+	size_t length;
+	ReadStringBuffer(fieldNum, str, length);
+	return StringUtils::ParseDouble(str, length);
 }
 
 std::string ccdb::MySQLDataProvider::ReadString( int fieldNum )
 {
-	if(IsNullOrUnreadable(fieldNum)) return string("");
-	return string(mRow[fieldNum]);
+	const char* str;
+	size_t length;
+	ReadStringBuffer(fieldNum, str, length);
+	return string(str, length);
+}
+
+void ccdb::MySQLDataProvider::ReadStringBuffer( int fieldNum, const char*& data, size_t& length )
+{
+	data = "";
+	length = 0;
+	if(IsNullOrUnreadable(fieldNum)) return;
+
+	//MySQL text protocol gives every field as a string, lengths are known after fetch
+	unsigned long *lengths = mysql_fetch_lengths(mResult);
+	data = mRow[fieldNum];
+	length = lengths ? static_cast<size_t>(lengths[fieldNum]) : strlen(mRow[fieldNum]);
 }
 
 
@@ -1646,16 +2063,19 @@ bool ccdb::MySQLDataProvider::QuerySelect(const char* query)
 		FreeMySQLResult();
 	}
 
-	//query
-	if(mysql_query(mMySQLHnd, query))
+	//query. The results are read from the server in full, so the request is done after mysql_store_result
 	{
-		string errStr = ComposeMySQLError("mysql_query()"); errStr.append("\n Query: "); errStr.append(query);
-		Error(CCDB_ERROR_QUERY_SELECT,"ccdb::MySQLDataProvider::QuerySelect()",errStr.c_str());
-		return false;
-	}
+		AdmissionControl::Ticket ticket(mAdmission);
+		if(mysql_query(mMySQLHnd, query))
+		{
+			string errStr = ComposeMySQLError("mysql_query()"); errStr.append("\n Query: "); errStr.append(query);
+			Error(CCDB_ERROR_QUERY_SELECT,"ccdb::MySQLDataProvider::QuerySelect()",errStr.c_str());
+			return false;
+		}
 
-	//get results
-	mResult = mysql_store_result(mMySQLHnd);
+		//get results
+		mResult = mysql_store_result(mMySQLHnd);
+	}
 
 	if(!mResult)
 	{
@@ -1693,6 +2113,7 @@ bool ccdb::MySQLDataProvider::QueryCustom( const string& query )
 		FreeMySQLResult();
 	}
 	//query
+	AdmissionControl::Ticket ticket(mAdmission);
 	if(mysql_query(mMySQLHnd, query.c_str()))
 	{
 		string errStr = ComposeMySQLError("mysql_query()"); errStr.append("\n Query: "); errStr.append(query);
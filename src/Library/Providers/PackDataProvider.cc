@@ -0,0 +1,341 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "CCDB/Providers/PackDataProvider.h"
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+
+#pragma region constructors
+
+ccdb::PackDataProvider::PackDataProvider(void)
+{
+	mData = NULL;
+	mSize = 0;
+	mIsMapped = false;
+	mTime = 0;
+	mCreatedTime = 0;
+}
+
+
+ccdb::PackDataProvider::~PackDataProvider(void)
+{
+	if(IsConnected())
+	{
+		Disconnect();
+	}
+}
+#pragma endregion constructors
+
+#pragma region Connection
+
+bool ccdb::PackDataProvider::Connect( string connectionString )
+{
+	ClearErrors();
+
+	if(IsConnected())
+	{
+		Error(CCDB_ERROR_CONNECTION_ALREADY_OPENED, "PackDataProvider::Connect", "Connection already opened");
+		return false;
+	}
+
+	if(connectionString.find("ccdbpack://") != 0)
+	{
+		Error(CCDB_ERROR_PARSE_CONNECTION_STRING, "PackDataProvider::Connect", "Connection string should start with ccdbpack://");
+		return false;
+	}
+	string path = connectionString.substr(11);
+
+#ifndef WIN32
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0)
+	{
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "PackDataProvider::Connect", "Can't open file '" + path + "'");
+		return false;
+	}
+
+	struct stat fileStat;
+	void* data = MAP_FAILED;
+	if(fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+	{
+		data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	close(fd);     //the mapping stays after the file is closed
+
+	if(data == MAP_FAILED)
+	{
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "PackDataProvider::Connect", "Can't map file '" + path + "' to memory");
+		return false;
+	}
+	mData = static_cast<const char*>(data);
+	mSize = fileStat.st_size;
+	mIsMapped = true;
+#else
+	FILE* file = fopen(path.c_str(), "rb");
+	if(!file)
+	{
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "PackDataProvider::Connect", "Can't open file '" + path + "'");
+		return false;
+	}
+	char chunk[64*1024];
+	size_t read;
+	mBuffer.clear();
+	while((read = fread(chunk, 1, sizeof(chunk), file)) > 0) mBuffer.insert(mBuffer.end(), chunk, chunk + read);
+	fclose(file);
+	mData = mBuffer.empty() ? NULL : &mBuffer[0];
+	mSize = mBuffer.size();
+	mIsMapped = false;
+#endif
+
+	mIsConnected = true;
+	if(!ReadIndex())
+	{
+		Disconnect();
+		return false;
+	}
+
+	mConnectionString = connectionString;
+	return true;
+}
+
+
+void ccdb::PackDataProvider::Disconnect()
+{
+	if(!IsConnected()) return;
+
+#ifndef WIN32
+	if(mIsMapped) munmap(const_cast<char*>(mData), mSize);
+#endif
+	mBuffer.clear();
+	mData = NULL;
+	mSize = 0;
+	mIsMapped = false;
+
+	mPackTables.clear();
+	ClearCatalog();
+	mIsConnected = false;
+}
+#pragma endregion Connection
+
+#pragma region Index
+
+bool ccdb::PackDataProvider::IsInFile( uint64_t offset, uint64_t count, uint64_t size ) const
+{
+	//records are 8 bytes aligned, strings are not
+	if(size > 1 && offset % 8 != 0) return false;
+	if(offset > mSize) return false;
+	return count <= (mSize - offset) / (size ? size : 1);
+}
+
+
+bool ccdb::PackDataProvider::ReadIndex()
+{
+	const char* thisFunc = "PackDataProvider::ReadIndex";
+
+	if(mSize < sizeof(PackFormat::Header) || memcmp(mData, PackFormat::cMagic, sizeof(PackFormat::cMagic)) != 0)
+	{
+		Error(CCDB_ERROR_FILE_FORMAT, thisFunc, "The file is not a ccdb pack");
+		return false;
+	}
+
+	const PackFormat::Header* header = At<PackFormat::Header>(0);
+	if(header->Version != PackFormat::cVersion)
+	{
+		Error(CCDB_ERROR_FILE_FORMAT, thisFunc, StringUtils::Format("Pack version %u is not supported. Supported version is %u", header->Version, PackFormat::cVersion));
+		return false;
+	}
+	if(header->ByteOrderMark != PackFormat::cByteOrderMark)
+	{
+		Error(CCDB_ERROR_FILE_FORMAT, thisFunc, "The pack was made on a machine with other byte order");
+		return false;
+	}
+	if(header->FileSize != mSize || !IsInFile(header->TablesOffset, header->TablesCount, sizeof(PackFormat::Table)) ||
+	   !IsInFile(header->Variation.Offset, header->Variation.Length, 1))
+	{
+		Error(CCDB_ERROR_FILE_FORMAT, thisFunc, "The pack is truncated or corrupted");
+		return false;
+	}
+
+	mVariation = GetString(header->Variation);
+	mTime = header->Time;
+	mCreatedTime = header->CreatedTime;
+	AddVariation(mVariation);
+
+	//check all records but cells, cells are checked when they are read
+	const PackFormat::Table* tables = At<PackFormat::Table>(header->TablesOffset);
+	for(uint64_t i = 0; i < header->TablesCount; i++)
+	{
+		const PackFormat::Table& table = tables[i];
+		bool isOk = IsInFile(table.Path.Offset, table.Path.Length, 1) &&
+		            IsInFile(table.Comment.Offset, table.Comment.Length, 1) &&
+		            IsInFile(table.ColumnsOffset, table.ColumnsCount, sizeof(PackFormat::Column)) &&
+		            IsInFile(table.IntervalsOffset, table.IntervalsCount, sizeof(PackFormat::Interval));
+
+		vector<string> columnNames;
+		vector<string> columnTypes;
+		const PackFormat::Column* columns = At<PackFormat::Column>(table.ColumnsOffset);
+		for(uint64_t j = 0; isOk && j < table.ColumnsCount; j++)
+		{
+			isOk = IsInFile(columns[j].Name.Offset, columns[j].Name.Length, 1) && IsInFile(columns[j].Type.Offset, columns[j].Type.Length, 1);
+			if(isOk)
+			{
+				columnNames.push_back(GetString(columns[j].Name));
+				columnTypes.push_back(GetString(columns[j].Type));
+			}
+		}
+
+		const PackFormat::Interval* intervals = At<PackFormat::Interval>(table.IntervalsOffset);
+		for(uint64_t j = 0; isOk && j < table.IntervalsCount; j++)
+		{
+			const PackFormat::Interval& interval = intervals[j];
+			isOk = interval.RunMin <= interval.RunMax && (j == 0 || intervals[j - 1].RunMax < interval.RunMin) &&
+			       IsInFile(interval.BlockOffset, 1, sizeof(PackFormat::Block));
+			if(!isOk) break;
+
+			const PackFormat::Block* block = At<PackFormat::Block>(interval.BlockOffset);
+			isOk = IsInFile(block->RawData.Offset, block->RawData.Length, 1) &&
+			       IsInFile(block->CellsOffset, block->CellsCount, sizeof(PackFormat::StrRef)) &&
+			       IsInFile(block->ValuesOffset, block->CellsCount, sizeof(double)) &&
+			       block->RowsCount * table.ColumnsCount == block->CellsCount;
+		}
+
+		if(!isOk)
+		{
+			Error(CCDB_ERROR_FILE_FORMAT, thisFunc, "The pack is truncated or corrupted");
+			return false;
+		}
+
+		size_t tableIndex = AddTable(GetString(table.Path), columnNames, columnTypes, (int)table.RowsCount, GetString(table.Comment));
+		if(tableIndex != mPackTables.size())
+		{
+			Error(CCDB_ERROR_FILE_FORMAT, thisFunc, "The pack has table '" + GetString(table.Path) + "' twice");
+			return false;
+		}
+		mPackTables.push_back(&table);
+	}
+
+	return true;
+}
+#pragma endregion Index
+
+#pragma region Assignments
+
+const ccdb::PackFormat::Block* ccdb::PackDataProvider::FindBlock( int run, const string& path, time_t time, const string& variation, int& tableIndex )
+{
+	ClearErrors(); //Clear error in function that can produce new ones
+
+	const char* thisFunc = "PackDataProvider::GetAssignmentShort";
+	if(!CheckConnection(thisFunc)) return NULL;
+
+	if(variation != mVariation)
+	{
+		Error(CCDB_ERROR_VARIATION_INVALID, thisFunc, "The pack has constants of variation '" + mVariation + "' only");
+		return NULL;
+	}
+
+	//a pack of the latest constants serves any time since it was made, other packs serve their time only
+	bool isTimeServed = time <= 0 || time == mTime || (mTime == 0 && time >= mCreatedTime);
+	if(!isTimeServed)
+	{
+		if(mTime == 0) Error(CCDB_ERROR_NO_ASSIGMENT, thisFunc, StringUtils::Format("The pack has the latest constants at time %lld, earlier times are not served", (long long)mCreatedTime));
+		else Error(CCDB_ERROR_NO_ASSIGMENT, thisFunc, StringUtils::Format("The pack has constants for time %lld only", (long long)mTime));
+		return NULL;
+	}
+
+	tableIndex = FindTable(path);
+	if(tableIndex < 0)
+	{
+		Error(CCDB_ERROR_NO_TYPETABLE, thisFunc, "Type table was not found: '" + path + "'");
+		return NULL;
+	}
+
+	//the last interval that starts not after the run
+	const PackFormat::Table* table = mPackTables[tableIndex];
+	const PackFormat::Interval* intervals = At<PackFormat::Interval>(table->IntervalsOffset);
+	size_t first = 0;
+	size_t count = (size_t)table->IntervalsCount;
+	while(count > 0)
+	{
+		size_t step = count / 2;
+		if(intervals[first + step].RunMin <= run)
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	if(first == 0 || intervals[first - 1].RunMax < run)
+	{
+		//No constants is not an error, as for other providers
+		return NULL;
+	}
+	return At<PackFormat::Block>(intervals[first - 1].BlockOffset);
+}
+
+
+ccdb::Assignment* ccdb::PackDataProvider::GetAssignmentShort( int run, const string& path, time_t time, const string& variation/*="default"*/, bool loadColumns/*=false*/ )
+{
+	int tableIndex;
+	const PackFormat::Block* block = FindBlock(run, path, time, variation, tableIndex);
+	if(!block) return NULL;
+
+	vector<string> cells(block->CellsCount);
+	const PackFormat::StrRef* refs = At<PackFormat::StrRef>(block->CellsOffset);
+	for(size_t i = 0; i < cells.size(); i++)
+	{
+		if(!IsInFile(refs[i].Offset, refs[i].Length, 1))
+		{
+			Error(CCDB_ERROR_FILE_FORMAT, "PackDataProvider::GetAssignmentShort", "The pack is corrupted");
+			return NULL;
+		}
+		cells[i].assign(mData + refs[i].Offset, (size_t)refs[i].Length);
+	}
+
+	Assignment* assignment = CreateAssignment(tableIndex, run, loadColumns);
+	assignment->SetId((int)block->AssignmentId);
+	assignment->SetCreatedTime((time_t)block->CreatedTime);
+	assignment->SetRawData(GetString(block->RawData), std::move(cells));
+	return assignment;
+}
+
+
+bool ccdb::PackDataProvider::FindConstants( PackConstants& constants, int run, const string& path, const string& variation/*="default"*/, time_t time/*=0*/ )
+{
+	int tableIndex;
+	const PackFormat::Block* block = FindBlock(run, path, time, variation, tableIndex);
+	if(!block) return false;
+
+	constants.RowsCount = (size_t)block->RowsCount;
+	constants.ColumnsCount = (size_t)mPackTables[tableIndex]->ColumnsCount;
+	constants.Values = At<double>(block->ValuesOffset);
+	constants.Cells = At<PackFormat::StrRef>(block->CellsOffset);
+	constants.Base = mData;
+	return true;
+}
+
+
+bool ccdb::PackDataProvider::GetDecodedValues( vector< vector<double> >& values, int run, const string& path, time_t time, const string& variation/*="default"*/ )
+{
+	PackConstants constants;
+	if(!FindConstants(constants, run, path, variation, time)) return false;
+
+	values.resize(constants.RowsCount);
+	for (size_t rowIter = 0; rowIter < constants.RowsCount; rowIter++)
+	{
+		const double* row = constants.Values + rowIter*constants.ColumnsCount;
+		values[rowIter].assign(row, row + constants.ColumnsCount);
+	}
+	return true;
+}
+#pragma endregion Assignments
@@ -0,0 +1,345 @@
+#include <stdio.h>
+#include <string.h>
+#include <set>
+#include <stdexcept>
+
+#include "CCDB/Providers/PackWriter.h"
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Helpers/TimeProvider.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+
+
+//______________________________________________________________________________
+ccdb::PackWriter::PackWriter( DataProvider* source, const std::string& variation/*="default"*/, time_t time/*=0*/ )
+    :mSource(source),
+    mVariation(variation),
+    mTime(time)
+{
+}
+
+
+//______________________________________________________________________________
+void ccdb::PackWriter::AddRunRange( int runMin, int runMax )
+{
+    if(runMin > runMax) throw std::logic_error(StringUtils::Format("Wrong run range %i-%i", runMin, runMax));
+    mRuns.push_back(make_pair(runMin, runMax));
+}
+
+
+//______________________________________________________________________________
+size_t ccdb::PackWriter::GetIntervalsCount() const
+{
+    size_t count = 0;
+    for(map<string, TableEntry>::const_iterator it = mTables.begin(); it != mTables.end(); ++it)
+    {
+        count += it->second.Intervals.size();
+    }
+    return count;
+}
+
+
+//______________________________________________________________________________
+void ccdb::PackWriter::AddAllTables()
+{
+    vector<ConstantsTypeTable*> tables;
+    if(!mSource->SearchConstantsTypeTables(tables, "*"))
+    {
+        throw std::logic_error(GetSourceErrors("Error selecting all type tables"));
+    }
+
+    vector<string> paths;
+    for(size_t i = 0; i < tables.size(); i++)
+    {
+        paths.push_back(tables[i]->GetFullPath());
+        delete tables[i];
+    }
+
+    for(size_t i = 0; i < paths.size(); i++) AddTable(paths[i]);
+}
+
+
+//______________________________________________________________________________
+void ccdb::PackWriter::AddTable( const std::string& tablePath )
+{
+    string path(tablePath);
+    PathUtils::MakeAbsolute(path);
+    if(mTables.find(path) != mTables.end()) return;
+
+    ConstantsTypeTable* typeTable = mSource->GetConstantsTypeTable(path, true);
+    if(!typeTable) throw std::logic_error(GetSourceErrors("Type table was not found: '" + path + "'"));
+
+    TableEntry table;
+    table.Path = path;
+    table.Comment = typeTable->GetComment();
+    table.RowsCount = typeTable->GetRowsCount();
+    table.ColumnNames = typeTable->GetColumnNames();
+    table.ColumnTypes = typeTable->GetColumnTypeStrings();
+    delete typeTable;
+
+    //Constants can change only on borders of run ranges. Take borders of all assignments of the table
+    vector<Assignment*> assignments;
+    if(!mSource->GetAssignments(assignments, path, 0, 0, "", "", 0, 0))
+    {
+        throw std::logic_error(GetSourceErrors("Error selecting assignments of '" + path + "'"));
+    }
+
+    set<int> borders;      //first runs of intervals
+    for(size_t i = 0; i < assignments.size(); i++)
+    {
+        RunRange* runRange = assignments[i]->GetRunRange();
+        if(runRange)
+        {
+            borders.insert(runRange->GetMin());
+            if(runRange->GetMax() < INFINITE_RUN) borders.insert(runRange->GetMax() + 1);
+        }
+    }
+    for(size_t i = 0; i < assignments.size(); i++) delete assignments[i];
+
+    vector<pair<int, int> > runs = mRuns;
+    if(runs.empty()) runs.push_back(make_pair(0, INFINITE_RUN));
+
+    for(size_t i = 0; i < runs.size(); i++)
+    {
+        int runMin = runs[i].first;
+        while(true)
+        {
+            set<int>::iterator next = borders.upper_bound(runMin);
+            int runMax = (next == borders.end() || *next > runs[i].second) ? runs[i].second : *next - 1;
+
+            AddInterval(table, table.ColumnTypes, runMin, runMax);
+
+            if(runMax >= runs[i].second) break;
+            runMin = runMax + 1;
+        }
+    }
+
+    mTables[path] = table;
+}
+
+
+//______________________________________________________________________________
+void ccdb::PackWriter::AddInterval( TableEntry& table, const std::vector<std::string>& columnTypes, int runMin, int runMax )
+{
+    Assignment* assignment = mTime > 0 ? mSource->GetAssignmentShort(runMin, table.Path, mTime, mVariation)
+                                       : mSource->GetAssignmentShort(runMin, table.Path, mVariation);
+    if(!assignment)
+    {
+        //no constants for these runs is not an error
+        if(mSource->GetNErrors() == 0) return;
+        throw std::logic_error(GetSourceErrors(StringUtils::Format("Error reading '%s' for run %i", table.Path.c_str(), runMin)));
+    }
+
+    size_t blockIndex;
+    map<int, size_t>::iterator it = mBlocksByAssignment.find(assignment->GetId());
+    if(it != mBlocksByAssignment.end())
+    {
+        blockIndex = it->second;
+    }
+    else
+    {
+        BlockEntry block;
+        block.AssignmentId = assignment->GetId();
+        block.CreatedTime = assignment->GetCreatedTime();
+        block.RawData = assignment->GetRawData();
+        assignment->GetVectorData(block.Cells);
+        if(columnTypes.empty() || block.Cells.size() % columnTypes.size() != 0)
+        {
+            throw std::logic_error(StringUtils::Format("Data of '%s' for run %i has %i cells that don't fill %i columns",
+                table.Path.c_str(), runMin, (int)block.Cells.size(), (int)columnTypes.size()));
+        }
+        block.RowsCount = block.Cells.size() / columnTypes.size();
+
+        //pre-decode cells as numbers, so readers don't parse them. Numbers are the ones
+        //Calibration::GetCalib gives for the cells, whatever the column type is
+        block.Values.resize(block.Cells.size());
+        for(size_t i = 0; i < block.Cells.size(); i++)
+        {
+            block.Values[i] = StringUtils::ParseDouble(block.Cells[i]);
+        }
+
+        mBlocks.push_back(block);
+        blockIndex = mBlocks.size() - 1;
+        mBlocksByAssignment[block.AssignmentId] = blockIndex;
+    }
+    delete assignment;
+
+    //merge with the previous interval if it has the same constants
+    if(!table.Intervals.empty())
+    {
+        IntervalEntry& last = table.Intervals.back();
+        if(last.Block == blockIndex && last.RunMax + 1 == runMin)
+        {
+            last.RunMax = runMax;
+            return;
+        }
+    }
+
+    IntervalEntry interval;
+    interval.RunMin = runMin;
+    interval.RunMax = runMax;
+    interval.Block = blockIndex;
+    table.Intervals.push_back(interval);
+}
+
+
+//______________________________________________________________________________
+std::string ccdb::PackWriter::GetSourceErrors( const std::string& message )
+{
+    string result(message);
+    vector<CCDBError *> errors = mSource->GetErrors();
+    for(size_t i = 0; i < errors.size(); i++)
+    {
+        result += ". " + errors[i]->GetMessage();
+    }
+    return result;
+}
+
+
+//______________________________________________________________________________
+uint64_t ccdb::PackWriter::Append( std::vector<char>& file, const void* data, size_t size )
+{
+    uint64_t offset = file.size();
+    file.insert(file.end(), (const char*)data, (const char*)data + size);
+    return offset;
+}
+
+
+//______________________________________________________________________________
+uint64_t ccdb::PackWriter::Align( std::vector<char>& file )
+{
+    file.resize((file.size() + 7) & ~(size_t)7, '\0');
+    return file.size();
+}
+
+
+//______________________________________________________________________________
+ccdb::PackFormat::StrRef ccdb::PackWriter::AppendString( std::vector<char>& file, const std::string& str )
+{
+    PackFormat::StrRef ref;
+    ref.Offset = Append(file, str.c_str(), str.size() + 1);   //with '\0'
+    ref.Length = str.size();
+    return ref;
+}
+
+
+//______________________________________________________________________________
+uint64_t ccdb::PackWriter::AppendBlock( std::vector<char>& file, const BlockEntry& block )
+{
+    PackFormat::Block record;
+    record.AssignmentId = block.AssignmentId;
+    record.CreatedTime = block.CreatedTime;
+    record.RawData = AppendString(file, block.RawData);
+    record.CellsCount = block.Cells.size();
+    record.RowsCount = block.RowsCount;
+
+    //Cells without encoded delimiters are referenced right in the raw blob, others are appended.
+    //The blob is walked the same way as StringUtils::SplitBlob does: empty tokens are skipped
+    vector<PackFormat::StrRef> cells(block.Cells.size());
+    size_t pos = 0;
+    size_t cellIndex = 0;
+    while(pos <= block.RawData.size() && cellIndex < block.Cells.size())
+    {
+        size_t end = block.RawData.find(CCDB_DATA_BLOB_DELIMETER[0], pos);
+        if(end == string::npos) end = block.RawData.size();
+        if(end > pos)
+        {
+            if(block.RawData.compare(pos, end - pos, block.Cells[cellIndex]) == 0)
+            {
+                cells[cellIndex].Offset = record.RawData.Offset + pos;
+                cells[cellIndex].Length = end - pos;
+            }
+            else
+            {
+                cells[cellIndex] = AppendString(file, block.Cells[cellIndex]);
+            }
+            cellIndex++;
+        }
+        pos = end + 1;
+    }
+    for(; cellIndex < block.Cells.size(); cellIndex++) cells[cellIndex] = AppendString(file, block.Cells[cellIndex]);
+
+    Align(file);
+    record.CellsOffset = Append(file, cells.empty() ? NULL : &cells[0], cells.size() * sizeof(PackFormat::StrRef));
+    record.ValuesOffset = Append(file, block.Values.empty() ? NULL : &block.Values[0], block.Values.size() * sizeof(double));
+    return Append(file, &record, sizeof(record));
+}
+
+
+//______________________________________________________________________________
+void ccdb::PackWriter::Write( const std::string& filePath )
+{
+    vector<char> file;
+
+    PackFormat::Header header;
+    memset(&header, 0, sizeof(header));
+    Append(file, &header, sizeof(header));      //is written again at the end
+    header.Variation = AppendString(file, mVariation);
+
+    vector<uint64_t> blockOffsets(mBlocks.size());
+    for(size_t i = 0; i < mBlocks.size(); i++)
+    {
+        blockOffsets[i] = AppendBlock(file, mBlocks[i]);
+    }
+
+    //tables are sorted by path as they are in the map
+    vector<PackFormat::Table> tables;
+    for(map<string, TableEntry>::const_iterator it = mTables.begin(); it != mTables.end(); ++it)
+    {
+        const TableEntry& table = it->second;
+
+        PackFormat::Table record;
+        record.Path = AppendString(file, table.Path);
+        record.Comment = AppendString(file, table.Comment);
+        record.RowsCount = table.RowsCount;
+
+        vector<PackFormat::Column> columns(table.ColumnNames.size());
+        for(size_t i = 0; i < columns.size(); i++)
+        {
+            columns[i].Name = AppendString(file, table.ColumnNames[i]);
+            columns[i].Type = AppendString(file, table.ColumnTypes[i]);
+        }
+
+        vector<PackFormat::Interval> intervals(table.Intervals.size());
+        for(size_t i = 0; i < intervals.size(); i++)
+        {
+            intervals[i].RunMin = table.Intervals[i].RunMin;
+            intervals[i].RunMax = table.Intervals[i].RunMax;
+            intervals[i].BlockOffset = blockOffsets[table.Intervals[i].Block];
+        }
+
+        Align(file);
+        record.ColumnsCount = columns.size();
+        record.ColumnsOffset = Append(file, columns.empty() ? NULL : &columns[0], columns.size() * sizeof(PackFormat::Column));
+        record.IntervalsCount = intervals.size();
+        record.IntervalsOffset = Append(file, intervals.empty() ? NULL : &intervals[0], intervals.size() * sizeof(PackFormat::Interval));
+        tables.push_back(record);
+    }
+
+    Align(file);
+    header.TablesCount = tables.size();
+    header.TablesOffset = Append(file, tables.empty() ? NULL : &tables[0], tables.size() * sizeof(PackFormat::Table));
+
+    memcpy(header.Magic, PackFormat::cMagic, sizeof(header.Magic));
+    header.Version = PackFormat::cVersion;
+    header.ByteOrderMark = PackFormat::cByteOrderMark;
+    header.FileSize = file.size();
+    header.Time = mTime;
+    header.CreatedTime = TimeProvider::GetUnixTimeStamp(ClockSources::Realtime);
+    memcpy(&file[0], &header, sizeof(header));
+
+    //Write to a temporary file and rename it, so nobody maps a half written pack
+    string tempPath = StringUtils::Format("%s.%lld.tmp", filePath.c_str(), (long long)header.CreatedTime ^ (long long)(size_t)this);
+    FILE* target = fopen(tempPath.c_str(), "wb");
+    if(!target) throw std::logic_error("Can't open file '" + tempPath + "' for writing");
+
+    bool isOk = fwrite(&file[0], 1, file.size(), target) == file.size();
+    isOk = (fclose(target) == 0) && isOk;
+    if(!isOk || rename(tempPath.c_str(), filePath.c_str()) != 0)
+    {
+        remove(tempPath.c_str());
+        throw std::logic_error("Can't write file '" + filePath + "'");
+    }
+}
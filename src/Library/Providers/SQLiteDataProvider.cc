@@ -1,11 +1,21 @@
 
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <iostream>
 #include <sstream>
 #include <time.h>
 #include <string.h>
 #include <limits.h>
+#include <sys/stat.h>
+#include <utime.h>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <functional>
+#if defined(__linux__)
+#include <fcntl.h>
+#endif
 
 
 #include "CCDB/Globals.h"
@@ -19,6 +29,112 @@
 
 using namespace ccdb;
 
+namespace
+{
+	/** Escapes characters that have special meaning in file: URI */
+	string EncodeUriPath(const string& path)
+	{
+		string result;
+		for (size_t i = 0; i < path.size(); i++)
+		{
+			switch(path[i])
+			{
+			case '%': result.append("%25"); break;
+			case '?': result.append("%3f"); break;
+			case '#': result.append("%23"); break;
+			default:  result.push_back(path[i]);
+			}
+		}
+		return result;
+	}
+
+	/** The database has tables, i.e. it is not a new empty one */
+	bool HasTables(sqlite3* database)
+	{
+		sqlite3_stmt* statement = NULL;
+		bool hasTables = sqlite3_prepare_v2(database, "SELECT 1 FROM `sqlite_master` LIMIT 1", -1, &statement, 0) == SQLITE_OK &&
+			sqlite3_step(statement) == SQLITE_ROW;
+		sqlite3_finalize(statement);
+		return hasTables;
+	}
+
+	/** Reads the file through to bring it to OS page cache */
+	void PrewarmFile(const string& path)
+	{
+		FILE* file = fopen(path.c_str(), "rb");
+		if(!file) return;
+
+#if defined(__linux__)
+		posix_fadvise(fileno(file), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+		vector<char> buffer(1024*1024);
+		while(fread(&buffer[0], 1, buffer.size(), file) == buffer.size());
+		fclose(file);
+	}
+
+	/** The copy has the size and the modification time of the file it was made from */
+	bool IsSameFile(const string& localPath, const struct stat& fileStat)
+	{
+		struct stat localStat;
+		return stat(localPath.c_str(), &localStat) == 0 &&
+			localStat.st_size == fileStat.st_size &&
+			localStat.st_mtime == fileStat.st_mtime;
+	}
+
+	/** Makes local copy of the file in scratchDir (if there is no up to date one) and gives its path */
+	bool CopyToScratch(const string& path, const string& scratchDir, string& localPath)
+	{
+		struct stat fileStat;
+		if(stat(path.c_str(), &fileStat) != 0) return false;
+
+		//The copy name is the hash of the file identity: path, size and modification time
+		string identity = StringUtils::Format("%s:%lld:%lld", path.c_str(), (long long)fileStat.st_size, (long long)fileStat.st_mtime);
+		unsigned long long hash = StringUtils::Hash64(identity);
+		localPath = StringUtils::Format("%s/ccdb-%016llx.sqlite", scratchDir.c_str(), hash);
+
+		//The path is in the name, size and modification time are given to the copy
+		if(IsSameFile(localPath, fileStat)) return true;
+
+		//Copy to a temporary file and rename it, so other processes never see a half copied file
+		unsigned long long uniqueId = std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+			static_cast<unsigned long long>(std::chrono::steady_clock::now().time_since_epoch().count());
+		string tempPath = StringUtils::Format("%s.%llx.tmp", localPath.c_str(), uniqueId);
+
+		FILE* source = fopen(path.c_str(), "rb");
+		if(!source) return false;
+		FILE* target = fopen(tempPath.c_str(), "wb");
+		if(!target) { fclose(source); return false; }
+
+		vector<char> buffer(1024*1024);
+		bool isOk = true;
+		size_t read;
+		while((read = fread(&buffer[0], 1, buffer.size(), source)) > 0)
+		{
+			if(fwrite(&buffer[0], 1, read, target) != read) { isOk = false; break; }
+		}
+		isOk = isOk && !ferror(source);
+		fclose(source);
+		isOk = (fclose(target) == 0) && isOk;
+
+		//The file could be changed while it was copied, then the copy is not what its name says
+		struct stat copiedStat;
+		isOk = isOk && stat(path.c_str(), &copiedStat) == 0 &&
+			copiedStat.st_size == fileStat.st_size && copiedStat.st_mtime == fileStat.st_mtime;
+
+		struct utimbuf times;
+		times.actime = fileStat.st_atime;
+		times.modtime = fileStat.st_mtime;
+		isOk = isOk && utime(tempPath.c_str(), &times) == 0 && IsSameFile(tempPath, fileStat);
+
+		if(isOk && rename(tempPath.c_str(), localPath.c_str()) == 0) return true;
+
+		remove(tempPath.c_str());
+
+		//Other process could have made the copy meanwhile
+		return IsSameFile(localPath, fileStat);
+	}
+}
+
 #pragma region constructors
 
 ccdb::SQLiteDataProvider::SQLiteDataProvider(void)
@@ -28,6 +144,9 @@ ccdb::SQLiteDataProvider::SQLiteDataProvider(void)
 	mStatement=NULL;
     mLastVariation = NULL;
 	mRootDir = new Directory(this, this);
+	mArchive = NULL;
+	mHotRunMin = 0;
+	mHotRunMax = INFINITE_RUN;
 	mDirsAreLoaded = false;
 }
 
@@ -57,8 +176,33 @@ bool ccdb::SQLiteDataProvider::Connect( std::string connectionString )
 
 	mConnectionString = connectionString;
 
-	//ok we dont need sqlite:// in the beginning.
-	connectionString.erase(0,9);
+	//ok we dont need sqlite:// and options in the beginning.
+	SQLiteConnectionInfo connection;
+	ParseConnectionString(connectionString, connection);
+
+	//The image in memory is loaded already, the file is not touched
+	if(!connection.SharedMemoryName.empty())
+	{
+		connection.ScratchDir = "";
+		connection.IsPrewarm = false;
+		connection.IsInMemory = false;
+		connection.IsImmutable = false;
+	}
+
+	//use local copy of the file if asked
+	if(!connection.ScratchDir.empty())
+	{
+		string localPath;
+		if(CopyToScratch(connection.FilePath, connection.ScratchDir, localPath))
+		{
+			connection.FilePath = localPath;
+		}
+		else
+		{
+			Warning(CCDB_WARNING_SCRATCH_COPY, "SQLiteDataProvider::Connect()", "Can't copy '" + connection.FilePath + "' to scratch directory '" + connection.ScratchDir + "'. The file is used directly");
+		}
+	}
+	connectionString = connection.FilePath;
 	
 	//check if we are connected
 	if(IsConnected())
@@ -70,8 +214,26 @@ bool ccdb::SQLiteDataProvider::Connect( std::string connectionString )
 	//verbose...
 	Log::Verbose("ccdb::SQLiteDataProvider::Connect", StringUtils::Format("Connecting to database:\n %s", connectionString.c_str()));
 	
+	if(connection.IsPrewarm) PrewarmFile(connection.FilePath);
+
 	//Try to open sqlite database
-	int result = sqlite3_open_v2(connectionString.c_str(), &mDatabase, SQLITE_OPEN_READONLY|SQLITE_OPEN_FULLMUTEX|SQLITE_OPEN_SHAREDCACHE, NULL);
+	//The provider keeps the statement state in members and is used by one thread at a time,
+	//so the connection needs no mutex of its own. Parallel readers use a connection each
+	//(@see DataProviderPool), that is why the cache is not shared: shared cache would serialize them again
+	int flags = SQLITE_OPEN_READONLY|SQLITE_OPEN_NOMUTEX|SQLITE_OPEN_PRIVATECACHE;
+	if(!connection.SharedMemoryName.empty())
+	{
+		//The image made by memory=1 is one per process, so its page cache is shared by the connections
+		connectionString = "file:" + connection.SharedMemoryName + "?mode=memory&cache=shared";
+		flags = SQLITE_OPEN_READONLY|SQLITE_OPEN_NOMUTEX|SQLITE_OPEN_SHAREDCACHE|SQLITE_OPEN_URI;
+	}
+	else if(connection.IsImmutable)
+	{
+		//immutable can be set only as URI parameter
+		connectionString = "file:" + EncodeUriPath(connection.FilePath) + "?immutable=1";
+		flags |= SQLITE_OPEN_URI;
+	}
+	int result = sqlite3_open_v2(connectionString.c_str(), &mDatabase, flags, NULL);
     //int result = sqlite3_open(connectionString.c_str(), &mDatabase);
 
 	if (result != SQLITE_OK) 
@@ -83,11 +245,114 @@ bool ccdb::SQLiteDataProvider::Connect( std::string connectionString )
 		return false;
 	}
 
+	//Named memory database is created empty if nobody holds it
+	if(!connection.SharedMemoryName.empty() && !HasTables(mDatabase))
+	{
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR,"bool SQLiteDataProvider::Connect(std::string connectionString)",
+			("The database image '" + connection.SharedMemoryName + "' is not loaded to memory").c_str());
+		sqlite3_close(mDatabase);
+		mDatabase = NULL;
+		mConnectionString = "";
+		return false;
+	}
+
     sqlite3_exec(mDatabase, "PRAGMA journal_mode = OFF;", NULL, 0, 0);
+	if(connection.MmapSize >= 0)
+	{
+		sqlite3_exec(mDatabase, StringUtils::Format("PRAGMA mmap_size = %lld;", connection.MmapSize).c_str(), NULL, 0, 0);
+	}
+	if(connection.CacheSize != 0)
+	{
+		sqlite3_exec(mDatabase, StringUtils::Format("PRAGMA cache_size = %i;", connection.CacheSize).c_str(), NULL, 0, 0);
+	}
+
+	//Copy whole database to memory by backup API. Reading is sequential and is done once.
+	//The image is a named memory database, so other connections of the process open it
+	//by shared_memory=<name> instead of loading their own copies (@see GetMemoryName)
+	if(connection.IsInMemory)
+	{
+		static std::atomic<unsigned> memoryImagesCount(0);
+		string memoryName = StringUtils::Format("ccdb-memory-%u", ++memoryImagesCount);
+		string memoryUri = "file:" + memoryName + "?mode=memory&cache=shared";
+
+		sqlite3* memoryDatabase = NULL;
+		sqlite3_backup* backup = NULL;
+		result = sqlite3_open_v2(memoryUri.c_str(), &memoryDatabase, SQLITE_OPEN_READWRITE|SQLITE_OPEN_CREATE|SQLITE_OPEN_NOMUTEX|SQLITE_OPEN_SHAREDCACHE|SQLITE_OPEN_URI, NULL);
+		if(result == SQLITE_OK) backup = sqlite3_backup_init(memoryDatabase, "main", mDatabase, "main");
+		if(backup)
+		{
+			sqlite3_backup_step(backup, -1);
+			result = sqlite3_backup_finish(backup);
+		}
+
+		if(!backup || result != SQLITE_OK)
+		{
+			string errStr = StringUtils::Format("Loading database to memory failed. Error code: %i. Message: '%s'", sqlite3_errcode(memoryDatabase), sqlite3_errmsg(memoryDatabase));
+			Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR,"bool SQLiteDataProvider::Connect(std::string connectionString)",errStr.c_str());
+			sqlite3_close(memoryDatabase);
+			sqlite3_close(mDatabase);
+			mDatabase = NULL;
+			mConnectionString = "";
+			return false;
+		}
+
+		sqlite3_close(mDatabase);
+		mDatabase = memoryDatabase;
+		mMemoryName = memoryName;
+	}
 	
+	mArchivePath = connection.ArchivePath;
+	if(!mArchivePath.empty()) ReadHotWindow();
+
 	mIsConnected = true;
 	return true;
 }
+
+
+bool ccdb::SQLiteDataProvider::ParseConnectionString( std::string conStr, SQLiteConnectionInfo &connection )
+{
+	//first check for uri type
+	if(conStr.find("sqlite://")!=0) return false;
+	conStr.erase(0,9);
+
+	//options like ?immutable=1&mmap=268435456
+	size_t questionPos = conStr.find('?');
+	if(questionPos!=string::npos)
+	{
+		vector<string> options = StringUtils::Split(conStr.substr(questionPos+1), "&");
+		conStr.erase(questionPos);
+
+		for (size_t i = 0; i < options.size(); i++)
+		{
+			size_t equalPos = options[i].find('=');
+			if(equalPos == string::npos) continue;
+
+			string name = options[i].substr(0, equalPos);
+			string value = options[i].substr(equalPos+1);
+			if(name == "immutable")        connection.IsImmutable = StringUtils::ParseBool(value);
+			else if(name == "mmap")        connection.MmapSize = StringUtils::ParseLong(value);
+			else if(name == "cache_size")  connection.CacheSize = StringUtils::ParseInt(value);
+			else if(name == "prewarm")     connection.IsPrewarm = StringUtils::ParseBool(value);
+			else if(name == "memory")      connection.IsInMemory = StringUtils::ParseBool(value);
+			else if(name == "scratch")     connection.ScratchDir = value;
+			else if(name == "pool")        connection.PoolSize = StringUtils::ParseInt(value);
+			else if(name == "archive")     connection.ArchivePath = value;
+			else if(name == "shared_memory") connection.SharedMemoryName = value;
+		}
+	}
+
+	connection.FilePath = conStr;
+
+	//relative archive is next to the hot database, not in the working directory
+	size_t slashPos = conStr.find_last_of('/');
+	if(!connection.ArchivePath.empty() && !PathUtils::IsAbsolute(connection.ArchivePath) && slashPos != string::npos)
+	{
+		connection.ArchivePath = PathUtils::CombinePath(conStr.substr(0, slashPos), connection.ArchivePath);
+	}
+	return true;
+}
+
+
 bool ccdb::SQLiteDataProvider::IsConnected()
 {
 	return mIsConnected;
@@ -103,6 +368,11 @@ void ccdb::SQLiteDataProvider::Disconnect()
 		sqlite3_close(mDatabase);
 		mDatabase = NULL;
 		mIsConnected = false;
+
+		delete mArchive;
+		mArchive = NULL;
+		mArchivePath = "";
+		mMemoryName = "";
 	}
 }
 
@@ -119,6 +389,56 @@ bool ccdb::SQLiteDataProvider::CheckConnection( const string& errorSource/*=""*/
 	}
 	return true;
 }
+
+
+void ccdb::SQLiteDataProvider::ReadHotWindow()
+{
+	//ArchiveSplitter writes the window to the hot database. A database without it has all runs
+	mHotRunMin = 0;
+	mHotRunMax = INFINITE_RUN;
+
+	sqlite3_stmt* statement = NULL;
+	if(sqlite3_prepare_v2(mDatabase, "SELECT `runMin`, `runMax` FROM `archiveWindow` LIMIT 1", -1, &statement, 0) == SQLITE_OK &&
+	   sqlite3_step(statement) == SQLITE_ROW)
+	{
+		mHotRunMin = sqlite3_column_int(statement, 0);
+		mHotRunMax = sqlite3_column_int(statement, 1);
+	}
+	sqlite3_finalize(statement);
+}
+
+
+bool ccdb::SQLiteDataProvider::IsArchiveRequest( int run, time_t time ) const
+{
+	//the hot database has only the latest constants of its window
+	return !mArchivePath.empty() && (time > 0 || run < mHotRunMin || run > mHotRunMax);
+}
+
+
+bool ccdb::SQLiteDataProvider::OpenArchive()
+{
+	if(mArchive) return true;
+
+	mArchive = new SQLiteDataProvider();
+	if(mArchive->Connect("sqlite://" + mArchivePath)) return true;
+
+	CopyArchiveErrors();
+	delete mArchive;
+	mArchive = NULL;
+	return false;
+}
+
+
+void ccdb::SQLiteDataProvider::CopyArchiveErrors()
+{
+	//the archive has logged the messages already
+	const vector<int>& codes = mArchive->GetErrorCodes();
+	for(size_t i = 0; i < codes.size(); i++)
+	{
+		mErrorCodes.push_back(codes[i]);
+		mLastError = codes[i];
+	}
+}
 #pragma endregion Connection
 
 #pragma region Directories
@@ -1004,6 +1324,92 @@ Assignment* ccdb::SQLiteDataProvider::GetAssignmentShort(int run, const string&
      * @param [in] variation - variation name
      * @return new DAssignment object or 
      */
+	if(IsArchiveRequest(run, time))
+	{
+		if(!CheckConnection("SQLiteDataProvider::GetAssignmentShort") || !OpenArchive()) return NULL;
+
+		Assignment* assignment = mArchive->GetAssignmentShort(run, path, time, variationName, loadColumns);
+		if(!assignment) CopyArchiveErrors();
+		return assignment;
+	}
+	return QueryAssignmentShort(run, path, time, variationName, loadColumns, true);
+}
+
+
+namespace
+{
+	/** BlobCursor that reads constantSets.vault by sqlite incremental blob I/O */
+	class SQLiteBlobCursor: public ccdb::BlobCursor
+	{
+	public:
+		SQLiteBlobCursor(sqlite3_blob* blob, size_t columnsCount)
+			:BlobCursor(columnsCount),
+			mBlob(blob),
+			mOffset(0),
+			mSize(static_cast<size_t>(sqlite3_blob_bytes(blob)))
+		{
+		}
+
+		virtual ~SQLiteBlobCursor()
+		{
+			sqlite3_blob_close(mBlob);
+		}
+
+	protected:
+		virtual size_t ReadChunk(char* buffer, size_t size)
+		{
+			size_t left = mSize - mOffset;
+			if(size > left) size = left;
+			if(size == 0) return 0;
+
+			if(sqlite3_blob_read(mBlob, buffer, static_cast<int>(size), static_cast<int>(mOffset)) != SQLITE_OK) return 0;
+			mOffset += size;
+			return size;
+		}
+
+	private:
+		sqlite3_blob* mBlob;	// opened vault
+		size_t mOffset;			// offset of the next chunk
+		size_t mSize;			// vault size in bytes
+	};
+}
+
+
+//______________________________________________________________________________
+BlobCursor* ccdb::SQLiteDataProvider::GetAssignmentCursor(int run, const string& path, time_t time, const string& variation /*="default"*/)
+{
+	if(IsArchiveRequest(run, time))
+	{
+		if(!CheckConnection("SQLiteDataProvider::GetAssignmentCursor") || !OpenArchive()) return NULL;
+
+		BlobCursor* cursor = mArchive->GetAssignmentCursor(run, path, time, variation);
+		if(!cursor) CopyArchiveErrors();
+		return cursor;
+	}
+
+	Assignment* assignment = QueryAssignmentShort(run, path, time, variation, false, false);
+	if(!assignment) return NULL;
+
+	size_t columnsCount = assignment->GetColumnsCount();
+	sqlite3_int64 vaultId = assignment->GetDataVaultId();
+	delete assignment;
+
+	//constantSets.id is INTEGER PRIMARY KEY, i.e. it is the rowid
+	sqlite3_blob* blob = NULL;
+	if(sqlite3_blob_open(mDatabase, "main", "constantSets", "vault", vaultId, 0, &blob) != SQLITE_OK)
+	{
+		Error(CCDB_ERROR_QUERY_SELECT, "SQLiteDataProvider::GetAssignmentCursor", ComposeSQLiteError("sqlite3_blob_open()"));
+		if(blob) sqlite3_blob_close(blob);
+		return NULL;
+	}
+
+	return new SQLiteBlobCursor(blob, columnsCount);
+}
+
+
+//______________________________________________________________________________
+Assignment* ccdb::SQLiteDataProvider::QueryAssignmentShort(int run, const string& path, time_t time, const string& variationName, bool loadColumns, bool loadBlob)
+{
 	char thisFunc[] = "ccdb::SQLiteDataProvider::GetAssignmentShort(int run, const string& path, time_t time, const string& variation, bool loadColumns /*=true*/)";
 	ClearErrors(); //Clear error in function that can produce new ones
 
@@ -1027,8 +1433,8 @@ Assignment* ccdb::SQLiteDataProvider::GetAssignmentShort(int run, const string&
 
 	////ok now we must build our mighty query...
 	string query(
-        "SELECT `assignments`.`id` AS `asId`, "
-        "`constantSets`.`vault` AS `blob` "
+        "SELECT `assignments`.`id` AS `asId`, " +
+        (loadBlob ? string("`constantSets`.`vault` AS `blob` ") : string("`constantSets`.`id` AS `constId` ")) +
         "FROM  `assignments` "
         "INNER JOIN `runRanges` ON `assignments`.`runRangeId`= `runRanges`.`id` "
         "INNER JOIN `constantSets` ON `assignments`.`constantSetId` = `constantSets`.`id` "
@@ -1076,8 +1482,19 @@ Assignment* ccdb::SQLiteDataProvider::GetAssignmentShort(int run, const string&
 			break;
 		case SQLITE_ROW:
 			assignment = new Assignment(this, this);
-			assignment->SetId( ReadIndex(0) );			
-			assignment->SetRawData( ReadString(1) );
+			assignment->SetId( ReadIndex(0) );
+			if(loadBlob)
+			{
+				//the blob goes to the assignment right from the statement buffer
+				const char* blob;
+				size_t blobLength;
+				ReadStringBuffer(1, blob, blobLength);
+				assignment->SetRawData(blob, blobLength);
+			}
+			else
+			{
+				assignment->SetDataVaultId(ReadIndex(1));
+			}
 
 			//additional fill
 			assignment->SetRequestedRun(run);
@@ -1097,7 +1514,7 @@ Assignment* ccdb::SQLiteDataProvider::GetAssignmentShort(int run, const string&
     //If We have not found data for this variation, getting data for parent variation
     if((assignment == NULL && selectedRows==0) && variation->GetParentDbId()!=0)
     {
-        return GetAssignmentShort(run, path, time, variation->GetParent()->GetName(), loadColumns);
+        return QueryAssignmentShort(run, path, time, variation->GetParent()->GetName(), loadColumns, loadBlob);
     }
     
 	if(assignment == NULL) 
@@ -1126,7 +1543,7 @@ Assignment* ccdb::SQLiteDataProvider::GetAssignmentFull( int run, const string&
 Assignment* ccdb::SQLiteDataProvider::GetAssignmentFull( int run, const string& path,int version, const string& variation/*= "default"*/)
 {
 	if(!CheckConnection("SQLiteDataProvider::GetAssignmentFull( int run, const char* path, const char* variation, int version /*= -1*/ )")) return NULL;
-	return DataProvider::GetAssignmentFull(run, path, variation);
+	return DataProvider::GetAssignmentFull(run, path, version, variation);
 }
 
 
@@ -1137,6 +1554,17 @@ bool ccdb::SQLiteDataProvider::GetAssignments( vector<Assignment *> &assingments
 
 	if(!CheckConnection(thisFunc)) return false;
 
+	//the hot database answers only the latest assignment of a run of its window, lists are history
+	bool isLatest = take == 1 && startWith == 0 && beginTime == 0 && endTime == 0 && runRangeName.empty() && runMin == runMax;
+	if(!mArchivePath.empty() && (!isLatest || IsArchiveRequest(runMin, 0)))
+	{
+		if(!OpenArchive()) return false;
+
+		bool isFound = mArchive->GetAssignments(assingments, path, runMin, runMax, runRangeName, variation, beginTime, endTime, sortBy, take, startWith);
+		if(!isFound) CopyArchiveErrors();
+		return isFound;
+	}
+
 	//get table! 
 	ConstantsTypeTable *table = GetConstantsTypeTable(path, true);
 	if(!table)
@@ -1401,7 +1829,10 @@ void ccdb::SQLiteDataProvider::FetchAssignment(Assignment* assignment, Constants
 	assignment->SetModifiedTime(ReadUnixTime(2));	/*02  " UNIX_TIMESTAMP(`assignments`.`modified`) as `asModified`,	"*/
 	assignment->SetComment(ReadString(3));			/*03  " `assignments`.`comment) as `asComment`,	"					 */
 	assignment->SetDataVaultId(ReadIndex(4));		/*04  " `constantSets`.`id` AS `constId`, "							 */
-	assignment->SetRawData(ReadString(5));			/*05  " `constantSets`.`vault` AS `blob`, "							 */
+	const char* blob;
+	size_t blobLength;
+	ReadStringBuffer(5, blob, blobLength);
+	assignment->SetRawData(blob, blobLength);		/*05  " `constantSets`.`vault` AS `blob`, "							 */
 	
 	RunRange * runRange = new RunRange(assignment, this);	
 	runRange->SetId(ReadIndex(6));					/*06  " `runRanges`.`id`   AS `rrId`, "	*/
@@ -1495,57 +1926,70 @@ int ccdb::SQLiteDataProvider::ReadInt( int fieldNum )
 {	
 	if(IsNullOrUnreadable(fieldNum)) return 0;
 
-	return atoi((const char*)sqlite3_column_text(mStatement,fieldNum)); //ugly isn't it?
+	return sqlite3_column_int(mStatement,fieldNum);
 }
 
 unsigned int ccdb::SQLiteDataProvider::ReadUInt( int fieldNum )
 {	
 	if(IsNullOrUnreadable(fieldNum)) return 0;
 
-	return static_cast<unsigned int>(atoi((const char*)sqlite3_column_text(mStatement,fieldNum))); //ugly isn't it?
+	return static_cast<unsigned int>(sqlite3_column_int64(mStatement,fieldNum));
 }
 
 long ccdb::SQLiteDataProvider::ReadLong( int fieldNum )
 {
 	if(IsNullOrUnreadable(fieldNum)) return 0;
 
-	return atol((const char*)sqlite3_column_text(mStatement,fieldNum)); //ugly isn't it?
+	return static_cast<long>(sqlite3_column_int64(mStatement,fieldNum));
 }
 
 unsigned long ccdb::SQLiteDataProvider::ReadULong( int fieldNum )
 {
 	if(IsNullOrUnreadable(fieldNum)) return 0;
 
-	return static_cast<unsigned long>(atol((const char*)sqlite3_column_text(mStatement,fieldNum))); //ugly isn't it?
+	return static_cast<unsigned long>(sqlite3_column_int64(mStatement,fieldNum));
 }
 
 dbkey_t ccdb::SQLiteDataProvider::ReadIndex( int fieldNum )
 {
 	if(IsNullOrUnreadable(fieldNum)) return 0;
 
-	return static_cast<dbkey_t>(atol((const char*)sqlite3_column_text(mStatement,fieldNum))); //ugly isn't it?
+	return static_cast<dbkey_t>(sqlite3_column_int64(mStatement,fieldNum));
 }
 
 bool ccdb::SQLiteDataProvider::ReadBool( int fieldNum )
 {
 	if(IsNullOrUnreadable(fieldNum)) return false;
 
-	return static_cast<bool>(atoi((const char*)sqlite3_column_text(mStatement,fieldNum))!=0); //ugly isn't it?
+	return sqlite3_column_int(mStatement,fieldNum)!=0;
 }
 
 double ccdb::SQLiteDataProvider::ReadDouble( int fieldNum )
 {
 	if(IsNullOrUnreadable(fieldNum)) return 0;
 
-	return atof((const char*)sqlite3_column_text(mStatement,fieldNum)); //ugly isn't it?
+	return sqlite3_column_double(mStatement,fieldNum);
 }
 
 std::string ccdb::SQLiteDataProvider::ReadString( int fieldNum )
 {
-	if(IsNullOrUnreadable(fieldNum)) return string("");
+	const char* str;
+	size_t length;
+	ReadStringBuffer(fieldNum, str, length);
+	return string(str, length);
+}
+
+void ccdb::SQLiteDataProvider::ReadStringBuffer( int fieldNum, const char*& data, size_t& length )
+{
+	data = "";
+	length = 0;
+	if(IsNullOrUnreadable(fieldNum)) return;
+
+	//sqlite3_column_bytes must be called after sqlite3_column_text, see sqlite docs
 	const char* str = (const char*)sqlite3_column_text(mStatement,fieldNum);
-	if(!str)return string("");
-	return string(str);
+	if(!str) return;
+	data = str;
+	length = static_cast<size_t>(sqlite3_column_bytes(mStatement,fieldNum));
 }
 
 
@@ -0,0 +1,376 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <future>
+
+#include "CCDB/Providers/ShardedDataProvider.h"
+#include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Helpers/PathUtils.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+
+namespace
+{
+	/** Splits the line by spaces and tabs */
+	void SplitBlanks(const string& line, vector<string>& fields)
+	{
+		fields.clear();
+		size_t start = line.find_first_not_of(" \t");
+		while(start != string::npos)
+		{
+			size_t end = line.find_first_of(" \t", start);
+			fields.push_back(line.substr(start, end == string::npos ? string::npos : end - start));
+			start = line.find_first_not_of(" \t", end);
+		}
+	}
+
+	bool ParseRun(const string& str, int& value)
+	{
+		if(str == "inf")
+		{
+			value = INT_MAX;
+			return true;
+		}
+		if(str.empty()) return false;
+		char* end;
+		long long number = strtoll(str.c_str(), &end, 10);
+		value = (int)number;
+		return *end == '\0' && number >= 0 && number <= INT_MAX;
+	}
+
+	ccdb::Assignment* LookupShard(ccdb::SQLiteDataProvider* shard, int run, const string& path, time_t time, const string& variation, bool loadColumns)
+	{
+		shard->ClearErrors();
+		if(time > 0) return shard->GetAssignmentShort(run, path, time, variation, loadColumns);
+		return shard->GetAssignmentShort(run, path, variation, loadColumns);
+	}
+}
+
+#pragma region constructors
+
+ccdb::ShardedDataProvider::ShardedDataProvider(void)
+{
+	mIsCatalogLoaded = false;
+	mParallelLookups = 0;
+}
+
+
+ccdb::ShardedDataProvider::~ShardedDataProvider(void)
+{
+	if(IsConnected())
+	{
+		Disconnect();
+	}
+}
+#pragma endregion constructors
+
+#pragma region Connection
+
+bool ccdb::ShardedDataProvider::Connect( string connectionString )
+{
+	ClearErrors();
+
+	if(IsConnected())
+	{
+		Error(CCDB_ERROR_CONNECTION_ALREADY_OPENED, "ShardedDataProvider::Connect", "Connection already opened");
+		return false;
+	}
+
+	if(connectionString.find("shards://") != 0)
+	{
+		Error(CCDB_ERROR_PARSE_CONNECTION_STRING, "ShardedDataProvider::Connect", "Connection string should start with shards://");
+		return false;
+	}
+	string indexPath = connectionString.substr(9);
+
+	FILE* file = fopen(indexPath.c_str(), "rb");
+	if(!file)
+	{
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "ShardedDataProvider::Connect", "Can't open index file '" + indexPath + "'");
+		return false;
+	}
+	string index;
+	char chunk[64*1024];
+	size_t read;
+	while((read = fread(chunk, 1, sizeof(chunk), file)) > 0) index.append(chunk, read);
+	fclose(file);
+
+	size_t slashPos = indexPath.rfind('/');
+	string indexDirectory = slashPos == string::npos ? "." : indexPath.substr(0, slashPos);
+
+	mIsConnected = true;
+	if(!ReadIndex(index, indexDirectory))
+	{
+		Disconnect();
+		return false;
+	}
+
+	//every ccdb database has the default variation
+	AddVariation("default");
+	mConnectionString = connectionString;
+	return true;
+}
+
+
+void ccdb::ShardedDataProvider::Disconnect()
+{
+	if(!IsConnected()) return;
+
+	for(size_t i = 0; i < mShards.size(); i++) delete mShards[i].Provider;
+	mShards.clear();
+	ClearCatalog();
+	mIsCatalogLoaded = false;
+	mIsConnected = false;
+}
+
+
+bool ccdb::ShardedDataProvider::ReadIndex( const string& index, const string& indexDirectory )
+{
+	const char* thisFunc = "ShardedDataProvider::ReadIndex";
+
+	vector<string> fields;
+	size_t lineStart = 0;
+	int lineNumber = 0;
+	while(lineStart < index.size())
+	{
+		size_t lineEnd = index.find('\n', lineStart);
+		if(lineEnd == string::npos) lineEnd = index.size();
+		string line = index.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+		lineNumber++;
+
+		if(!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+		SplitBlanks(line, fields);
+		if(fields.empty() || fields[0][0] == '#') continue;
+
+		Shard shard;
+		shard.Provider = NULL;
+		bool isOk = fields[0] == "shard" && fields.size() == 5 && ParseRun(fields[2], shard.RunMin) && ParseRun(fields[3], shard.RunMax);
+		isOk = isOk && shard.RunMin <= shard.RunMax && !fields[4].empty() && fields[4][0] == '/';
+		if(!isOk)
+		{
+			Error(CCDB_ERROR_FILE_FORMAT, thisFunc, StringUtils::Format("Wrong record at line %i of the index", lineNumber));
+			return false;
+		}
+
+		const string& file = fields[1];
+		if(file.find("sqlite://") == 0)        shard.ConnectionString = file;
+		else if(file[0] == '/')                 shard.ConnectionString = "sqlite://" + file;
+		else                                    shard.ConnectionString = "sqlite://" + indexDirectory + "/" + file;
+
+		shard.PathPrefix = fields[4];
+		if(shard.PathPrefix.size() > 1 && shard.PathPrefix[shard.PathPrefix.size() - 1] == '/') shard.PathPrefix.erase(shard.PathPrefix.size() - 1);
+		mShards.push_back(shard);
+	}
+
+	if(mShards.empty())
+	{
+		Error(CCDB_ERROR_FILE_FORMAT, thisFunc, "The index has no shards");
+		return false;
+	}
+	return true;
+}
+
+
+bool ccdb::ShardedDataProvider::OpenShard( size_t shardIndex )
+{
+	Shard& shard = mShards[shardIndex];
+	if(shard.Provider) return true;
+
+	SQLiteDataProvider* provider = new SQLiteDataProvider();
+	if(!provider->Connect(shard.ConnectionString))
+	{
+		CopyShardErrors(provider);
+		delete provider;
+		Error(CCDB_ERROR_CONNECTION_EXTERNAL_ERROR, "ShardedDataProvider::OpenShard", "Can't open shard '" + shard.ConnectionString + "'");
+		return false;
+	}
+	shard.Provider = provider;
+	return true;
+}
+
+
+size_t ccdb::ShardedDataProvider::GetOpenedShardsCount() const
+{
+	size_t count = 0;
+	for(size_t i = 0; i < mShards.size(); i++) if(mShards[i].Provider) count++;
+	return count;
+}
+
+
+void ccdb::ShardedDataProvider::CopyShardErrors( SQLiteDataProvider* shard )
+{
+	//the shard has logged the messages already
+	const vector<int>& codes = shard->GetErrorCodes();
+	for(size_t i = 0; i < codes.size(); i++)
+	{
+		mErrorCodes.push_back(codes[i]);
+		mLastError = codes[i];
+	}
+}
+#pragma endregion Connection
+
+#pragma region Catalog
+
+bool ccdb::ShardedDataProvider::LoadCatalog()
+{
+	if(mIsCatalogLoaded) return true;
+
+	vector<ConstantsTypeTable*> tables;
+	for(size_t i = 0; i < mShards.size(); i++)
+	{
+		if(!OpenShard(i)) return false;
+		if(!mShards[i].Provider->SearchConstantsTypeTables(tables, "*", "", true))
+		{
+			CopyShardErrors(mShards[i].Provider);
+			return false;
+		}
+
+		for(size_t j = 0; j < tables.size(); j++)
+		{
+			//tables of other shards may be already in the catalog
+			ConstantsTypeTable* table = tables[j];
+			if(FindTable(table->GetFullPath()) < 0)
+			{
+				AddTable(table->GetFullPath(), table->GetColumnNames(), table->GetColumnTypeStrings(), table->GetRowsCount(), table->GetComment());
+			}
+			delete table;
+		}
+	}
+
+	mIsCatalogLoaded = true;
+	return true;
+}
+
+
+ccdb::Directory* ccdb::ShardedDataProvider::GetDirectory( const string& path )
+{
+	if(!IsConnected() || !LoadCatalog()) return NULL;
+	return CatalogDataProvider::GetDirectory(path);
+}
+
+
+bool ccdb::ShardedDataProvider::SearchDirectories( vector<Directory *>& resultDirectories, const string& searchPattern, const string& parentPath/*=""*/, int take/*=0*/, int startWith/*=0*/ )
+{
+	if(IsConnected() && !LoadCatalog()) return false;
+	return CatalogDataProvider::SearchDirectories(resultDirectories, searchPattern, parentPath, take, startWith);
+}
+
+
+bool ccdb::ShardedDataProvider::SearchConstantsTypeTables( vector<ConstantsTypeTable *>& typeTables, const string& pattern, const string& parentPath /*= ""*/, bool loadColumns/*=false*/, int take/*=0*/, int startWith/*=0 */ )
+{
+	if(IsConnected() && !LoadCatalog()) return false;
+	return CatalogDataProvider::SearchConstantsTypeTables(typeTables, pattern, parentPath, loadColumns, take, startWith);
+}
+
+
+ccdb::Variation* ccdb::ShardedDataProvider::GetVariation( const string& name )
+{
+	map<string, Variation*>::iterator it = mVariationsByName.find(name);
+	if(it != mVariationsByName.end()) return it->second;
+	if(!IsConnected()) return NULL;
+
+	//the first shard that has the variation tells its parent
+	for(size_t i = 0; i < mShards.size(); i++)
+	{
+		if(!OpenShard(i)) return NULL;
+		Variation* variation = mShards[i].Provider->GetVariation(name);
+		if(!variation || variation->GetName() != name) continue;   //SQLite gives an empty variation if not found
+
+		string parentName = variation->GetParent() ? variation->GetParent()->GetName() : "";
+		if(!parentName.empty() && !GetVariation(parentName)) return NULL;
+		return AddVariation(name, parentName);
+	}
+	return NULL;
+}
+#pragma endregion Catalog
+
+#pragma region Assignments
+
+void ccdb::ShardedDataProvider::FindShards( int run, const string& path, vector<size_t>& shardIndexes, bool& isPathKnown ) const
+{
+	shardIndexes.clear();
+	isPathKnown = false;
+	for(size_t i = 0; i < mShards.size(); i++)
+	{
+		//the prefix matches whole directories only
+		const string& prefix = mShards[i].PathPrefix;
+		bool isUnderPrefix = prefix == "/" || (path.compare(0, prefix.size(), prefix) == 0 && (path.size() == prefix.size() || path[prefix.size()] == '/'));
+		if(!isUnderPrefix) continue;
+
+		isPathKnown = true;
+		if(run >= mShards[i].RunMin && run <= mShards[i].RunMax) shardIndexes.push_back(i);
+	}
+}
+
+
+ccdb::Assignment* ccdb::ShardedDataProvider::GetAssignmentShort( int run, const string& path, time_t time, const string& variation/*="default"*/, bool loadColumns/*=false*/ )
+{
+	const char* thisFunc = "ShardedDataProvider::GetAssignmentShort";
+	if(!CheckConnection(thisFunc)) return NULL;
+
+	string fullPath(path);
+	PathUtils::MakeAbsolute(fullPath);
+
+	vector<size_t> candidates;
+	bool isPathKnown;
+	FindShards(run, fullPath, candidates, isPathKnown);
+	if(!isPathKnown)
+	{
+		Error(CCDB_ERROR_NO_TYPETABLE, thisFunc, "No shard has tables under '" + fullPath + "'");
+		return NULL;
+	}
+	for(size_t i = 0; i < candidates.size(); i++) if(!OpenShard(candidates[i])) return NULL;
+	if(candidates.empty()) return NULL;                         //No shard has the run. It is not an error, as no constants
+
+	//Shards are separate connections, so they are queried at the same time. This thread takes the first one
+	vector<Assignment*> results(candidates.size(), NULL);
+	if(candidates.size() > 1)
+	{
+		mParallelLookups++;
+		vector< future<Assignment*> > futures;
+		for(size_t i = 1; i < candidates.size(); i++)
+		{
+			SQLiteDataProvider* shard = mShards[candidates[i]].Provider;
+			futures.push_back(async(launch::async, [=, &fullPath, &variation]() { return LookupShard(shard, run, fullPath, time, variation, loadColumns); }));
+		}
+		results[0] = LookupShard(mShards[candidates[0]].Provider, run, fullPath, time, variation, loadColumns);
+		for(size_t i = 1; i < candidates.size(); i++) results[i] = futures[i - 1].get();
+	}
+	else
+	{
+		results[0] = LookupShard(mShards[candidates[0]].Provider, run, fullPath, time, variation, loadColumns);
+	}
+
+	//the newest assignment wins, as one database would give it. Errors count only if no shard could answer
+	Assignment* result = NULL;
+	bool isAnswered = false;
+	for(size_t i = 0; i < candidates.size(); i++)
+	{
+		if(results[i] || mShards[candidates[i]].Provider->GetNErrors() == 0) isAnswered = true;
+		if(!results[i]) continue;
+
+		if(!result)
+		{
+			result = results[i];
+		}
+		else if(results[i]->GetCreatedTime() > result->GetCreatedTime() ||
+			(results[i]->GetCreatedTime() == result->GetCreatedTime() && results[i]->GetId() > result->GetId()))
+		{
+			delete result;
+			result = results[i];
+		}
+		else
+		{
+			delete results[i];
+		}
+	}
+
+	if(!isAnswered)
+	{
+		for(size_t i = 0; i < candidates.size(); i++) CopyShardErrors(mShards[candidates[i]].Provider);
+	}
+	return result;
+}
+#pragma endregion Assignments
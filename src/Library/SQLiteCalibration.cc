@@ -93,6 +93,34 @@ bool SQLiteCalibration::Connect( std::string connectionString )
     }
 
     bool result = mProvider->Connect(connectionString);
+
+    //Read connections for parallel GetAssignment. They are opened when threads need them
+    //Their number may be set by ?pool= option
+    if(result)
+    {
+        SQLiteConnectionInfo connection;
+        SQLiteDataProvider::ParseConnectionString(connectionString, connection);
+        size_t poolSize = connection.PoolSize > 0 ? connection.PoolSize : 0;
+
+        //The database is loaded to memory once, read connections open the same copy
+        string poolConnectionString = connectionString;
+        SQLiteDataProvider* sqliteProvider = dynamic_cast<SQLiteDataProvider*>(mProvider);
+        if(sqliteProvider && !sqliteProvider->GetMemoryName().empty())
+        {
+            poolConnectionString += (poolConnectionString.find('?') == string::npos) ? "?" : "&";
+            poolConnectionString += "shared_memory=" + sqliteProvider->GetMemoryName();
+        }
+
+        if(mReadPool == NULL)
+        {
+            mReadPool = new DataProviderPool(poolConnectionString, [](){ return new SQLiteDataProvider(); }, poolSize);
+        }
+        else
+        {
+            mReadPool->SetConnectionString(poolConnectionString);
+            mReadPool->SetMaxSize(poolSize);
+        }
+    }
     Unlock();
     return result;
     //TODO decide maybe to throw an exception here?
@@ -116,7 +144,9 @@ void SQLiteCalibration::Disconnect()
         throw std::logic_error(ERRMSG_CONNECT_LOCKED); //TODO ERRMSG_DISCONECT_LOCKED
     }
 
+    WaitForRefreshes();
     mProvider->Disconnect();
+    if(mReadPool) mReadPool->Disconnect();
 }
 
 
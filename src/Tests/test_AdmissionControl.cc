@@ -0,0 +1,82 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "CCDB/Helpers/AdmissionControl.h"
+#include "CCDB/Helpers/StopWatch.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* **
+ * @brief Test of client side limits of requests
+ */
+TEST_CASE("CCDB/AdmissionControl","Token bucket and in flight cap tests")
+{
+	//burst goes at once, then requests go with the rate
+	AdmissionControl bucket(200, 4, 0);
+	for(int i = 0; i < 4; i++) REQUIRE(bucket.TryAcquireToken());
+	REQUIRE_FALSE(bucket.TryAcquireToken());
+
+	StopWatch watch;
+	for(int i = 0; i < 10; i++) bucket.AcquireToken();
+	REQUIRE(watch.ElapsedMs() >= 40);
+
+	//no rate - no waiting
+	AdmissionControl unlimited(0, 1, 0);
+	int taken = 0;
+	for(int i = 0; i < 1000; i++) taken += unlimited.TryAcquireToken() ? 1 : 0;
+	REQUIRE(taken == 1000);
+
+	//not more than 2 requests in flight
+	AdmissionControl inFlight(0, 1, 2);
+	atomic<int> current(0);
+	atomic<int> maximum(0);
+	vector<thread> threads;
+	for(int i = 0; i < 6; i++)
+	{
+		threads.push_back(thread([&]()
+		{
+			AdmissionControl::Ticket ticket(&inFlight);
+			int now = ++current;
+			int seen = maximum.load();
+			while(now > seen && !maximum.compare_exchange_weak(seen, now));
+			this_thread::sleep_for(chrono::milliseconds(20));
+			--current;
+		}));
+	}
+	for(size_t i = 0; i < threads.size(); i++) threads[i].join();
+	REQUIRE(maximum.load() <= 2);
+	REQUIRE(maximum.load() >= 1);
+	REQUIRE(inFlight.GetInFlight() == 0);
+
+	//null controller does nothing
+	{
+		AdmissionControl::Ticket ticket(NULL);
+	}
+
+	//jitter and backoff stay in their limits
+	REQUIRE(AdmissionControl::RandomMilliseconds(0) == 0);
+	for(unsigned attempt = 0; attempt < 40; attempt++)
+	{
+		unsigned limit = attempt < 10 ? 100u << attempt : 10000u;
+		if(limit > 10000) limit = 10000;
+		REQUIRE(AdmissionControl::GetBackoffMilliseconds(attempt, 100, 10000) <= limit);
+		REQUIRE(AdmissionControl::RandomMilliseconds(50) <= 50);
+	}
+
+	//controllers are shared by host and limits, other limits get their own controller
+	AdmissionControl* host = AdmissionControl::GetForHost("test_admission_host:3306", 100, 10, 4);
+	REQUIRE(AdmissionControl::GetForHost("test_admission_host:3306", 100, 10, 4) == host);
+	AdmissionControl* otherLimits = AdmissionControl::GetForHost("test_admission_host:3306", 5, 1, 1);
+	REQUIRE(otherLimits != host);
+	REQUIRE(host->GetRate() == 100);
+	REQUIRE(host->GetMaxInFlight() == 4);
+	REQUIRE(otherLimits->GetRate() == 5);
+	REQUIRE(otherLimits->GetMaxInFlight() == 1);
+	REQUIRE(AdmissionControl::GetForHost("other_admission_host:3306", 5, 1, 1) != otherLimits);
+}
@@ -0,0 +1,94 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "CCDB/Providers/ArchiveSplitter.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* **
+ * @brief Test of splitting the database to the hot file and the archive
+ */
+TEST_CASE("CCDB/ArchiveSplitter","Hot database and archive tests")
+{
+	{
+		SQLiteDataProvider source;
+		if(!source.Connect(TESTS_SQLITE_STRING)) return;
+	}
+
+	string source = string(getenv("CCDB_HOME")) + "/sql/ccdb.sqlite";
+	string hotPath = "test_ccdb_lib_hot.sqlite";
+	string archivePath = "test_ccdb_lib_archive.sqlite";
+	time_t before = 1346000000;  //between the first and the latest default constants of test_table
+
+	//all runs. The first default assignment of test_table is covered by the latest one
+	ArchiveSplitter splitter;
+	splitter.Split(source, hotPath, archivePath);
+	REQUIRE(splitter.GetAssignmentsCount() == 5);
+	REQUIRE(splitter.GetMovedAssignmentsCount() == 1);
+	REQUIRE(splitter.GetMovedConstantSetsCount() <= 1);
+	REQUIRE_THROWS(splitter.Split(source, source, archivePath));
+
+	//without archive the hot file has no history
+	SQLiteDataProvider hot;
+	REQUIRE(hot.Connect("sqlite://" + hotPath));
+	Assignment* assignment = hot.GetAssignmentShort(100, "/test/test_vars/test_table", "default");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 4);
+	REQUIRE(hot.GetAssignmentShort(100, "/test/test_vars/test_table", before, "default") == NULL);
+	hot.Disconnect();
+
+	//with archive the history is back
+	REQUIRE(hot.Connect("sqlite://" + hotPath + "?archive=" + archivePath));
+	assignment = hot.GetAssignmentShort(600, "/test/test_vars/test_table", "test");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 2);
+	assignment = hot.GetAssignmentShort(100, "/test/test_vars/test_table", before, "default");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 1);
+
+	//lists and versions are history too
+	vector<Assignment*> assignments;
+	REQUIRE(hot.GetAssignments(assignments, "/test/test_vars/test_table", 100, "default"));
+	REQUIRE(assignments.size() == 2);
+	REQUIRE(hot.GetAssignmentFull(100, "/test/test_vars/test_table", 1, "default") != NULL);
+	hot.Disconnect();
+
+	//relative archive is next to the hot database
+	SQLiteConnectionInfo connection;
+	SQLiteDataProvider::ParseConnectionString("sqlite:///data/hot.sqlite?archive=archive.sqlite", connection);
+	REQUIRE(connection.ArchivePath == "/data/archive.sqlite");
+	SQLiteDataProvider::ParseConnectionString("sqlite://hot.sqlite?archive=archive.sqlite", connection);
+	REQUIRE(connection.ArchivePath == "archive.sqlite");
+
+	//runs outside the window go to the archive, so variation test is not replaced by default there
+	splitter.SetRunWindow(0, 400);
+	splitter.Split(source, hotPath, archivePath);
+	REQUIRE(splitter.GetMovedAssignmentsCount() == 2);
+	REQUIRE_THROWS(splitter.SetRunWindow(10, 1));
+
+	REQUIRE(hot.Connect("sqlite://" + hotPath + "?archive=" + archivePath));
+	assignment = hot.GetAssignmentShort(100, "/test/test_vars/test_table", "test");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 4);
+	assignment = hot.GetAssignmentShort(600, "/test/test_vars/test_table", "test");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 2);
+	hot.Disconnect();
+
+	//archive that can't be opened is an error of the query, not of the connection
+	REQUIRE(hot.Connect("sqlite://" + hotPath + "?archive=test_ccdb_lib_no_such_archive.sqlite"));
+	REQUIRE(hot.GetAssignmentShort(100, "/test/test_vars/test_table", "default") != NULL);
+	REQUIRE(hot.GetAssignmentShort(600, "/test/test_vars/test_table", "test") == NULL);
+	REQUIRE(hot.GetLastError() == CCDB_ERROR_CONNECTION_EXTERNAL_ERROR);
+	hot.Disconnect();
+
+	remove(hotPath.c_str());
+	remove(archivePath.c_str());
+}
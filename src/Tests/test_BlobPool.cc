@@ -0,0 +1,61 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <memory>
+
+#include "CCDB/Helpers/BlobPool.h"
+#include "CCDB/Model/Assignment.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* **
+ * @brief Test of decoded blobs shared by content
+ */
+TEST_CASE("CCDB/BlobPool","Blob deduplication tests")
+{
+	BlobPool& pool = BlobPool::Instance();
+	size_t blobsCount = pool.GetBlobsCount();
+
+	REQUIRE(BlobPool::Hash("1|2|3", 5) == BlobPool::Hash("1|2|3", 5));
+	REQUIRE(BlobPool::Hash("1|2|3", 5) != BlobPool::Hash("1|2|4", 5));
+	REQUIRE(BlobPool::Empty()->Cells.empty());
+
+	//assignments with identical blobs share the decoded cells
+	string blob = "blob_pool_test|1.5|2.5|3&delimiter;4";
+	unique_ptr<Assignment> first(new Assignment());
+	unique_ptr<Assignment> second(new Assignment());
+	unique_ptr<Assignment> other(new Assignment());
+	first->SetRawData(blob);
+	size_t sharedCount = pool.GetSharedCount();
+	second->SetRawData(blob.data(), blob.size());
+	other->SetRawData(blob + "|5");
+
+	REQUIRE(first->GetDecodedBlob() == second->GetDecodedBlob());
+	REQUIRE(first->GetDecodedBlob() != other->GetDecodedBlob());
+	REQUIRE(pool.GetSharedCount() == sharedCount + 1);
+	REQUIRE(pool.GetBlobsCount() == blobsCount + 2);
+	REQUIRE(second->GetCellsCount() == 4);
+	REQUIRE(second->GetVectorData()[3] == "3|4");
+	REQUIRE(other->GetCellsCount() == 5);
+
+	//already decoded cells are shared too
+	unique_ptr<Assignment> decoded(new Assignment());
+	vector<string> cells = first->GetVectorData();
+	decoded->SetRawData(blob, std::move(cells));
+	REQUIRE(decoded->GetDecodedBlob() == first->GetDecodedBlob());
+
+	//a new blob is not changed by other assignments
+	second->SetRawData(string("7|8"));
+	REQUIRE(first->GetCellsCount() == 4);
+	REQUIRE(second->GetCellsCount() == 2);
+
+	//blobs leave the pool with their last assignment
+	first.reset();
+	decoded.reset();
+	other.reset();
+	second.reset();
+	REQUIRE(pool.GetBlobsCount() == blobsCount);
+	REQUIRE_FALSE(pool.Find(blob.data(), blob.size(), BlobPool::Hash(blob.data(), blob.size())));
+}
@@ -0,0 +1,137 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <stdio.h>
+
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/CachingDataProvider.h"
+#include "CCDB/Helpers/TimeProvider.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* **
+ * @brief Test of the provider that caches constants in memory and in a local file
+ */
+TEST_CASE("CCDB/CachingDataProvider","Caching provider tests")
+{
+	{
+		SQLiteDataProvider source;
+		if(!source.Connect(TESTS_SQLITE_STRING)) return;
+	}
+
+	string cachePath = "test_ccdb_lib_cache.sqlite";
+	remove(cachePath.c_str());
+	string connectionString = string("cache://") + TESTS_SQLITE_STRING;
+
+	//FIRST JOB: constants come from the remote
+	//----------------------------------------------------
+	{
+		CachingDataProvider prov(cachePath);
+		REQUIRE(prov.Connect(connectionString));
+		REQUIRE_FALSE(prov.IsRemoteConnected());
+
+		Assignment* assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "default", true);
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		REQUIRE(assignment->GetTypeTable()->GetColumns().size() == 3);
+		REQUIRE(prov.GetRemoteFetches() == 1);
+		REQUIRE(prov.IsRemoteConnected());
+
+		//the second request is served from memory
+		assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "default", true);
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		vector<vector<string> > values = assignment->GetData();
+		REQUIRE(values.size() == 2);
+		REQUIRE(values[1][2] == "2.7");
+		REQUIRE(prov.GetMemoryHits() == 1);
+		REQUIRE(prov.GetRemoteFetches() == 1);
+
+		//other runs of the run range are served from memory too
+		assignment = prov.GetAssignmentShort(200, "/test/test_vars/test_table", "default");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		REQUIRE(prov.GetMemoryHits() == 2);
+		REQUIRE(prov.GetRemoteFetches() == 1);
+
+		assignment = prov.GetAssignmentFull(600, "/test/test_vars/test_table", "test");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 2);
+		REQUIRE(assignment->GetRunRange() != NULL);
+		REQUIRE(assignment->GetRunRange()->GetMax() == 3000);
+
+		//the assignment of the parent variation is not given for runs the variation has its own one
+		assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "test");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		assignment = prov.GetAssignmentShort(600, "/test/test_vars/test_table", "test");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 2);
+		assignment = prov.GetAssignmentShort(499, "/test/test_vars/test_table", "test");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		REQUIRE(prov.GetRemoteFetches() == 4);
+		assignment = prov.GetAssignmentShort(3001, "/test/test_vars/test_table", "test");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		REQUIRE(prov.GetRemoteFetches() == 5);
+
+		//not found is not cached and not an error
+		REQUIRE(prov.GetAssignmentShort(100, "/test/test_vars/test_table2", "default") == NULL);
+		REQUIRE(prov.GetAssignmentShort(100, "/test/test_vars/no_such_table", "default") == NULL);
+		REQUIRE(prov.GetLastError() == CCDB_ERROR_NO_TYPETABLE);
+
+		//not cached requests go to the remote
+		REQUIRE(prov.GetVariation("subtest") != NULL);
+		vector<Assignment*> assignments;
+		REQUIRE(prov.GetAssignments(assignments, "/test/test_vars/test_table", 0, 0, "", "", 0, 0));
+		REQUIRE(assignments.size() == 4);
+	}
+
+	//SECOND JOB: constants come from the cache file, the remote is not touched
+	//----------------------------------------------------
+	{
+		CachingDataProvider prov(cachePath);
+		REQUIRE(prov.Connect(connectionString));
+
+		Assignment* assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "default", true);
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		REQUIRE(assignment->GetRawData() == "2.2|2.3|2.4|2.5|2.6|2.7");
+		REQUIRE(assignment->GetTypeTable()->GetColumns().size() == 3);
+
+		assignment = prov.GetAssignmentFull(600, "/test/test_vars/test_table", "test");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetRunRange()->GetMin() == 500);
+		REQUIRE(assignment->GetVariation()->GetName() == "test");
+
+		ConstantsTypeTable* table = prov.GetConstantsTypeTable("/test/test_vars/test_table", true);
+		REQUIRE(table != NULL);
+		REQUIRE(table->GetRowsCount() == 2);
+
+		REQUIRE(prov.GetFileHits() == 2);
+		REQUIRE(prov.GetRemoteFetches() == 0);
+		REQUIRE_FALSE(prov.IsRemoteConnected());
+
+		//expired latest constants are fetched again
+		prov.SetMaxAge(60);
+		time_t later = TimeProvider::GetUnixTimeStamp(ClockSources::Realtime) + 100;
+		TimeProvider::SetUnitTestTime(later);
+		TimeProvider::SetTimeUnitTest(true);
+		assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "default");
+		TimeProvider::SetTimeUnitTest(false);
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		REQUIRE(prov.GetRemoteFetches() == 1);
+		REQUIRE(prov.IsRemoteConnected());
+	}
+
+	REQUIRE_FALSE(CachingDataProvider(cachePath).Connect("cache://nosuchdb://"));
+
+	remove(cachePath.c_str());
+	remove((cachePath + "-wal").c_str());
+	remove((cachePath + "-shm").c_str());
+}
@@ -0,0 +1,147 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <thread>
+#include <string.h>
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/DaemonServer.h"
+#include "CCDB/Providers/DaemonDataProvider.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* **
+ * @brief Test of the node daemon and the provider that reads from it
+ */
+TEST_CASE("CCDB/DaemonDataProvider","Daemon provider tests")
+{
+	SQLiteDataProvider upstream;
+	if(!upstream.Connect(TESTS_SQLITE_STRING)) return;
+
+	string socketPath = "test_ccdb_lib_daemon.socket";
+	DaemonServer server(&upstream);
+	server.SetMaxCacheBytes(1);        //only the last result is kept
+	REQUIRE_NOTHROW(server.Listen(socketPath));
+	std::thread serverThread(&DaemonServer::Run, &server);
+
+	string connectionString = "ccdbd://" + socketPath;
+
+	//Catalog and single requests
+	//----------------------------------------------------
+	{
+		DaemonDataProvider prov;
+		REQUIRE(prov.Connect(connectionString));
+		REQUIRE(prov.GetConnectionString() == connectionString);
+
+		ConstantsTypeTable* table = prov.GetConstantsTypeTable("/test/test_vars/test_table", true);
+		REQUIRE(table != NULL);
+		REQUIRE(table->GetColumns().size() == 3);
+
+		Assignment* assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "default", true);
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		vector<vector<string> > values = assignment->GetData();
+		REQUIRE(values.size() == 2);
+		REQUIRE(values[1][2] == "2.7");
+
+		//the same request again is served from the cache of the daemon
+		size_t upstreamRequests = server.GetUpstreamRequests();
+		assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "default");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		REQUIRE(server.GetUpstreamRequests() == upstreamRequests);
+
+		//as are other runs of the run range
+		assignment = prov.GetAssignmentShort(200, "/test/test_vars/test_table", "default");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		REQUIRE(server.GetUpstreamRequests() == upstreamRequests);
+
+		//variation and its parents are taken from the daemon
+		assignment = prov.GetAssignmentShort(600, "/test/test_vars/test_table", "test");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 2);
+		assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "test");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		REQUIRE(prov.GetVariation("test")->GetParent()->GetName() == "default");
+
+		//unknown table is an error, unknown variation is not
+		prov.ClearErrors();
+		REQUIRE(prov.GetAssignmentShort(100, "/test/test_vars/no_such_table", "default") == NULL);
+		REQUIRE(prov.GetLastError() == CCDB_ERROR_NO_TYPETABLE);
+	}
+
+	//Batch requests
+	//----------------------------------------------------
+	{
+		DaemonDataProvider prov;
+		REQUIRE(prov.Connect(connectionString));
+
+		vector<DaemonProtocol::ConstantsRequest> requests(3);
+		requests[0].Run = 100;
+		requests[0].Time = 0;
+		requests[0].Path = "/test/test_vars/test_table";
+		requests[0].Variation = "subtest";
+		requests[1].Run = 100;
+		requests[1].Time = 0;
+		requests[1].Path = "/test/test_vars/test_table2";
+		requests[1].Variation = "test";
+		requests[2].Run = 100;
+		requests[2].Time = 0;
+		requests[2].Path = "/test/test_vars/no_such_table";
+		requests[2].Variation = "default";
+
+		vector<Assignment*> assignments;
+		REQUIRE(prov.GetAssignmentsBatch(requests, assignments));
+		REQUIRE(assignments.size() == 3);
+		REQUIRE(assignments[0] != NULL);
+		REQUIRE(assignments[0]->GetId() == 5);
+		REQUIRE(assignments[1] != NULL);
+		REQUIRE(assignments[1]->GetRawData() == "10|20|30");
+		REQUIRE(assignments[2] == NULL);
+		REQUIRE(server.GetClientsCount() == 1);
+		REQUIRE(server.GetCacheSize() == 1);
+	}
+
+#ifndef WIN32
+	//A client that sends half a frame stalls only itself
+	//----------------------------------------------------
+	{
+		sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		strcpy(address.sun_path, socketPath.c_str());
+		int stalled = socket(AF_UNIX, SOCK_STREAM, 0);
+		REQUIRE(connect(stalled, (sockaddr*)&address, sizeof(address)) == 0);
+		uint32_t length = 100;
+		REQUIRE(send(stalled, &length, 2, 0) == 2);
+
+		DaemonDataProvider prov;
+		REQUIRE(prov.Connect(connectionString));
+		Assignment* assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "default");
+		REQUIRE(assignment != NULL);
+		REQUIRE(assignment->GetId() == 4);
+		close(stalled);
+	}
+#endif
+
+	//A daemon that is not running
+	//----------------------------------------------------
+	{
+		DaemonDataProvider prov;
+		REQUIRE_FALSE(prov.Connect("ccdbd://test_ccdb_lib_no_daemon.socket"));
+		REQUIRE(prov.GetLastError() == CCDB_ERROR_CONNECTION_EXTERNAL_ERROR);
+	}
+
+	server.Stop();
+	serverThread.join();
+}
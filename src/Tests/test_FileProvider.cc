@@ -0,0 +1,117 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <stdio.h>
+#include <memory>
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/FileDataProvider.h"
+#include "CCDB/Providers/FileDataWriter.h"
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* ** 
+ * @brief Test of writing and reading directories of table files
+ */
+TEST_CASE("CCDB/FileDataProvider","File writer and provider tests")
+{
+	SQLiteDataProvider source;
+	if(!source.Connect(TESTS_SQLITE_STRING)) return;
+
+	string dirPath = "test_ccdb_lib_files";
+
+	//WRITE
+	//----------------------------------------------------
+	{
+		FileDataWriter writer(&source);
+		writer.AddTable("/test/test_vars/test_table");
+		writer.AddTable("/test/test_vars/test_table2");
+		REQUIRE_NOTHROW(writer.Write(dirPath));
+
+		//test_table: default 0-inf, test 500-3000, subtest 0-inf. test_table2: test 0-inf
+		REQUIRE(writer.GetTablesCount() == 2);
+		REQUIRE(writer.GetIntervalsCount() == 4);
+		REQUIRE_THROWS(writer.AddTable("/test/test_vars/no_such_table"));
+	}
+
+	//READ
+	//----------------------------------------------------
+	FileDataProvider files;
+	REQUIRE(files.Connect("file://" + dirPath));
+
+	//catalog
+	ConstantsTypeTable* table = files.GetConstantsTypeTable("/test/test_vars/test_table", true);
+	REQUIRE(table != NULL);
+	REQUIRE(table->GetColumns().size() == 3);
+	REQUIRE(table->GetRowsCount() == 2);
+	REQUIRE(files.GetVariation("subtest") != NULL);
+	REQUIRE(files.GetVariation("subtest")->GetParent() == files.GetVariation("test"));
+
+	//the latest of default assignments
+	Assignment* assignment = files.GetAssignmentFull(100, "/test/test_vars/test_table");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 4);
+	REQUIRE(assignment->GetTypeTable()->GetColumns().size() == 3);
+	vector<vector<string> > values = assignment->GetData();
+	REQUIRE(values.size() == 2);
+	REQUIRE(values[0][0] == "2.2");
+	REQUIRE(values[1][2] == "2.7");
+
+	//variation has own constants for the run
+	assignment = files.GetAssignmentShort(600, "/test/test_vars/test_table", "test");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 2);
+	REQUIRE(assignment->GetRawData() == "1.0|2.0|3.0|4.0|5.0|6.0");
+
+	//variation has no constants for the run, the parent one is taken
+	assignment = files.GetAssignmentShort(100, "/test/test_vars/test_table", "test");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 4);
+
+	assignment = files.GetAssignmentShort(600, "/test/test_vars/test_table", "subtest");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 5);
+
+	//no constants is not an error
+	REQUIRE(files.GetAssignmentShort(100, "/test/test_vars/test_table2", "default") == NULL);
+	REQUIRE(files.GetNErrors() == 0);
+
+	REQUIRE(files.GetAssignmentShort(100, "/test/test_vars/test_table", "no_such_variation") == NULL);
+	REQUIRE(files.GetLastError() == CCDB_ERROR_VARIATION_INVALID);
+
+	//only the latest constants are kept
+	REQUIRE(files.GetAssignmentShort(100, "/test/test_vars/test_table", 1000, "default") == NULL);
+	REQUIRE(files.GetLastError() == CCDB_ERROR_NO_ASSIGMENT);
+
+	files.Disconnect();
+
+	//USER API
+	//----------------------------------------------------
+	{
+		unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration("file://" + dirPath, 100, "test"));
+		vector<vector<double> > doubles;
+		REQUIRE(calib->GetCalib(doubles, "/test/test_vars/test_table2"));
+		REQUIRE(doubles.size() == 1);
+		REQUIRE(doubles[0][2] == 30.0);
+	}
+
+	//not a directory of table files
+	REQUIRE_FALSE(files.Connect("file://" + dirPath + "/test"));
+	REQUIRE(files.GetLastError() == CCDB_ERROR_CONNECTION_EXTERNAL_ERROR);
+
+	remove((dirPath + "/ccdb.index").c_str());
+	remove((dirPath + "/test/test_vars/test_table.ccdb").c_str());
+	remove((dirPath + "/test/test_vars/test_table2.ccdb").c_str());
+#ifndef WIN32
+	rmdir((dirPath + "/test/test_vars").c_str());
+	rmdir((dirPath + "/test").c_str());
+	rmdir(dirPath.c_str());
+#endif
+}
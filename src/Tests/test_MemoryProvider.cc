@@ -0,0 +1,121 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <memory>
+
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/MemoryDataProvider.h"
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* **
+ * @brief Test of the provider that keeps constants in memory
+ */
+TEST_CASE("CCDB/MemoryDataProvider","Memory provider tests")
+{
+	{
+		SQLiteDataProvider source;
+		if(!source.Connect(TESTS_SQLITE_STRING)) return;
+	}
+
+	MemoryDataProvider prov;
+	REQUIRE(prov.Connect(string("memory://") + TESTS_SQLITE_STRING));
+	REQUIRE(prov.GetLoadedTablesCount() > 0);
+
+	//catalog
+	REQUIRE(prov.GetDirectory("/test/test_vars") != NULL);
+	ConstantsTypeTable* table = prov.GetConstantsTypeTable("/test/test_vars/test_table", true);
+	REQUIRE(table != NULL);
+	REQUIRE(table->GetColumns().size() == 3);
+	REQUIRE(prov.GetVariation("subtest") != NULL);
+	REQUIRE(prov.GetVariation("subtest")->GetParent() == prov.GetVariation("test"));
+
+	//the latest of default assignments
+	Assignment* assignment = prov.GetAssignmentFull(100, "/test/test_vars/test_table");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 4);
+	REQUIRE(assignment->GetRunRange() != NULL);
+	REQUIRE(assignment->GetRunRange()->GetName() == "all");
+	REQUIRE(assignment->GetVariation()->GetName() == "default");
+	vector<vector<string> > values = assignment->GetData();
+	REQUIRE(values.size() == 2);
+	REQUIRE(values[1][2] == "2.7");
+
+	//variation has own constants for the run, or the parent one is taken
+	assignment = prov.GetAssignmentShort(600, "/test/test_vars/test_table", "test");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 2);
+	assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "test");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 4);
+	assignment = prov.GetAssignmentShort(600, "/test/test_vars/test_table", "subtest");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 5);
+
+	//no constants is not an error
+	REQUIRE(prov.GetAssignmentShort(100, "/test/test_vars/test_table2", "default") == NULL);
+	REQUIRE(prov.GetNErrors() == 0);
+	REQUIRE(prov.GetAssignmentShort(100, "/test/test_vars/test_table", "no_such_variation") == NULL);
+	REQUIRE(prov.GetLastError() == CCDB_ERROR_VARIATION_INVALID);
+
+	//history
+	vector<Assignment*> assignments;
+	REQUIRE(prov.GetAssignments(assignments, "/test/test_vars/test_table", 0, 0, "", "", 0, 0));
+	REQUIRE(assignments.size() == 4);
+	REQUIRE(assignments[0]->GetId() == 5);   //the latest first
+	REQUIRE(assignments[3]->GetId() == 1);
+	time_t firstCreated = assignments[3]->GetCreatedTime();
+
+	REQUIRE(prov.GetAssignments(assignments, "/test/test_vars/test_table", 0, 0, "", "default", 0, 0));
+	REQUIRE(assignments.size() == 2);
+	REQUIRE(prov.GetAssignments(assignments, "/test/test_vars/test_table", 0, 0, "test", "", 0, 0));
+	REQUIRE(assignments.size() == 1);
+	REQUIRE(assignments[0]->GetId() == 2);
+
+	//constants at time are the same as in the database
+	assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", firstCreated + 100, "default");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 1);
+	assignment = prov.GetAssignmentFull(100, "/test/test_vars/test_table", 0, "default");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 1);
+
+	//run ranges
+	vector<RunRange*> runRanges;
+	REQUIRE(prov.GetRunRanges(runRanges, table));
+	REQUIRE(runRanges.size() == 2);
+	REQUIRE(prov.GetRunRange(500, 3000, "test") != NULL);
+	REQUIRE(prov.GetRunRange("all") != NULL);
+
+	prov.Disconnect();
+	REQUIRE_FALSE(prov.IsConnected());
+
+	//LAZY LOADING
+	//----------------------------------------------------
+	MemoryDataProvider lazy(true);
+	REQUIRE(lazy.Connect(string("memory://") + TESTS_SQLITE_STRING));
+	REQUIRE(lazy.GetLoadedTablesCount() == 0);
+	assignment = lazy.GetAssignmentShort(100, "/test/test_vars/test_table2", "subtest");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 3);
+	REQUIRE(assignment->GetRawData() == "10|20|30");
+	REQUIRE(lazy.GetLoadedTablesCount() == 1);
+	lazy.Disconnect();
+
+	//USER API
+	//----------------------------------------------------
+	{
+		unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(string("memory://") + TESTS_SQLITE_STRING, 100, "test"));
+		vector<vector<double> > doubles;
+		REQUIRE(calib->GetCalib(doubles, "/test/test_vars/test_table2"));
+		REQUIRE(doubles.size() == 1);
+		REQUIRE(doubles[0][2] == 30.0);
+	}
+
+	REQUIRE_FALSE(prov.Connect("memory://nosuchdb://"));
+	REQUIRE(prov.GetLastError() == CCDB_ERROR_PARSE_CONNECTION_STRING);
+}
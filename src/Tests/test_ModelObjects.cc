@@ -49,4 +49,31 @@ TEST_CASE("CCDB/ModelObjects","ModelObjects tests")
 
 	//TODO more complicated tests with a - benchmark, b - check for memory management
 };
+
+
+TEST_CASE("CCDB/ModelObjects/Assignment/RawData","Assignment takes blob from a buffer")
+{
+	//The buffer is not null terminated and is not used after SetRawData
+	char buffer[] = {'1','|','2','|','a','&','d','e','l','i','m','i','t','e','r',';','b','|','X'};
+	Assignment assignment;
+	assignment.SetRawData(buffer, sizeof(buffer) - 2);
+	buffer[0] = '9';
+
+	REQUIRE(assignment.GetRawData() == "1|2|a&delimiter;b");
+	vector<string> values = assignment.GetVectorData();
+	REQUIRE(values.size() == 3);
+	REQUIRE(values[0] == "1");
+	REQUIRE(values[2] == "a|b");
+
+	assignment.SetRawData(string("10|20"));
+	REQUIRE(assignment.GetVectorData().size() == 2);
+
+	assignment.SetRawData(NULL, 0);
+	REQUIRE(assignment.GetVectorData().empty());
+
+	//data of shared assignments is not changed under the readers
+	assignment.SetDataReadOnly();
+	REQUIRE_THROWS(assignment.SetRawData(string("30|40")));
+	REQUIRE(assignment.GetVectorData().empty());
+}
 #endif
@@ -2,6 +2,8 @@
 #include "Tests/catch.hpp"
 #include "Tests/tests.h"
 #include <memory>
+#include <thread>
+#include <atomic>
 
 #include "CCDB/Console.h"
 #include "CCDB/SQLiteCalibration.h"
@@ -178,6 +180,144 @@ TEST_CASE("CCDB/UserAPI/SQLite_CalibrationGenerator","Use universal generator to
 		REQUIRE(a->GetValueDouble(2) > 29);
 	}
 
+	SECTION("Column projection", "Get only selected columns")
+	{
+		vector<string> columns;
+		columns.push_back("c3");
+		columns.push_back("c1");
+
+		vector<vector<int> > intValues;
+		REQUIRE_NOTHROW(result = sqliteCalib->GetCalib(intValues, "/test/test_vars/test_table2::test", columns));
+		REQUIRE(result);
+		REQUIRE(intValues.size()==1);
+		REQUIRE(intValues[0].size()==2);
+		REQUIRE(intValues[0][0]==30);
+		REQUIRE(intValues[0][1]==10);
+
+		vector<vector<string> > stringValues;
+		REQUIRE_NOTHROW(result = sqliteCalib->GetCalib(stringValues, "/test/test_vars/test_table2::test", columns));
+		REQUIRE(stringValues[0][0]=="30");
+
+		columns.push_back("no_such_column");
+		vector<vector<double> > doubleValues;
+		REQUIRE_THROWS(sqliteCalib->GetCalib(doubleValues, "/test/test_vars/test_table2::test", columns));
+	}
+
+	SECTION("Keyed lookup", "Find rows by a key column")
+	{
+		vector<int> row;
+		REQUIRE(sqliteCalib->Lookup(row, "/test/test_vars/test_table2::test", "c2", "20"));
+		REQUIRE(row.size()==3);
+		REQUIRE(row[0]==10);
+		REQUIRE(row[2]==30);
+		REQUIRE_FALSE(sqliteCalib->Lookup(row, "/test/test_vars/test_table2::test", "c2", "21"));
+		REQUIRE_THROWS(sqliteCalib->Lookup(row, "/test/test_vars/test_table2::test", "no_such_column", "20"));
+
+		Assignment* a = sqliteCalib->GetAssignment("/test/test_vars/test_table2::test");
+		const Assignment::RowIndex& index = a->GetRowIndex(0);
+		REQUIRE(index.size()==1);
+		REQUIRE(&index == &a->GetRowIndex(0));
+		REQUIRE(a->IsDataReadOnly());
+		REQUIRE(a->Lookup(0, "10")==0);
+
+		//integer keys are parsed, so they don't need to be written as they are stored
+		REQUIRE(sqliteCalib->Lookup(row, "/test/test_vars/test_table2::test", "c2", 20L));
+		REQUIRE(row[2]==30);
+		vector<string> stringRow;
+		REQUIRE(sqliteCalib->Lookup(stringRow, "/test/test_vars/test_table2::test", "c1", 10L));
+		REQUIRE(stringRow[1]=="20");
+		REQUIRE_FALSE(sqliteCalib->Lookup(row, "/test/test_vars/test_table2::test", "c2", 21L));
+		REQUIRE(a->Lookup(0, 10L)==0);
+		REQUIRE(a->Lookup(1, 10L)==-1);
+		REQUIRE(a->GetIntRowIndex(2).count(30)==1);
+	}
+
+	SECTION("Cursor", "Read constants row by row")
+	{
+		unique_ptr<BlobCursor> cursor(sqliteCalib->OpenCursor("/test/test_vars/test_table2::test"));
+		REQUIRE(cursor.get()!=NULL);
+		REQUIRE(cursor->GetColumnsCount()==3);
+
+		vector<int> row;
+		REQUIRE(cursor->NextRow(row));
+		REQUIRE(row[0]==10);
+		REQUIRE(row[1]==20);
+		REQUIRE(row[2]==30);
+		REQUIRE_FALSE(cursor->NextRow(row));
+		REQUIRE(cursor->GetRowsRead()==1);
+
+		//the cursor holds its connection of the pool until it is deleted
+		DataProviderPool* pool = sqliteCalib->GetReadPool();
+		cursor.reset();
+		size_t acquires = pool->GetAcquiresCount();
+		size_t waits = pool->GetWaitsCount();
+		cursor.reset(sqliteCalib->OpenCursor("/test/test_vars/test_table2::test"));
+		REQUIRE(pool->GetAcquiresCount() == acquires + 1);
+		cursor.reset();
+		vector<vector<int> > values;
+		REQUIRE(sqliteCalib->GetCalib(values, "/test/test_vars/test_table2::test"));
+		REQUIRE(pool->GetWaitsCount() == waits);
+
+		REQUIRE(sqliteCalib->OpenCursor("/test/test_vars/no_such_table")==NULL);
+	}
+
+	SECTION("Parallel reads", "Threads read constants through the pool of connections")
+	{
+		unique_ptr<SQLiteCalibration> calib(new SQLiteCalibration(100));
+		REQUIRE(calib->Connect(TESTS_SQLITE_STRING));
+		calib->EnableCache(false);
+		REQUIRE(calib->GetReadPool()!=NULL);
+		calib->GetReadPool()->SetMaxSize(3);
+
+		std::atomic<int> errors(0);
+		vector<std::thread> threads;
+		for (int i = 0; i < 6; i++)
+		{
+			threads.push_back(std::thread([&calib, &errors]()
+			{
+				for (int j = 0; j < 20; j++)
+				{
+					vector<vector<int> > values;
+					if(!calib->GetCalib(values, "/test/test_vars/test_table2::test") || values.size()!=1 || values[0][1]!=20) errors++;
+				}
+			}));
+		}
+		for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+		REQUIRE(errors==0);
+		REQUIRE(calib->GetReadPool()->GetSize() > 0);
+		REQUIRE(calib->GetReadPool()->GetSize() <= 3);
+		REQUIRE(calib->GetReadPool()->GetAcquiresCount() == 120);
+
+		//disconnected and pinged providers are connected again
+		calib->GetReadPool()->SetPingInterval(0);
+		calib->Disconnect();
+		REQUIRE(calib->Connect(TESTS_SQLITE_STRING));
+		vector<vector<int> > values;
+		REQUIRE(calib->GetCalib(values, "/test/test_vars/test_table2::test"));
+		REQUIRE(calib->GetReadPool()->GetReconnectsCount() == 0);
+
+		//the database is loaded to memory once, read connections open the same copy
+		unique_ptr<SQLiteCalibration> memoryCalib(new SQLiteCalibration(100));
+		REQUIRE(memoryCalib->Connect(string(TESTS_SQLITE_STRING) + "?memory=1"));
+		memoryCalib->EnableCache(false);
+		REQUIRE(memoryCalib->GetReadPool()->GetConnectionString().find("shared_memory=") != string::npos);
+		threads.clear();
+		for (int i = 0; i < 4; i++)
+		{
+			threads.push_back(std::thread([&memoryCalib, &errors]()
+			{
+				for (int j = 0; j < 20; j++)
+				{
+					vector<vector<int> > values;
+					if(!memoryCalib->GetCalib(values, "/test/test_vars/test_table2::test") || values.size()!=1 || values[0][1]!=20) errors++;
+				}
+			}));
+		}
+		for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+		REQUIRE(errors==0);
+	}
+
 	//=== Default time ===
 	SECTION("Several Calibrations tear down SQLite", "Test that crash in destructor #45")
 	{
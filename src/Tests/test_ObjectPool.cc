@@ -0,0 +1,86 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <memory>
+#include <thread>
+
+#include "CCDB/Helpers/ObjectPool.h"
+#include "CCDB/Model/Assignment.h"
+#include "CCDB/Model/Variation.h"
+#include "CCDB/Model/RunRange.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* **
+ * @brief Test of pooled model objects and index based ownership
+ */
+TEST_CASE("CCDB/ObjectPool","Object pool tests")
+{
+	FixedSizePool pool(20, 4);
+	REQUIRE(pool.GetBlockSize() >= 20);
+	REQUIRE(pool.GetBlockSize() % alignof(max_align_t) == 0);
+
+	vector<void*> blocks;
+	for(int i = 0; i < 5; i++) blocks.push_back(pool.Allocate());
+	REQUIRE(pool.GetChunksCount() == 2);
+	REQUIRE(pool.GetUsedCount() == 5);
+	void* freed = blocks[2];
+	pool.Free(freed);
+	pool.Free(NULL);
+	REQUIRE(pool.GetUsedCount() == 4);
+	REQUIRE(pool.Allocate() == freed);		//freed blocks are given again
+	REQUIRE(pool.GetChunksCount() == 2);
+
+	//threads take blocks from their own lists, blocks freed by other threads are kept
+	//and all of them go back to the pool when the threads exit
+	FixedSizePool threadsPool(sizeof(double));
+	vector<void*> shared(1000);
+	thread producer([&]{ for(size_t i = 0; i < shared.size(); i++) shared[i] = threadsPool.Allocate(); });
+	producer.join();
+	REQUIRE(threadsPool.GetUsedCount() == shared.size());
+	thread consumer([&]{ for(size_t i = 0; i < shared.size(); i++) threadsPool.Free(shared[i]); });
+	consumer.join();
+	REQUIRE(threadsPool.GetUsedCount() == 0);
+	size_t chunksCount = threadsPool.GetChunksCount();
+	thread user([&]{ for(size_t i = 0; i < shared.size(); i++) shared[i] = threadsPool.Allocate(); });
+	user.join();
+	REQUIRE(threadsPool.GetChunksCount() == chunksCount);
+
+	//model objects are taken from the pool of their class
+	FixedSizePool& assignments = Assignment::GetPool();
+	size_t usedCount = assignments.GetUsedCount();
+	unique_ptr<Assignment> assignment(new Assignment());
+	REQUIRE(assignments.GetUsedCount() == usedCount + 1);
+
+	//owned objects are deleted with the owner, released ones are not
+	RunRange* runRange = new RunRange(assignment.get());
+	Variation* variation = new Variation(assignment.get());
+	Variation* released = new Variation(assignment.get());
+	REQUIRE(assignment->GetOwnedCount() == 3);
+	REQUIRE(assignment->IsOwner(runRange));
+	released->ReleaseOwning();
+	REQUIRE(assignment->GetOwnedCount() == 2);
+	REQUIRE_FALSE(assignment->IsOwner(released));
+	REQUIRE(assignment->IsOwner(variation));
+	REQUIRE(assignment->IsOwner(runRange));
+
+	//deleted object leaves the list of its owner
+	delete runRange;
+	REQUIRE(assignment->GetOwnedCount() == 1);
+	REQUIRE(assignment->IsOwner(variation));
+
+	//ownership moves to another owner
+	Assignment other;
+	variation->SetOwner(&other);
+	REQUIRE(assignment->GetOwnedCount() == 0);
+	REQUIRE(other.GetOwnedCount() == 1);
+
+	size_t variationsCount = Variation::GetPool().GetUsedCount();
+	delete released;
+	REQUIRE(Variation::GetPool().GetUsedCount() == variationsCount - 1);
+
+	assignment.reset();
+	REQUIRE(assignments.GetUsedCount() == usedCount);
+}
@@ -0,0 +1,131 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <stdio.h>
+#include <math.h>
+#include <memory>
+
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/PackDataProvider.h"
+#include "CCDB/Providers/PackWriter.h"
+#include "CCDB/CalibrationGenerator.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* ** 
+ * @brief Test of writing and reading ccdbpack files
+ */
+TEST_CASE("CCDB/PackDataProvider","Pack writer and provider tests")
+{
+	SQLiteDataProvider source;
+	if(!source.Connect(TESTS_SQLITE_STRING)) return;
+
+	string packPath = "test_ccdb_lib.ccdbpack";
+
+	//WRITE
+	//----------------------------------------------------
+	//variation 'test' has assignment 4 (from default) for runs 100-499 and assignment 2 for runs 500-1000
+	{
+		PackWriter writer(&source, "test");
+		writer.AddRunRange(100, 1000);
+		writer.AddTable("/test/test_vars/test_table");
+		writer.AddTable("/test/test_vars/test_table2");
+		REQUIRE_NOTHROW(writer.Write(packPath));
+
+		REQUIRE(writer.GetTablesCount() == 2);
+		REQUIRE(writer.GetIntervalsCount() == 3);
+		REQUIRE(writer.GetBlocksCount() == 3);
+		REQUIRE_THROWS(writer.AddTable("/test/test_vars/no_such_table"));
+	}
+
+	//READ
+	//----------------------------------------------------
+	PackDataProvider pack;
+	REQUIRE(pack.Connect("ccdbpack://" + packPath));
+	REQUIRE(pack.GetPackVariation() == "test");
+
+	//catalog
+	ConstantsTypeTable* table = pack.GetConstantsTypeTable("/test/test_vars/test_table", true);
+	REQUIRE(table != NULL);
+	REQUIRE(table->GetColumns().size() == 3);
+	REQUIRE(table->GetRowsCount() == 2);
+
+	vector<ConstantsTypeTable*> tables;
+	REQUIRE(pack.SearchConstantsTypeTables(tables, "test_table*"));
+	REQUIRE(tables.size() == 2);
+
+	//assignments
+	Assignment* assignment = pack.GetAssignmentShort(100, "/test/test_vars/test_table", "test");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 4);
+	vector<vector<string> > values = assignment->GetData();
+	REQUIRE(values.size() == 2);
+	REQUIRE(values[0].size() == 3);
+	REQUIRE(values[0][0] == "2.2");
+	REQUIRE(values[1][2] == "2.7");
+
+	assignment = pack.GetAssignmentFull(600, "/test/test_vars/test_table", "test");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 2);
+	REQUIRE(assignment->GetTypeTable()->GetColumns().size() == 3);
+	REQUIRE(assignment->GetRawData() == "1.0|2.0|3.0|4.0|5.0|6.0");
+
+	//no constants for the run is not an error
+	REQUIRE(pack.GetAssignmentShort(2000, "/test/test_vars/test_table", "test") == NULL);
+	REQUIRE(pack.GetNErrors() == 0);
+
+	//the pack of the latest constants serves times since it was made, not earlier
+	assignment = pack.GetAssignmentShort(100, "/test/test_vars/test_table", pack.GetPackCreatedTime() + 3600, "test");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 4);
+	REQUIRE(pack.GetAssignmentShort(100, "/test/test_vars/test_table", pack.GetPackCreatedTime() - 3600, "test") == NULL);
+	REQUIRE(pack.GetLastError() == CCDB_ERROR_NO_ASSIGMENT);
+
+	//the pack has only one variation
+	REQUIRE(pack.GetAssignmentShort(600, "/test/test_vars/test_table", "default") == NULL);
+	REQUIRE(pack.GetLastError() == CCDB_ERROR_VARIATION_INVALID);
+
+	//constants right in the file
+	PackConstants constants;
+	REQUIRE(pack.FindConstants(constants, 600, "/test/test_vars/test_table", "test"));
+	REQUIRE(constants.RowsCount == 2);
+	REQUIRE(constants.ColumnsCount == 3);
+	REQUIRE(constants.GetValue(1, 0) == 4.0);
+	REQUIRE(constants.GetCellString(1, 0) == "4.0");
+
+	REQUIRE(pack.FindConstants(constants, 500, "/test/test_vars/test_table2", "test"));
+	REQUIRE(constants.RowsCount == 1);
+	REQUIRE(constants.GetValue(0, 2) == 30.0);
+
+	pack.Disconnect();
+
+	//USER API
+	//----------------------------------------------------
+	{
+		unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration("ccdbpack://" + packPath, 600, "test"));
+		vector<vector<double> > doubles;
+		REQUIRE(calib->GetCalib(doubles, "/test/test_vars/test_table"));
+		REQUIRE(doubles.size() == 2);
+		REQUIRE(doubles[0][1] == 2.0);
+
+		//numbers are the ones the source gives
+		unique_ptr<Calibration> sourceCalib(CalibrationGenerator::CreateCalibration(TESTS_SQLITE_STRING, 600, "test"));
+		vector<vector<double> > sourceDoubles;
+		REQUIRE(sourceCalib->GetCalib(sourceDoubles, "/test/test_vars/test_table"));
+		REQUIRE(doubles == sourceDoubles);
+
+		vector<vector<string> > strings;
+		REQUIRE(calib->GetCalib(strings, "/test/test_vars/test_table::test"));
+		REQUIRE(strings[1][2] == "6.0");
+	}
+
+	//not a pack
+	string sqlitePath = string(TESTS_SQLITE_STRING).substr(string("sqlite://").size());
+	REQUIRE_FALSE(pack.Connect("ccdbpack://" + sqlitePath));
+	REQUIRE(pack.GetLastError() == CCDB_ERROR_FILE_FORMAT);
+
+	remove(packPath.c_str());
+}
@@ -0,0 +1,93 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <memory>
+
+#include "CCDB/Helpers/ConstantsSnapshot.h"
+#include "CCDB/SQLiteCalibration.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* **
+ * @brief Test of tables packed into read-only memory before fork
+ */
+TEST_CASE("CCDB/PrepareForFork","Fork snapshot tests")
+{
+	ConstantsSnapshot snapshot;
+	vector<vector<double> > values(2, vector<double>(3, 1.5));
+	values[1][2] = 7;
+	snapshot.Add("table", values);
+	snapshot.Add("table", vector<vector<double> >(1, vector<double>(1, 0)));
+	snapshot.Add("other_table", vector<vector<double> >(1, vector<double>(1, 42)));
+	REQUIRE_THROWS(snapshot.Add("wrong_table", vector<vector<double> >{ {1, 2}, {3} }));
+
+	ConstantsSnapshot::Table table;
+	REQUIRE_FALSE(snapshot.Find("table", table));
+	snapshot.Seal();
+	REQUIRE(snapshot.IsSealed());
+	REQUIRE(snapshot.GetTablesCount() == 2);
+	REQUIRE_THROWS(snapshot.Add("late_table", values));
+
+	REQUIRE(snapshot.Find("table", table));
+	REQUIRE(table.Rows == 2);
+	REQUIRE(table.Columns == 3);
+	REQUIRE(table.Values[5] == 7);
+	REQUIRE(snapshot.Find("other_table", table));
+	REQUIRE(table.Values[0] == 42);
+	REQUIRE_FALSE(snapshot.Find("no_such_table", table));
+
+	//Calibration packs tables and closes the connection
+	//----------------------------------------------------
+	SQLiteDataProvider prov;
+	if(!prov.Connect(TESTS_SQLITE_STRING)) return;
+
+	unique_ptr<SQLiteCalibration> calib(new SQLiteCalibration(100));
+	REQUIRE(calib->Connect(TESTS_SQLITE_STRING));
+
+	vector<string> namepaths;
+	namepaths.push_back("/test/test_vars/test_table");
+	namepaths.push_back("/test/test_vars/test_table2:100:test");
+	REQUIRE(calib->PrepareForFork(namepaths));
+	REQUIRE_FALSE(calib->IsConnected());
+	REQUIRE(calib->GetForkSnapshot()->GetTablesCount() == 2);
+
+	//the worker reads packed tables without a connection
+	pid_t child = fork();
+	if(child == 0)
+	{
+		vector<vector<double> > childValues;
+		vector<double> rowValues;
+		bool isOk = calib->GetCalib(childValues, "test/test_vars/test_table") && childValues.size() == 2 && childValues[1][2] > 2.69 && childValues[1][2] < 2.71;
+		isOk = isOk && calib->GetCalib(rowValues, "/test/test_vars/test_table2:100:test") && rowValues.size() == 3;
+		isOk = isOk && !calib->IsConnected();
+		_exit(isOk ? 0 : 1);
+	}
+	int status = -1;
+	waitpid(child, &status, 0);
+	REQUIRE(status == 0);
+
+	//tables that are not packed are read through a new connection
+	vector<vector<string> > stringValues;
+	REQUIRE(calib->GetCalib(stringValues, "/test/test_vars/test_table"));
+	REQUIRE(calib->IsConnected());
+
+	//not found tables are reported
+	namepaths.push_back("/test/test_vars/test_table2:100:default");
+	REQUIRE_FALSE(calib->PrepareForFork(namepaths));
+	REQUIRE(calib->GetForkSnapshot()->GetTablesCount() == 2);
+
+	//all tables of the default run and variation
+	REQUIRE(calib->PrepareForFork());
+	REQUIRE(calib->GetForkSnapshot()->GetTablesCount() >= 1);
+
+	//the connection of a locked provider is not closed silently
+	SQLiteCalibration lockedCalib(100);
+	lockedCalib.UseProvider(&prov, true);
+	REQUIRE_THROWS_AS(lockedCalib.PrepareForFork(namepaths), std::logic_error);
+	REQUIRE(prov.IsConnected());
+}
@@ -0,0 +1,67 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include "CCDB/Helpers/ReplicaSelector.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* **
+ * @brief Test of replica routing by latencies
+ */
+TEST_CASE("CCDB/ReplicaSelector","Replica selection tests")
+{
+	ReplicaSelector selector(3);
+	REQUIRE(selector.GetReplicasCount() == 3);
+	REQUIRE_THROWS(ReplicaSelector(0));
+
+	//not measured replicas go first
+	REQUIRE(selector.Select() == 0);
+	selector.AddLatency(0, 10);
+	REQUIRE(selector.Select() == 1);
+	selector.AddLatency(1, 2);
+	REQUIRE(selector.Select() == 2);
+	selector.AddLatency(2, 5);
+
+	//then the fastest one
+	REQUIRE(selector.Select() == 1);
+	vector<size_t> excluded(1, 1);
+	REQUIRE(selector.Select(excluded) == 2);
+	excluded.push_back(2);
+	excluded.push_back(0);
+	REQUIRE(selector.Select(excluded) == -1);
+
+	//the average follows the latency
+	for(int i = 0; i < 20; i++) selector.AddLatency(1, 20);
+	REQUIRE(selector.GetLatency(1) > 15);
+	REQUIRE(selector.Select() == 2);
+
+	//failed replica is skipped until the retry time
+	selector.SetRetryDelay(3600);
+	selector.MarkFailed(2);
+	REQUIRE_FALSE(selector.IsHealthy(2));
+	REQUIRE(selector.Select() == 0);
+	selector.MarkFailed(0);
+	selector.MarkFailed(1);
+	REQUIRE(selector.Select() == 2);		//all are down, the first due is given
+	selector.AddLatency(0, 1);
+	REQUIRE(selector.IsHealthy(0));
+	REQUIRE(selector.Select() == 0);
+	selector.SetRetryDelay(0);
+	selector.MarkFailed(1);
+	REQUIRE(selector.IsHealthy(1));
+
+	//percentile is given when there are enough samples
+	ReplicaSelector samples(1, 10);
+	REQUIRE(samples.GetPercentile(0, 95) < 0);
+	for(int i = 1; i <= 10; i++) samples.AddLatency(0, i);
+	REQUIRE(samples.GetPercentile(0, 50) >= 5);
+	REQUIRE(samples.GetPercentile(0, 50) <= 6);
+	REQUIRE(samples.GetPercentile(0, 100) == 10);
+	REQUIRE(samples.GetPercentile(0, 0) == 1);
+
+	//old samples are replaced
+	for(int i = 0; i < 10; i++) samples.AddLatency(0, 100);
+	REQUIRE(samples.GetPercentile(0, 0) == 100);
+}
@@ -4,7 +4,16 @@
 
 #include "CCDB/Console.h"
 #include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Model/Assignment.h"
 
+#ifndef WIN32
+#include <stdlib.h>
+#include <stdio.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <utime.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 using namespace ccdb;
@@ -41,3 +50,109 @@ TEST_CASE("CCDB/SQLiteDataProvider/Connection","Connection tests")
 	prov->Disconnect();
 	delete prov;
 }
+
+
+TEST_CASE("CCDB/SQLiteDataProvider/ConnectionOptions","Connection string options")
+{
+	SQLiteConnectionInfo connection;
+	REQUIRE(SQLiteDataProvider::ParseConnectionString("sqlite:///data/ccdb.sqlite?immutable=1&mmap=268435456&cache_size=-65536&prewarm=1", connection));
+	REQUIRE(connection.FilePath == "/data/ccdb.sqlite");
+	REQUIRE(connection.IsImmutable);
+	REQUIRE(connection.MmapSize == 268435456);
+	REQUIRE(connection.CacheSize == -65536);
+	REQUIRE(connection.IsPrewarm);
+
+	SQLiteConnectionInfo noOptions;
+	REQUIRE(SQLiteDataProvider::ParseConnectionString("sqlite://ccdb.sqlite", noOptions));
+	REQUIRE(noOptions.FilePath == "ccdb.sqlite");
+	REQUIRE_FALSE(noOptions.IsImmutable);
+	REQUIRE(noOptions.MmapSize < 0);
+	REQUIRE_FALSE(SQLiteDataProvider::ParseConnectionString("mysql://localhost", noOptions));
+
+	//read data from immutable memory mapped file
+	SQLiteDataProvider *prov = new SQLiteDataProvider();
+	string conStr = string(TESTS_SQLITE_STRING) + "?immutable=1&mmap=67108864&cache_size=-8192&prewarm=1";
+	REQUIRE(prov->Connect(conStr));
+	REQUIRE(prov->GetConnectionString() == conStr);
+	Assignment* assignment = prov->GetAssignmentShort(100, "/test/test_vars/test_table", "default");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetCellsCount() == 6);
+	delete assignment;
+	prov->Disconnect();
+	delete prov;
+}
+
+
+TEST_CASE("CCDB/SQLiteDataProvider/InMemory","Database loaded to memory")
+{
+	SQLiteConnectionInfo connection;
+	REQUIRE(SQLiteDataProvider::ParseConnectionString("sqlite://ccdb.sqlite?memory=1&scratch=/scratch/ccdb&pool=2", connection));
+	REQUIRE(connection.IsInMemory);
+	REQUIRE(connection.ScratchDir == "/scratch/ccdb");
+	REQUIRE(connection.PoolSize == 2);
+
+	SQLiteDataProvider prov;
+	REQUIRE(prov.Connect(string(TESTS_SQLITE_STRING) + "?memory=1"));
+	Assignment* assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "default");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetCellsCount() == 6);
+	delete assignment;
+
+	//other connections open the same copy
+	REQUIRE_FALSE(prov.GetMemoryName().empty());
+	SQLiteDataProvider reader;
+	REQUIRE(reader.Connect("sqlite://no_such_file.sqlite?shared_memory=" + prov.GetMemoryName()));
+	assignment = reader.GetAssignmentShort(100, "/test/test_vars/test_table", "default");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetCellsCount() == 6);
+	delete assignment;
+	reader.Disconnect();
+	prov.Disconnect();
+	REQUIRE(prov.GetMemoryName().empty());
+	REQUIRE_FALSE(reader.Connect("sqlite://no_such_file.sqlite?shared_memory=ccdb-memory-no-such"));
+
+#ifndef WIN32
+	//local copy, the second connect uses the same copy
+	for (int i = 0; i < 2; i++)
+	{
+		REQUIRE(prov.Connect(string(TESTS_SQLITE_STRING) + "?scratch=/tmp&memory=1"));
+		REQUIRE(prov.GetLastError() == CCDB_NO_ERRORS);
+		assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "default");
+		REQUIRE(assignment != NULL);
+		delete assignment;
+		prov.Disconnect();
+	}
+
+	//the copy of the same size but of other modification time is made again
+	char scratchDir[] = "/tmp/ccdb_test_scratch_XXXXXX";
+	REQUIRE(mkdtemp(scratchDir) != NULL);
+	REQUIRE(prov.Connect(string(TESTS_SQLITE_STRING) + "?scratch=" + scratchDir));
+	prov.Disconnect();
+
+	string copyPath;
+	DIR* dir = opendir(scratchDir);
+	REQUIRE(dir != NULL);
+	while(dirent* entry = readdir(dir))
+	{
+		if(entry->d_name[0] != '.') copyPath = string(scratchDir) + "/" + entry->d_name;
+	}
+	closedir(dir);
+	REQUIRE_FALSE(copyPath.empty());
+
+	struct stat copyStat;
+	REQUIRE(stat(copyPath.c_str(), &copyStat) == 0);
+	time_t sourceTime = copyStat.st_mtime;
+	struct utimbuf times;
+	times.actime = times.modtime = sourceTime - 100;
+	REQUIRE(utime(copyPath.c_str(), &times) == 0);
+
+	REQUIRE(prov.Connect(string(TESTS_SQLITE_STRING) + "?scratch=" + scratchDir));
+	REQUIRE(prov.GetLastError() == CCDB_NO_ERRORS);
+	prov.Disconnect();
+	REQUIRE(stat(copyPath.c_str(), &copyStat) == 0);
+	REQUIRE(copyStat.st_mtime == sourceTime);
+
+	remove(copyPath.c_str());
+	rmdir(scratchDir);
+#endif
+}
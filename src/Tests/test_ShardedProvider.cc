@@ -0,0 +1,133 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <sqlite3.h>
+
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/ShardedDataProvider.h"
+#include "CCDB/Globals.h"
+
+using namespace std;
+using namespace ccdb;
+
+namespace
+{
+	void WriteIndex(const string& path, const string& content)
+	{
+		FILE* file = fopen(path.c_str(), "wb");
+		fputs(content.c_str(), file);
+		fclose(file);
+	}
+
+	/** Copies the database and runs sql on the copy */
+	void CopyDatabase(const string& source, const string& copy, const string& sql)
+	{
+		ifstream in(source.c_str(), ios::binary);
+		ofstream out(copy.c_str(), ios::binary);
+		out << in.rdbuf();
+		out.close();
+
+		sqlite3* database;
+		sqlite3_open(copy.c_str(), &database);
+		sqlite3_exec(database, sql.c_str(), NULL, NULL, NULL);
+		sqlite3_close(database);
+	}
+}
+
+/********************************************************************* **
+ * @brief Test of the provider over several SQLite files
+ */
+TEST_CASE("CCDB/ShardedDataProvider","Sharded provider tests")
+{
+	{
+		SQLiteDataProvider source;
+		if(!source.Connect(TESTS_SQLITE_STRING)) return;
+	}
+
+	//All shards are the test database, so routing is seen by the shards that are opened
+	string database = string(getenv("CCDB_HOME")) + "/sql/ccdb.sqlite";
+	string indexPath = "test_ccdb_lib_shards.index";
+	WriteIndex(indexPath,
+		"# shards of the test database\n"
+		"shard " + database + "   0     999  /test\n"
+		"shard sqlite://" + database + "   1000  inf  /test/\n"
+		"shard " + database + "\t500\t3000\t/test/test_vars\n");
+
+	ShardedDataProvider prov;
+	REQUIRE(prov.Connect("shards://" + indexPath));
+	REQUIRE(prov.GetShardsCount() == 3);
+	REQUIRE(prov.GetOpenedShardsCount() == 0);
+
+	//one shard has the run
+	Assignment* assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "default");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 4);
+	REQUIRE(prov.GetOpenedShardsCount() == 1);
+	REQUIRE(prov.GetParallelLookups() == 0);
+
+	//two shards have the run. They are queried in parallel
+	assignment = prov.GetAssignmentShort(600, "/test/test_vars/test_table", "test", true);
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 2);
+	REQUIRE(assignment->GetTypeTable()->GetColumns().size() == 3);
+	REQUIRE(prov.GetOpenedShardsCount() == 2);
+	REQUIRE(prov.GetParallelLookups() == 1);
+
+	//open ended shard
+	assignment = prov.GetAssignmentShort(5000, "test/test_vars/test_table2", "test");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetRawData() == "10|20|30");
+	REQUIRE(prov.GetOpenedShardsCount() == 3);
+
+	//no shard for the path is an error, no shard for the run is not
+	prov.ClearErrors();
+	REQUIRE(prov.GetAssignmentShort(100, "/other/table", "default") == NULL);
+	REQUIRE(prov.GetLastError() == CCDB_ERROR_NO_TYPETABLE);
+	prov.ClearErrors();
+	REQUIRE(prov.GetAssignmentShort(100, "/testing/table", "default") == NULL);
+	REQUIRE(prov.GetLastError() == CCDB_ERROR_NO_TYPETABLE);
+
+	//all shards fail on an unknown table
+	prov.ClearErrors();
+	REQUIRE(prov.GetAssignmentShort(2000, "/test/test_vars/no_such_table", "default") == NULL);
+	REQUIRE(prov.GetLastError() == CCDB_ERROR_NO_TYPETABLE);
+
+	//catalog and variations come from the shards
+	ConstantsTypeTable* table = prov.GetConstantsTypeTable("/test/test_vars/test_table", true);
+	REQUIRE(table != NULL);
+	REQUIRE(table->GetColumns().size() == 3);
+	REQUIRE(prov.GetDirectory("/test/test_vars") != NULL);
+	REQUIRE(prov.GetVariation("subtest") != NULL);
+	REQUIRE(prov.GetVariation("subtest")->GetParent()->GetName() == "test");
+	REQUIRE(prov.GetVariation("no_such_variation") == NULL);
+	prov.Disconnect();
+
+	//wrong index
+	WriteIndex(indexPath, "shard " + database + " 100 10 /\n");
+	REQUIRE_FALSE(prov.Connect("shards://" + indexPath));
+	REQUIRE(prov.GetLastError() == CCDB_ERROR_FILE_FORMAT);
+	WriteIndex(indexPath, "# no shards\n");
+	REQUIRE_FALSE(prov.Connect("shards://" + indexPath));
+	REQUIRE_FALSE(prov.Connect("shards://test_ccdb_lib_no_such.index"));
+	REQUIRE(prov.GetLastError() == CCDB_ERROR_CONNECTION_EXTERNAL_ERROR);
+
+	//the newest assignment wins whatever the order of shards is. The first shard has not the latest one
+	string oldDatabase = "test_ccdb_lib_shards_old.sqlite";
+	CopyDatabase(database, oldDatabase, "DELETE FROM assignments WHERE id = 4;");
+	WriteIndex(indexPath,
+		"shard " + oldDatabase + " 0 inf /\n"
+		"shard " + database + " 0 inf /\n");
+	REQUIRE(prov.Connect("shards://" + indexPath));
+	assignment = prov.GetAssignmentShort(100, "/test/test_vars/test_table", "default");
+	REQUIRE(assignment != NULL);
+	REQUIRE(assignment->GetId() == 4);
+	delete assignment;
+	prov.Disconnect();
+
+	remove(oldDatabase.c_str());
+	remove(indexPath.c_str());
+}
@@ -0,0 +1,156 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <memory>
+
+#include "CCDB/Helpers/SharedMemoryCache.h"
+#include "CCDB/SQLiteCalibration.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* **
+ * @brief Test of the cache of decoded tables shared by processes
+ */
+TEST_CASE("CCDB/SharedMemoryCache","Shared memory cache tests")
+{
+	string segmentName = "/ccdb_test_shared_cache";
+	SharedMemoryCache::Remove(segmentName);
+
+	SharedMemoryCache cache;
+	REQUIRE_NOTHROW(cache.Open(segmentName, 1024*1024));
+	REQUIRE(cache.IsOpen());
+	REQUIRE(cache.GetTablesCount() == 0);
+
+	double values[] = {1, 2, 3, 4, 5, 6};
+	REQUIRE(cache.Add("table", values, 2, 3));
+	REQUIRE(cache.Add("table", values, 2, 3));
+	REQUIRE(cache.GetTablesCount() == 1);
+
+	SharedMemoryCache::Table table;
+	REQUIRE_FALSE(cache.Find("no_such_table", table));
+	REQUIRE(cache.Find("table", table));
+	REQUIRE(table.Rows == 2);
+	REQUIRE(table.Columns == 3);
+	REQUIRE(table.Values[5] == 6);
+	REQUIRE(table.LoadTime > 0);
+
+	//a table added before the given time is replaced
+	double newValues[] = {7};
+	REQUIRE(cache.Add("table", newValues, 1, 1, table.LoadTime));
+	REQUIRE(cache.Find("table", table));
+	REQUIRE(table.Rows == 2);
+	REQUIRE(cache.Add("table", newValues, 1, 1, table.LoadTime + 1));
+	REQUIRE(cache.Find("table", table));
+	REQUIRE(table.Rows == 1);
+	REQUIRE(table.Values[0] == 7);
+	REQUIRE(cache.GetTablesCount() == 1);
+
+	//another process adds a table, this one sees it
+	pid_t child = fork();
+	if(child == 0)
+	{
+		SharedMemoryCache childCache;
+		childCache.Open(segmentName);
+		double childValues[] = {42};
+		_exit(childCache.Add("child_table", childValues, 1, 1) ? 0 : 1);
+	}
+	int status = -1;
+	waitpid(child, &status, 0);
+	REQUIRE(status == 0);
+	REQUIRE(cache.Find("child_table", table));
+	REQUIRE(table.Values[0] == 42);
+	REQUIRE(cache.GetTablesCount() == 2);
+
+	//the segment keeps its size and doesn't take more than it has
+	vector<double> bigTable(cache.GetSize() / sizeof(double));
+	REQUIRE_FALSE(cache.Add("big_table", bigTable.data(), 1, bigTable.size()));
+	REQUIRE_FALSE(cache.Find("big_table", table));
+	REQUIRE(cache.GetResetsCount() == 0);
+
+	//aliases point to the values of another table and are not counted as tables
+	REQUIRE(cache.Add("run_101", values, 2, 3));
+	REQUIRE(cache.AddAlias("run_102", "run_101"));
+	REQUIRE(cache.AddAlias("run_103", "no_such_table"));
+	REQUIRE_FALSE(cache.Find("run_103", table));
+	REQUIRE(cache.Find("run_102", table));
+	REQUIRE(table.Rows == 2);
+	REQUIRE(table.Values[5] == 6);
+	REQUIRE(cache.IsUnchanged(table));
+	REQUIRE(cache.GetTablesCount() == 3);
+
+	//a full segment is reset, the tables found before are then stale
+	size_t freeBytes = cache.GetFreeBytes();
+	REQUIRE(freeBytes > 0);
+	REQUIRE(freeBytes < cache.GetSize());
+	vector<double> halfTable(cache.GetSize() / sizeof(double) / 2);
+	REQUIRE(cache.Add("half_table_1", halfTable.data(), 1, halfTable.size()));
+	REQUIRE(cache.GetFreeBytes() < freeBytes);
+	REQUIRE(cache.Add("half_table_2", halfTable.data(), 1, halfTable.size()));
+	REQUIRE(cache.GetResetsCount() == 1);
+	REQUIRE_FALSE(cache.IsUnchanged(table));
+	REQUIRE_FALSE(cache.Find("run_102", table));
+	REQUIRE_FALSE(cache.Find("half_table_1", table));
+	REQUIRE(cache.Find("half_table_2", table));
+	REQUIRE(cache.GetTablesCount() == 1);
+	cache.Close();
+
+	//a segment that others may change is not used
+	SharedMemoryCache::Remove(segmentName);
+	int fd = shm_open(segmentName.c_str(), O_RDWR | O_CREAT, 0600);
+	REQUIRE(fd >= 0);
+	fchmod(fd, 0666);
+	close(fd);
+	SharedMemoryCache openCache;
+	REQUIRE_THROWS(openCache.Open(segmentName, 1024*1024));
+	SharedMemoryCache::Remove(segmentName);
+
+	//Calibration takes decoded constants from the segment
+	//----------------------------------------------------
+	SQLiteDataProvider prov;
+	if(prov.Connect(TESTS_SQLITE_STRING))
+	{
+		SharedMemoryCache::Remove(segmentName);
+
+		unique_ptr<SQLiteCalibration> calib(new SQLiteCalibration(100));
+		REQUIRE(calib->Connect(TESTS_SQLITE_STRING));
+		REQUIRE_NOTHROW(calib->EnableSharedCache(segmentName, 1024*1024));
+
+		vector<vector<double> > tableValues;
+		REQUIRE(calib->GetCalib(tableValues, "/test/test_vars/test_table"));
+		REQUIRE(tableValues.size() == 2);
+		REQUIRE(tableValues[1][2] == Approx(2.7));
+		REQUIRE(calib->GetSharedCache()->GetTablesCount() == 1);
+
+		//the second calibration doesn't decode the table again
+		unique_ptr<SQLiteCalibration> secondCalib(new SQLiteCalibration(100));
+		REQUIRE(secondCalib->Connect(TESTS_SQLITE_STRING));
+		secondCalib->EnableSharedCache(segmentName);
+		vector<vector<double> > sharedValues;
+		REQUIRE(secondCalib->GetCalib(sharedValues, "/test/test_vars/test_table:100:default"));
+		REQUIRE(sharedValues == tableValues);
+		REQUIRE(secondCalib->GetSharedCache()->GetTablesCount() == 1);
+
+		//another run of the same assignment shares its values
+		vector<vector<double> > otherRunValues;
+		REQUIRE(secondCalib->GetCalib(otherRunValues, "/test/test_vars/test_table:200:default"));
+		REQUIRE(otherRunValues == tableValues);
+		REQUIRE(secondCalib->GetSharedCache()->GetTablesCount() == 1);
+
+		//single row version
+		vector<double> rowValues;
+		REQUIRE(secondCalib->GetCalib(rowValues, "/test/test_vars/test_table2:100:test"));
+		REQUIRE(rowValues.size() == 3);
+		REQUIRE(rowValues[2] == 30);
+		REQUIRE_THROWS(secondCalib->GetCalib(rowValues, "/test/test_vars/test_table"));
+	}
+
+	SharedMemoryCache::Remove(segmentName);
+}
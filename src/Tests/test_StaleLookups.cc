@@ -0,0 +1,121 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "CCDB/SQLiteCalibration.h"
+#include "CCDB/Providers/SQLiteDataProvider.h"
+
+using namespace std;
+using namespace ccdb;
+
+namespace
+{
+	/** SQLite provider that answers assignment requests with a delay */
+	class SlowSQLiteProvider: public SQLiteDataProvider
+	{
+	public:
+		SlowSQLiteProvider(): DelayMs(0) {}
+
+		virtual Assignment* GetAssignmentShort(int run, const string& path, const string& variation="default", bool loadColumns =false)
+		{
+			this_thread::sleep_for(chrono::milliseconds(DelayMs.load()));
+			return SQLiteDataProvider::GetAssignmentShort(run, path, variation, loadColumns);
+		}
+
+		virtual Assignment* GetAssignmentShort(int run, const string& path, time_t time, const string& variation="default", bool loadColumns =false)
+		{
+			this_thread::sleep_for(chrono::milliseconds(DelayMs.load()));
+			return SQLiteDataProvider::GetAssignmentShort(run, path, time, variation, loadColumns);
+		}
+
+		atomic<int> DelayMs;
+	};
+}
+
+/********************************************************************* **
+ * @brief Test of deadlined requests that give stale constants
+ */
+TEST_CASE("CCDB/StaleLookups","Deadline and stale constants tests")
+{
+	SlowSQLiteProvider prov;
+	if(!prov.Connect(TESTS_SQLITE_STRING)) return;
+
+	SQLiteCalibration calib(1000);
+	calib.UseProvider(&prov, true);
+	calib.EnableCache(true);
+	REQUIRE(calib.GetDeadline() == 0);
+
+	//without the deadline requests wait for the database
+	vector<vector<string> > values;
+	REQUIRE(calib.GetCalib(values, "/test/test_vars/test_table:1501:test"));
+	vector<vector<string> > goodValues = values;
+	values.clear();
+	REQUIRE(calib.GetCalib(values, "/test/test_vars/test_table:1501:test"));
+	REQUIRE(calib.GetLookupStats().Hits == 1);
+
+	//the last known good assignment of the table and the run is given on the deadline
+	calib.SetDeadline(50);
+	prov.DelayMs = 500;
+	values.clear();
+	REQUIRE(calib.GetCalib(values, "test/test_vars/test_table:1501:test"));
+	REQUIRE(values == goodValues);
+	REQUIRE(calib.GetLookupStats().Stale == 1);
+
+	//the table is loaded in background
+	calib.WaitForRefreshes();
+	prov.DelayMs = 0;
+	values.clear();
+	REQUIRE(calib.GetCalib(values, "test/test_vars/test_table:1501:test"));
+	REQUIRE(calib.GetLookupStats().Hits == 2);
+
+	//there is no older assignment of the run, the request waits
+	prov.DelayMs = 300;
+	values.clear();
+	REQUIRE(calib.GetCalib(values, "/test/test_vars/test_table:1503:test"));
+	REQUIRE(values.size() > 0);
+	REQUIRE(calib.GetLookupStats().Timeouts == 1);
+
+	//deadline of the scope
+	calib.SetDeadline(0);
+	{
+		Calibration::DeadlineScope scope(20);
+		values.clear();
+		REQUIRE(calib.GetCalib(values, "/test/test_vars/test_table:1501:test:2035"));
+		REQUIRE(calib.GetLookupStats().Stale == 2);
+	}
+	prov.DelayMs = 0;
+	REQUIRE(calib.GetCalib(values, "/test/test_vars/test_table:1505:test"));
+	REQUIRE(calib.GetLookupStats().Stale == 2);
+
+	//expired cached assignment is given while the new one is loaded
+	calib.SetCacheMaxAge(0.05);
+	this_thread::sleep_for(chrono::milliseconds(100));
+	calib.SetDeadline(20);
+	prov.DelayMs = 300;
+	values.clear();
+	REQUIRE(calib.GetCalib(values, "/test/test_vars/test_table:1501:test"));
+	REQUIRE(values == goodValues);
+	REQUIRE(calib.GetLookupStats().Stale == 3);
+	calib.WaitForRefreshes();
+
+	Calibration::LookupStats stats = calib.GetLookupStats();
+	REQUIRE(stats.Hits == 2);
+	REQUIRE(stats.Timeouts == 1);
+
+	//replaced assignments are deleted, refreshes don't grow the memory
+	calib.SetDeadline(0);
+	prov.DelayMs = 0;
+	calib.SetCacheMaxAge(0.001);
+	size_t assignmentsCount = Assignment::GetPool().GetUsedCount();
+	for(int i = 0; i < 5; i++)
+	{
+		this_thread::sleep_for(chrono::milliseconds(5));
+		values.clear();
+		REQUIRE(calib.GetCalib(values, "/test/test_vars/test_table:1501:test"));
+	}
+	REQUIRE(Assignment::GetPool().GetUsedCount() <= assignmentsCount + 1);
+}
@@ -0,0 +1,95 @@
+#pragma warning(disable:4800)
+#include "Tests/tests.h"
+#include "Tests/catch.hpp"
+
+#include "CCDB/Helpers/StringPool.h"
+#include "CCDB/Model/Assignment.h"
+#include "CCDB/Model/ConstantsTypeTable.h"
+
+using namespace std;
+using namespace ccdb;
+
+/********************************************************************* **
+ * @brief Test of interned column names and cells
+ */
+TEST_CASE("CCDB/StringPool","String interning tests")
+{
+	StringPool& pool = StringPool::Instance();
+	REQUIRE(pool.Find("string_pool_test_value") == NULL);
+	StringPool::Handle handle = pool.Intern("string_pool_test_value");
+	REQUIRE(*handle == "string_pool_test_value");
+	REQUIRE(pool.Intern(string("string_pool_test_") + "value") == handle);
+	REQUIRE(pool.Find("string_pool_test_value") == handle);
+	size_t count = pool.GetCount();
+	pool.Intern("string_pool_test_value");
+	REQUIRE(pool.GetCount() == count);
+
+	//columns with equal names have equal handles
+	ConstantsTypeTable table;
+	table.AddColumn("state", ConstantsTypeColumn::cStringColumn);
+	table.AddColumn("channel", ConstantsTypeColumn::cIntColumn);
+	table.SetNRows(3);
+	ConstantsTypeColumn column;
+	column.SetName("state");
+	REQUIRE(table.GetColumns()[0]->GetNameHandle() == column.GetNameHandle());
+	REQUIRE(table.GetColumns()[1]->GetNameHandle() != column.GetNameHandle());
+
+	Assignment assignment;
+	assignment.SetTypeTable(&table);
+	assignment.SetRawData(string("ON|1|OFF|2|ON|3"));
+	REQUIRE(assignment.GetColumnIndex("channel") == 1);
+	REQUIRE(assignment.GetColumnIndex("no_such_column_name") == -1);
+	REQUIRE(assignment.GetValue(2, "channel") == "3");
+	REQUIRE(assignment.GetValue("state") == "ON");
+	REQUIRE(assignment.GetValue(3, "state") == "");
+
+	//cells of a low cardinality column are compared as pointers
+	const vector<StringPool::Handle>& states = assignment.GetColumnHandles(0);
+	REQUIRE(states.size() == 3);
+	REQUIRE(states[0] == states[2]);
+	REQUIRE(states[0] != states[1]);
+	REQUIRE(states[1] == pool.Find("OFF"));
+	REQUIRE(&assignment.GetColumnHandles(0) == &states);
+	REQUIRE(assignment.GetColumnHandles(5).empty());
+
+	//numbers are not interned unless the column is declared low cardinality
+	REQUIRE(assignment.GetColumnHandles(1).empty());
+	ConstantsTypeTable declaredTable;
+	declaredTable.AddColumn("state", ConstantsTypeColumn::cStringColumn);
+	declaredTable.AddColumn("channel", ConstantsTypeColumn::cIntColumn);
+	declaredTable.GetColumns()[1]->SetLowCardinality(true);
+	declaredTable.SetNRows(3);
+	Assignment declaredAssignment;
+	declaredAssignment.SetTypeTable(&declaredTable);
+	declaredAssignment.SetRawData(string("ON|1|OFF|2|ON|3"));
+	REQUIRE(declaredAssignment.GetColumnHandles(1).size() == 3);
+
+	//string columns of many distinct values are not interned
+	ConstantsTypeTable namesTable;
+	namesTable.AddColumn("name", ConstantsTypeColumn::cStringColumn);
+	size_t rowsCount = Assignment::cMaxDetectedDistinctCells + 1;
+	namesTable.SetNRows((int)rowsCount);
+	vector<string> names;
+	for(size_t i = 0; i < rowsCount; i++) names.push_back("string_pool_test_name_" + to_string(i));
+	Assignment namesAssignment;
+	namesAssignment.SetTypeTable(&namesTable);
+	namesAssignment.SetRawData(Assignment::VectorToBlob(names));
+	count = pool.GetCount();
+	REQUIRE(namesAssignment.GetColumnHandles(0).empty());
+	REQUIRE(pool.GetCount() == count);
+
+	//renamed columns are found by their new names
+	declaredTable.GetColumns()[1]->SetName("module");
+	REQUIRE(declaredTable.GetColumnIndex("module") == 1);
+	REQUIRE(declaredTable.GetColumnIndex("channel") == -1);
+
+	//rows give cells by names without copies
+	Assignment::RowView row = assignment.GetRow(1);
+	REQUIRE(row.at("state") == "OFF");
+	REQUIRE(&row.at("channel") == &assignment.GetCell(1, 1));
+	REQUIRE(row.at(column.GetNameHandle()) == "OFF");
+	REQUIRE(row.count("channel") == 1);
+	REQUIRE(row.count("no_such_column_name") == 0);
+	REQUIRE(row.size() == 2);
+	REQUIRE_THROWS_AS(row.at("no_such_column_name"), std::out_of_range);
+}
@@ -3,7 +3,12 @@
 
 #include "Tests/catch.hpp"
 
+#include <thread>
+#include <climits>
+#include <cmath>
+
 #include "CCDB/Helpers/StringUtils.h"
+#include "CCDB/Helpers/BlobCursor.h"
 
 
 using namespace std;
@@ -72,4 +77,145 @@ TEST_CASE("CCDB/StringUtils/Split", "Test of lexical splittiong string to tokens
 	REQUIRE(outArray[5] == "30e-2");
 }
 
+
+TEST_CASE("CCDB/StringUtils/SplitBlob", "One pass blob splitting and fast numbers parsing")
+{
+    vector<string> tokens;
+
+    //long enough to go through 16 bytes chunks
+    string blob = "10|20|30|40|50|30e-2|a&delimiter;b|&amp;|&delimiter;||last one";
+    REQUIRE(StringUtils::SplitBlob(blob, tokens) == 10);
+    REQUIRE(tokens[0] == "10");
+    REQUIRE(tokens[5] == "30e-2");
+    REQUIRE(tokens[6] == "a|b");
+    REQUIRE(tokens[7] == "&amp;");
+    REQUIRE(tokens[8] == "|");
+    REQUIRE(tokens[9] == "last one");
+
+    //the same as Split + DecodeBlobSeparator
+    vector<string> splitTokens = StringUtils::Split(blob, "|");
+    REQUIRE(splitTokens.size() == tokens.size());
+    REQUIRE(StringUtils::SplitBlob("", tokens) == 0);
+
+    //numbers
+    bool result = false;
+    REQUIRE(StringUtils::ParseInt(" -42", &result) == -42);
+    REQUIRE(result);
+    REQUIRE(StringUtils::ParseInt("42abc", &result) == 42);
+    REQUIRE(!result);
+    REQUIRE(StringUtils::ParseLong("1234567890123") == 1234567890123L);
+    REQUIRE(StringUtils::ParseULong("18446744073709551615") == 18446744073709551615UL);
+
+    //out of range values are reported and clamped
+    REQUIRE(StringUtils::ParseLong("9223372036854775807", &result) == LONG_MAX);
+    REQUIRE(result);
+    REQUIRE(StringUtils::ParseLong("-9223372036854775808", &result) == LONG_MIN);
+    REQUIRE(result);
+    REQUIRE(StringUtils::ParseLong("9223372036854775808", &result) == LONG_MAX);
+    REQUIRE_FALSE(result);
+    REQUIRE(StringUtils::ParseLong("-99999999999999999999999", &result) == LONG_MIN);
+    REQUIRE_FALSE(result);
+    REQUIRE(StringUtils::ParseULong("18446744073709551616", &result) == ULONG_MAX);
+    REQUIRE_FALSE(result);
+    REQUIRE(StringUtils::ParseInt("2147483647", &result) == INT_MAX);
+    REQUIRE(result);
+    REQUIRE(StringUtils::ParseInt("2147483648", &result) == INT_MAX);
+    REQUIRE_FALSE(result);
+    REQUIRE(StringUtils::ParseInt("-2147483649", &result) == INT_MIN);
+    REQUIRE_FALSE(result);
+    REQUIRE(StringUtils::ParseUInt("4294967296", &result) == UINT_MAX);
+    REQUIRE_FALSE(result);
+    REQUIRE(StringUtils::ParseDouble("1e99999999999999999999") == HUGE_VAL);
+    REQUIRE(StringUtils::ParseBool("true"));
+    REQUIRE(!StringUtils::ParseBool("0"));
+
+    REQUIRE(StringUtils::ParseDouble("30e-2", &result) == 0.3);
+    REQUIRE(result);
+    REQUIRE(StringUtils::ParseDouble("-1.5") == -1.5);
+    REQUIRE(StringUtils::ParseDouble("0.1") == 0.1);
+    REQUIRE(StringUtils::ParseDouble("123456789012345678901234") == 123456789012345678901234.0);
+    REQUIRE(StringUtils::ParseDouble("2.2250738585072014e-308") == 2.2250738585072014e-308);
+    REQUIRE(StringUtils::ParseDouble("0x10") == 16.0);
+    REQUIRE(StringUtils::ParseDouble("1.5e") == 1.5);
+    StringUtils::ParseDouble("abc", &result);
+    REQUIRE(!result);
+}
+
+
+TEST_CASE("CCDB/StringUtils/SplitBlobParallel", "Parallel blob splitting gives the same result as serial")
+{
+    string blob;
+    for (int i=0; i<100000; i++)
+    {
+        if(i) blob.append(i%97 ? "|" : "||");
+        blob.append(i%13 ? StringUtils::IntToString(i) : "a&delimiter;b");
+    }
+
+    vector<string> serialTokens;
+    vector<string> parallelTokens;
+    StringUtils::SplitBlob(blob, serialTokens);
+
+    REQUIRE(StringUtils::SplitBlobParallel(blob.data(), blob.size(), parallelTokens, 4) == serialTokens.size());
+    REQUIRE(parallelTokens == serialTokens);
+
+    //more chunks than cells and default number of chunks
+    StringUtils::SplitBlobParallel(blob.data(), blob.size(), parallelTokens, 1000);
+    REQUIRE(parallelTokens == serialTokens);
+    StringUtils::SplitBlobParallel(blob.data(), blob.size(), parallelTokens);
+    REQUIRE(parallelTokens == serialTokens);
+
+    //small blob
+    REQUIRE(StringUtils::SplitBlobParallel("1|2", 3, parallelTokens, 4) == 2);
+
+    //many threads decode at once. They share decoder threads of the process
+    vector<vector<string> > threadTokens(8);
+    vector<std::thread> threads;
+    for (size_t i=0; i<threadTokens.size(); i++)
+    {
+        threads.push_back(std::thread([&blob, &threadTokens, i]() { StringUtils::SplitBlobParallel(blob.data(), blob.size(), threadTokens[i], 16); }));
+    }
+    for (size_t i=0; i<threads.size(); i++) threads[i].join();
+    for (size_t i=0; i<threadTokens.size(); i++) REQUIRE(threadTokens[i] == serialTokens);
+    REQUIRE(StringUtils::GetDecoderThreadsCount() == 0);
+}
+
+
+TEST_CASE("CCDB/StringUtils/BlobCursor", "Row by row reading gives the same cells as SplitBlob")
+{
+    //escapes and delimiters are cut by the chunk borders of the small buffer
+    string blob;
+    for (int i=0; i<1000; i++)
+    {
+        if(i) blob.append(i%7 ? "|" : "||");
+        blob.append(i%5 ? StringUtils::IntToString(i) : "x&delimiter;&y");
+    }
+    vector<string> tokens;
+    StringUtils::SplitBlob(blob, tokens);
+
+    StringBlobCursor cursor(blob, 4, 16);
+    vector<string> row;
+    vector<string> cells;
+    while(cursor.NextRow(row)) cells.insert(cells.end(), row.begin(), row.end());
+    REQUIRE(cursor.GetRowsRead() == 250);
+    REQUIRE(cells == tokens);
+
+    //typed rows
+    StringBlobCursor intCursor("1|2|3|4|5|6", 3);
+    vector<int> intRow;
+    REQUIRE(intCursor.NextRow(intRow));
+    REQUIRE(intRow[2] == 3);
+    REQUIRE(intCursor.NextRow(intRow));
+    REQUIRE(intRow[0] == 4);
+    REQUIRE_FALSE(intCursor.NextRow(intRow));
+}
+
+
+TEST_CASE("CCDB/StringUtils/Hash64", "Hash is the standard 64 bit FNV-1a")
+{
+    REQUIRE(StringUtils::Hash64("") == 0xcbf29ce484222325ULL);
+    REQUIRE(StringUtils::Hash64("a") == 0xaf63dc4c8601ec8cULL);
+    REQUIRE(StringUtils::Hash64("foobar") == 0x85944171f73967e8ULL);
+    REQUIRE(StringUtils::Hash64(string("a\0b", 3)) != StringUtils::Hash64("a"));
+}
+
 #endif //test_StringUtils_h
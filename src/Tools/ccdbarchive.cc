@@ -0,0 +1,104 @@
+/*
+ * ccdbarchive - splits a ccdb SQLite file into a hot file with the latest constants and a history archive
+ *
+ *   ccdbarchive [-r min-max] <source file> <hot file> <archive file>
+ *
+ * The hot file keeps assignments that are still the latest ones for runs of the window, the archive keeps all.
+ * Both are read by sqlite://<hot file>?archive=<archive file> connection string
+ */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/ArchiveSplitter.h"
+#include "CCDB/Helpers/StringUtils.h"
+
+using namespace std;
+using namespace ccdb;
+
+void print_usage()
+{
+	printf("Usage: ccdbarchive [-r min-max] <source file> <hot file> <archive file>\n");
+	printf("   -r min-max    - runs the hot file is made for. Default is all runs\n");
+	printf("Files are SQLite file paths or sqlite:// connection strings\n");
+}
+
+
+bool parse_run_range(const string& str, int& runMin, int& runMax)
+{
+	size_t dashPos = str.find('-');
+	if(dashPos == string::npos || dashPos == 0) return false;
+
+	bool minIsOk, maxIsOk;
+	runMin = StringUtils::ParseInt(str.substr(0, dashPos), &minIsOk);
+	runMax = StringUtils::ParseInt(str.substr(dashPos + 1), &maxIsOk);
+	return minIsOk && maxIsOk && runMin <= runMax;
+}
+
+
+string file_path(const string& str)
+{
+	SQLiteConnectionInfo connection;
+	if(SQLiteDataProvider::ParseConnectionString(str, connection)) return connection.FilePath;
+	return str;
+}
+
+
+int main(int argc, char* argv[])
+{
+	ArchiveSplitter splitter;
+	vector<string> positional;
+
+	for(int i = 1; i < argc; i++)
+	{
+		string arg(argv[i]);
+		if(arg == "-h" || arg == "--help")
+		{
+			print_usage();
+			return 0;
+		}
+		else if(arg == "-r" && i + 1 < argc)
+		{
+			int runMin, runMax;
+			if(!parse_run_range(argv[++i], runMin, runMax))
+			{
+				fprintf(stderr, "Wrong run range '%s'. Should be like 1000-2000\n", argv[i]);
+				return 1;
+			}
+			splitter.SetRunWindow(runMin, runMax);
+		}
+		else if(arg.size() > 1 && arg[0] == '-')
+		{
+			fprintf(stderr, "Unknown option '%s'\n", arg.c_str());
+			print_usage();
+			return 1;
+		}
+		else
+		{
+			positional.push_back(file_path(arg));
+		}
+	}
+
+	if(positional.size() != 3)
+	{
+		print_usage();
+		return 1;
+	}
+
+	try
+	{
+		splitter.Split(positional[0], positional[1], positional[2]);
+		printf("Written '%s': %lu of %lu assignments, %lu assignments and %lu constant sets are only in '%s'\n", positional[1].c_str(),
+		       (unsigned long)(splitter.GetAssignmentsCount() - splitter.GetMovedAssignmentsCount()), (unsigned long)splitter.GetAssignmentsCount(),
+		       (unsigned long)splitter.GetMovedAssignmentsCount(), (unsigned long)splitter.GetMovedConstantSetsCount(), positional[2].c_str());
+	}
+	catch(std::exception& ex)
+	{
+		fprintf(stderr, "%s\n", ex.what());
+		return 3;
+	}
+	return 0;
+}
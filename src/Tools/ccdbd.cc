@@ -0,0 +1,136 @@
+/*
+ * ccdbd - serves constants of a ccdb database to all processes of the node
+ *
+ *   ccdbd [-s socket] [--max-age seconds] [--cache-size MB] <connection string>
+ *
+ * The daemon keeps one connection to the database and one cache of constants for the node.
+ * Jobs read constants with ccdbd://<socket> connection string. The default socket is /tmp/ccdbd.socket
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/PackDataProvider.h"
+#include "CCDB/Providers/FileDataProvider.h"
+#include "CCDB/Providers/DaemonServer.h"
+#ifdef CCDB_MYSQL
+#include "CCDB/Providers/MySQLDataProvider.h"
+#endif
+
+using namespace std;
+using namespace ccdb;
+
+static DaemonServer* gServer = NULL;
+
+void print_usage()
+{
+	printf("Usage: ccdbd [-s socket] [--max-age seconds] [--cache-size MB] <connection string>\n");
+	printf("   -s socket          path of the socket, default /tmp/ccdbd.socket\n");
+	printf("   --max-age seconds  latest constants are taken from the database again after this time, default 3600. 0 - never\n");
+	printf("   --cache-size MB    memory of cached constants, the least recently used are dropped first, default 256. 0 - no limit\n");
+}
+
+
+void handle_signal(int)
+{
+	if(gServer) gServer->Stop();
+}
+
+
+DataProvider* create_provider(const string& connectionString)
+{
+	if(connectionString.find("sqlite://") == 0) return new SQLiteDataProvider();
+	if(connectionString.find("ccdbpack://") == 0) return new PackDataProvider();
+	if(connectionString.find("file://") == 0) return new FileDataProvider();
+
+#ifdef CCDB_MYSQL
+	if(connectionString.find("mysql://") == 0) return new MySQLDataProvider();
+#endif
+	return NULL;
+}
+
+
+int main(int argc, char* argv[])
+{
+	string socketPath = "/tmp/ccdbd.socket";
+	time_t maxAge = 3600;
+	size_t cacheSize = 256;
+	vector<string> positional;
+	for(int i = 1; i < argc; i++)
+	{
+		string arg(argv[i]);
+		if(arg == "-h" || arg == "--help")
+		{
+			print_usage();
+			return 0;
+		}
+		if(arg == "-s" && i + 1 < argc)
+		{
+			socketPath = argv[++i];
+			continue;
+		}
+		if(arg == "--max-age" && i + 1 < argc)
+		{
+			maxAge = atol(argv[++i]);
+			continue;
+		}
+		if(arg == "--cache-size" && i + 1 < argc)
+		{
+			cacheSize = (size_t)atol(argv[++i]);
+			continue;
+		}
+		positional.push_back(arg);
+	}
+
+	if(positional.size() != 1)
+	{
+		print_usage();
+		return 1;
+	}
+	string connectionString = positional[0];
+
+	DataProvider* provider = create_provider(connectionString);
+	if(!provider)
+	{
+		fprintf(stderr, "Unknown connection string type: '%s'\n", connectionString.c_str());
+		return 1;
+	}
+	if(!provider->Connect(connectionString))
+	{
+		fprintf(stderr, "Can't connect to '%s'\n", connectionString.c_str());
+		delete provider;
+		return 2;
+	}
+
+	int result = 0;
+	try
+	{
+		DaemonServer server(provider);
+		server.SetMaxAge(maxAge);
+		server.SetMaxCacheBytes(cacheSize*1024*1024);
+		server.Listen(socketPath);
+
+		gServer = &server;
+		signal(SIGINT, handle_signal);
+		signal(SIGTERM, handle_signal);
+		printf("Serving '%s' on %s\n", connectionString.c_str(), socketPath.c_str());
+
+		server.Run();
+		gServer = NULL;
+		printf("Stopped. %zu requests went to the database\n", server.GetUpstreamRequests());
+	}
+	catch(std::exception& ex)
+	{
+		fprintf(stderr, "Error: %s\n", ex.what());
+		result = 3;
+	}
+
+	provider->Disconnect();
+	delete provider;
+	return result;
+}
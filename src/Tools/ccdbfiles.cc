@@ -0,0 +1,103 @@
+/*
+ * ccdbfiles - exports constants of a ccdb database to a directory of table files
+ *
+ *   ccdbfiles <connection string> <output directory> [table path]...
+ *
+ * If no tables are given all tables are exported. All variations and runs are exported, only the latest constants are kept.
+ * The directory is read by file://<output directory> connection string
+ */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/FileDataWriter.h"
+#ifdef CCDB_MYSQL
+#include "CCDB/Providers/MySQLDataProvider.h"
+#endif
+
+using namespace std;
+using namespace ccdb;
+
+void print_usage()
+{
+	printf("Usage: ccdbfiles <connection string> <output directory> [table path]...\n");
+	printf("If no table paths are given, all tables are exported\n");
+}
+
+
+DataProvider* create_provider(const string& connectionString)
+{
+	if(connectionString.find("sqlite://") == 0) return new SQLiteDataProvider();
+
+#ifdef CCDB_MYSQL
+	if(connectionString.find("mysql://") == 0) return new MySQLDataProvider();
+#endif
+	return NULL;
+}
+
+
+int main(int argc, char* argv[])
+{
+	vector<string> positional;
+	for(int i = 1; i < argc; i++)
+	{
+		string arg(argv[i]);
+		if(arg == "-h" || arg == "--help")
+		{
+			print_usage();
+			return 0;
+		}
+		positional.push_back(arg);
+	}
+
+	if(positional.size() < 2)
+	{
+		print_usage();
+		return 1;
+	}
+	string connectionString = positional[0];
+	string outputDir = positional[1];
+
+	DataProvider* provider = create_provider(connectionString);
+	if(!provider)
+	{
+		fprintf(stderr, "Unknown connection string type: '%s'\n", connectionString.c_str());
+		return 1;
+	}
+	if(!provider->Connect(connectionString))
+	{
+		fprintf(stderr, "Can't connect to '%s'\n", connectionString.c_str());
+		delete provider;
+		return 2;
+	}
+
+	int result = 0;
+	try
+	{
+		FileDataWriter writer(provider);
+		if(positional.size() == 2)
+		{
+			writer.AddAllTables();
+		}
+		else
+		{
+			for(size_t i = 2; i < positional.size(); i++) writer.AddTable(positional[i]);
+		}
+
+		writer.Write(outputDir);
+		printf("Written '%s': %lu tables, %lu run intervals\n", outputDir.c_str(),
+		       (unsigned long)writer.GetTablesCount(), (unsigned long)writer.GetIntervalsCount());
+	}
+	catch(std::exception& ex)
+	{
+		fprintf(stderr, "%s\n", ex.what());
+		result = 3;
+	}
+
+	provider->Disconnect();
+	delete provider;
+	return result;
+}
@@ -0,0 +1,155 @@
+/*
+ * ccdbpack - exports constants of a ccdb database to a ccdbpack file
+ *
+ *   ccdbpack [-v variation] [-t unix time] [-r min-max]... <connection string> <output file> [table path]...
+ *
+ * If no tables are given all tables are exported. If no run ranges are given all runs are exported.
+ * The pack is read by ccdbpack://<output file> connection string
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "CCDB/Providers/SQLiteDataProvider.h"
+#include "CCDB/Providers/PackWriter.h"
+#include "CCDB/Helpers/StringUtils.h"
+#ifdef CCDB_MYSQL
+#include "CCDB/Providers/MySQLDataProvider.h"
+#endif
+
+using namespace std;
+using namespace ccdb;
+
+void print_usage()
+{
+	printf("Usage: ccdbpack [-v variation] [-t unix time] [-r min-max]... <connection string> <output file> [table path]...\n");
+	printf("   -v variation  - variation of constants. Default is 'default'\n");
+	printf("   -t time       - take constants as they were at the unix time. Default is the latest constants\n");
+	printf("   -r min-max    - runs to export, could be given several times. Default is all runs\n");
+	printf("If no table paths are given, all tables are exported\n");
+}
+
+
+DataProvider* create_provider(const string& connectionString)
+{
+	if(connectionString.find("sqlite://") == 0) return new SQLiteDataProvider();
+
+#ifdef CCDB_MYSQL
+	if(connectionString.find("mysql://") == 0) return new MySQLDataProvider();
+#endif
+	return NULL;
+}
+
+
+bool parse_run_range(const string& str, int& runMin, int& runMax)
+{
+	size_t dashPos = str.find('-');
+	if(dashPos == string::npos || dashPos == 0) return false;
+
+	bool minIsOk, maxIsOk;
+	runMin = StringUtils::ParseInt(str.substr(0, dashPos), &minIsOk);
+	runMax = StringUtils::ParseInt(str.substr(dashPos + 1), &maxIsOk);
+	return minIsOk && maxIsOk && runMin <= runMax;
+}
+
+
+int main(int argc, char* argv[])
+{
+	string variation = "default";
+	time_t time = 0;
+	vector<pair<int, int> > runs;
+	vector<string> positional;
+
+	for(int i = 1; i < argc; i++)
+	{
+		string arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+		if(arg == "-h" || arg == "--help")
+		{
+			print_usage();
+			return 0;
+		}
+		else if(arg == "-v" && hasValue)
+		{
+			variation = argv[++i];
+		}
+		else if(arg == "-t" && hasValue)
+		{
+			time = (time_t)atoll(argv[++i]);
+		}
+		else if(arg == "-r" && hasValue)
+		{
+			int runMin, runMax;
+			if(!parse_run_range(argv[++i], runMin, runMax))
+			{
+				fprintf(stderr, "Wrong run range '%s'. Should be like 1000-2000\n", argv[i]);
+				return 1;
+			}
+			runs.push_back(make_pair(runMin, runMax));
+		}
+		else if(arg.size() > 1 && arg[0] == '-')
+		{
+			fprintf(stderr, "Unknown option '%s'\n", arg.c_str());
+			print_usage();
+			return 1;
+		}
+		else
+		{
+			positional.push_back(arg);
+		}
+	}
+
+	if(positional.size() < 2)
+	{
+		print_usage();
+		return 1;
+	}
+	string connectionString = positional[0];
+	string outputFile = positional[1];
+
+	DataProvider* provider = create_provider(connectionString);
+	if(!provider)
+	{
+		fprintf(stderr, "Unknown connection string type: '%s'\n", connectionString.c_str());
+		return 1;
+	}
+	if(!provider->Connect(connectionString))
+	{
+		fprintf(stderr, "Can't connect to '%s'\n", connectionString.c_str());
+		delete provider;
+		return 2;
+	}
+
+	int result = 0;
+	try
+	{
+		PackWriter writer(provider, variation, time);
+		for(size_t i = 0; i < runs.size(); i++) writer.AddRunRange(runs[i].first, runs[i].second);
+
+		if(positional.size() == 2)
+		{
+			writer.AddAllTables();
+		}
+		else
+		{
+			for(size_t i = 2; i < positional.size(); i++) writer.AddTable(positional[i]);
+		}
+
+		writer.Write(outputFile);
+		printf("Written '%s': %lu tables, %lu run intervals, %lu distinct constants\n", outputFile.c_str(),
+		       (unsigned long)writer.GetTablesCount(), (unsigned long)writer.GetIntervalsCount(), (unsigned long)writer.GetBlocksCount());
+	}
+	catch(std::exception& ex)
+	{
+		fprintf(stderr, "%s\n", ex.what());
+		result = 3;
+	}
+
+	provider->Disconnect();
+	delete provider;
+	return result;
+}